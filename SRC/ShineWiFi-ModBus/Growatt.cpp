@@ -1,15 +1,152 @@
-#include <ModbusMaster.h>
+#include "ModbusRtu.h"
 #include <ArduinoJson.h>
 #include <Arduino.h>
 
 #include "GrowattTypes.h"
 #include "Growatt.h"
+#include "JsonWriter.h"
+#include "MsgPackWriter.h"
 #include "Config.h"
 #ifndef __CONFIG_H__
 #error Please rename Config.h.example to Config.h
 #endif
 #include <time.h>
 
+#ifndef MODBUS_MAX_FRAGMENT_SIZE
+#define MODBUS_MAX_FRAGMENT_SIZE 64
+#endif
+#if MODBUS_MAX_FRAGMENT_SIZE > 125
+#error "MODBUS_MAX_FRAGMENT_SIZE is limited to 125 registers by the Modbus protocol"
+#endif
+#ifndef MODBUS_REQUEST_COST
+#define MODBUS_REQUEST_COST 50
+#endif
+#ifndef MODBUS_READ_QUEUE_SIZE
+#define MODBUS_READ_QUEUE_SIZE 4
+#endif
+#ifndef FULL_READ_INTERVAL
+#define FULL_READ_INTERVAL 10
+#endif
+#ifndef MODBUS_PROBE_FRAGMENT_SIZE
+#define MODBUS_PROBE_FRAGMENT_SIZE 0
+#endif
+#ifndef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+#if MODBUS_POLL_TASK == 1 && !defined(ESP32)
+// the ESP8266 polls from loop()
+#undef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+
+#if MODBUS_POLL_TASK == 1
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Keeps the polling task and the blocking requests of the web server from using the Modbus
+// engine at the same time. The mutex is recursive, the blocking functions call each other.
+class BusGuard {
+  public:
+    BusGuard(void *mutex) : _Mutex((SemaphoreHandle_t)mutex) {
+      if (_Mutex != NULL)
+        xSemaphoreTakeRecursive(_Mutex, portMAX_DELAY);
+    }
+    ~BusGuard() {
+      if (_Mutex != NULL)
+        xSemaphoreGiveRecursive(_Mutex);
+    }
+
+  private:
+    SemaphoreHandle_t _Mutex;
+};
+#define BUS_GUARD() BusGuard busGuard(_BusMutex)
+#else
+#define BUS_GUARD()
+#endif
+
+// A read of the probed size has to succeed this often in a row to count as reliable
+#define FRAME_PROBE_ATTEMPTS 3
+// Moving average of reads failing because of their length (0xFFFF = all of them).
+// Above the threshold the fragment size is reduced
+#define FRAME_ERROR_RATE_THRESHOLD 0x8000
+// Reductions stop at the smallest size that still reads each register table in this many requests
+#define FRAME_FLOOR_FRAGMENTS 20
+// A reduced size is raised by a step after this many read cycles in a row without a frame error
+#define FRAME_RECOVERY_CYCLES 60
+
+// Deadbands used for change-only publishing if a register does not define its own,
+// indexed by RegisterUnit_t
+static const float UNIT_DEADBANDS[] PROGMEM = {
+  DEADBAND_ABS(0),    // NONE: status and settings, every change counts
+  DEADBAND_REL(2),    // POWER_W
+  DEADBAND_ABS(0),    // POWER_KWH: counters already have a coarse resolution
+  DEADBAND_ABS(0.5),  // VOLTAGE
+  DEADBAND_ABS(0.1),  // CURRENT
+  DEADBAND_ABS(0),    // SECONDS
+  DEADBAND_ABS(1),    // PRECENTAGE
+  DEADBAND_ABS(0.05), // FREQUENCY
+  DEADBAND_ABS(0.5),  // TEMPERATURE
+  DEADBAND_REL(2),    // VA
+};
+
+// Home Assistant unit and device class of each RegisterUnit_t
+static const char HA_UNITS[][4] PROGMEM = {"", "W", "kWh", "V", "A", "s", "%", "Hz", "°C", "VA"};
+static const char HA_DEVICE_CLASSES[][15] PROGMEM = {
+  "", "power", "energy", "voltage", "current", "duration", "", "frequency", "temperature", "apparent_power"
+};
+
+#define _FRONIUS_STR(x) #x
+#define FRONIUS_STR(x) _FRONIUS_STR(x)
+#define FRONIUS_HEAD(arguments) \
+  "{\"Head\":{\"RequestArguments\":{" arguments "}," \
+  "\"Status\":{\"Code\":0,\"Reason\":\"\",\"UserMessage\":\"\"},\"Timestamp\":" JSON_SLOT_STRING "},"
+#define FRONIUS_VALUE(name, unit) "\"" name "\":{\"Value\":" JSON_SLOT_NUMBER ",\"Unit\":\"" unit "\"}"
+
+// Fronius Solar API documents, their structure never changes, so they are kept as text and
+// only the values are patched in (slots in order of appearance)
+static const char FRONIUS_REALTIME_TEXT[] PROGMEM =
+  FRONIUS_HEAD("\"DeviceId\":1,\"Scope\":\"Device\",\"DataCollection\":\"CommonInverterData\"")
+  "\"Body\":{\"Data\":{"
+  FRONIUS_VALUE("PAC", "W") "," FRONIUS_VALUE("PDC", "W") "," FRONIUS_VALUE("FAC", "Hz") ","
+  FRONIUS_VALUE("UAC", "V") "," FRONIUS_VALUE("IAC", "A") ","
+  FRONIUS_VALUE("UAC_L1", "V") "," FRONIUS_VALUE("UAC_L2", "V") "," FRONIUS_VALUE("UAC_L3", "V") ","
+  FRONIUS_VALUE("IAC_L1", "A") "," FRONIUS_VALUE("IAC_L2", "A") "," FRONIUS_VALUE("IAC_L3", "A") ","
+  "\"DeviceStatus\":{\"ErrorCode\":0,\"StatusCode\":" JSON_SLOT_NUMBER ",\"Status\":" JSON_SLOT_STRING "},"
+  FRONIUS_VALUE("PAC_L1", "W") "," FRONIUS_VALUE("PAC_L2", "W") "," FRONIUS_VALUE("PAC_L3", "W") ","
+  FRONIUS_VALUE("UDC", "V") "," FRONIUS_VALUE("IDC", "A") ","
+  FRONIUS_VALUE("DAY_ENERGY", "Wh") "," FRONIUS_VALUE("DAY_ENERGY_L1", "Wh") ","
+  FRONIUS_VALUE("DAY_ENERGY_L2", "Wh") "," FRONIUS_VALUE("DAY_ENERGY_L3", "Wh") ","
+  FRONIUS_VALUE("TOTAL_ENERGY", "Wh") "," FRONIUS_VALUE("TOTAL_ENERGY_L1", "Wh") ","
+  FRONIUS_VALUE("TOTAL_ENERGY_L2", "Wh") "," FRONIUS_VALUE("TOTAL_ENERGY_L3", "Wh")
+  "}}}";
+
+enum {
+  FR_TIMESTAMP, FR_PAC, FR_PDC, FR_FAC, FR_UAC, FR_IAC, FR_UAC_L1, FR_UAC_L2, FR_UAC_L3,
+  FR_IAC_L1, FR_IAC_L2, FR_IAC_L3, FR_STATUS_CODE, FR_STATUS, FR_PAC_L1, FR_PAC_L2, FR_PAC_L3,
+  FR_UDC, FR_IDC, FR_DAY_ENERGY, FR_DAY_ENERGY_L1, FR_DAY_ENERGY_L2, FR_DAY_ENERGY_L3,
+  FR_TOTAL_ENERGY, FR_TOTAL_ENERGY_L1, FR_TOTAL_ENERGY_L2, FR_TOTAL_ENERGY_L3, FR_SLOT_COUNT
+};
+
+static const char FRONIUS_POWER_FLOW_TEXT[] PROGMEM =
+  FRONIUS_HEAD("")
+  "\"Body\":{\"Data\":{\"Site\":{\"P_PV\":" JSON_SLOT_NUMBER ",\"P_Load\":" JSON_SLOT_NUMBER ","
+  "\"E_DAY\":" JSON_SLOT_NUMBER ",\"E_TOTAL\":" JSON_SLOT_NUMBER "},"
+  "\"Inverters\":{\"1\":{\"DT\":" FRONIUS_STR(FRONIUS_DEVICE_TYPE) ",\"P\":" JSON_SLOT_NUMBER "}}}}}";
+
+enum { PF_TIMESTAMP, PF_P_PV, PF_P_LOAD, PF_E_DAY, PF_E_TOTAL, PF_INVERTER_P, PF_SLOT_COUNT };
+
+static const char FRONIUS_INVERTER_INFO_TEXT[] PROGMEM =
+  FRONIUS_HEAD("")
+  "\"Body\":{\"Data\":{\"1\":{\"CustomName\":\"Growatt Inverter\","
+  "\"DT\":" FRONIUS_STR(FRONIUS_DEVICE_TYPE) ",\"ErrorCode\":0,\"PVPower\":" JSON_SLOT_NUMBER ",\"Show\":1,"
+  "\"StatusCode\":" JSON_SLOT_NUMBER ",\"Status\":" JSON_SLOT_STRING ",\"UniqueID\":\"" FRONIUS_SERIAL "\"}}}}";
+
+enum { II_TIMESTAMP, II_PV_POWER, II_STATUS_CODE, II_STATUS, II_SLOT_COUNT };
+
+static JsonTemplate FroniusRealtimeTemplate(FRONIUS_REALTIME_TEXT, FR_SLOT_COUNT);
+static JsonTemplate FroniusPowerFlowTemplate(FRONIUS_POWER_FLOW_TEXT, PF_SLOT_COUNT);
+static JsonTemplate FroniusInverterInfoTemplate(FRONIUS_INVERTER_INFO_TEXT, II_SLOT_COUNT);
+
 #if GROWATT_MODBUS_VERSION == 120
   #include "Growatt120.h"
 #elif GROWATT_MODBUS_VERSION == 124
@@ -22,17 +159,59 @@
   #error "Unsupported Growatt Modbus version"
 #endif
 
-ModbusMaster Modbus;
+ModbusRtu Modbus;
 
 // Constructor
 Growatt::Growatt() {
   _eDevice = Undef_stick;
   _PacketCnt = 0;
-  _prevTotalEnergy = 0;
-  _prevEnergyValid = false;
-  _accEnergyL1 = 0;
-  _accEnergyL2 = 0;
-  _accEnergyL3 = 0;
+  _ValuesPacketCnt = 0;
+  _CyclePacketCnt[0] = 0;
+  _CyclePacketCnt[1] = 0;
+  _ValuesTime = 0;
+  _CycleTime[0] = 0;
+  _CycleTime[1] = 0;
+  _CycleStart = 0;
+  _CycleDuration = 0;
+  _MaxFragmentSize = MODBUS_MAX_FRAGMENT_SIZE;
+  _ProbedFragmentSize = MODBUS_MAX_FRAGMENT_SIZE;
+  _MinFragmentSize = 2;
+  _FrameErrorRate = 0;
+  _CleanCycles = 0;
+  memset(_InputPolled, 0, sizeof(_InputPolled));
+  memset(_HoldingPolled, 0, sizeof(_HoldingPolled));
+  memset(_InputFresh, 0, sizeof(_InputFresh));
+  memset(_HoldingFresh, 0, sizeof(_HoldingFresh));
+  _PollCycle = 0;
+  _StatusChanged = false;
+  _LastStatus = 0;
+  _StatusDue = false;
+  _Serial = NULL;
+  _Step = STEP_IDLE;
+  _Fragment = 0;
+  _StepTimer = 0;
+  _Result = READ_IDLE;
+  _VerifyHolding = false;
+  _ReadQueue = NULL;
+  _InputPublished = NULL;
+  _HoldingPublished = NULL;
+  _InputDeadbands = NULL;
+  _HoldingDeadbands = NULL;
+  _PublishSeq = 0;
+  _DeltaFull = false;
+  memset(_InputDelta, 0, sizeof(_InputDelta));
+  memset(_HoldingDelta, 0, sizeof(_HoldingDelta));
+  memset(_HoldingDuplicate, 0, sizeof(_HoldingDuplicate));
+  memset(_JsonCache, 0, sizeof(_JsonCache));
+  _JsonGeneration = 0;
+  _SchemaId = 0;
+  _InputTarget = NULL;
+  _HoldingTarget = NULL;
+  memset(_InputSnapshot, 0, sizeof(_InputSnapshot));
+  memset(_HoldingSnapshot, 0, sizeof(_HoldingSnapshot));
+  _Published = 0;
+  _ReaderSnapshot = 0;
+  _BusMutex = NULL;
 }
 
 void Growatt::InitProtocol() {
@@ -51,34 +230,274 @@ void Growatt::InitProtocol() {
   #else
     #error "Unsupported Growatt Modbus version"
   #endif
+
+  _MinFragmentSize = _FindMinFragmentSize();
+  _PlanReadFragments(_MaxFragmentSize);
+  _SchemaId = _ComputeSchemaId();
+  _FindDuplicateHoldings();
+  // the file system is mounted before
+  _PhaseEnergy.Begin();
+
+  if (_InputPublished == NULL) {
+    _InputPublished = (uint32_t *)calloc(_Protocol.InputRegisterCount + 1, sizeof(uint32_t));
+    _HoldingPublished = (uint32_t *)calloc(_Protocol.HoldingRegisterCount + 1, sizeof(uint32_t));
+    _InputDeadbands = (sRawDeadband_t *)calloc(_Protocol.InputRegisterCount + 1, sizeof(sRawDeadband_t));
+    _HoldingDeadbands = (sRawDeadband_t *)calloc(_Protocol.HoldingRegisterCount + 1, sizeof(sRawDeadband_t));
+  }
+  if (_InputDeadbands != NULL && _HoldingDeadbands != NULL) {
+    for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+      _InputDeadbands[i] = _RawDeadband(_Protocol.InputRegisters[i]);
+    }
+    for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+      _HoldingDeadbands[i] = _RawDeadband(_Protocol.HoldingRegisters[i]);
+    }
+  }
+
+  // a read cycle decodes directly into the values of the protocol, unless it runs in a task
+  // of its own: then it fills the snapshot the reader does not use (see AcquireSnapshot())
+  _InputTarget = _Protocol.InputValues;
+  _HoldingTarget = _Protocol.HoldingValues;
+#if MODBUS_POLL_TASK == 1
+  if (_BusMutex == NULL)
+    _BusMutex = xSemaphoreCreateRecursiveMutex();
+  _InputSnapshot[0] = _Protocol.InputValues;
+  _HoldingSnapshot[0] = _Protocol.HoldingValues;
+  if (_InputSnapshot[1] == NULL) {
+    _InputSnapshot[1] = (uint32_t *)calloc(_Protocol.InputRegisterCount + 1, sizeof(uint32_t));
+    _HoldingSnapshot[1] = (uint32_t *)calloc(_Protocol.HoldingRegisterCount + 1, sizeof(uint32_t));
+  }
+  if (_InputSnapshot[1] == NULL || _HoldingSnapshot[1] == NULL) {
+    // without memory for a second set both snapshots share the values, as on the ESP8266
+    free(_InputSnapshot[1]);
+    free(_HoldingSnapshot[1]);
+    _InputSnapshot[1] = _InputSnapshot[0];
+    _HoldingSnapshot[1] = _HoldingSnapshot[0];
+  }
+  _Published = 0;
+  _ReaderSnapshot = 0;
+#endif
+}
+
+uint8_t Growatt::ProbeMaxFragmentSize() {
+  /**
+   * @brief Find the largest number of input registers the inverter returns in a single read
+   *        using a binary search between 2 and MODBUS_MAX_FRAGMENT_SIZE
+   * @returns the largest reliable read size, 0 if the inverter does not answer at all
+   */
+  BUS_GUARD();
+  uint8_t good = 1;
+  uint8_t bad = MODBUS_MAX_FRAGMENT_SIZE + 1;
+
+  // most inverters take the maximum, so try that first
+  if (_ProbeFrameSize(MODBUS_MAX_FRAGMENT_SIZE)) {
+    return MODBUS_MAX_FRAGMENT_SIZE;
+  }
+  bad = MODBUS_MAX_FRAGMENT_SIZE;
+
+  while (bad - good > 1) {
+    uint8_t size = (good + bad) / 2;
+    if (_ProbeFrameSize(size)) {
+      good = size;
+    } else {
+      bad = size;
+    }
+  }
+  // a 32 bit register needs at least two registers per read
+  return (good >= 2) ? good : 0;
+}
+
+bool Growatt::_ProbeFrameSize(uint8_t size) {
+  /**
+   * @brief Check whether reads of the given length are answered reliably
+   * @param size number of registers to read, starting at address 0
+   * @returns true if all attempts succeeded
+   */
+  _WaitIdle();
+  for (int i = 0; i < FRAME_PROBE_ATTEMPTS; i++) {
+    if (Modbus.readInputRegisters(0, size) != Modbus.ku8MBSuccess) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Growatt::SetMaxFragmentSize(uint8_t size) {
+  /**
+   * @brief Set the largest number of registers read at once (e.g. the probed size) and replan
+   *        the read fragments. Frame errors reduce the size for a while, it never grows above
+   *        this one.
+   * @param size number of registers, limited to 2..MODBUS_MAX_FRAGMENT_SIZE
+   */
+  BUS_GUARD();
+  if (size < 2)
+    size = 2;
+  if (size > MODBUS_MAX_FRAGMENT_SIZE)
+    size = MODBUS_MAX_FRAGMENT_SIZE;
+  _ProbedFragmentSize = size;
+  _SetFragmentSize(size);
+}
+
+void Growatt::_SetFragmentSize(uint8_t size) {
+  BUS_GUARD();
+  _MaxFragmentSize = size;
+  _FrameErrorRate = 0;
+  _CleanCycles = 0;
+  _PlanReadFragments(_MaxFragmentSize);
+}
+
+uint8_t Growatt::_FindMinFragmentSize() {
+  /**
+   * @brief Find the smallest fragment size that reads each register table in at most
+   *        FRAME_FLOOR_FRAGMENTS requests, frame errors don't reduce the size below it
+   */
+  uint8_t size;
+
+  for (size = 2; size < MODBUS_MAX_FRAGMENT_SIZE; size++) {
+    _PlanReadFragments(size);
+    if (_Protocol.InputFragmentCount <= FRAME_FLOOR_FRAGMENTS && _Protocol.HoldingFragmentCount <= FRAME_FLOOR_FRAGMENTS)
+      break;
+  }
+  return size;
+}
+
+uint8_t Growatt::GetMaxFragmentSize() {
+  return _MaxFragmentSize;
+}
+
+void Growatt::SetModbusTrace(ModbusTrace_t trace) {
+  /**
+   * @brief Pass every completed Modbus request to a function, e.g. to record the traffic.
+   *        With MODBUS_POLL_TASK it is called from the polling task.
+   */
+  BUS_GUARD();
+
+  Modbus.setTrace(trace);
+}
+
+void Growatt::_TrackFrameError(const sGrowattReadFragment_t &fragment) {
+  /**
+   * @brief A fragment read failed, but a single register at the same address could still be
+   *        read (see STEP_VERIFY). The inverter is alive and the length of the read is the
+   *        likely cause. When this happens too often, the fragment size is reduced below the
+   *        failing length, but not below the floor (_FindMinFragmentSize()) or the size set.
+   *        The reduction is not stored, a noisy line must not shrink the size for good.
+   * @param fragment the fragment that failed
+   */
+  uint8_t floor = (_MinFragmentSize < _ProbedFragmentSize) ? _MinFragmentSize : _ProbedFragmentSize;
+  uint8_t size = fragment.FragmentSize - (fragment.FragmentSize >> 2) - 1;
+
+  _CleanCycles = 0;
+  _FrameErrorRate += (0xFFFF - _FrameErrorRate) >> 2;
+  if (_FrameErrorRate > FRAME_ERROR_RATE_THRESHOLD) {
+    if (size < floor)
+      size = floor;
+    if (size < _MaxFragmentSize)
+      _SetFragmentSize(size);
+  }
+}
+
+void Growatt::_PlanReadFragments(uint8_t maxFragmentSize) {
+  /**
+   * @brief Plan the read fragments covering the complete register tables
+   * @param maxFragmentSize maximal number of registers per read
+   */
+  uint8_t all[GROWATT_MAX_REGISTERS];
+
+  for (int i = 0; i < GROWATT_MAX_REGISTERS; i++) {
+    all[i] = i;
+  }
+  _Protocol.InputFragmentCount = _PlanFragments(_Protocol.InputRegisters, all, _Protocol.InputRegisterCount,
+                                                maxFragmentSize, _Protocol.InputReadFragments);
+  _Protocol.HoldingFragmentCount = _PlanFragments(_Protocol.HoldingRegisters, all, _Protocol.HoldingRegisterCount,
+                                                  maxFragmentSize, _Protocol.HoldingReadFragments);
+}
+
+uint8_t Growatt::_PlanFragments(const sGrowattModbusReg_t *registers, const uint8_t *indices, uint8_t indexCount,
+                                uint8_t maxFragmentSize, sGrowattReadFragment_t *fragments) {
+  /**
+   * @brief Compute the cheapest set of read windows covering the given registers.
+   *        Every request costs MODBUS_REQUEST_COST, every transferred register (including
+   *        the unused ones in a gap) costs 1. No window is longer than maxFragmentSize.
+   * @param registers the register table
+   * @param indices indices of the registers that have to be read
+   * @param indexCount number of indices
+   * @param maxFragmentSize maximal number of registers per window
+   * @param fragments array receiving the windows, sorted by address. There is at most one
+   *        window per register, so GROWATT_MAX_FRAGMENTS windows cover any table at any size.
+   * @returns number of planned windows
+   */
+  uint8_t order[GROWATT_MAX_REGISTERS];
+  uint32_t cost[GROWATT_MAX_REGISTERS + 1];     // cost[i]: cheapest way to read the first i registers in address order
+  uint8_t lastStart[GROWATT_MAX_REGISTERS + 1]; // first register of the last window in that solution
+  uint8_t n = 0;
+
+  // sort by address (insertion sort, the tables are small)
+  for (int i = 0; i < indexCount; i++) {
+    int j = i;
+    while (j > 0 && registers[order[j - 1]].Address() > registers[indices[i]].Address()) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = indices[i];
+  }
+
+  cost[0] = 0;
+  for (int i = 1; i <= indexCount; i++) {
+    uint32_t end = 0;
+    cost[i] = UINT32_MAX;
+    // the last window covers the registers order[j - 1] .. order[i - 1]
+    for (int j = i; j >= 1; j--) {
+      const sGrowattModbusReg_t &reg = registers[order[j - 1]];
+      uint32_t regEnd = reg.Address() + ((reg.Size() == SIZE_16BIT) ? 1 : 2);
+      if (regEnd > end)
+        end = regEnd;
+      uint32_t span = end - reg.Address();
+      if (span > maxFragmentSize)
+        break; // windows starting further down are even longer
+      uint32_t c = cost[j - 1] + MODBUS_REQUEST_COST + span;
+      if (c < cost[i]) {
+        cost[i] = c;
+        lastStart[i] = j - 1;
+      }
+    }
+  }
+
+  // walk back from the end; windows come out in descending address order
+  for (int i = indexCount; i > 0; i = lastStart[i]) {
+    n++;
+  }
+  uint8_t w = n;
+  for (int i = indexCount; i > 0; i = lastStart[i]) {
+    w--;
+    uint16_t start = registers[order[lastStart[i]]].Address();
+    uint16_t end = 0;
+    for (int k = lastStart[i]; k < i; k++) {
+      const sGrowattModbusReg_t &reg = registers[order[k]];
+      uint16_t regEnd = reg.Address() + ((reg.Size() == SIZE_16BIT) ? 1 : 2);
+      if (regEnd > end)
+        end = regEnd;
+    }
+    fragments[w].StartAddress = start;
+    fragments[w].FragmentSize = end - start;
+  }
+  return n;
 }
 
 void Growatt::begin(Stream &serial) {
   /**
-   * @brief Set up communication with the inverter
+   * @brief Start the detection of the wifi stick, it is completed by Poll(). The stick type
+   *        stays Undef_stick until an inverter answered.
    * @param serial The serial interface
    */
-  uint8_t res;
-
   #if SIMULATE_INVERTER == 1
     _eDevice = SIMULATE_DEVICE;
   #else
-    // init communication with the inverter
-    Serial.begin(9600);
-    Modbus.begin(1, serial);
-    res = Modbus.readInputRegisters(0, 1);
-    if(res == Modbus.ku8MBSuccess) {
-      _eDevice = ShineWiFi_S; // Serial
-    } else {
-      delay(1000);
-      Serial.begin(115200);
-      Modbus.begin(1, serial);
-      res = Modbus.readInputRegisters(0, 1);
-      if(res == Modbus.ku8MBSuccess) {
-        _eDevice = ShineWiFi_X; // USB
-      }
-      delay(1000);
-    }
+    BUS_GUARD();
+    _WaitIdle();
+    _Serial = &serial;
+    _eDevice = Undef_stick;
+    _Result = READ_IDLE;
+    _Step = STEP_DETECT_S;
   #endif
 }
 
@@ -93,426 +512,1470 @@ eDevice_t Growatt::GetWiFiStickType() {
 
 bool Growatt::ReadInputRegisters() {
   /**
-   * @brief Read the input registers from the inverter
+   * @brief Read all input registers from the inverter, blocks until done
    * @returns true if data was read successfully, false otherwise
    */
-  uint16_t registerAddress;
+  BUS_GUARD();
+  _WaitIdle();
+  _PlanCycle(_Protocol.InputRegisters, _Protocol.InputRegisterCount, _InputPolled, true, _InputCyclePlan);
+  return _ReadPlan(false, _InputCyclePlan);
+}
+
+bool Growatt::ReadHoldingRegisters() {
+  /**
+   * @brief Read all holding registers from the inverter, blocks until done
+   * @returns true if data was read successfully, false otherwise
+   */
+  BUS_GUARD();
+  _WaitIdle();
+  _PlanCycle(_Protocol.HoldingRegisters, _Protocol.HoldingRegisterCount, _HoldingPolled, true, _HoldingCyclePlan);
+  return _ReadPlan(true, _HoldingCyclePlan);
+}
+
+void Growatt::_ScheduleCycle(bool fullRead) {
+  /**
+   * @brief Plan the fragments of this cycle from the registers that are due
+   * @param fullRead read all registers regardless of their polling class
+   */
+  _PlanCycle(_Protocol.InputRegisters, _Protocol.InputRegisterCount, _InputPolled, fullRead, _InputCyclePlan);
+  _PlanCycle(_Protocol.HoldingRegisters, _Protocol.HoldingRegisterCount, _HoldingPolled, fullRead, _HoldingCyclePlan);
+}
+
+bool Growatt::_IsDue(const sGrowattModbusReg_t &reg, bool polled, bool fullRead) {
+  /**
+   * @brief Check whether a register has to be read in the current cycle
+   * @param reg the register
+   * @param polled true if the register has been read before
+   * @param fullRead read all registers regardless of their polling class
+   * @returns true if the register is due
+   */
+  if (fullRead || !polled)
+    return true;
+
+  switch (reg.Poll()) {
+    case POLL_ALWAYS:
+      return true;
+    case POLL_SLOW:
+      return (_PollCycle % FULL_READ_INTERVAL) == 0;
+    case POLL_ON_STATUS:
+      return _StatusChanged;
+    default:
+      return false; // POLL_ONCE
+  }
+}
+
+void Growatt::_PlanCycle(const sGrowattModbusReg_t *registers, uint16_t registerCount, const uint8_t *polled,
+                         bool fullRead, sGrowattReadPlan_t &plan) {
+  /**
+   * @brief Select the due registers of a table and plan their fragments and decoding
+   * @param registers the register table
+   * @param registerCount number of registers in the table
+   * @param polled bit set of the registers read before
+   * @param fullRead read all registers regardless of their polling class
+   * @param plan the plan to fill
+   */
+  uint8_t due[GROWATT_MAX_REGISTERS];
+  uint8_t dueCount = 0;
+
+  for (int i = 0; i < registerCount; i++) {
+    if (_IsDue(registers[i], polled[i >> 3] & (1 << (i & 7)), fullRead))
+      due[dueCount++] = i;
+  }
+  plan.FragmentCount = _PlanFragments(registers, due, dueCount, _MaxFragmentSize, plan.Fragments);
+  _BuildDecodePlan(registers, registerCount, plan.Fragments, plan.FragmentCount, plan.Decode);
+}
+
+bool Growatt::_ReadPlan(bool holding, const sGrowattReadPlan_t &plan) {
+  /**
+   * @brief Read the fragments of a plan one after the other and decode them
+   * @param holding true for the holding register table, false for the input register table
+   * @param plan the fragments and decode plan
+   * @returns true if all fragments were read successfully, false otherwise
+   */
   uint8_t res;
 
   // read each fragment separately
-  for (int i = 0; i < _Protocol.InputFragmentCount; i++) {
-    res = Modbus.readInputRegisters(
-      _Protocol.InputReadFragments[i].StartAddress,
-      _Protocol.InputReadFragments[i].FragmentSize
-    );
-    if(res == Modbus.ku8MBSuccess) {
-      for (int j = 0; j < _Protocol.InputRegisterCount; j++) {
-        // make sure the register we try to read is in the fragment
-        if (_Protocol.InputRegisters[j].address >= _Protocol.InputReadFragments[i].StartAddress) {
-          // when we exceed the fragment size, skip to new fragment
-          if (_Protocol.InputRegisters[j].address >= _Protocol.InputReadFragments[i].StartAddress + _Protocol.InputReadFragments[i].FragmentSize)
-            break;
-          // let's say the register address is 1013 and read window is 1000-1050
-          // that means the response in the buffer is on position 1013 - 1000 = 13
-          registerAddress = _Protocol.InputRegisters[j].address - _Protocol.InputReadFragments[i].StartAddress;
-          if (_Protocol.InputRegisters[j].size == SIZE_16BIT) {
-            _Protocol.InputRegisters[j].value = Modbus.getResponseBuffer(registerAddress);
-          } else {
-            _Protocol.InputRegisters[j].value = (Modbus.getResponseBuffer(registerAddress) << 16) + Modbus.getResponseBuffer(registerAddress + 1);
-          }
-        }
-      }
+  for (int i = 0; i < plan.FragmentCount; i++) {
+    if (holding) {
+      res = Modbus.readHoldingRegisters(plan.Fragments[i].StartAddress, plan.Fragments[i].FragmentSize);
     } else {
+      res = Modbus.readInputRegisters(plan.Fragments[i].StartAddress, plan.Fragments[i].FragmentSize);
+    }
+    if (res != Modbus.ku8MBSuccess) {
       return false;
     }
+    if (holding) {
+      _DecodeFragment(_HoldingTarget, _HoldingPolled, plan.Decode, i);
+    } else {
+      _DecodeFragment(_InputTarget, _InputPolled, plan.Decode, i);
+    }
   }
   return true;
 }
 
-bool Growatt::ReadInputRegistersFast() {
-  uint16_t registerAddress;
-  uint8_t res;
-  for (int i = 0; i < _Protocol.InputFastFragmentCount; i++) {
-    res = Modbus.readInputRegisters(
-      _Protocol.InputReadFragments[i].StartAddress,
-      _Protocol.InputReadFragments[i].FragmentSize
-    );
-    if(res == Modbus.ku8MBSuccess) {
-      for (int j = 0; j < _Protocol.InputRegisterCount; j++) {
-        if (_Protocol.InputRegisters[j].address >= _Protocol.InputReadFragments[i].StartAddress) {
-          if (_Protocol.InputRegisters[j].address >= _Protocol.InputReadFragments[i].StartAddress + _Protocol.InputReadFragments[i].FragmentSize)
-            break;
-          registerAddress = _Protocol.InputRegisters[j].address - _Protocol.InputReadFragments[i].StartAddress;
-          if (_Protocol.InputRegisters[j].size == SIZE_16BIT) {
-            _Protocol.InputRegisters[j].value = Modbus.getResponseBuffer(registerAddress);
-          } else {
-            _Protocol.InputRegisters[j].value = (Modbus.getResponseBuffer(registerAddress) << 16) + Modbus.getResponseBuffer(registerAddress + 1);
-          }
-        }
-      }
+void Growatt::_DecodeFragment(uint32_t *values, uint8_t *polled,
+                              const sGrowattDecodePlan_t &plan, uint8_t fragment) {
+  /**
+   * @brief Copy the registers of one fragment from the Modbus response buffer into the value table
+   * @param values the values of the register table the plan was built for
+   * @param polled bit set of the registers read before, updated with the decoded registers
+   * @param plan the decode plan
+   * @param fragment index of the fragment that is in the response buffer
+   */
+  for (uint8_t e = plan.FragmentStart[fragment]; e < plan.FragmentStart[fragment + 1]; e++) {
+    const sGrowattDecodeEntry_t &entry = plan.Entries[e];
+    if (entry.Width == 1) {
+      values[entry.RegisterIndex] = Modbus.getResponseBuffer(entry.BufferOffset);
     } else {
-      return false;
+      values[entry.RegisterIndex] = (Modbus.getResponseBuffer(entry.BufferOffset) << 16) + Modbus.getResponseBuffer(entry.BufferOffset + 1);
     }
+    polled[entry.RegisterIndex >> 3] |= 1 << (entry.RegisterIndex & 7);
   }
-  return true;
 }
 
-bool Growatt::ReadHoldingRegisters() {
+void Growatt::_BuildDecodePlan(const sGrowattModbusReg_t *registers, uint16_t registerCount,
+                               const sGrowattReadFragment_t *fragments, uint8_t fragmentCount,
+                               sGrowattDecodePlan_t &plan) {
   /**
-   * @brief Read the holding registers from the inverter
+   * @brief Map every register to the fragment(s) containing it. The register table does not
+   *        need to be sorted by address.
+   * @param registers the register table
+   * @param registerCount number of registers in the table
+   * @param fragments the read fragments
+   * @param fragmentCount number of read fragments
+   * @param plan the plan to fill
+   */
+  const uint8_t maxEntries = sizeof(plan.Entries) / sizeof(plan.Entries[0]);
+  uint8_t n = 0;
+
+  for (int i = 0; i < fragmentCount; i++) {
+    plan.FragmentStart[i] = n;
+    for (int j = 0; j < registerCount; j++) {
+      uint8_t width = (registers[j].Size() == SIZE_16BIT) ? 1 : 2;
+      // let's say the register address is 1013 and read window is 1000-1050
+      // that means the response in the buffer is on position 1013 - 1000 = 13
+      if (registers[j].Address() >= fragments[i].StartAddress &&
+          registers[j].Address() + width <= fragments[i].StartAddress + fragments[i].FragmentSize &&
+          n < maxEntries) {
+        plan.Entries[n].BufferOffset = registers[j].Address() - fragments[i].StartAddress;
+        plan.Entries[n].RegisterIndex = j;
+        plan.Entries[n].Width = width;
+        n++;
+      }
+    }
+  }
+  plan.FragmentStart[fragmentCount] = n;
+}
+
+bool Growatt::ReadData(bool fullRead) {
+  /**
+   * @brief Reads the registers that are due in this cycle (see RegisterPollClass_t) from the
+   *        inverter and updates the internal data structures, blocks until done
+   * @param fullRead read all registers regardless of their polling class
    * @returns true if data was read successfully, false otherwise
    */
-  uint16_t registerAddress;
-  uint8_t res;
+  eReadState_t state;
+  BUS_GUARD();
 
-  // read each fragment separately
-  for (int i = 0; i < _Protocol.HoldingFragmentCount; i++) {
-    res = Modbus.readHoldingRegisters(
-      _Protocol.HoldingReadFragments[i].StartAddress,
-      _Protocol.HoldingReadFragments[i].FragmentSize
-    );
-    if(res == Modbus.ku8MBSuccess) {
-      for (int j = 0; j < _Protocol.HoldingRegisterCount; j++) {
-        if (_Protocol.HoldingRegisters[j].address >= _Protocol.HoldingReadFragments[i].StartAddress) {
-          if (_Protocol.HoldingRegisters[j].address >= _Protocol.HoldingReadFragments[i].StartAddress + _Protocol.HoldingReadFragments[i].FragmentSize)
-            break;
-          registerAddress = _Protocol.HoldingRegisters[j].address - _Protocol.HoldingReadFragments[i].StartAddress;
-          if (_Protocol.HoldingRegisters[j].size == SIZE_16BIT) {
-            _Protocol.HoldingRegisters[j].value = Modbus.getResponseBuffer(registerAddress);
-          } else {
-            _Protocol.HoldingRegisters[j].value = (Modbus.getResponseBuffer(registerAddress) << 16) + Modbus.getResponseBuffer(registerAddress + 1);
-          }
+  _WaitIdle();
+  if (!StartReadData(fullRead))
+    return false;
+  while ((state = Poll()) == READ_BUSY) {
+    yield();
+  }
+  return state == READ_SUCCEEDED;
+}
+
+bool Growatt::StartReadData(bool fullRead) {
+  /**
+   * @brief Start a read cycle of the registers that are due (see RegisterPollClass_t).
+   *        The cycle is carried out by Poll().
+   * @param fullRead read all registers regardless of their polling class
+   * @returns true if the cycle was started, false if no stick is detected, the
+   *          communication is busy or the reader did not take over the last snapshot yet
+   */
+  BUS_GUARD();
+  if (_eDevice == Undef_stick || _Step != STEP_IDLE)
+    return false;
+  if (!_BeginSnapshot())
+    return false;
+
+  _PacketCnt++;
+  _CycleStart = micros();
+  _StatusDue = _StatusChanged;
+  _ScheduleCycle(fullRead);
+  _Fragment = 0;
+  _Result = READ_IDLE;
+  _Step = STEP_INPUT;
+  return true;
+}
+
+eReadState_t Growatt::Poll() {
+  /**
+   * @brief Advance the communication with the inverter, to be called from loop().
+   *        Returns immediately: at most one Modbus request is started or completed per call.
+   * @returns READ_BUSY while stick detection or a read cycle is running. The result of a
+   *          finished read cycle is returned once, afterwards READ_IDLE.
+   */
+  eReadState_t result;
+  BUS_GUARD();
+
+  if (_Step != STEP_IDLE) {
+    if (Modbus.busy()) {
+      uint8_t res = Modbus.poll();
+      if (res == Modbus.ku8MBBusy)
+        return READ_BUSY;
+      _CompleteStep(res);
+    } else {
+      _StartStep();
+    }
+    if (_Step != STEP_IDLE)
+      return READ_BUSY;
+  }
+
+  result = _Result;
+  _Result = READ_IDLE;
+  return result;
+}
+
+uint32_t Growatt::GetCycleDuration() {
+  /**
+   * @returns duration of the last finished read cycle in microseconds
+   */
+  return _CycleDuration;
+}
+
+void Growatt::_StartStep() {
+  /**
+   * @brief Send the request of the current step, the engine has to be idle
+   */
+  switch (_Step) {
+    case STEP_DETECT_S:
+      Serial.begin(9600);
+      Modbus.begin(1, *_Serial);
+      Modbus.startReadInputRegisters(0, 1);
+      break;
+    case STEP_DETECT_WAIT:
+      if ((uint32_t)(millis() - _StepTimer) < 1000)
+        break;
+      Serial.begin(115200);
+      Modbus.begin(1, *_Serial);
+      Modbus.startReadInputRegisters(0, 1);
+      _Step = STEP_DETECT_X;
+      break;
+    case STEP_INPUT:
+    case STEP_HOLDING:
+    case STEP_QUEUED:
+      if (!_StartFragment())
+        _FinishCycle(true);
+      break;
+    case STEP_VERIFY: {
+      const sGrowattReadPlan_t &plan = _VerifyHolding ? _HoldingCyclePlan : _InputCyclePlan;
+      const sGrowattReadFragment_t &fragment = plan.Fragments[_Fragment];
+      if (_VerifyHolding) {
+        Modbus.startReadHoldingRegisters(fragment.StartAddress, 1);
+      } else {
+        Modbus.startReadInputRegisters(fragment.StartAddress, 1);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+bool Growatt::_StartFragment() {
+  /**
+   * @brief Send the read request of the next fragment of the cycle, moves on to the
+   *        holding registers when the input registers are done
+   * @returns false if all fragments of the cycle have been read
+   */
+  if (_Step == STEP_INPUT && _Fragment >= _InputCyclePlan.FragmentCount) {
+    _Step = STEP_HOLDING;
+    _Fragment = 0;
+  }
+  if (_Step == STEP_INPUT) {
+    const sGrowattReadFragment_t &fragment = _InputCyclePlan.Fragments[_Fragment];
+    return Modbus.startReadInputRegisters(fragment.StartAddress, fragment.FragmentSize);
+  }
+  if (_Step == STEP_HOLDING && _Fragment >= _HoldingCyclePlan.FragmentCount) {
+    _Step = STEP_QUEUED;
+    _Fragment = 0;
+  }
+  if (_Step == STEP_HOLDING) {
+    const sGrowattReadFragment_t &fragment = _HoldingCyclePlan.Fragments[_Fragment];
+    return Modbus.startReadHoldingRegisters(fragment.StartAddress, fragment.FragmentSize);
+  }
+  return _StartQueuedRead();
+}
+
+bool Growatt::_StartQueuedRead() {
+  /**
+   * @brief Send the next read of the queued reads (QueueRead()), an entry is read in parts of
+   *        at most _MaxFragmentSize registers
+   * @returns false if no queued read is left
+   */
+  if (_ReadQueue == NULL)
+    return false;
+
+  for (; _Fragment < MODBUS_READ_QUEUE_SIZE; _Fragment++) {
+    sGrowattQueuedRead_t &read = _ReadQueue[_Fragment];
+    if (read.State == QUEUED_WAITING) {
+      read.State = QUEUED_READING;
+      read.Done = 0;
+    }
+    if (read.State != QUEUED_READING)
+      continue;
+
+    uint8_t count = (read.Count - read.Done > _MaxFragmentSize) ? _MaxFragmentSize : read.Count - read.Done;
+    if (read.Holding)
+      return Modbus.startReadHoldingRegisters(read.Address + read.Done, count);
+    return Modbus.startReadInputRegisters(read.Address + read.Done, count);
+  }
+  return false;
+}
+
+void Growatt::_CompleteQueuedRead(uint8_t res) {
+  /**
+   * @brief Store the answer to a part of the queued read being read
+   * @param res result of the Modbus request
+   */
+  sGrowattQueuedRead_t &read = _ReadQueue[_Fragment];
+  uint8_t count = (read.Count - read.Done > _MaxFragmentSize) ? _MaxFragmentSize : read.Count - read.Done;
+
+  if (res == Modbus.ku8MBSuccess) {
+    for (uint8_t i = 0; i < count; i++) {
+      read.Words[read.Done + i] = Modbus.getResponseBuffer(i);
+    }
+    read.Done += count;
+    if (read.Done < read.Count)
+      return;
+    read.State = QUEUED_DONE;
+  } else {
+    read.State = QUEUED_FAILED;
+    read.Result = res;
+  }
+  // nobody waits for it any more
+  if (read.Users == 0)
+    read.State = QUEUED_FREE;
+  _Fragment++;
+}
+
+void Growatt::_CompleteStep(uint8_t res) {
+  /**
+   * @brief Handle the answer of the current step and move on to the next one
+   * @param res result of the Modbus request
+   */
+  bool ok = (res == Modbus.ku8MBSuccess);
+
+  switch (_Step) {
+    case STEP_DETECT_S:
+      if (ok) {
+        _eDevice = ShineWiFi_S; // Serial
+        _Step = STEP_IDLE;
+      } else {
+        _StepTimer = millis();
+        _Step = STEP_DETECT_WAIT;
+      }
+      break;
+    case STEP_DETECT_X:
+      if (ok)
+        _eDevice = ShineWiFi_X; // USB
+      _Step = STEP_IDLE;
+      break;
+    case STEP_INPUT:
+    case STEP_HOLDING:
+      if (ok) {
+        _FrameErrorRate -= _FrameErrorRate >> 4;
+        if (_Step == STEP_HOLDING) {
+          _DecodeFragment(_HoldingTarget, _HoldingPolled, _HoldingCyclePlan.Decode, _Fragment);
+        } else {
+          _DecodeFragment(_InputTarget, _InputPolled, _InputCyclePlan.Decode, _Fragment);
         }
+        _Fragment++;
+        break;
+      }
+#if MODBUS_PROBE_FRAGMENT_SIZE == 1
+      // check with a single register whether the inverter is alive and the read was too long
+      _VerifyHolding = (_Step == STEP_HOLDING);
+      if ((_VerifyHolding ? _HoldingCyclePlan : _InputCyclePlan).Fragments[_Fragment].FragmentSize > 2) {
+        _Step = STEP_VERIFY;
+        break;
+      }
+#endif
+      _FinishCycle(false);
+      break;
+    case STEP_QUEUED:
+      // a failed queued read doesn't fail the cycle, the register tables have been read
+      _CompleteQueuedRead(res);
+      break;
+    case STEP_VERIFY:
+      if (ok) {
+        const sGrowattReadPlan_t &plan = _VerifyHolding ? _HoldingCyclePlan : _InputCyclePlan;
+        _TrackFrameError(plan.Fragments[_Fragment]);
       }
+      _FinishCycle(false);
+      break;
+    default:
+      _Step = STEP_IDLE;
+      break;
+  }
+}
+
+void Growatt::_FinishCycle(bool ok) {
+  /**
+   * @brief End the read cycle and update the derived data
+   * @param ok true if all fragments were read
+   */
+  _Step = STEP_IDLE;
+  _GotData = ok;
+  _Result = ok ? READ_SUCCEEDED : READ_FAILED;
+  _CycleDuration = micros() - _CycleStart;
+#if MODBUS_POLL_TASK == 0
+  // the values changed, the cached documents are outdated
+  _JsonGeneration = _PacketCnt;
+#endif
+  if (!ok)
+    return;
+
+  // every protocol defines the inverter status as input register 0
+  if (_StatusDue)
+    _StatusChanged = false;
+  if (_Protocol.InputRegisterCount > 0 && _InputTarget[0] != _LastStatus) {
+    _StatusChanged = (_PollCycle != 0);
+    _LastStatus = _InputTarget[0];
+  }
+  _PollCycle++;
+
+  // after a while without frame errors a reduced size gets another try, one step larger
+  if (_MaxFragmentSize < _ProbedFragmentSize && ++_CleanCycles >= FRAME_RECOVERY_CYCLES) {
+    uint16_t size = _MaxFragmentSize + (_MaxFragmentSize >> 2) + 1;
+    _SetFragmentSize((size < _ProbedFragmentSize) ? size : _ProbedFragmentSize);
+  }
+
+#if MODBUS_POLL_TASK == 1
+  _MarkFresh(_InputCyclePlan, _InputFresh[1 - _Published]);
+  _MarkFresh(_HoldingCyclePlan, _HoldingFresh[1 - _Published]);
+  // a failed cycle is never published, the reader keeps the last complete one
+  _CycleTime[1 - _Published] = millis();
+  _CyclePacketCnt[1 - _Published] = _PacketCnt;
+  __atomic_store_n(&_Published, (uint8_t)(1 - _Published), __ATOMIC_RELEASE);
+#else
+  _MarkFresh(_InputCyclePlan, _InputFresh[0]);
+  _MarkFresh(_HoldingCyclePlan, _HoldingFresh[0]);
+  _ValuesTime = millis();
+  _ValuesPacketCnt = _PacketCnt;
+  _UpdateEnergyAccumulation();
+#endif
+}
+
+void Growatt::_MarkFresh(const sGrowattReadPlan_t &plan, uint8_t *fresh) {
+  /**
+   * @brief Note the registers a read cycle read
+   * @param plan the plan of the cycle
+   * @param fresh bit set receiving the registers
+   */
+  memset(fresh, 0, 16);
+  for (uint8_t e = 0; e < plan.Decode.FragmentStart[plan.FragmentCount]; e++) {
+    uint8_t index = plan.Decode.Entries[e].RegisterIndex;
+    fresh[index >> 3] |= 1 << (index & 7);
+  }
+}
+
+bool Growatt::_BeginSnapshot() {
+  /**
+   * @brief Prepare the values a read cycle decodes into. With MODBUS_POLL_TASK this is the
+   *        snapshot not published last, it starts as a copy of the published one, so registers
+   *        not due in this cycle keep their values.
+   * @returns false if the reader still uses that snapshot
+   */
+#if MODBUS_POLL_TASK == 1
+  uint8_t back = 1 - _Published;
+
+  if (__atomic_load_n(&_ReaderSnapshot, __ATOMIC_ACQUIRE) != _Published)
+    return false;
+
+  _InputTarget = _InputSnapshot[back];
+  _HoldingTarget = _HoldingSnapshot[back];
+  if (_InputTarget != _InputSnapshot[_Published]) {
+    memcpy(_InputTarget, _InputSnapshot[_Published], _Protocol.InputRegisterCount * sizeof(uint32_t));
+    memcpy(_HoldingTarget, _HoldingSnapshot[_Published], _Protocol.HoldingRegisterCount * sizeof(uint32_t));
+  }
+#endif
+  return true;
+}
+
+bool Growatt::AcquireSnapshot() {
+  /**
+   * @brief Take over the values of the last completed read cycle. With MODBUS_POLL_TASK the
+   *        values, the JSON documents and the energy accumulation only change by this call,
+   *        it has to be called by the task reading them (loop()) and never blocks. The polling
+   *        task does not start a new cycle before the reader took over the last one.
+   *        Without MODBUS_POLL_TASK the values are updated by Poll() and nothing is done here.
+   * @returns true if a new snapshot was taken over
+   */
+#if MODBUS_POLL_TASK == 1
+  uint8_t snapshot = __atomic_load_n(&_Published, __ATOMIC_ACQUIRE);
+
+  if (snapshot == _ReaderSnapshot)
+    return false;
+
+  __atomic_store_n(&_ReaderSnapshot, snapshot, __ATOMIC_RELEASE);
+  _Protocol.InputValues = _InputSnapshot[snapshot];
+  _Protocol.HoldingValues = _HoldingSnapshot[snapshot];
+  _ValuesTime = _CycleTime[snapshot];
+  _ValuesPacketCnt = _CyclePacketCnt[snapshot];
+  // the values changed, the cached documents are outdated
+  _JsonGeneration++;
+  _UpdateEnergyAccumulation();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void Growatt::_WaitIdle() {
+  /**
+   * @brief Complete a running request of the asynchronous communication, so a blocking
+   *        request can use the bus. The read cycle itself continues with the next Poll().
+   */
+  while (Modbus.busy()) {
+    uint8_t res = Modbus.poll();
+    if (res != Modbus.ku8MBBusy) {
+      _CompleteStep(res);
     } else {
+      yield();
+    }
+  }
+}
+
+const sGrowattModbusReg_t &Growatt::GetInputRegister(uint16_t reg) {
+  /**
+   * @brief get the description of the input register, it resides in flash (use the accessors)
+   * @param reg the register to get
+   * @returns the register description
+   */
+    return _Protocol.InputRegisters[reg];
+}
+
+const sGrowattModbusReg_t &Growatt::GetHoldingRegister(uint16_t reg) {
+  /**
+   * @brief get the description of the holding register, it resides in flash (use the accessors)
+   * @param reg the register to get
+   * @returns the register description
+   */
+    return _Protocol.HoldingRegisters[reg];
+}
+
+uint32_t Growatt::GetInputValue(uint16_t reg) {
+  /**
+   * @brief get the raw value of the input register as last read from the inverter
+   * @param reg the register to get
+   * @returns the register value
+   */
+    return _Protocol.InputValues[reg];
+}
+
+uint32_t Growatt::GetHoldingValue(uint16_t reg) {
+  /**
+   * @brief get the raw value of the holding register as last read from the inverter
+   * @param reg the register to get
+   * @returns the register value
+   */
+    return _Protocol.HoldingValues[reg];
+}
+
+bool Growatt::ReadWords(bool holding, uint16_t address, uint8_t count, uint16_t *words, uint8_t *result) {
+  /**
+   * @brief Read registers with a single request, blocks until done. The values of the register
+   *        tables are left to the read cycles.
+   * @param holding true for holding registers, false for input registers
+   * @param address address of the first register
+   * @param count number of registers, at most 125
+   * @param words receives the registers
+   * @param result optional, receives the Modbus result
+   * @returns true if successful
+   */
+  uint8_t res = Modbus.ku8MBResponseTimedOut;
+  BUS_GUARD();
+
+  if (_eDevice != Undef_stick && count > 0 && count <= 125) {
+    _WaitIdle();
+    res = holding ? Modbus.readHoldingRegisters(address, count) : Modbus.readInputRegisters(address, count);
+  }
+  if (result != NULL)
+    *result = res;
+  if (res != Modbus.ku8MBSuccess)
+    return false;
+  for (uint8_t i = 0; i < count; i++) {
+    words[i] = Modbus.getResponseBuffer(i);
+  }
+  return true;
+}
+
+bool Growatt::ReadHoldingReg(uint16_t adr, uint16_t* result) {
+  /**
+   * @brief read 16b holding register
+   * @param adr address of the register
+   * @param result pointer to the result
+   * @returns true if successful
+   */
+  return ReadWords(true, adr, 1, result, NULL);
+}
+
+bool Growatt::ReadHoldingReg(uint16_t adr, uint32_t* result) {
+  /**
+   * @brief read 32b holding register
+   * @param adr address of the register
+   * @param result pointer to the result
+   * @returns true if successful
+   */
+  uint16_t words[2];
+
+  if (!ReadWords(true, adr, 2, words, NULL))
+    return false;
+  *result = ((uint32_t)words[0] << 16) + words[1];
+  return true;
+}
+
+bool Growatt::WriteHoldingReg(uint16_t adr, uint16_t value) {
+  /**
+   * @brief write 16b holding register
+   * @param adr address of the register
+   * @param value value to write to the register
+   * @returns true if successful
+   */
+    BUS_GUARD();
+    _WaitIdle();
+    uint8_t res = Modbus.writeSingleRegister(adr, value);
+    if (res == Modbus.ku8MBSuccess) {
+        return true;
+    }
+    return false;
+}
+
+uint32_t Growatt::GetValuesTime() {
+  /**
+   * @returns millis() of the read cycle the values are from, 0 before the first one
+   */
+  return _ValuesTime;
+}
+
+bool Growatt::GetCachedWords(bool holding, uint16_t address, uint8_t count, uint16_t *words,
+                             uint32_t maxAge, uint8_t *covered) {
+  /**
+   * @brief Get registers as the inverter sent them from the values of the last read cycle,
+   *        without a Modbus request
+   * @param holding true for holding registers, false for input registers
+   * @param address address of the first register
+   * @param count number of registers, at most 125
+   * @param words receives the registers that are available
+   * @param maxAge only registers read by the last read cycle, at most maxAge ms ago, are
+   *        available. By default every register read before is.
+   * @param covered optional bit set (16 bytes) receiving the registers available
+   * @returns false if not all registers are available
+   */
+  const sGrowattModbusReg_t *registers = holding ? _Protocol.HoldingRegisters : _Protocol.InputRegisters;
+  uint16_t registerCount = holding ? _Protocol.HoldingRegisterCount : _Protocol.InputRegisterCount;
+  const uint32_t *values = holding ? _Protocol.HoldingValues : _Protocol.InputValues;
+  const uint8_t *available = holding ? _HoldingPolled : _InputPolled;
+  uint8_t found[16];
+  uint8_t missing = count;
+
+  if (covered == NULL)
+    covered = found;
+  memset(covered, 0, sizeof(found));
+  if (count == 0 || count > 125)
+    return false;
+  if (maxAge != UINT32_MAX) {
+#if MODBUS_POLL_TASK == 1
+    uint8_t snapshot = _ReaderSnapshot;
+#else
+    uint8_t snapshot = 0;
+#endif
+    if (_ValuesTime == 0 || (uint32_t)(millis() - _ValuesTime) > maxAge)
       return false;
+    available = holding ? _HoldingFresh[snapshot] : _InputFresh[snapshot];
+  }
+
+  for (uint16_t i = 0; i < registerCount && missing > 0; i++) {
+    if ((available[i >> 3] & (1 << (i & 7))) == 0)
+      continue;
+    uint16_t start = registers[i].Address();
+    uint8_t width = (registers[i].Size() == SIZE_16BIT) ? 1 : 2;
+    for (uint8_t w = 0; w < width; w++) {
+      uint32_t offset = (uint32_t)start + w - address;
+      if (start + w < address || offset >= count)
+        continue;
+      // the high word of a 32 bit register comes first
+      words[offset] = (width == 1) ? values[i] : (w == 0) ? values[i] >> 16 : values[i] & 0xFFFF;
+      if ((covered[offset >> 3] & (1 << (offset & 7))) == 0) {
+        covered[offset >> 3] |= 1 << (offset & 7);
+        missing--;
+      }
+    }
+  }
+  return missing == 0;
+}
+
+int8_t Growatt::QueueRead(bool holding, uint16_t address, uint8_t count) {
+  /**
+   * @brief Queue a read of registers to be carried out at the end of the next read cycle.
+   *        It is merged with a queued read of the same table if the registers in between
+   *        cost less than a request (MODBUS_REQUEST_COST). Poll for the result with
+   *        GetQueuedRead() and release the entry with ReleaseRead().
+   * @param holding true for holding registers, false for input registers
+   * @param address address of the first register
+   * @param count number of registers, at most 125
+   * @returns the entry of the queue, -1 if the queue is full or no inverter is detected
+   */
+  int8_t slot = -1;
+  BUS_GUARD();
+
+  if (_eDevice == Undef_stick || count == 0 || count > 125 || (uint32_t)address + count > 0x10000)
+    return -1;
+  if (_ReadQueue == NULL)
+    _ReadQueue = (sGrowattQueuedRead_t *)calloc(MODBUS_READ_QUEUE_SIZE, sizeof(sGrowattQueuedRead_t));
+  if (_ReadQueue == NULL)
+    return -1;
+
+  for (int8_t i = 0; i < MODBUS_READ_QUEUE_SIZE; i++) {
+    sGrowattQueuedRead_t &read = _ReadQueue[i];
+    if (read.State == QUEUED_FREE) {
+      if (slot < 0)
+        slot = i;
+      continue;
+    }
+    if (read.State != QUEUED_WAITING || read.Holding != holding)
+      continue;
+
+    uint16_t start = (read.Address < address) ? read.Address : address;
+    uint32_t end = (read.Address + read.Count > address + count) ? read.Address + read.Count : address + count;
+    if (end - start <= 125 && end - start <= (uint32_t)read.Count + count + MODBUS_REQUEST_COST) {
+      read.Address = start;
+      read.Count = end - start;
+      read.Users++;
+      return i;
     }
   }
+  if (slot < 0)
+    return -1;
+
+  sGrowattQueuedRead_t &read = _ReadQueue[slot];
+  read.State = QUEUED_WAITING;
+  read.Holding = holding;
+  read.Address = address;
+  read.Count = count;
+  read.Done = 0;
+  read.Users = 1;
+  read.Result = Modbus.ku8MBSuccess;
+  return slot;
+}
+
+eQueuedReadState_t Growatt::GetQueuedRead(int8_t slot, uint16_t address, uint8_t count, uint16_t *words,
+                                          uint8_t *result) {
+  /**
+   * @brief Get the result of a read queued by QueueRead()
+   * @param slot the entry returned by QueueRead()
+   * @param address address of the first register, as passed to QueueRead()
+   * @param count number of registers, as passed to QueueRead()
+   * @param words receives the registers when the read is done
+   * @param result receives the Modbus result (an exception code of the inverter or a
+   *        ModbusRtu error) when the read failed
+   * @returns QUEUED_DONE or QUEUED_FAILED when finished, otherwise the read is pending
+   */
+  BUS_GUARD();
+  const sGrowattQueuedRead_t &read = _ReadQueue[slot];
+
+  if (read.State == QUEUED_DONE)
+    memcpy(words, read.Words + (address - read.Address), count * sizeof(uint16_t));
+  else if (read.State == QUEUED_FAILED)
+    *result = read.Result;
+  return (eQueuedReadState_t)read.State;
+}
+
+void Growatt::ReleaseRead(int8_t slot) {
+  /**
+   * @brief A request no longer waits for a read queued by QueueRead(), finished or not
+   * @param slot the entry returned by QueueRead()
+   */
+  BUS_GUARD();
+  sGrowattQueuedRead_t &read = _ReadQueue[slot];
+
+  if (read.Users > 0)
+    read.Users--;
+  // an entry being read is freed when its answer arrives
+  if (read.Users == 0 && read.State != QUEUED_READING)
+    read.State = QUEUED_FREE;
+}
+
+bool Growatt::ConfigureExportLimit(uint16_t percent) {
+#if GROWATT_MODBUS_VERSION == 125
+  uint16_t scaled = percent * 10; // register uses 0.1 percent units
+  bool ok = true;
+  BUS_GUARD();
+  ok &= WriteHoldingReg(_Protocol.HoldingRegisters[P125_EXPORT_LIMIT_ENABLED_WR].Address(), 1);
+  ok &= WriteHoldingReg(_Protocol.HoldingRegisters[P125_EXPORT_LIMIT_PERCENT_WR].Address(), scaled);
+  if (ok) {
+    // read back by the next cycle, the values only change with a read cycle (s. AcquireSnapshot())
+    _HoldingPolled[P125_EXPORT_LIMIT_ENABLED_WR >> 3] &= ~(1 << (P125_EXPORT_LIMIT_ENABLED_WR & 7));
+    _HoldingPolled[P125_EXPORT_LIMIT_PERCENT_WR >> 3] &= ~(1 << (P125_EXPORT_LIMIT_PERCENT_WR & 7));
+  }
+  return ok;
+#else
+  (void)percent;
+  return false;
+#endif
+}
+
+
+bool Growatt::ReadInputReg(uint16_t adr, uint16_t* result) {
+  /**
+   * @brief read 16b input register
+   * @param adr address of the register
+   * @param result pointer to the result
+   * @returns true if successful
+   */
+  return ReadWords(false, adr, 1, result, NULL);
+}
+
+bool Growatt::ReadInputReg(uint16_t adr, uint32_t* result) {
+  /**
+   * @brief read 32b input register
+   * @param adr address of the register
+   * @param result pointer to the result
+   * @returns true if successful
+   */
+  uint16_t words[2];
+
+  if (!ReadWords(false, adr, 2, words, NULL))
+    return false;
+  *result = ((uint32_t)words[0] << 16) + words[1];
   return true;
 }
 
-bool Growatt::ReadHoldingRegistersFast() {
-  uint16_t registerAddress;
-  uint8_t res;
-  for (int i = 0; i < _Protocol.HoldingFastFragmentCount; i++) {
-    res = Modbus.readHoldingRegisters(
-      _Protocol.HoldingReadFragments[i].StartAddress,
-      _Protocol.HoldingReadFragments[i].FragmentSize
-    );
-    if(res == Modbus.ku8MBSuccess) {
-      for (int j = 0; j < _Protocol.HoldingRegisterCount; j++) {
-        if (_Protocol.HoldingRegisters[j].address >= _Protocol.HoldingReadFragments[i].StartAddress) {
-          if (_Protocol.HoldingRegisters[j].address >= _Protocol.HoldingReadFragments[i].StartAddress + _Protocol.HoldingReadFragments[i].FragmentSize)
-            break;
-          registerAddress = _Protocol.HoldingRegisters[j].address - _Protocol.HoldingReadFragments[i].StartAddress;
-          if (_Protocol.HoldingRegisters[j].size == SIZE_16BIT) {
-            _Protocol.HoldingRegisters[j].value = Modbus.getResponseBuffer(registerAddress);
-          } else {
-            _Protocol.HoldingRegisters[j].value = (Modbus.getResponseBuffer(registerAddress) << 16) + Modbus.getResponseBuffer(registerAddress + 1);
-          }
-        }
+sFixedPoint_t Growatt::_Fixed(const sGrowattModbusReg_t &reg, uint32_t value) {
+  /**
+   * @brief Scale a raw register value without floating point: the factor is applied to the
+   *        integer, the exponent becomes the position of the decimal point
+   */
+  sFixedPoint_t fixed = {(int64_t)value * reg.ScaleFactor(), reg.ScaleExponent()};
+  return fixed;
+}
+
+sFixedPoint_t Growatt::_FixedSum(sFixedPoint_t a, sFixedPoint_t b) {
+  // the sum gets the finer of both exponents
+  while (a.Exponent > b.Exponent) {
+    a.Value *= 10;
+    a.Exponent--;
+  }
+  while (b.Exponent > a.Exponent) {
+    b.Value *= 10;
+    b.Exponent--;
+  }
+  a.Value += b.Value;
+  return a;
+}
+
+sFixedPoint_t Growatt::_FixedRatio(sFixedPoint_t value, int64_t numerator, int64_t denominator, int8_t exponent) {
+  /**
+   * @brief value * numerator / denominator, rounded half away from zero to the exponent
+   */
+  sFixedPoint_t fine = value.Rounded((value.Exponent < exponent) ? value.Exponent : exponent);
+  int64_t product = fine.Value * numerator;
+  sFixedPoint_t result = {0, exponent};
+
+  if (denominator < 0) {
+    product = -product;
+    denominator = -denominator;
+  }
+  for (int8_t e = fine.Exponent; e < exponent; e++) {
+    denominator *= 10;
+  }
+  if (denominator != 0)
+    result.Value = (product + ((product < 0) ? -denominator / 2 : denominator / 2)) / denominator;
+  return result;
+}
+
+sFixedPoint_t Growatt::_FixedShare(sFixedPoint_t value, sFixedPoint_t part, sFixedPoint_t whole, int8_t exponent) {
+  /**
+   * @brief The share of value that part has in whole, 0 if whole is 0
+   */
+  int8_t common = (part.Exponent < whole.Exponent) ? part.Exponent : whole.Exponent;
+
+  return _FixedRatio(value, part.Rounded(common).Value, whole.Rounded(common).Value, exponent);
+}
+
+sRawDeadband_t Growatt::_RawDeadband(const sGrowattModbusReg_t &reg) {
+  /**
+   * @brief Convert the deadband of a register to raw register steps
+   * @param reg the register description
+   * @returns the deadband, the default of the unit if the register defines none
+   */
+  float deadband = reg.Deadband();
+  double step = _Fixed(reg, 1).ToDouble();
+  double change;
+  sRawDeadband_t raw;
+
+  if (deadband == 0)
+    deadband = pgm_read_float(&UNIT_DEADBANDS[reg.Unit()]);
+
+  raw.Relative = (deadband < 0);
+  if (raw.Relative)
+    change = -deadband * 10000.0;
+  else
+    change = (step > 0) ? deadband / step : 0;
+  // the deadbands are decimals held in a float: 0.5 V are 5 steps of 0.1 V, not 6
+  change = ceil(change - 0.001);
+  raw.Change = (change <= 0) ? 0 : (change >= UINT16_MAX) ? UINT16_MAX : (uint16_t)change;
+  return raw;
+}
+
+bool Growatt::_ExceedsDeadband(sRawDeadband_t deadband, uint32_t value, uint32_t last) {
+  /**
+   * @brief Check whether a register moved far enough from its last published value
+   * @param deadband the deadband of the register in raw steps (_RawDeadband())
+   * @param value the current raw value
+   * @param last the last published raw value
+   * @returns true if the change exceeds the deadband of the register
+   */
+  uint32_t change = (value > last) ? value - last : last - value;
+
+  if (change == 0)
+    return false;
+  if (deadband.Relative)
+    return (uint64_t)change * 10000 >= (uint64_t)deadband.Change * last;
+  return change >= deadband.Change;
+}
+
+sFixedPoint_t Growatt::_FixedInput(uint16_t reg, int8_t exponent) {
+  /**
+   * @brief Scaled value of an input register, additionally multiplied with 10^exponent
+   *        (e.g. 3 for kWh -> Wh)
+   */
+  sFixedPoint_t fixed = _Fixed(_Protocol.InputRegisters[reg], _Protocol.InputValues[reg]);
+  fixed.Exponent += exponent;
+  return fixed;
+}
+
+void Growatt::_UpdateEnergyAccumulation() {
+  /**
+   * @brief Integrate the per phase energy with the values of the completed read cycle
+   */
+#if GROWATT_MODBUS_VERSION == 305
+  sFixedPoint_t totE = _FixedInput(P305_ENERGY_TOTAL, 3);
+  sFixedPoint_t pac_l1 = _FixedInput(P305_AC_POWER);
+  sFixedPoint_t pac_l2 = {0, 0}, pac_l3 = {0, 0};
+#elif GROWATT_MODBUS_VERSION == 120
+  sFixedPoint_t totE = _FixedInput(P120_ENERGY_TOTAL, 3);
+  sFixedPoint_t pac_l1 = _FixedInput(P120_GRID_L1_OUTPUT_POWER);
+  sFixedPoint_t pac_l2 = _FixedInput(P120_GRID_L2_OUTPUT_POWER);
+  sFixedPoint_t pac_l3 = _FixedInput(P120_GRID_L3_OUTPUT_POWER);
+#elif GROWATT_MODBUS_VERSION == 124
+  sFixedPoint_t totE = _FixedInput(P124_EAC_TOTAL, 3);
+  sFixedPoint_t pac_l1 = _FixedInput(P124_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P124_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P124_PAC3);
+#elif GROWATT_MODBUS_VERSION == 125
+  sFixedPoint_t totE = _FixedInput(P125_EAC_TOTAL, 3);
+  sFixedPoint_t pac_l1 = _FixedInput(P125_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P125_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P125_PAC3);
+#else
+  sFixedPoint_t totE = {0, 0};
+  sFixedPoint_t pac_l1 = {0, 0}, pac_l2 = {0, 0}, pac_l3 = {0, 0};
+#endif
+
+  // [0.1 W] and [Wh]
+  int32_t power[PHASE_COUNT] = {(int32_t)pac_l1.Rounded(-1).Value, (int32_t)pac_l2.Rounded(-1).Value,
+                                (int32_t)pac_l3.Rounded(-1).Value};
+  _PhaseEnergy.Add(_ValuesTime, power, totE.Rounded(0).Value);
+}
+
+void Growatt::SaveEnergy() {
+  /**
+   * @brief Save the per phase energy now, e.g. before a restart
+   */
+  _PhaseEnergy.Save();
+}
+
+uint8_t Growatt::MapStatusToFronius(uint32_t status) {
+  switch (status) {
+    case GwStatusWaiting:
+      return 1;  // Waiting
+    case GwStatusNormal:
+      return 7;  // Running
+    case GwStatusFault:
+      return 16; // Fault
+    default:
+      return 0;  // Unknown
+  }
+}
+
+const char* Growatt::FroniusStatusToString(uint8_t status) {
+  switch (status) {
+    case 1:
+      return "Waiting";
+    case 7:
+      return "Running";
+    case 16:
+      return "Fault";
+    default:
+      return "Unknown";
+  }
+}
+
+void Growatt::CreateJsonDocument(eJsonDocument_t document, Print &out, const char *MacAddress) {
+  /**
+   * @brief Write one of the web server documents
+   * @param document the document
+   * @param out the document is streamed to it
+   * @param MacAddress mac address of the stick, used by JSON_STATUS
+   */
+  switch (document) {
+    case JSON_STATUS:
+      CreateJson(out, MacAddress);
+      break;
+    case JSON_UI_STATUS:
+      CreateUIJson(out, false);
+      break;
+    case JSON_UI_VALUES:
+      CreateUIJson(out, true);
+      break;
+    case JSON_FRONIUS:
+      CreateFroniusJson(out);
+      break;
+    case JSON_POWER_FLOW:
+      CreatePowerFlowJson(out);
+      break;
+    case JSON_DEVICE_INFO:
+      CreateDeviceInfoJson(out);
+      break;
+    case JSON_INVERTER_INFO:
+      CreateInverterInfoJson(out);
+      break;
+    case JSON_LOGGER_INFO:
+      CreateLoggerInfoJson(out);
+      break;
+    case JSON_ACTIVE_DEVICE_INFO:
+      CreateActiveDeviceInfoJson(out);
+      break;
+    default:
+      break;
+  }
+}
+
+bool Growatt::GetCachedJson(eJsonDocument_t document, const char *MacAddress, const char **json, size_t *length) {
+  /**
+   * @brief Get a web server document rendered from the last read cycle. Each document is
+   *        rendered at most once per read cycle. The cached document is replaced only when
+   *        the values of a newer cycle are complete, while a cycle is running the last
+   *        rendered document is returned.
+   * @param document the document
+   * @param MacAddress mac address of the stick, used by JSON_STATUS
+   * @param json receives the document, it is not terminated
+   * @param length receives the length of the document
+   * @returns false if the document is not available from the cache (never rendered before a
+   *          read cycle started or not enough memory), CreateJsonDocument() has to be used then
+   */
+  if (document >= JSON_DOCUMENT_COUNT)
+    return false;
+
+  sJsonCache_t &cache = _JsonCache[document];
+  bool complete = true;
+
+#if MODBUS_POLL_TASK == 0
+  // the register values are updated fragment by fragment, a mix of two cycles is never
+  // rendered: the last rendered document stays until the running cycle is complete
+  complete = (_Step == STEP_IDLE);
+#endif
+  if ((cache.Body == NULL || cache.Generation != _JsonGeneration) && complete) {
+    CountingPrint counter;
+    CreateJsonDocument(document, counter, MacAddress);
+    if (counter.Count() > cache.Capacity) {
+      free(cache.Body);
+      // some headroom, so slightly longer numbers don't need a new allocation
+      cache.Capacity = (counter.Count() + 64) & ~(size_t)63;
+      cache.Body = (char *)malloc(cache.Capacity);
+      if (cache.Body == NULL) {
+        cache.Capacity = 0;
+        return false;
       }
-    } else {
-      return false;
     }
+    BufferPrint out(cache.Body, cache.Capacity);
+    CreateJsonDocument(document, out, MacAddress);
+    cache.Length = out.Length();
+    cache.Generation = _JsonGeneration;
   }
+  if (cache.Body == NULL)
+    return false;
+
+  *json = cache.Body;
+  *length = cache.Length;
   return true;
 }
 
-bool Growatt::ReadData(bool fullRead) {
+void Growatt::CreateJson(Print &out, const char *MacAddress) {
   /**
-   * @brief Reads the data from the inverter and updates the internal data structures
-   * @returns true if data was read successfully, false otherwise
+   * @brief Write the JSON document with all registers
+   * @param out the document is streamed to it, nothing is buffered here
+   * @param MacAddress mac address of the stick
    */
+  JsonWriter json(out);
 
-  _PacketCnt++;
-  bool ok;
-  if(fullRead) {
-    ok = ReadInputRegisters() && ReadHoldingRegisters();
-  } else {
-    ok = ReadInputRegistersFast() && ReadHoldingRegistersFast();
+  json.BeginObject();
+#if SIMULATE_INVERTER != 1
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    json.Member(_Protocol.InputRegisters[i].Name(), _Fixed(_Protocol.InputRegisters[i], _Protocol.InputValues[i]));
   }
-  _GotData = ok;
-  if (_GotData) {
-    _UpdateEnergyAccumulation();
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    if (!IsDuplicateHolding(i))
+      json.Member(_Protocol.HoldingRegisters[i].Name(), _Fixed(_Protocol.HoldingRegisters[i], _Protocol.HoldingValues[i]));
   }
-  return _GotData;
+#else
+  #warning simulating the inverter
+  json.Member(F("Status"), 1);
+  json.Member(F("DcPower"), 230);
+  json.Member(F("DcVoltage"), 70.5);
+  json.Member(F("DcInputCurrent"), 8.5);
+  json.Member(F("AcFreq"), 50.00);
+  json.Member(F("AcVoltage"), 230.0);
+  json.Member(F("AcPower"), 0.00);
+  json.Member(F("EnergyToday"), 0.3);
+  json.Member(F("EnergyTotal"), 49.1);
+  json.Member(F("OperatingTime"), 123456);
+  json.Member(F("Temperature"), 21.12);
+  json.Member(F("AccumulatedEnergy"), 320);
+#endif // SIMULATE_INVERTER
+  json.Member(F("Mac"), MacAddress);
+  json.Member(F("Cnt"), _ValuesPacketCnt);
+  json.EndObject();
 }
 
-sGrowattModbusReg_t Growatt::GetInputRegister(uint16_t reg) {
+bool Growatt::PrepareDeltaJson(bool full) {
   /**
-   * @brief get the internal representation of the input register
-   * @param reg the register to get
-   * @returns the register value
+   * @brief Select the registers for the next change-only document: the registers that moved
+   *        by more than their deadband since they were last included, or all registers for a
+   *        full snapshot. The document gets the next sequence number ("Seq").
+   *        CreateDeltaJson() writes it and can be called repeatedly, e.g. to measure it first.
+   * @param full include all registers
+   * @returns false if no register changed, there is nothing to publish then
    */
-    if (_GotData == false) {
-      ReadData();
+  bool changed = false;
+
+  memset(_InputDelta, 0, sizeof(_InputDelta));
+  memset(_HoldingDelta, 0, sizeof(_HoldingDelta));
+  if (_InputPublished == NULL || _HoldingPublished == NULL)
+    return false;
+
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    if (InputPublishDue(i, full)) {
+      _InputDelta[i >> 3] |= 1 << (i & 7);
+      changed = true;
     }
-    return _Protocol.InputRegisters[reg];
+  }
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    if (HoldingPublishDue(i, full)) {
+      _HoldingDelta[i >> 3] |= 1 << (i & 7);
+      changed = true;
+    }
+  }
+  if (!changed && !full)
+    return false;
+
+  _DeltaFull = full;
+  _PublishSeq++;
+  return true;
 }
 
-sGrowattModbusReg_t Growatt::GetHoldingRegister(uint16_t reg) {
+void Growatt::CreateDeltaJson(Print &out, const char *MacAddress) {
   /**
-   * @brief get the internal representation of the holding register
-   * @param reg the register to get
-   * @returns the register value
+   * @brief Write the change-only document selected by the last PrepareDeltaJson()
+   * @param out the document is streamed to it, nothing is buffered here
+   * @param MacAddress mac address of the stick
    */
-    if (_GotData == false) {
-      ReadData();
-    }
-    return _Protocol.HoldingRegisters[reg];
+  JsonWriter json(out);
+
+  json.BeginObject();
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    if (_InputDelta[i >> 3] & (1 << (i & 7)))
+      json.Member(_Protocol.InputRegisters[i].Name(), _Fixed(_Protocol.InputRegisters[i], _InputPublished[i]));
+  }
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    if ((_HoldingDelta[i >> 3] & (1 << (i & 7))) && !IsDuplicateHolding(i))
+      json.Member(_Protocol.HoldingRegisters[i].Name(), _Fixed(_Protocol.HoldingRegisters[i], _HoldingPublished[i]));
+  }
+  json.Member(F("Mac"), MacAddress);
+  json.Member(F("Cnt"), _ValuesPacketCnt);
+  json.Member(F("Seq"), _PublishSeq);
+  json.Member(F("Full"), _DeltaFull);
+  json.EndObject();
 }
 
-bool Growatt::ReadHoldingReg(uint16_t adr, uint16_t* result) {
+uint32_t Growatt::_ComputeSchemaId() {
   /**
-   * @brief read 16b holding register
-   * @param adr address of the register
-   * @param result pointer to the result
-   * @returns true if successful
+   * @brief Hash (FNV-1a) of the names, units and multipliers of both register tables, it
+   *        changes whenever the meaning of a register ID in the MessagePack documents changes
    */
-  uint8_t res = Modbus.readHoldingRegisters(adr, 1);
-  if (res == Modbus.ku8MBSuccess) {
-    uint16_t val = Modbus.getResponseBuffer(0);
-    *result = val;
-    for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
-      if (_Protocol.HoldingRegisters[i].address == adr &&
-          _Protocol.HoldingRegisters[i].size == SIZE_16BIT) {
-        _Protocol.HoldingRegisters[i].value = val;
-        break;
+  uint32_t hash = 2166136261UL;
+  const sGrowattModbusReg_t *tables[] = {_Protocol.InputRegisters, _Protocol.HoldingRegisters};
+  uint16_t counts[] = {_Protocol.InputRegisterCount, _Protocol.HoldingRegisterCount};
+
+  for (int t = 0; t < 2; t++) {
+    for (int i = 0; i < counts[t]; i++) {
+      const sGrowattModbusReg_t &reg = tables[t][i];
+      float multiplier = reg.Multiplier();
+      uint8_t bytes[6];
+      const char *name = reg.name;
+      char c;
+
+      do {
+        c = pgm_read_byte(name++);
+        hash = (hash ^ (uint8_t)c) * 16777619UL;
+      } while (c != '\0');
+      memcpy(bytes, &multiplier, 4);
+      bytes[4] = reg.Unit();
+      bytes[5] = t;
+      for (int b = 0; b < 6; b++) {
+        hash = (hash ^ bytes[b]) * 16777619UL;
       }
     }
-    return true;
   }
-  return false;
+  return hash;
 }
 
-bool Growatt::ReadHoldingReg(uint16_t adr, uint32_t* result) {
+void Growatt::_FindDuplicateHoldings() {
   /**
-   * @brief read 32b holding register
-   * @param adr address of the register
-   * @param result pointer to the result
-   * @returns true if successful
+   * @brief Mark the holding registers with the name of an input register, e.g. a setting the
+   *        inverter also reports as input register. Keys and MQTT topics are the names, so
+   *        only the input register is written there.
    */
-  uint8_t res = Modbus.readHoldingRegisters(adr, 2);
-  if (res == Modbus.ku8MBSuccess) {
-    uint32_t val = (Modbus.getResponseBuffer(0) << 16) +
-                   Modbus.getResponseBuffer(1);
-    *result = val;
-    for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
-      if (_Protocol.HoldingRegisters[i].address == adr &&
-          _Protocol.HoldingRegisters[i].size == SIZE_32BIT) {
-        _Protocol.HoldingRegisters[i].value = val;
+  memset(_HoldingDuplicate, 0, sizeof(_HoldingDuplicate));
+  for (int h = 0; h < _Protocol.HoldingRegisterCount; h++) {
+    for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+      const char *a = _Protocol.HoldingRegisters[h].name;
+      const char *b = _Protocol.InputRegisters[i].name;
+      char c;
+
+      while ((c = pgm_read_byte(a)) == pgm_read_byte(b) && c != '\0') {
+        a++;
+        b++;
+      }
+      if (c == pgm_read_byte(b)) {
+        _HoldingDuplicate[h >> 3] |= 1 << (h & 7);
         break;
       }
     }
-    return true;
   }
-  return false;
 }
 
-bool Growatt::WriteHoldingReg(uint16_t adr, uint16_t value) {
+bool Growatt::IsDuplicateHolding(uint16_t reg) {
   /**
-   * @brief write 16b holding register
-   * @param adr address of the register
-   * @param value value to write to the register
-   * @returns true if successful
+   * @brief Check whether a holding register has the name of an input register, the
+   *        documents keyed by name and the MQTT topics leave it out
+   * @param reg index into the holding register table
    */
-    uint8_t res = Modbus.writeSingleRegister(adr, value);
-    if (res == Modbus.ku8MBSuccess) {
-        return true;
-    }
-    return false;
+  return reg < _Protocol.HoldingRegisterCount && (_HoldingDuplicate[reg >> 3] & (1 << (reg & 7)));
 }
 
-bool Growatt::ConfigureExportLimit(uint16_t percent) {
-#if GROWATT_MODBUS_VERSION == 125
-  uint16_t scaled = percent * 10; // register uses 0.1 percent units
-  bool ok = true;
-  ok &= WriteHoldingReg(_Protocol.HoldingRegisters[P125_EXPORT_LIMIT_ENABLED_WR].address, 1);
-  ok &= WriteHoldingReg(_Protocol.HoldingRegisters[P125_EXPORT_LIMIT_PERCENT_WR].address, scaled);
-  if (ok) {
-    _Protocol.HoldingRegisters[P125_EXPORT_LIMIT_ENABLED_WR].value = 1;
-    _Protocol.HoldingRegisters[P125_EXPORT_LIMIT_PERCENT_WR].value = scaled;
-  }
-  return ok;
-#else
-  (void)percent;
-  return false;
-#endif
+uint32_t Growatt::GetSchemaId() {
+  return _SchemaId;
 }
 
-
-bool Growatt::ReadInputReg(uint16_t adr, uint16_t* result) {
+void Growatt::CreateSchemaJson(Print &out) {
   /**
-   * @brief read 16b input register
-   * @param adr address of the register
-   * @param result pointer to the result
-   * @returns true if successful
+   * @brief Write the schema of the MessagePack documents: the register ID is the position in
+   *        the "Input" or "Holding" list, each entry is [name, unit, multiplier]. The value in
+   *        the unit is the transferred integer times the multiplier.
+   * @param out the document is streamed to it
    */
-  uint8_t res = Modbus.readInputRegisters(adr, 1);
-  if (res == Modbus.ku8MBSuccess) {
-    uint16_t val = Modbus.getResponseBuffer(0);
-    *result = val;
-    for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
-      if (_Protocol.InputRegisters[i].address == adr &&
-          _Protocol.InputRegisters[i].size == SIZE_16BIT) {
-        _Protocol.InputRegisters[i].value = val;
-        break;
-      }
+  JsonWriter json(out);
+  const sGrowattModbusReg_t *tables[] = {_Protocol.InputRegisters, _Protocol.HoldingRegisters};
+  uint16_t counts[] = {_Protocol.InputRegisterCount, _Protocol.HoldingRegisterCount};
+
+  json.BeginObject();
+  json.Member(F("Schema"), (unsigned long)_SchemaId);
+  for (int t = 0; t < 2; t++) {
+    json.BeginArray(t == 0 ? F("Input") : F("Holding"));
+    for (int i = 0; i < counts[t]; i++) {
+      const sGrowattModbusReg_t &reg = tables[t][i];
+      json.BeginArray();
+      json.Value(reg.Name());
+      json.Value(FPSTR(HA_UNITS[reg.Unit()]));
+      json.Value(_Fixed(reg, 1));
+      json.EndArray();
     }
-    return true;
+    json.EndArray();
   }
-  return false;
+  json.EndObject();
 }
 
-bool Growatt::ReadInputReg(uint16_t adr, uint32_t* result) {
+void Growatt::CreateMsgPack(Print &out, const char *MacAddress) {
   /**
-   * @brief read 32b input register
-   * @param adr address of the register
-   * @param result pointer to the result
-   * @returns true if successful
+   * @brief Write all registers as MessagePack: {"Schema": id, "Input": [raw values],
+   *        "Holding": [raw values], "Mac": mac, "Cnt": n}. The values are the unscaled
+   *        register contents in the order of the schema (see CreateSchemaJson()).
+   * @param out the document is streamed to it
+   * @param MacAddress mac address of the stick
    */
-  uint8_t res = Modbus.readInputRegisters(adr, 2);
-  if (res == Modbus.ku8MBSuccess) {
-    uint32_t val = (Modbus.getResponseBuffer(0) << 16) +
-                   Modbus.getResponseBuffer(1);
-    *result = val;
-    for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
-      if (_Protocol.InputRegisters[i].address == adr &&
-          _Protocol.InputRegisters[i].size == SIZE_32BIT) {
-        _Protocol.InputRegisters[i].value = val;
-        break;
-      }
-    }
-    return true;
+  MsgPackWriter msg(out);
+
+  msg.BeginMap(5);
+  msg.Member(F("Schema"), (unsigned long)_SchemaId);
+  msg.Value(F("Input"));
+  msg.BeginArray(_Protocol.InputRegisterCount);
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    msg.Value((unsigned long)_Protocol.InputValues[i]);
   }
-  return false;
+  msg.Value(F("Holding"));
+  msg.BeginArray(_Protocol.HoldingRegisterCount);
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    msg.Value((unsigned long)_Protocol.HoldingValues[i]);
+  }
+  msg.Member(F("Mac"), MacAddress);
+  msg.Member(F("Cnt"), (unsigned long)_ValuesPacketCnt);
 }
 
-double Growatt::_round2(double value) {
-   return (int)(value * 100 + 0.5) / 100.0;
-}
+void Growatt::CreateDeltaMsgPack(Print &out, const char *MacAddress) {
+  /**
+   * @brief Write the change-only document selected by the last PrepareDeltaJson() as
+   *        MessagePack. "Input" and "Holding" are maps from register ID to raw value,
+   *        otherwise like CreateMsgPack() plus "Seq" and "Full" as in CreateDeltaJson().
+   * @param out the document is streamed to it
+   * @param MacAddress mac address of the stick
+   */
+  MsgPackWriter msg(out);
+  uint16_t inputs = 0;
+  uint16_t holdings = 0;
 
-void Growatt::_UpdateEnergyAccumulation() {
-#if GROWATT_MODBUS_VERSION == 305
-  double totE = _Protocol.InputRegisters[P305_ENERGY_TOTAL].value *
-                _Protocol.InputRegisters[P305_ENERGY_TOTAL].multiplier * 1000.0;
-  double pac_l1 = _Protocol.InputRegisters[P305_AC_POWER].value *
-                  _Protocol.InputRegisters[P305_AC_POWER].multiplier;
-  double pac_l2 = 0;
-  double pac_l3 = 0;
-#elif GROWATT_MODBUS_VERSION == 120
-  double totE = _Protocol.InputRegisters[P120_ENERGY_TOTAL].value *
-                _Protocol.InputRegisters[P120_ENERGY_TOTAL].multiplier * 1000.0;
-  double pac_l1 = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].value *
-                  _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].value *
-                  _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].value *
-                  _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].multiplier;
-#elif GROWATT_MODBUS_VERSION == 124
-  double totE = _Protocol.InputRegisters[P124_EAC_TOTAL].value *
-                _Protocol.InputRegisters[P124_EAC_TOTAL].multiplier * 1000.0;
-  double pac_l1 = _Protocol.InputRegisters[P124_PAC1].value *
-                  _Protocol.InputRegisters[P124_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P124_PAC2].value *
-                  _Protocol.InputRegisters[P124_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P124_PAC3].value *
-                  _Protocol.InputRegisters[P124_PAC3].multiplier;
-#elif GROWATT_MODBUS_VERSION == 125
-  double totE = _Protocol.InputRegisters[P125_EAC_TOTAL].value *
-                _Protocol.InputRegisters[P125_EAC_TOTAL].multiplier * 1000.0;
-  double pac_l1 = _Protocol.InputRegisters[P125_PAC1].value *
-                  _Protocol.InputRegisters[P125_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P125_PAC2].value *
-                  _Protocol.InputRegisters[P125_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P125_PAC3].value *
-                  _Protocol.InputRegisters[P125_PAC3].multiplier;
-#else
-  double totE = 0;
-  double pac_l1 = 0, pac_l2 = 0, pac_l3 = 0;
-#endif
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    if (_InputDelta[i >> 3] & (1 << (i & 7)))
+      inputs++;
+  }
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    if (_HoldingDelta[i >> 3] & (1 << (i & 7)))
+      holdings++;
+  }
 
-  double sumPacInstant = pac_l1 + pac_l2 + pac_l3;
-  if (_prevEnergyValid) {
-    double deltaE = totE - _prevTotalEnergy;
-    if (deltaE < 0)
-      deltaE = 0;
-    if (sumPacInstant > 0) {
-      _accEnergyL1 += deltaE * pac_l1 / sumPacInstant;
-      _accEnergyL2 += deltaE * pac_l2 / sumPacInstant;
-      _accEnergyL3 += deltaE * pac_l3 / sumPacInstant;
-    }
+  msg.BeginMap(7);
+  msg.Member(F("Schema"), (unsigned long)_SchemaId);
+  msg.Value(F("Input"));
+  msg.BeginMap(inputs);
+  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
+    if (_InputDelta[i >> 3] & (1 << (i & 7)))
+      msg.Member(i, (unsigned long)_InputPublished[i]);
+  }
+  msg.Value(F("Holding"));
+  msg.BeginMap(holdings);
+  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
+    if (_HoldingDelta[i >> 3] & (1 << (i & 7)))
+      msg.Member(i, (unsigned long)_HoldingPublished[i]);
   }
-  _prevTotalEnergy = totE;
-  _prevEnergyValid = true;
+  msg.Member(F("Mac"), MacAddress);
+  msg.Member(F("Cnt"), (unsigned long)_ValuesPacketCnt);
+  msg.Member(F("Seq"), (unsigned long)_PublishSeq);
+  msg.Member(F("Full"), _DeltaFull);
 }
 
-uint8_t Growatt::MapStatusToFronius(uint32_t status) {
-  switch (status) {
-    case GwStatusWaiting:
-      return 1;  // Waiting
-    case GwStatusNormal:
-      return 7;  // Running
-    case GwStatusFault:
-      return 16; // Fault
-    default:
-      return 0;  // Unknown
-  }
+bool Growatt::InputPublishDue(uint16_t reg, bool full) {
+  /**
+   * @brief Check whether an input register moved beyond its deadband since it was last
+   *        published, the current value is remembered as published if so
+   * @param reg index into the input register table
+   * @param full publish regardless of the deadband
+   * @returns true if the register has to be published
+   */
+  if (_InputPublished == NULL || _InputDeadbands == NULL || reg >= _Protocol.InputRegisterCount)
+    return false;
+  if (!full && !_ExceedsDeadband(_InputDeadbands[reg], _Protocol.InputValues[reg], _InputPublished[reg]))
+    return false;
+  _InputPublished[reg] = _Protocol.InputValues[reg];
+  return true;
 }
 
-const char* Growatt::FroniusStatusToString(uint8_t status) {
-  switch (status) {
-    case 1:
-      return "Waiting";
-    case 7:
-      return "Running";
-    case 16:
-      return "Fault";
-    default:
-      return "Unknown";
-  }
+bool Growatt::HoldingPublishDue(uint16_t reg, bool full) {
+  /**
+   * @brief Check whether a holding register moved beyond its deadband since it was last
+   *        published, the current value is remembered as published if so
+   * @param reg index into the holding register table
+   * @param full publish regardless of the deadband
+   * @returns true if the register has to be published
+   */
+  if (_HoldingPublished == NULL || _HoldingDeadbands == NULL || reg >= _Protocol.HoldingRegisterCount)
+    return false;
+  if (!full && !_ExceedsDeadband(_HoldingDeadbands[reg], _Protocol.HoldingValues[reg], _HoldingPublished[reg]))
+    return false;
+  _HoldingPublished[reg] = _Protocol.HoldingValues[reg];
+  return true;
+}
+
+void Growatt::FormatValue(const sGrowattModbusReg_t &reg, uint32_t value, char *Buffer, size_t size) {
+  /**
+   * @brief Format a raw register value as scaled plain number, e.g. for a per-register MQTT topic.
+   *        The number of decimals follows the scale (10^-1 -> 1, 10^-2 -> 2)
+   * @param reg the register description
+   * @param value the raw value
+   * @param Buffer receives the text
+   * @param size size of Buffer
+   */
+  size_t len = JsonWriter::FormatFixed(_Fixed(reg, value), Buffer, size - 1, false);
+  Buffer[len] = '\0';
 }
 
-void Growatt::CreateJson(char *Buffer, const char *MacAddress) {
-  StaticJsonDocument<2048> doc;
+void Growatt::CreateDiscoveryJson(Print &out, const sGrowattModbusReg_t &reg, const char *StateTopic,
+                                  const char *DeviceId) {
+  /**
+   * @brief Write the Home Assistant MQTT discovery config of a register, its state is the
+   *        plain value published to StateTopic
+   * @param out the document is streamed to it, count it first (CountingPrint) to check it
+   *        fits the MQTT packet
+   * @param reg the register description
+   * @param StateTopic topic the register value is published to
+   * @param DeviceId unique id of the stick, used for the entity and device ids
+   */
+  JsonWriter json(out);
+  char uniqueId[96];
+  RegisterUnit_t unit = reg.Unit();
+
+  // the name lives in flash, so it is appended with the _P variant
+  snprintf(uniqueId, sizeof(uniqueId), "%s_", DeviceId);
+  strncat_P(uniqueId, reg.name, sizeof(uniqueId) - strlen(uniqueId) - 1);
+
+  json.BeginObject();
+  json.Member(F("name"), reg.Name());
+  json.Member(F("uniq_id"), uniqueId);
+  json.Member(F("stat_t"), StateTopic);
+  if (unit != NONE)
+    json.Member(F("unit_of_meas"), FPSTR(HA_UNITS[unit]));
+  if (pgm_read_byte(&HA_DEVICE_CLASSES[unit][0]) != '\0')
+    json.Member(F("dev_cla"), FPSTR(HA_DEVICE_CLASSES[unit]));
+  if (unit == POWER_KWH || unit == SECONDS)
+    json.Member(F("stat_cla"), F("total_increasing"));
+  else if (unit != NONE)
+    json.Member(F("stat_cla"), F("measurement"));
+
+  json.BeginObject(F("dev"));
+  json.Member(F("ids"), DeviceId);
+  json.Member(F("name"), DeviceId);
+  json.Member(F("mf"), F("Growatt"));
+  json.Member(F("mdl"), F("ShineWiFi-ModBus"));
+  json.EndObject();
+  json.EndObject();
+}
 
-#if SIMULATE_INVERTER != 1
-  for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
-    if (_Protocol.InputRegisters[i].multiplier  == (int)_Protocol.InputRegisters[i].multiplier) {
-      doc[_Protocol.InputRegisters[i].name] = _Protocol.InputRegisters[i].value * _Protocol.InputRegisters[i].multiplier;
-    } else {
-      doc[_Protocol.InputRegisters[i].name] = _round2(_Protocol.InputRegisters[i].value * _Protocol.InputRegisters[i].multiplier);
-    }
-  }
-  for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
-    if (_Protocol.HoldingRegisters[i].multiplier  == (int)_Protocol.HoldingRegisters[i].multiplier) {
-      doc[_Protocol.HoldingRegisters[i].name] = _Protocol.HoldingRegisters[i].value * _Protocol.HoldingRegisters[i].multiplier;
-    } else {
-      doc[_Protocol.HoldingRegisters[i].name] = _round2(_Protocol.HoldingRegisters[i].value * _Protocol.HoldingRegisters[i].multiplier);
-    }
-  }
-#else
-  #warning simulating the inverter
-  doc["Status"] = 1;
-  doc["DcPower"] = 230;
-  doc["DcVoltage"] = 70.5;
-  doc["DcInputCurrent"] = 8.5;
-  doc["AcFreq"] = 50.00;
-  doc["AcVoltage"] = 230.0;
-  doc["AcPower"] = 0.00;
-  doc["EnergyToday"] = 0.3;
-  doc["EnergyTotal"] = 49.1;
-  doc["OperatingTime"] = 123456;
-  doc["Temperature"] = 21.12;
-  doc["AccumulatedEnergy"] = 320;
-#endif // SIMULATE_INVERTER
-  doc["Mac"] = MacAddress;
-  doc["Cnt"] = _PacketCnt;
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+void Growatt::_FroniusTimestamp(char *Buffer, size_t size) {
+  /**
+   * @brief Format the current time for the "Timestamp" of the Fronius documents
+   */
+  time_t now = time(nullptr);
+  struct tm *tm_info = localtime(&now);
+
+  snprintf(Buffer, size, "%04d-%02d-%02dT%02d:%02d:%02d+00:00",
+           tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
+           tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
 }
 
-void Growatt::CreateDeviceInfoJson(char *Buffer) {
+void Growatt::CreateDeviceInfoJson(Print &out) {
   StaticJsonDocument<512> doc;
 
   JsonObject head = doc.createNestedObject("Head");
@@ -531,13 +1994,13 @@ void Growatt::CreateDeviceInfoJson(char *Buffer) {
   JsonObject data = body.createNestedObject("Data");
 
 #if GROWATT_MODBUS_VERSION == 305
-  uint32_t gwStatus = _Protocol.InputRegisters[P305_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P305_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 120
-  uint32_t gwStatus = _Protocol.InputRegisters[P120_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P120_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 124
-  uint32_t gwStatus = _Protocol.InputRegisters[P124_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P124_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 125
-  uint32_t gwStatus = _Protocol.InputRegisters[P125_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P125_I_STATUS];
 #else
   uint32_t gwStatus = 0;
 #endif
@@ -545,545 +2008,371 @@ void Growatt::CreateDeviceInfoJson(char *Buffer) {
   data["DeviceType"] = FRONIUS_DEVICE_TYPE;
   data["Serial"] = FRONIUS_SERIAL;
 
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  serializeJson(doc, out);
+}
+
+template <typename V>
+void Growatt::_UIEntry(JsonWriter &json, bool valuesOnly, const __FlashStringHelper *name, V value,
+                       const char *unit, bool plot) {
+  if (valuesOnly) {
+    json.Value(value);
+    return;
+  }
+  json.BeginArray(name);
+  json.Value(value);
+  json.Value(unit);
+  json.Value(plot);
+  json.EndArray();
 }
 
-void Growatt::CreateUIJson(char *Buffer) {
-  StaticJsonDocument<2048> doc;
+void Growatt::CreateUIJson(Print &out, bool valuesOnly) {
+  /**
+   * @brief Write the JSON document for the web frontend: [value, unit, plot] per register
+   * @param out the document is streamed to it, nothing is buffered here
+   * @param valuesOnly true: only the values as array, in the order of the full document
+   */
+  JsonWriter json(out);
   const char* unitStr[] = {"", "W", "kWh", "V", "A", "s", "%", "Hz", "C", "VA"};
 
+  if (valuesOnly)
+    json.BeginArray();
+  else
+    json.BeginObject();
+
 #if SIMULATE_INVERTER != 1
   for (int i = 0; i < _Protocol.InputRegisterCount; i++) {
-    if (_Protocol.InputRegisters[i].frontend == true || _Protocol.InputRegisters[i].plot == true) {
-      JsonArray arr = doc.createNestedArray(_Protocol.InputRegisters[i].name);
-
-       // value
-      if (_Protocol.InputRegisters[i].multiplier  == (int)_Protocol.InputRegisters[i].multiplier) {
-        arr.add(_Protocol.InputRegisters[i].value * _Protocol.InputRegisters[i].multiplier);
-      } else {
-        arr.add(_round2(_Protocol.InputRegisters[i].value * _Protocol.InputRegisters[i].multiplier));
-      }
-      arr.add(unitStr[_Protocol.InputRegisters[i].unit]); //unit
-      arr.add(_Protocol.InputRegisters[i].plot); //should be plotted
+    if (_Protocol.InputRegisters[i].Frontend() == true || _Protocol.InputRegisters[i].Plot() == true) {
+      _UIEntry(json, valuesOnly, _Protocol.InputRegisters[i].Name(),
+               _Fixed(_Protocol.InputRegisters[i], _Protocol.InputValues[i]),
+               unitStr[_Protocol.InputRegisters[i].Unit()], _Protocol.InputRegisters[i].Plot());
     }
   }
   for (int i = 0; i < _Protocol.HoldingRegisterCount; i++) {
-    if (_Protocol.HoldingRegisters[i].frontend == true || _Protocol.HoldingRegisters[i].plot == true) {
-      JsonArray arr = doc.createNestedArray(_Protocol.HoldingRegisters[i].name);
-
-      //value
-      if (_Protocol.HoldingRegisters[i].multiplier  == (int)_Protocol.HoldingRegisters[i].multiplier) {
-        arr.add(_Protocol.HoldingRegisters[i].value * _Protocol.HoldingRegisters[i].multiplier);
-      } else {
-        arr.add(_round2(_Protocol.HoldingRegisters[i].value * _Protocol.HoldingRegisters[i].multiplier));
-      }
-      arr.add(unitStr[_Protocol.HoldingRegisters[i].unit]);
-      arr.add(_Protocol.HoldingRegisters[i].plot); //should be plotted
+    if (IsDuplicateHolding(i))
+      continue;
+    if (_Protocol.HoldingRegisters[i].Frontend() == true || _Protocol.HoldingRegisters[i].Plot() == true) {
+      _UIEntry(json, valuesOnly, _Protocol.HoldingRegisters[i].Name(),
+               _Fixed(_Protocol.HoldingRegisters[i], _Protocol.HoldingValues[i]),
+               unitStr[_Protocol.HoldingRegisters[i].Unit()], _Protocol.HoldingRegisters[i].Plot());
     }
   }
 
   // compute additional aggregated statistics
 #if GROWATT_MODBUS_VERSION == 305
-  double uac_l1 = _Protocol.InputRegisters[P305_AC_VOLTAGE].value *
-                   _Protocol.InputRegisters[P305_AC_VOLTAGE].multiplier;
-  double uac_l2 = 0, uac_l3 = 0;
-  double iac_l1 = _Protocol.InputRegisters[P305_AC_OUTPUT_CURRENT].value *
-                   _Protocol.InputRegisters[P305_AC_OUTPUT_CURRENT].multiplier;
-  double iac_l2 = 0, iac_l3 = 0;
-  double pac_l1 = _Protocol.InputRegisters[P305_AC_POWER].value *
-                   _Protocol.InputRegisters[P305_AC_POWER].multiplier;
-  double pac_l2 = 0, pac_l3 = 0;
-  double dayE = _Protocol.InputRegisters[P305_ENERGY_TODAY].value *
-                _Protocol.InputRegisters[P305_ENERGY_TODAY].multiplier * 1000.0;
+  sFixedPoint_t uac_l1 = _FixedInput(P305_AC_VOLTAGE);
+  sFixedPoint_t uac_l2 = {0, 0}, uac_l3 = {0, 0};
+  sFixedPoint_t iac_l1 = _FixedInput(P305_AC_OUTPUT_CURRENT);
+  sFixedPoint_t iac_l2 = {0, 0}, iac_l3 = {0, 0};
+  sFixedPoint_t pac_l1 = _FixedInput(P305_AC_POWER);
+  sFixedPoint_t pac_l2 = {0, 0}, pac_l3 = {0, 0};
+  sFixedPoint_t dayE = _FixedInput(P305_ENERGY_TODAY);
 #elif GROWATT_MODBUS_VERSION == 120
-  double uac_l1 = _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].value *
-                   _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P120_GRID_L2_VOLTAGE].value *
-                   _Protocol.InputRegisters[P120_GRID_L2_VOLTAGE].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P120_GRID_L3_VOLTAGE].value *
-                   _Protocol.InputRegisters[P120_GRID_L3_VOLTAGE].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].value *
-                   _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_CURRENT].value *
-                   _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_CURRENT].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_CURRENT].value *
-                   _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_CURRENT].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].value *
-                   _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].value *
-                   _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].value *
-                   _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].multiplier;
-  double dayE = _Protocol.InputRegisters[P120_ENERGY_TODAY].value *
-                _Protocol.InputRegisters[P120_ENERGY_TODAY].multiplier * 1000.0;
+  sFixedPoint_t uac_l1 = _FixedInput(P120_GRID_L1_VOLTAGE);
+  sFixedPoint_t uac_l2 = _FixedInput(P120_GRID_L2_VOLTAGE);
+  sFixedPoint_t uac_l3 = _FixedInput(P120_GRID_L3_VOLTAGE);
+  sFixedPoint_t iac_l1 = _FixedInput(P120_GRID_L1_OUTPUT_CURRENT);
+  sFixedPoint_t iac_l2 = _FixedInput(P120_GRID_L2_OUTPUT_CURRENT);
+  sFixedPoint_t iac_l3 = _FixedInput(P120_GRID_L3_OUTPUT_CURRENT);
+  sFixedPoint_t pac_l1 = _FixedInput(P120_GRID_L1_OUTPUT_POWER);
+  sFixedPoint_t pac_l2 = _FixedInput(P120_GRID_L2_OUTPUT_POWER);
+  sFixedPoint_t pac_l3 = _FixedInput(P120_GRID_L3_OUTPUT_POWER);
+  sFixedPoint_t dayE = _FixedInput(P120_ENERGY_TODAY);
 #elif GROWATT_MODBUS_VERSION == 124
-  double uac_l1 = _Protocol.InputRegisters[P124_VAC1].value *
-                   _Protocol.InputRegisters[P124_VAC1].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P124_VAC2].value *
-                   _Protocol.InputRegisters[P124_VAC2].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P124_VAC3].value *
-                   _Protocol.InputRegisters[P124_VAC3].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P124_IAC1].value *
-                   _Protocol.InputRegisters[P124_IAC1].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P124_IAC2].value *
-                   _Protocol.InputRegisters[P124_IAC2].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P124_IAC3].value *
-                   _Protocol.InputRegisters[P124_IAC3].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P124_PAC1].value *
-                   _Protocol.InputRegisters[P124_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P124_PAC2].value *
-                   _Protocol.InputRegisters[P124_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P124_PAC3].value *
-                   _Protocol.InputRegisters[P124_PAC3].multiplier;
-  double dayE = _Protocol.InputRegisters[P124_EAC_TODAY].value *
-                _Protocol.InputRegisters[P124_EAC_TODAY].multiplier * 1000.0;
+  sFixedPoint_t uac_l1 = _FixedInput(P124_VAC1);
+  sFixedPoint_t uac_l2 = _FixedInput(P124_VAC2);
+  sFixedPoint_t uac_l3 = _FixedInput(P124_VAC3);
+  sFixedPoint_t iac_l1 = _FixedInput(P124_IAC1);
+  sFixedPoint_t iac_l2 = _FixedInput(P124_IAC2);
+  sFixedPoint_t iac_l3 = _FixedInput(P124_IAC3);
+  sFixedPoint_t pac_l1 = _FixedInput(P124_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P124_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P124_PAC3);
+  sFixedPoint_t dayE = _FixedInput(P124_EAC_TODAY);
 #elif GROWATT_MODBUS_VERSION == 125
-  double uac_l1 = _Protocol.InputRegisters[P125_VAC1].value *
-                   _Protocol.InputRegisters[P125_VAC1].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P125_VAC2].value *
-                   _Protocol.InputRegisters[P125_VAC2].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P125_VAC3].value *
-                   _Protocol.InputRegisters[P125_VAC3].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P125_IAC1].value *
-                   _Protocol.InputRegisters[P125_IAC1].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P125_IAC2].value *
-                   _Protocol.InputRegisters[P125_IAC2].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P125_IAC3].value *
-                   _Protocol.InputRegisters[P125_IAC3].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P125_PAC1].value *
-                   _Protocol.InputRegisters[P125_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P125_PAC2].value *
-                   _Protocol.InputRegisters[P125_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P125_PAC3].value *
-                   _Protocol.InputRegisters[P125_PAC3].multiplier;
-  double dayE = _Protocol.InputRegisters[P125_EAC_TODAY].value *
-                _Protocol.InputRegisters[P125_EAC_TODAY].multiplier * 1000.0;
+  sFixedPoint_t uac_l1 = _FixedInput(P125_VAC1);
+  sFixedPoint_t uac_l2 = _FixedInput(P125_VAC2);
+  sFixedPoint_t uac_l3 = _FixedInput(P125_VAC3);
+  sFixedPoint_t iac_l1 = _FixedInput(P125_IAC1);
+  sFixedPoint_t iac_l2 = _FixedInput(P125_IAC2);
+  sFixedPoint_t iac_l3 = _FixedInput(P125_IAC3);
+  sFixedPoint_t pac_l1 = _FixedInput(P125_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P125_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P125_PAC3);
+  sFixedPoint_t dayE = _FixedInput(P125_EAC_TODAY);
 #else
-  double uac_l1 = 0, uac_l2 = 0, uac_l3 = 0;
-  double iac_l1 = 0, iac_l2 = 0, iac_l3 = 0;
-  double pac_l1 = 0, pac_l2 = 0, pac_l3 = 0;
-  double dayE = 0;
+  sFixedPoint_t uac_l1 = {0, 0}, uac_l2 = {0, 0}, uac_l3 = {0, 0};
+  sFixedPoint_t iac_l1 = {0, 0}, iac_l2 = {0, 0}, iac_l3 = {0, 0};
+  sFixedPoint_t pac_l1 = {0, 0}, pac_l2 = {0, 0}, pac_l3 = {0, 0};
+  sFixedPoint_t dayE = {0, 0};
 #endif
 
-  double uac_avg = (uac_l1 + uac_l2 + uac_l3) / 3.0;
-  double line_avg = uac_avg * 1.7320508; // sqrt(3)
-  double iac_avg = (iac_l1 + iac_l2 + iac_l3) / 3.0;
-  double pac_sum = pac_l1 + pac_l2 + pac_l3;
-
-  double sumPac = pac_sum;
-  double dayE_l1 = 0, dayE_l2 = 0, dayE_l3 = 0;
-  if (sumPac != 0) {
-    dayE_l1 = dayE * pac_l1 / sumPac;
-    dayE_l2 = dayE * pac_l2 / sumPac;
-    dayE_l3 = dayE * pac_l3 / sumPac;
-  }
-
-  JsonArray arr = doc.createNestedArray("VoltageAvg");
-  arr.add(_round2(uac_avg));
-  arr.add("V");
-  arr.add(false);
-
-  arr = doc.createNestedArray("LineVoltageAvg");
-  arr.add(_round2(line_avg));
-  arr.add("V");
-  arr.add(false);
-
-  arr = doc.createNestedArray("CurrentAvg");
-  arr.add(_round2(iac_avg));
-  arr.add("A");
-  arr.add(false);
-
-  arr = doc.createNestedArray("PowerSum");
-  arr.add(_round2(pac_sum));
-  arr.add("W");
-  arr.add(false);
-
-  arr = doc.createNestedArray("DayEnergyL1");
-  arr.add(_round2(dayE_l1 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
-  arr = doc.createNestedArray("DayEnergyL2");
-  arr.add(_round2(dayE_l2 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
-  arr = doc.createNestedArray("DayEnergyL3");
-  arr.add(_round2(dayE_l3 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
-
-  arr = doc.createNestedArray("TotalEnergyL1");
-  arr.add(_round2(_accEnergyL1 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
-  arr = doc.createNestedArray("TotalEnergyL2");
-  arr.add(_round2(_accEnergyL2 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
-  arr = doc.createNestedArray("TotalEnergyL3");
-  arr.add(_round2(_accEnergyL3 / 1000.0));
-  arr.add("kWh");
-  arr.add(false);
+  sFixedPoint_t uac_sum = _FixedSum(_FixedSum(uac_l1, uac_l2), uac_l3);
+  sFixedPoint_t iac_sum = _FixedSum(_FixedSum(iac_l1, iac_l2), iac_l3);
+  sFixedPoint_t pac_sum = _FixedSum(_FixedSum(pac_l1, pac_l2), pac_l3);
+  sFixedPoint_t totE_l1 = {_PhaseEnergy.Total(0), -3}, totE_l2 = {_PhaseEnergy.Total(1), -3};
+  sFixedPoint_t totE_l3 = {_PhaseEnergy.Total(2), -3};
+
+  _UIEntry(json, valuesOnly, F("VoltageAvg"), _FixedRatio(uac_sum, 1, 3, -2), "V", false);
+  // the average times sqrt(3)
+  _UIEntry(json, valuesOnly, F("LineVoltageAvg"), _FixedRatio(uac_sum, 17320508, 30000000, -2), "V", false);
+  _UIEntry(json, valuesOnly, F("CurrentAvg"), _FixedRatio(iac_sum, 1, 3, -2), "A", false);
+  _UIEntry(json, valuesOnly, F("PowerSum"), pac_sum.Rounded(-2), "W", false);
+  _UIEntry(json, valuesOnly, F("DayEnergyL1"), _FixedShare(dayE, pac_l1, pac_sum, -2), "kWh", false);
+  _UIEntry(json, valuesOnly, F("DayEnergyL2"), _FixedShare(dayE, pac_l2, pac_sum, -2), "kWh", false);
+  _UIEntry(json, valuesOnly, F("DayEnergyL3"), _FixedShare(dayE, pac_l3, pac_sum, -2), "kWh", false);
+  _UIEntry(json, valuesOnly, F("TotalEnergyL1"), totE_l1.Rounded(-2), "kWh", false);
+  _UIEntry(json, valuesOnly, F("TotalEnergyL2"), totE_l2.Rounded(-2), "kWh", false);
+  _UIEntry(json, valuesOnly, F("TotalEnergyL3"), totE_l3.Rounded(-2), "kWh", false);
 #else
   #warning simulating the inverter
-  JsonArray arr = doc.createNestedArray("Status");
-  arr.add(1);arr.add("");arr.add(false);
-  arr = doc.createNestedArray("DcPower");
-  arr.add(230);arr.add("W");arr.add(true);
-  arr = doc.createNestedArray("DcVoltage");
-  arr.add(70.5);arr.add("V");arr.add(false);
-  arr = doc.createNestedArray("DcInputCurrent");
-  arr.add(8.5);arr.add("A");arr.add(false);
-  arr = doc.createNestedArray("AcFreq");
-  arr.add(50);arr.add("Hz");arr.add(false);
-  arr = doc.createNestedArray("AcVoltage");
-  arr.add(230);arr.add("V");arr.add(false);
-  arr = doc.createNestedArray("AcPower");
-  arr.add(0.00);arr.add("W");arr.add(false);
-  arr = doc.createNestedArray("EnergyToday");
-  arr.add(0.3);arr.add("kWh");arr.add(false);
-  arr = doc.createNestedArray("EnergyTotal");
-  arr.add(49.1);arr.add("kWh");arr.add(false);
-  arr = doc.createNestedArray("OperatingTime");
-  arr.add(123456);arr.add("s");arr.add(false);
-  arr = doc.createNestedArray("Temperature");
-  arr.add(21.12);arr.add("C");arr.add(false);
-  arr = doc.createNestedArray("AccumulatedEnergy");
-  arr.add(320);arr.add("kWh");arr.add(false);
+  _UIEntry(json, valuesOnly, F("Status"), 1, "", false);
+  _UIEntry(json, valuesOnly, F("DcPower"), 230, "W", true);
+  _UIEntry(json, valuesOnly, F("DcVoltage"), 70.5, "V", false);
+  _UIEntry(json, valuesOnly, F("DcInputCurrent"), 8.5, "A", false);
+  _UIEntry(json, valuesOnly, F("AcFreq"), 50, "Hz", false);
+  _UIEntry(json, valuesOnly, F("AcVoltage"), 230, "V", false);
+  _UIEntry(json, valuesOnly, F("AcPower"), 0.00, "W", false);
+  _UIEntry(json, valuesOnly, F("EnergyToday"), 0.3, "kWh", false);
+  _UIEntry(json, valuesOnly, F("EnergyTotal"), 49.1, "kWh", false);
+  _UIEntry(json, valuesOnly, F("OperatingTime"), 123456, "s", false);
+  _UIEntry(json, valuesOnly, F("Temperature"), 21.12, "C", false);
+  _UIEntry(json, valuesOnly, F("AccumulatedEnergy"), 320, "kWh", false);
 #endif // SIMULATE_INVERTER
 
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  if (valuesOnly)
+    json.EndArray();
+  else
+    json.EndObject();
 }
 
-void Growatt::CreateFroniusJson(char *Buffer) {
-  StaticJsonDocument<2048> doc;
-
-  JsonObject head = doc.createNestedObject("Head");
-  JsonObject req = head.createNestedObject("RequestArguments");
-  req["DeviceId"] = 1;
-  req["Scope"] = "Device";
-  req["DataCollection"] = "CommonInverterData";
-  JsonObject status = head.createNestedObject("Status");
-  status["Code"] = 0;
-  status["Reason"] = "";
-  status["UserMessage"] = "";
-  time_t now = time(nullptr);
-  struct tm *tm_info = localtime(&now);
+void Growatt::CreateFroniusJson(Print &out) {
+  /**
+   * @brief Write GetInverterRealtimeData, the values are patched into a prebuilt template
+   * @param out the document is written to it
+   */
   char ts[30];
-  snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d+00:00",
-           tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-           tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-  head["Timestamp"] = ts;
 
-  JsonObject body = doc.createNestedObject("Body");
-  JsonObject data = body.createNestedObject("Data");
+  if (!FroniusRealtimeTemplate.Begin()) {
+    out.print(F("{}"));
+    return;
+  }
 
 #if GROWATT_MODBUS_VERSION == 305
-  double pac  = _Protocol.InputRegisters[P305_AC_POWER].value * _Protocol.InputRegisters[P305_AC_POWER].multiplier;
-  double fac  = _Protocol.InputRegisters[P305_AC_FREQUENCY].value * _Protocol.InputRegisters[P305_AC_FREQUENCY].multiplier;
-  double uac  = _Protocol.InputRegisters[P305_AC_VOLTAGE].value * _Protocol.InputRegisters[P305_AC_VOLTAGE].multiplier;
-  double iac  = _Protocol.InputRegisters[P305_AC_OUTPUT_CURRENT].value * _Protocol.InputRegisters[P305_AC_OUTPUT_CURRENT].multiplier;
-  double pdc  = _Protocol.InputRegisters[P305_DC_POWER].value * _Protocol.InputRegisters[P305_DC_POWER].multiplier;
-  double udc  = _Protocol.InputRegisters[P305_DC_VOLTAGE].value * _Protocol.InputRegisters[P305_DC_VOLTAGE].multiplier;
-  double idc  = _Protocol.InputRegisters[P305_DC_INPUT_CURRENT].value * _Protocol.InputRegisters[P305_DC_INPUT_CURRENT].multiplier;
-  double dayE = _Protocol.InputRegisters[P305_ENERGY_TODAY].value * _Protocol.InputRegisters[P305_ENERGY_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P305_ENERGY_TOTAL].value * _Protocol.InputRegisters[P305_ENERGY_TOTAL].multiplier * 1000.0;
-  double uac_l1 = uac, uac_l2 = 0, uac_l3 = 0;
-  double iac_l1 = iac, iac_l2 = 0, iac_l3 = 0;
-  double pac_l1 = pac, pac_l2 = 0, pac_l3 = 0;
+  sFixedPoint_t pac  = _FixedInput(P305_AC_POWER);
+  sFixedPoint_t fac  = _FixedInput(P305_AC_FREQUENCY);
+  sFixedPoint_t uac  = _FixedInput(P305_AC_VOLTAGE);
+  sFixedPoint_t iac  = _FixedInput(P305_AC_OUTPUT_CURRENT);
+  sFixedPoint_t pdc  = _FixedInput(P305_DC_POWER);
+  sFixedPoint_t udc  = _FixedInput(P305_DC_VOLTAGE);
+  sFixedPoint_t idc  = _FixedInput(P305_DC_INPUT_CURRENT);
+  sFixedPoint_t dayE = _FixedInput(P305_ENERGY_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P305_ENERGY_TOTAL, 3);
+  sFixedPoint_t uac_l1 = uac, uac_l2 = {0, 0}, uac_l3 = {0, 0};
+  sFixedPoint_t iac_l1 = iac, iac_l2 = {0, 0}, iac_l3 = {0, 0};
+  sFixedPoint_t pac_l1 = pac, pac_l2 = {0, 0}, pac_l3 = {0, 0};
 #elif GROWATT_MODBUS_VERSION == 120
-  double pac  = _Protocol.InputRegisters[P120_OUTPUT_POWER].value * _Protocol.InputRegisters[P120_OUTPUT_POWER].multiplier;
-  double fac  = _Protocol.InputRegisters[P120_GRID_FREQUENCY].value * _Protocol.InputRegisters[P120_GRID_FREQUENCY].multiplier;
-  double uac  = _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].value * _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].multiplier;
-  double iac  = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].value * _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].multiplier;
-  double pdc  = _Protocol.InputRegisters[P120_INPUT_POWER].value * _Protocol.InputRegisters[P120_INPUT_POWER].multiplier;
-  double udc  = _Protocol.InputRegisters[P120_PV1_VOLTAGE].value * _Protocol.InputRegisters[P120_PV1_VOLTAGE].multiplier;
-  double idc  = (_Protocol.InputRegisters[P120_PV1_INPUT_CURRENT].value * _Protocol.InputRegisters[P120_PV1_INPUT_CURRENT].multiplier) +
-                 (_Protocol.InputRegisters[P120_PV2_INPUT_CURRENT].value * _Protocol.InputRegisters[P120_PV2_INPUT_CURRENT].multiplier);
-  double dayE = _Protocol.InputRegisters[P120_ENERGY_TODAY].value * _Protocol.InputRegisters[P120_ENERGY_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P120_ENERGY_TOTAL].value * _Protocol.InputRegisters[P120_ENERGY_TOTAL].multiplier * 1000.0;
-  double uac_l1 = _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].value * _Protocol.InputRegisters[P120_GRID_L1_VOLTAGE].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P120_GRID_L2_VOLTAGE].value * _Protocol.InputRegisters[P120_GRID_L2_VOLTAGE].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P120_GRID_L3_VOLTAGE].value * _Protocol.InputRegisters[P120_GRID_L3_VOLTAGE].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].value * _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_CURRENT].value * _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_CURRENT].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_CURRENT].value * _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_CURRENT].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].value * _Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].value * _Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].value * _Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER].multiplier;
+  sFixedPoint_t pac  = _FixedInput(P120_OUTPUT_POWER);
+  sFixedPoint_t fac  = _FixedInput(P120_GRID_FREQUENCY);
+  sFixedPoint_t uac  = _FixedInput(P120_GRID_L1_VOLTAGE);
+  sFixedPoint_t iac  = _FixedInput(P120_GRID_L1_OUTPUT_CURRENT);
+  sFixedPoint_t pdc  = _FixedInput(P120_INPUT_POWER);
+  sFixedPoint_t udc  = _FixedInput(P120_PV1_VOLTAGE);
+  sFixedPoint_t idc  = _FixedSum(_FixedInput(P120_PV1_INPUT_CURRENT), _FixedInput(P120_PV2_INPUT_CURRENT));
+  sFixedPoint_t dayE = _FixedInput(P120_ENERGY_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P120_ENERGY_TOTAL, 3);
+  sFixedPoint_t uac_l1 = _FixedInput(P120_GRID_L1_VOLTAGE);
+  sFixedPoint_t uac_l2 = _FixedInput(P120_GRID_L2_VOLTAGE);
+  sFixedPoint_t uac_l3 = _FixedInput(P120_GRID_L3_VOLTAGE);
+  sFixedPoint_t iac_l1 = _FixedInput(P120_GRID_L1_OUTPUT_CURRENT);
+  sFixedPoint_t iac_l2 = _FixedInput(P120_GRID_L2_OUTPUT_CURRENT);
+  sFixedPoint_t iac_l3 = _FixedInput(P120_GRID_L3_OUTPUT_CURRENT);
+  sFixedPoint_t pac_l1 = _FixedInput(P120_GRID_L1_OUTPUT_POWER);
+  sFixedPoint_t pac_l2 = _FixedInput(P120_GRID_L2_OUTPUT_POWER);
+  sFixedPoint_t pac_l3 = _FixedInput(P120_GRID_L3_OUTPUT_POWER);
 #elif GROWATT_MODBUS_VERSION == 124
-  double pac  = _Protocol.InputRegisters[P124_PAC].value * _Protocol.InputRegisters[P124_PAC].multiplier;
-  double fac  = _Protocol.InputRegisters[P124_FAC].value * _Protocol.InputRegisters[P124_FAC].multiplier;
-  double uac  = _Protocol.InputRegisters[P124_VAC1].value * _Protocol.InputRegisters[P124_VAC1].multiplier;
-  double iac  = _Protocol.InputRegisters[P124_IAC1].value * _Protocol.InputRegisters[P124_IAC1].multiplier;
-  double pdc  = _Protocol.InputRegisters[P124_INPUT_POWER].value * _Protocol.InputRegisters[P124_INPUT_POWER].multiplier;
-  double udc  = _Protocol.InputRegisters[P124_PV1_VOLTAGE].value * _Protocol.InputRegisters[P124_PV1_VOLTAGE].multiplier;
-  double idc  = (_Protocol.InputRegisters[P124_PV1_CURRENT].value * _Protocol.InputRegisters[P124_PV1_CURRENT].multiplier) +
-                 (_Protocol.InputRegisters[P124_PV2_CURRENT].value * _Protocol.InputRegisters[P124_PV2_CURRENT].multiplier);
-  double dayE = _Protocol.InputRegisters[P124_EAC_TODAY].value * _Protocol.InputRegisters[P124_EAC_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P124_EAC_TOTAL].value * _Protocol.InputRegisters[P124_EAC_TOTAL].multiplier * 1000.0;
-  double uac_l1 = _Protocol.InputRegisters[P124_VAC1].value * _Protocol.InputRegisters[P124_VAC1].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P124_VAC2].value * _Protocol.InputRegisters[P124_VAC2].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P124_VAC3].value * _Protocol.InputRegisters[P124_VAC3].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P124_IAC1].value * _Protocol.InputRegisters[P124_IAC1].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P124_IAC2].value * _Protocol.InputRegisters[P124_IAC2].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P124_IAC3].value * _Protocol.InputRegisters[P124_IAC3].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P124_PAC1].value * _Protocol.InputRegisters[P124_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P124_PAC2].value * _Protocol.InputRegisters[P124_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P124_PAC3].value * _Protocol.InputRegisters[P124_PAC3].multiplier;
+  sFixedPoint_t pac  = _FixedInput(P124_PAC);
+  sFixedPoint_t fac  = _FixedInput(P124_FAC);
+  sFixedPoint_t uac  = _FixedInput(P124_VAC1);
+  sFixedPoint_t iac  = _FixedInput(P124_IAC1);
+  sFixedPoint_t pdc  = _FixedInput(P124_INPUT_POWER);
+  sFixedPoint_t udc  = _FixedInput(P124_PV1_VOLTAGE);
+  sFixedPoint_t idc  = _FixedSum(_FixedInput(P124_PV1_CURRENT), _FixedInput(P124_PV2_CURRENT));
+  sFixedPoint_t dayE = _FixedInput(P124_EAC_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P124_EAC_TOTAL, 3);
+  sFixedPoint_t uac_l1 = _FixedInput(P124_VAC1);
+  sFixedPoint_t uac_l2 = _FixedInput(P124_VAC2);
+  sFixedPoint_t uac_l3 = _FixedInput(P124_VAC3);
+  sFixedPoint_t iac_l1 = _FixedInput(P124_IAC1);
+  sFixedPoint_t iac_l2 = _FixedInput(P124_IAC2);
+  sFixedPoint_t iac_l3 = _FixedInput(P124_IAC3);
+  sFixedPoint_t pac_l1 = _FixedInput(P124_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P124_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P124_PAC3);
 #elif GROWATT_MODBUS_VERSION == 125
-  double pac  = _Protocol.InputRegisters[P125_PAC].value * _Protocol.InputRegisters[P125_PAC].multiplier;
-  double fac  = _Protocol.InputRegisters[P125_FAC].value * _Protocol.InputRegisters[P125_FAC].multiplier;
-  double uac  = _Protocol.InputRegisters[P125_VAC1].value * _Protocol.InputRegisters[P125_VAC1].multiplier;
-  double iac  = _Protocol.InputRegisters[P125_IAC1].value * _Protocol.InputRegisters[P125_IAC1].multiplier;
-  double pdc  = _Protocol.InputRegisters[P125_INPUT_POWER].value * _Protocol.InputRegisters[P125_INPUT_POWER].multiplier;
-  double udc  = _Protocol.InputRegisters[P125_PV1_VOLTAGE].value * _Protocol.InputRegisters[P125_PV1_VOLTAGE].multiplier;
-  double idc  = (_Protocol.InputRegisters[P125_PV1_CURRENT].value * _Protocol.InputRegisters[P125_PV1_CURRENT].multiplier) +
-                 (_Protocol.InputRegisters[P125_PV2_CURRENT].value * _Protocol.InputRegisters[P125_PV2_CURRENT].multiplier);
-  double dayE = _Protocol.InputRegisters[P125_EAC_TODAY].value * _Protocol.InputRegisters[P125_EAC_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P125_EAC_TOTAL].value * _Protocol.InputRegisters[P125_EAC_TOTAL].multiplier * 1000.0;
-  double uac_l1 = _Protocol.InputRegisters[P125_VAC1].value * _Protocol.InputRegisters[P125_VAC1].multiplier;
-  double uac_l2 = _Protocol.InputRegisters[P125_VAC2].value * _Protocol.InputRegisters[P125_VAC2].multiplier;
-  double uac_l3 = _Protocol.InputRegisters[P125_VAC3].value * _Protocol.InputRegisters[P125_VAC3].multiplier;
-  double iac_l1 = _Protocol.InputRegisters[P125_IAC1].value * _Protocol.InputRegisters[P125_IAC1].multiplier;
-  double iac_l2 = _Protocol.InputRegisters[P125_IAC2].value * _Protocol.InputRegisters[P125_IAC2].multiplier;
-  double iac_l3 = _Protocol.InputRegisters[P125_IAC3].value * _Protocol.InputRegisters[P125_IAC3].multiplier;
-  double pac_l1 = _Protocol.InputRegisters[P125_PAC1].value * _Protocol.InputRegisters[P125_PAC1].multiplier;
-  double pac_l2 = _Protocol.InputRegisters[P125_PAC2].value * _Protocol.InputRegisters[P125_PAC2].multiplier;
-  double pac_l3 = _Protocol.InputRegisters[P125_PAC3].value * _Protocol.InputRegisters[P125_PAC3].multiplier;
+  sFixedPoint_t pac  = _FixedInput(P125_PAC);
+  sFixedPoint_t fac  = _FixedInput(P125_FAC);
+  sFixedPoint_t uac  = _FixedInput(P125_VAC1);
+  sFixedPoint_t iac  = _FixedInput(P125_IAC1);
+  sFixedPoint_t pdc  = _FixedInput(P125_INPUT_POWER);
+  sFixedPoint_t udc  = _FixedInput(P125_PV1_VOLTAGE);
+  sFixedPoint_t idc  = _FixedSum(_FixedInput(P125_PV1_CURRENT), _FixedInput(P125_PV2_CURRENT));
+  sFixedPoint_t dayE = _FixedInput(P125_EAC_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P125_EAC_TOTAL, 3);
+  sFixedPoint_t uac_l1 = _FixedInput(P125_VAC1);
+  sFixedPoint_t uac_l2 = _FixedInput(P125_VAC2);
+  sFixedPoint_t uac_l3 = _FixedInput(P125_VAC3);
+  sFixedPoint_t iac_l1 = _FixedInput(P125_IAC1);
+  sFixedPoint_t iac_l2 = _FixedInput(P125_IAC2);
+  sFixedPoint_t iac_l3 = _FixedInput(P125_IAC3);
+  sFixedPoint_t pac_l1 = _FixedInput(P125_PAC1);
+  sFixedPoint_t pac_l2 = _FixedInput(P125_PAC2);
+  sFixedPoint_t pac_l3 = _FixedInput(P125_PAC3);
 #else
-  double pac = 0, fac = 0, uac = 0, iac = 0, pdc = 0, udc = 0, idc = 0, dayE = 0, totE = 0;
-  double uac_l1 = 0, uac_l2 = 0, uac_l3 = 0;
-  double iac_l1 = 0, iac_l2 = 0, iac_l3 = 0;
-  double pac_l1 = 0, pac_l2 = 0, pac_l3 = 0;
+  sFixedPoint_t pac = {0, 0}, fac = {0, 0}, uac = {0, 0}, iac = {0, 0}, pdc = {0, 0}, udc = {0, 0}, idc = {0, 0};
+  sFixedPoint_t dayE = {0, 0}, totE = {0, 0};
+  sFixedPoint_t uac_l1 = {0, 0}, uac_l2 = {0, 0}, uac_l3 = {0, 0};
+  sFixedPoint_t iac_l1 = {0, 0}, iac_l2 = {0, 0}, iac_l3 = {0, 0};
+  sFixedPoint_t pac_l1 = {0, 0}, pac_l2 = {0, 0}, pac_l3 = {0, 0};
 #endif
 
-  // accumulate per phase energy based on total energy increments
-  double sumPacInstant = pac_l1 + pac_l2 + pac_l3;
-  if (_prevEnergyValid) {
-    double deltaE = totE - _prevTotalEnergy;
-    if (deltaE < 0) deltaE = 0;
-    if (sumPacInstant > 0) {
-      _accEnergyL1 += deltaE * pac_l1 / sumPacInstant;
-      _accEnergyL2 += deltaE * pac_l2 / sumPacInstant;
-      _accEnergyL3 += deltaE * pac_l3 / sumPacInstant;
-    }
-  }
-  _prevTotalEnergy = totE;
-  _prevEnergyValid = true;
-
-  double dayE_l1 = 0, dayE_l2 = 0, dayE_l3 = 0;
-  double totE_l1 = _accEnergyL1, totE_l2 = _accEnergyL2, totE_l3 = _accEnergyL3;
-  double sumPac = pac_l1 + pac_l2 + pac_l3;
-  if (sumPac != 0) {
-    dayE_l1 = dayE * pac_l1 / sumPac;
-    dayE_l2 = dayE * pac_l2 / sumPac;
-    dayE_l3 = dayE * pac_l3 / sumPac;
-  }
+  // the day energy split in the ratio of the power of the phases, in Wh
+  sFixedPoint_t pac_sum = _FixedSum(_FixedSum(pac_l1, pac_l2), pac_l3);
+  sFixedPoint_t dayE_l1 = _FixedShare(dayE, pac_l1, pac_sum, 0);
+  sFixedPoint_t dayE_l2 = _FixedShare(dayE, pac_l2, pac_sum, 0);
+  sFixedPoint_t dayE_l3 = _FixedShare(dayE, pac_l3, pac_sum, 0);
+  sFixedPoint_t totE_l1 = {_PhaseEnergy.Total(0), 0}, totE_l2 = {_PhaseEnergy.Total(1), 0};
+  sFixedPoint_t totE_l3 = {_PhaseEnergy.Total(2), 0};
 
 #if GROWATT_MODBUS_VERSION == 305
-  uint32_t gwStatus = _Protocol.InputRegisters[P305_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P305_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 120
-  uint32_t gwStatus = _Protocol.InputRegisters[P120_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P120_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 124
-  uint32_t gwStatus = _Protocol.InputRegisters[P124_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P124_I_STATUS];
 #else
   uint32_t gwStatus = 0;
 #endif
   uint8_t froniusStatus = MapStatusToFronius(gwStatus);
 
-  JsonObject pacObj = data.createNestedObject("PAC");
-  pacObj["Value"] = pac;
-  pacObj["Unit"] = "W";
-  JsonObject pdcObj = data.createNestedObject("PDC");
-  pdcObj["Value"] = pdc;
-  pdcObj["Unit"] = "W";
-  JsonObject facObj = data.createNestedObject("FAC");
-  facObj["Value"] = fac;
-  facObj["Unit"] = "Hz";
-  JsonObject uacObj = data.createNestedObject("UAC");
-  uacObj["Value"] = uac;
-  uacObj["Unit"] = "V";
-  JsonObject iacObj = data.createNestedObject("IAC");
-  iacObj["Value"] = iac;
-  iacObj["Unit"] = "A";
-  JsonObject uacL1Obj = data.createNestedObject("UAC_L1");
-  uacL1Obj["Value"] = uac_l1;
-  uacL1Obj["Unit"] = "V";
-  JsonObject uacL2Obj = data.createNestedObject("UAC_L2");
-  uacL2Obj["Value"] = uac_l2;
-  uacL2Obj["Unit"] = "V";
-  JsonObject uacL3Obj = data.createNestedObject("UAC_L3");
-  uacL3Obj["Value"] = uac_l3;
-  uacL3Obj["Unit"] = "V";
-  JsonObject iacL1Obj = data.createNestedObject("IAC_L1");
-  iacL1Obj["Value"] = iac_l1;
-  iacL1Obj["Unit"] = "A";
-  JsonObject iacL2Obj = data.createNestedObject("IAC_L2");
-  iacL2Obj["Value"] = iac_l2;
-  iacL2Obj["Unit"] = "A";
-  JsonObject iacL3Obj = data.createNestedObject("IAC_L3");
-  iacL3Obj["Value"] = iac_l3;
-  iacL3Obj["Unit"] = "A";
-  JsonObject devStat = data.createNestedObject("DeviceStatus");
-  devStat["ErrorCode"] = 0;
-  devStat["StatusCode"] = froniusStatus;
-  devStat["Status"] = FroniusStatusToString(froniusStatus);
-  JsonObject pacL1Obj = data.createNestedObject("PAC_L1");
-  pacL1Obj["Value"] = pac_l1;
-  pacL1Obj["Unit"] = "W";
-  JsonObject pacL2Obj = data.createNestedObject("PAC_L2");
-  pacL2Obj["Value"] = pac_l2;
-  pacL2Obj["Unit"] = "W";
-  JsonObject pacL3Obj = data.createNestedObject("PAC_L3");
-  pacL3Obj["Value"] = pac_l3;
-  pacL3Obj["Unit"] = "W";
-  JsonObject udcObj = data.createNestedObject("UDC");
-  udcObj["Value"] = udc;
-  udcObj["Unit"] = "V";
-  JsonObject idcObj = data.createNestedObject("IDC");
-  idcObj["Value"] = idc;
-  idcObj["Unit"] = "A";
-  JsonObject dayObj = data.createNestedObject("DAY_ENERGY");
-  dayObj["Value"] = dayE;
-  dayObj["Unit"] = "Wh";
-  JsonObject dayL1Obj = data.createNestedObject("DAY_ENERGY_L1");
-  dayL1Obj["Value"] = dayE_l1;
-  dayL1Obj["Unit"] = "Wh";
-  JsonObject dayL2Obj = data.createNestedObject("DAY_ENERGY_L2");
-  dayL2Obj["Value"] = dayE_l2;
-  dayL2Obj["Unit"] = "Wh";
-  JsonObject dayL3Obj = data.createNestedObject("DAY_ENERGY_L3");
-  dayL3Obj["Value"] = dayE_l3;
-  dayL3Obj["Unit"] = "Wh";
-  JsonObject totObj = data.createNestedObject("TOTAL_ENERGY");
-  totObj["Value"] = totE;
-  totObj["Unit"] = "Wh";
-  JsonObject totL1Obj = data.createNestedObject("TOTAL_ENERGY_L1");
-  totL1Obj["Value"] = totE_l1;
-  totL1Obj["Unit"] = "Wh";
-  JsonObject totL2Obj = data.createNestedObject("TOTAL_ENERGY_L2");
-  totL2Obj["Value"] = totE_l2;
-  totL2Obj["Unit"] = "Wh";
-  JsonObject totL3Obj = data.createNestedObject("TOTAL_ENERGY_L3");
-  totL3Obj["Value"] = totE_l3;
-  totL3Obj["Unit"] = "Wh";
-
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
-}
-
-void Growatt::CreatePowerFlowJson(char *Buffer) {
-  StaticJsonDocument<2048> doc;
+  _FroniusTimestamp(ts, sizeof(ts));
+  FroniusRealtimeTemplate.SetString(FR_TIMESTAMP, ts);
+  FroniusRealtimeTemplate.SetNumber(FR_PAC, pac);
+  FroniusRealtimeTemplate.SetNumber(FR_PDC, pdc);
+  FroniusRealtimeTemplate.SetNumber(FR_FAC, fac);
+  FroniusRealtimeTemplate.SetNumber(FR_UAC, uac);
+  FroniusRealtimeTemplate.SetNumber(FR_IAC, iac);
+  FroniusRealtimeTemplate.SetNumber(FR_UAC_L1, uac_l1);
+  FroniusRealtimeTemplate.SetNumber(FR_UAC_L2, uac_l2);
+  FroniusRealtimeTemplate.SetNumber(FR_UAC_L3, uac_l3);
+  FroniusRealtimeTemplate.SetNumber(FR_IAC_L1, iac_l1);
+  FroniusRealtimeTemplate.SetNumber(FR_IAC_L2, iac_l2);
+  FroniusRealtimeTemplate.SetNumber(FR_IAC_L3, iac_l3);
+  FroniusRealtimeTemplate.SetNumber(FR_STATUS_CODE, froniusStatus);
+  FroniusRealtimeTemplate.SetString(FR_STATUS, FroniusStatusToString(froniusStatus));
+  FroniusRealtimeTemplate.SetNumber(FR_PAC_L1, pac_l1);
+  FroniusRealtimeTemplate.SetNumber(FR_PAC_L2, pac_l2);
+  FroniusRealtimeTemplate.SetNumber(FR_PAC_L3, pac_l3);
+  FroniusRealtimeTemplate.SetNumber(FR_UDC, udc);
+  FroniusRealtimeTemplate.SetNumber(FR_IDC, idc);
+  FroniusRealtimeTemplate.SetNumber(FR_DAY_ENERGY, dayE);
+  FroniusRealtimeTemplate.SetNumber(FR_DAY_ENERGY_L1, dayE_l1);
+  FroniusRealtimeTemplate.SetNumber(FR_DAY_ENERGY_L2, dayE_l2);
+  FroniusRealtimeTemplate.SetNumber(FR_DAY_ENERGY_L3, dayE_l3);
+  FroniusRealtimeTemplate.SetNumber(FR_TOTAL_ENERGY, totE);
+  FroniusRealtimeTemplate.SetNumber(FR_TOTAL_ENERGY_L1, totE_l1);
+  FroniusRealtimeTemplate.SetNumber(FR_TOTAL_ENERGY_L2, totE_l2);
+  FroniusRealtimeTemplate.SetNumber(FR_TOTAL_ENERGY_L3, totE_l3);
+  FroniusRealtimeTemplate.Write(out);
+}
 
-  JsonObject head = doc.createNestedObject("Head");
-  head.createNestedObject("RequestArguments");
-  JsonObject status = head.createNestedObject("Status");
-  status["Code"] = 0;
-  status["Reason"] = "";
-  status["UserMessage"] = "";
-  time_t now = time(nullptr);
-  struct tm *tm_info = localtime(&now);
+void Growatt::CreatePowerFlowJson(Print &out) {
+  /**
+   * @brief Write GetPowerFlowRealtimeData, the values are patched into a prebuilt template
+   * @param out the document is written to it
+   */
   char ts[30];
-  snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d+00:00",
-           tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-           tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-  head["Timestamp"] = ts;
 
-  JsonObject body = doc.createNestedObject("Body");
-  JsonObject data = body.createNestedObject("Data");
-  JsonObject site = data.createNestedObject("Site");
+  if (!FroniusPowerFlowTemplate.Begin()) {
+    out.print(F("{}"));
+    return;
+  }
 
 #if GROWATT_MODBUS_VERSION == 305
-  double pac = _Protocol.InputRegisters[P305_AC_POWER].value * _Protocol.InputRegisters[P305_AC_POWER].multiplier;
-  double pdc = _Protocol.InputRegisters[P305_DC_POWER].value * _Protocol.InputRegisters[P305_DC_POWER].multiplier;
-  double dayE = _Protocol.InputRegisters[P305_ENERGY_TODAY].value * _Protocol.InputRegisters[P305_ENERGY_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P305_ENERGY_TOTAL].value * _Protocol.InputRegisters[P305_ENERGY_TOTAL].multiplier * 1000.0;
+  sFixedPoint_t pac = _FixedInput(P305_AC_POWER);
+  sFixedPoint_t pdc = _FixedInput(P305_DC_POWER);
+  sFixedPoint_t dayE = _FixedInput(P305_ENERGY_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P305_ENERGY_TOTAL, 3);
 #elif GROWATT_MODBUS_VERSION == 120
-  double pac = _Protocol.InputRegisters[P120_OUTPUT_POWER].value * _Protocol.InputRegisters[P120_OUTPUT_POWER].multiplier;
-  double pdc = _Protocol.InputRegisters[P120_INPUT_POWER].value * _Protocol.InputRegisters[P120_INPUT_POWER].multiplier;
-  double dayE = _Protocol.InputRegisters[P120_ENERGY_TODAY].value * _Protocol.InputRegisters[P120_ENERGY_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P120_ENERGY_TOTAL].value * _Protocol.InputRegisters[P120_ENERGY_TOTAL].multiplier * 1000.0;
+  sFixedPoint_t pac = _FixedInput(P120_OUTPUT_POWER);
+  sFixedPoint_t pdc = _FixedInput(P120_INPUT_POWER);
+  sFixedPoint_t dayE = _FixedInput(P120_ENERGY_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P120_ENERGY_TOTAL, 3);
 #elif GROWATT_MODBUS_VERSION == 124
-  double pac = _Protocol.InputRegisters[P124_PAC].value * _Protocol.InputRegisters[P124_PAC].multiplier;
-  double pdc = _Protocol.InputRegisters[P124_INPUT_POWER].value * _Protocol.InputRegisters[P124_INPUT_POWER].multiplier;
-  double dayE = _Protocol.InputRegisters[P124_EAC_TODAY].value * _Protocol.InputRegisters[P124_EAC_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P124_EAC_TOTAL].value * _Protocol.InputRegisters[P124_EAC_TOTAL].multiplier * 1000.0;
+  sFixedPoint_t pac = _FixedInput(P124_PAC);
+  sFixedPoint_t pdc = _FixedInput(P124_INPUT_POWER);
+  sFixedPoint_t dayE = _FixedInput(P124_EAC_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P124_EAC_TOTAL, 3);
 #elif GROWATT_MODBUS_VERSION == 125
-  double pac = _Protocol.InputRegisters[P125_PAC].value * _Protocol.InputRegisters[P125_PAC].multiplier;
-  double pdc = _Protocol.InputRegisters[P125_INPUT_POWER].value * _Protocol.InputRegisters[P125_INPUT_POWER].multiplier;
-  double dayE = _Protocol.InputRegisters[P125_EAC_TODAY].value * _Protocol.InputRegisters[P125_EAC_TODAY].multiplier * 1000.0;
-  double totE = _Protocol.InputRegisters[P125_EAC_TOTAL].value * _Protocol.InputRegisters[P125_EAC_TOTAL].multiplier * 1000.0;
+  sFixedPoint_t pac = _FixedInput(P125_PAC);
+  sFixedPoint_t pdc = _FixedInput(P125_INPUT_POWER);
+  sFixedPoint_t dayE = _FixedInput(P125_EAC_TODAY, 3);
+  sFixedPoint_t totE = _FixedInput(P125_EAC_TOTAL, 3);
 #else
-  double pac = 0, pdc = 0, dayE = 0, totE = 0;
+  sFixedPoint_t pac = {0, 0}, pdc = {0, 0}, dayE = {0, 0}, totE = {0, 0};
 #endif
 
-  site["P_PV"] = pdc;
-  site["P_Load"] = pac;
-  site["E_DAY"] = dayE;
-  site["E_TOTAL"] = totE;
-
-  JsonObject invs = data.createNestedObject("Inverters");
-  JsonObject inv = invs.createNestedObject("1");
-  inv["DT"] = FRONIUS_DEVICE_TYPE;
-  inv["P"] = pac;
-
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  _FroniusTimestamp(ts, sizeof(ts));
+  FroniusPowerFlowTemplate.SetString(PF_TIMESTAMP, ts);
+  FroniusPowerFlowTemplate.SetNumber(PF_P_PV, pdc);
+  FroniusPowerFlowTemplate.SetNumber(PF_P_LOAD, pac);
+  FroniusPowerFlowTemplate.SetNumber(PF_E_DAY, dayE);
+  FroniusPowerFlowTemplate.SetNumber(PF_E_TOTAL, totE);
+  FroniusPowerFlowTemplate.SetNumber(PF_INVERTER_P, pac);
+  FroniusPowerFlowTemplate.Write(out);
 }
 
-void Growatt::CreateInverterInfoJson(char *Buffer) {
-  StaticJsonDocument<512> doc;
-
-  JsonObject head = doc.createNestedObject("Head");
-  head.createNestedObject("RequestArguments");
-  JsonObject status = head.createNestedObject("Status");
-  status["Code"] = 0;
-  status["Reason"] = "";
-  status["UserMessage"] = "";
-  time_t now = time(nullptr);
-  struct tm *tm_info = localtime(&now);
+void Growatt::CreateInverterInfoJson(Print &out) {
+  /**
+   * @brief Write GetInverterInfo, the values are patched into a prebuilt template
+   * @param out the document is written to it
+   */
   char ts[30];
-  snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d+00:00",
-           tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-           tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-  head["Timestamp"] = ts;
 
-  JsonObject body = doc.createNestedObject("Body");
-  JsonObject data = body.createNestedObject("Data");
-  JsonObject inv = data.createNestedObject("1");
+  if (!FroniusInverterInfoTemplate.Begin()) {
+    out.print(F("{}"));
+    return;
+  }
 
 #if GROWATT_MODBUS_VERSION == 305
-  double pdc = _Protocol.InputRegisters[P305_DC_POWER].value * _Protocol.InputRegisters[P305_DC_POWER].multiplier * 1000.0;
+  sFixedPoint_t pdc = _FixedInput(P305_DC_POWER, 3);
 #elif GROWATT_MODBUS_VERSION == 120
-  double pdc = _Protocol.InputRegisters[P120_INPUT_POWER].value * _Protocol.InputRegisters[P120_INPUT_POWER].multiplier * 1000.0;
+  sFixedPoint_t pdc = _FixedInput(P120_INPUT_POWER, 3);
 #elif GROWATT_MODBUS_VERSION == 124
-  double pdc = _Protocol.InputRegisters[P124_INPUT_POWER].value * _Protocol.InputRegisters[P124_INPUT_POWER].multiplier * 1000.0;
+  sFixedPoint_t pdc = _FixedInput(P124_INPUT_POWER, 3);
 #else
-  double pdc = 0;
+  sFixedPoint_t pdc = {0, 0};
 #endif
 
 #if GROWATT_MODBUS_VERSION == 305
-  uint32_t gwStatus = _Protocol.InputRegisters[P305_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P305_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 120
-  uint32_t gwStatus = _Protocol.InputRegisters[P120_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P120_I_STATUS];
 #elif GROWATT_MODBUS_VERSION == 124
-  uint32_t gwStatus = _Protocol.InputRegisters[P124_I_STATUS].value;
+  uint32_t gwStatus = _Protocol.InputValues[P124_I_STATUS];
 #else
   uint32_t gwStatus = 0;
 #endif
   uint8_t froniusStatus = MapStatusToFronius(gwStatus);
 
-  inv["CustomName"] = "Growatt Inverter";
-  inv["DT"] = FRONIUS_DEVICE_TYPE;
-  inv["ErrorCode"] = 0;
-  inv["PVPower"] = (uint32_t)pdc;
-  inv["Show"] = 1;
-  inv["StatusCode"] = froniusStatus;
-  inv["Status"] = FroniusStatusToString(froniusStatus);
-  inv["UniqueID"] = FRONIUS_SERIAL;
-
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  _FroniusTimestamp(ts, sizeof(ts));
+  FroniusInverterInfoTemplate.SetString(II_TIMESTAMP, ts);
+  FroniusInverterInfoTemplate.SetNumber(II_PV_POWER, pdc);
+  FroniusInverterInfoTemplate.SetNumber(II_STATUS_CODE, froniusStatus);
+  FroniusInverterInfoTemplate.SetString(II_STATUS, FroniusStatusToString(froniusStatus));
+  FroniusInverterInfoTemplate.Write(out);
 }
 
-void Growatt::CreateLoggerInfoJson(char *Buffer) {
+void Growatt::CreateLoggerInfoJson(Print &out) {
   StaticJsonDocument<512> doc;
 
   JsonObject head = doc.createNestedObject("Head");
@@ -1106,10 +2395,10 @@ void Growatt::CreateLoggerInfoJson(char *Buffer) {
   data["HWVersion"] = "1.0";
   data["TimezoneLocation"] = "UTC";
 
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  serializeJson(doc, out);
 }
 
-void Growatt::CreateActiveDeviceInfoJson(char *Buffer) {
+void Growatt::CreateActiveDeviceInfoJson(Print &out) {
   StaticJsonDocument<256> doc;
 
   JsonObject head = doc.createNestedObject("Head");
@@ -1130,5 +2419,5 @@ void Growatt::CreateActiveDeviceInfoJson(char *Buffer) {
   JsonObject body = doc.createNestedObject("Body");
   body.createNestedObject("Data");
 
-  serializeJson(doc, Buffer, MQTT_MAX_PACKET_SIZE);
+  serializeJson(doc, out);
 }
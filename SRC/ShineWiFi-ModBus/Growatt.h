@@ -2,6 +2,9 @@
 #define _GROWATT_H_
 
 #include "GrowattTypes.h"
+#include "ModbusRtu.h"
+#include "PhaseEnergy.h"
+#include "JsonWriter.h"
 
 class Growatt {
   public:
@@ -13,43 +16,180 @@ class Growatt {
 
     bool ReadInputRegisters();
     bool ReadHoldingRegisters();
-    bool ReadInputRegistersFast();
-    bool ReadHoldingRegistersFast();
-    bool ReadData(bool fullRead = true);
+    bool ReadData(bool fullRead = false);
+    bool StartReadData(bool fullRead = false);
+    eReadState_t Poll();
+    uint32_t GetCycleDuration();
+    bool AcquireSnapshot();
+    void SaveEnergy();
+    uint8_t ProbeMaxFragmentSize();
+    void SetMaxFragmentSize(uint8_t size);
+    uint8_t GetMaxFragmentSize();
+    void SetModbusTrace(ModbusTrace_t trace);
     eDevice_t GetWiFiStickType();
-    sGrowattModbusReg_t GetInputRegister(uint16_t reg);
-    sGrowattModbusReg_t GetHoldingRegister(uint16_t reg);
+    const sGrowattModbusReg_t &GetInputRegister(uint16_t reg);
+    const sGrowattModbusReg_t &GetHoldingRegister(uint16_t reg);
+    uint32_t GetInputValue(uint16_t reg);
+    uint32_t GetHoldingValue(uint16_t reg);
     bool ReadInputReg(uint16_t adr, uint32_t* result);
     bool ReadInputReg(uint16_t adr, uint16_t* result);
     bool ReadHoldingReg(uint16_t adr, uint32_t* result);
     bool ReadHoldingReg(uint16_t adr, uint16_t* result);
     bool WriteHoldingReg(uint16_t adr, uint16_t value);
+    uint32_t GetValuesTime();
+    bool GetCachedWords(bool holding, uint16_t address, uint8_t count, uint16_t *words,
+                        uint32_t maxAge = UINT32_MAX, uint8_t *covered = NULL);
+    bool ReadWords(bool holding, uint16_t address, uint8_t count, uint16_t *words, uint8_t *result);
+    int8_t QueueRead(bool holding, uint16_t address, uint8_t count);
+    eQueuedReadState_t GetQueuedRead(int8_t slot, uint16_t address, uint8_t count, uint16_t *words,
+                                     uint8_t *result);
+    void ReleaseRead(int8_t slot);
     bool ConfigureExportLimit(uint16_t percent);
-    void CreateJson(char *Buffer, const char *MacAddress);
-    void CreateUIJson(char *Buffer);
-    void CreateFroniusJson(char *Buffer);
-    void CreatePowerFlowJson(char *Buffer);
-    void CreateDeviceInfoJson(char *Buffer);
-    void CreateInverterInfoJson(char *Buffer);
-    void CreateLoggerInfoJson(char *Buffer);
-    void CreateActiveDeviceInfoJson(char *Buffer);
+    void CreateJsonDocument(eJsonDocument_t document, Print &out, const char *MacAddress);
+    bool GetCachedJson(eJsonDocument_t document, const char *MacAddress, const char **json, size_t *length);
+    void CreateJson(Print &out, const char *MacAddress);
+    bool PrepareDeltaJson(bool full);
+    void CreateDeltaJson(Print &out, const char *MacAddress);
+    uint32_t GetSchemaId();
+    void CreateSchemaJson(Print &out);
+    void CreateMsgPack(Print &out, const char *MacAddress);
+    void CreateDeltaMsgPack(Print &out, const char *MacAddress);
+    bool InputPublishDue(uint16_t reg, bool full);
+    bool HoldingPublishDue(uint16_t reg, bool full);
+    bool IsDuplicateHolding(uint16_t reg);
+    static void FormatValue(const sGrowattModbusReg_t &reg, uint32_t value, char *Buffer, size_t size);
+    static void CreateDiscoveryJson(Print &out, const sGrowattModbusReg_t &reg, const char *StateTopic,
+                                    const char *DeviceId);
+    void CreateUIJson(Print &out, bool valuesOnly);
+    void CreateFroniusJson(Print &out);
+    void CreatePowerFlowJson(Print &out);
+    void CreateDeviceInfoJson(Print &out);
+    void CreateInverterInfoJson(Print &out);
+    void CreateLoggerInfoJson(Print &out);
+    void CreateActiveDeviceInfoJson(Print &out);
     static uint8_t MapStatusToFronius(uint32_t status);
     static const char* FroniusStatusToString(uint8_t status);
   private:
+    // the native benchmarks (native/bench) time private steps of a read cycle, the native
+    // tests (native/test) check them
+    friend class GrowattBenchmark;
+    friend class GrowattTest;
+
     eDevice_t _eDevice;
     bool _GotData;
+    // read cycles started (polling side) and the counter of the cycle the values are from,
+    // per snapshot with MODBUS_POLL_TASK. The documents show the latter, it only changes
+    // with the values.
     uint32_t _PacketCnt;
-    // previous total energy reading to compute increments
-    double _prevTotalEnergy;
-    bool _prevEnergyValid;
-    // accumulated phase energies in Wh since startup
-    double _accEnergyL1;
-    double _accEnergyL2;
-    double _accEnergyL3;
+    uint32_t _ValuesPacketCnt;
+    uint32_t _CyclePacketCnt[2];
+    // energy per phase, integrated from the values of every read cycle at the time they
+    // were read (per snapshot with MODBUS_POLL_TASK)
+    PhaseEnergy _PhaseEnergy;
+    uint32_t _ValuesTime;
+    uint32_t _CycleTime[2];
+    // micros() at the start of the running read cycle and the duration of the last one
+    uint32_t _CycleStart;
+    uint32_t _CycleDuration;
+    // largest number of registers read at once and the rate of reads failing because of it,
+    // the size set (probed) and the floor of the reductions, read cycles since the last error
+    uint8_t _MaxFragmentSize;
+    uint16_t _FrameErrorRate;
+    uint8_t _ProbedFragmentSize;
+    uint8_t _MinFragmentSize;
+    uint16_t _CleanCycles;
+    // poll scheduler state: fragments of the current cycle, registers read at least once,
+    // cycle counter for POLL_SLOW and pending status change for POLL_ON_STATUS
+    sGrowattReadPlan_t _InputCyclePlan;
+    sGrowattReadPlan_t _HoldingCyclePlan;
+    uint8_t _InputPolled[16];
+    uint8_t _HoldingPolled[16];
+    // registers read by the last successful cycle, per snapshot (see AcquireSnapshot())
+    uint8_t _InputFresh[2][16];
+    uint8_t _HoldingFresh[2][16];
+    uint16_t _PollCycle;
+    bool _StatusChanged;
+    uint32_t _LastStatus;
+    bool _StatusDue;
+    // asynchronous communication state: current step, fragment and result of the last cycle
+    Stream *_Serial;
+    eModbusStep_t _Step;
+    uint8_t _Fragment;
+    uint32_t _StepTimer;
+    eReadState_t _Result;
+    bool _VerifyHolding;
+    // reads queued besides the register tables, MODBUS_READ_QUEUE_SIZE entries allocated on first use
+    sGrowattQueuedRead_t *_ReadQueue;
+    // last values sent by CreateDeltaJson() and the sequence number of its documents
+    uint32_t *_InputPublished;
+    uint32_t *_HoldingPublished;
+    // deadbands of the registers in raw steps, allocated with the values published
+    sRawDeadband_t *_InputDeadbands;
+    sRawDeadband_t *_HoldingDeadbands;
+    uint32_t _PublishSeq;
+    // registers selected by PrepareDeltaJson() and whether it is a full snapshot
+    uint8_t _InputDelta[16];
+    uint8_t _HoldingDelta[16];
+    bool _DeltaFull;
+    // holding registers named like an input register, left out where registers go by name
+    uint8_t _HoldingDuplicate[16];
+    // rendered web server documents and the read cycle they belong to
+    sJsonCache_t _JsonCache[JSON_DOCUMENT_COUNT];
+    uint32_t _JsonGeneration;
+    // identifies the register tables in the MessagePack documents
+    uint32_t _SchemaId;
+    // values a read cycle decodes into. With a polling task of its own there are two
+    // snapshots: the one published last (read by loop()) and the one being filled
+    uint32_t *_InputTarget;
+    uint32_t *_HoldingTarget;
+    uint32_t *_InputSnapshot[2];
+    uint32_t *_HoldingSnapshot[2];
+    uint8_t _Published;
+    uint8_t _ReaderSnapshot;
+    // recursive mutex guarding the Modbus engine between the tasks
+    void *_BusMutex;
 
     eDevice_t _InitModbusCommunication();
-    static double _round2(double value);
+    void _PlanReadFragments(uint8_t maxFragmentSize);
+    void _SetFragmentSize(uint8_t size);
+    uint8_t _FindMinFragmentSize();
+    static uint8_t _PlanFragments(const sGrowattModbusReg_t *registers, const uint8_t *indices, uint8_t indexCount,
+                                  uint8_t maxFragmentSize, sGrowattReadFragment_t *fragments);
+    static void _BuildDecodePlan(const sGrowattModbusReg_t *registers, uint16_t registerCount,
+                                 const sGrowattReadFragment_t *fragments, uint8_t fragmentCount,
+                                 sGrowattDecodePlan_t &plan);
+    static void _DecodeFragment(uint32_t *values, uint8_t *polled,
+                                const sGrowattDecodePlan_t &plan, uint8_t fragment);
+    void _ScheduleCycle(bool fullRead);
+    bool _IsDue(const sGrowattModbusReg_t &reg, bool polled, bool fullRead);
+    void _PlanCycle(const sGrowattModbusReg_t *registers, uint16_t registerCount, const uint8_t *polled,
+                    bool fullRead, sGrowattReadPlan_t &plan);
+    bool _ReadPlan(bool holding, const sGrowattReadPlan_t &plan);
+    void _StartStep();
+    void _CompleteStep(uint8_t res);
+    bool _StartFragment();
+    bool _StartQueuedRead();
+    void _CompleteQueuedRead(uint8_t res);
+    void _FinishCycle(bool ok);
+    static void _MarkFresh(const sGrowattReadPlan_t &plan, uint8_t *fresh);
+    bool _BeginSnapshot();
+    void _WaitIdle();
+    bool _ProbeFrameSize(uint8_t size);
+    void _TrackFrameError(const sGrowattReadFragment_t &fragment);
+    static sFixedPoint_t _Fixed(const sGrowattModbusReg_t &reg, uint32_t value);
+    static sFixedPoint_t _FixedSum(sFixedPoint_t a, sFixedPoint_t b);
+    static sFixedPoint_t _FixedRatio(sFixedPoint_t value, int64_t numerator, int64_t denominator, int8_t exponent);
+    static sFixedPoint_t _FixedShare(sFixedPoint_t value, sFixedPoint_t part, sFixedPoint_t whole, int8_t exponent);
+    sFixedPoint_t _FixedInput(uint16_t reg, int8_t exponent = 0);
+    static void _FroniusTimestamp(char *Buffer, size_t size);
+    template <typename V>
+    static void _UIEntry(JsonWriter &json, bool valuesOnly, const __FlashStringHelper *name, V value,
+                         const char *unit, bool plot);
+    static sRawDeadband_t _RawDeadband(const sGrowattModbusReg_t &reg);
+    static bool _ExceedsDeadband(sRawDeadband_t deadband, uint32_t value, uint32_t last);
     void _UpdateEnergyAccumulation();
+    uint32_t _ComputeSchemaId();
+    void _FindDuplicateHoldings();
 
 };
 
@@ -12,69 +12,65 @@
 // - Storage(SPA Type)
 // - Storage(SPH Type)：
 
-
-void init_growatt120(sProtocolDefinition_t &Protocol)
-{
-    // definition of input registers
-    Protocol.InputRegisterCount = 29;
-    Protocol.InputFragmentCount = 2;
-    Protocol.InputFastFragmentCount = 1;
-    Protocol.InputReadFragments[0] = sGrowattReadFragment_t{0, 49};
-    Protocol.InputReadFragments[1] = sGrowattReadFragment_t{53, 42};
-
-    // FRAGMENT 1: BEGIN
-    // address, value, size, name, multiplier, unit, frontend, plot
-    Protocol.InputRegisters[P120_I_STATUS] = sGrowattModbusReg_t{0, 0, SIZE_16BIT, "InverterStatus", 1, NONE, true, false};    // #1
-    Protocol.InputRegisters[P120_INPUT_POWER] = sGrowattModbusReg_t{1, 0, SIZE_32BIT, "InputPower", 0.1, POWER_W, true, true}; // #2
-
-    Protocol.InputRegisters[P120_PV1_VOLTAGE] = sGrowattModbusReg_t{3, 0, SIZE_16BIT, "PV1Voltage", 0.1, VOLTAGE, false, false};            // #3
-    Protocol.InputRegisters[P120_PV1_INPUT_CURRENT] = sGrowattModbusReg_t{4, 0, SIZE_16BIT, "PV1InputCurrent", 0.1, CURRENT, false, false}; // #4
-    Protocol.InputRegisters[P120_PV1_INPUT_POWER] = sGrowattModbusReg_t{5, 0, SIZE_32BIT, "PV1InputPower", 0.1, POWER_W, false, false};     // #5
-
-    Protocol.InputRegisters[P120_PV2_VOLTAGE] = sGrowattModbusReg_t{7, 0, SIZE_16BIT, "PV2Voltage", 0.1, VOLTAGE, false, false};            // #6
-    Protocol.InputRegisters[P120_PV2_INPUT_CURRENT] = sGrowattModbusReg_t{8, 0, SIZE_16BIT, "PV2InputCurrent", 0.1, CURRENT, false, false}; // #7
-    Protocol.InputRegisters[P120_PV2_INPUT_POWER] = sGrowattModbusReg_t{9, 0, SIZE_32BIT, "PV2InputPower", 0.1, POWER_W, false, false};     // #8
-
-    Protocol.InputRegisters[P120_OUTPUT_POWER] = sGrowattModbusReg_t{35, 0, SIZE_32BIT, "OutputPower", 0.1, POWER_W, true, true};          // #9
-    Protocol.InputRegisters[P120_GRID_FREQUENCY] = sGrowattModbusReg_t{37, 0, SIZE_16BIT, "GridFrequency", 0.01, FREQUENCY, false, false}; // #10
-
-    Protocol.InputRegisters[P120_GRID_L1_VOLTAGE] = sGrowattModbusReg_t{38, 0, SIZE_16BIT, "GridL1Voltage", 0.1, VOLTAGE, true, false};              // #11
-    Protocol.InputRegisters[P120_GRID_L1_OUTPUT_CURRENT] = sGrowattModbusReg_t{39, 0, SIZE_16BIT, "GridL1OutputCurrent", 0.1, CURRENT, true, false}; // #12
-    Protocol.InputRegisters[P120_GRID_L1_OUTPUT_POWER] = sGrowattModbusReg_t{40, 0, SIZE_32BIT, "GridL1OutputPower", 0.1, VA, true, false};          // #13
-
-    Protocol.InputRegisters[P120_GRID_L2_VOLTAGE] = sGrowattModbusReg_t{42, 0, SIZE_16BIT, "GridL2Voltage", 0.1, VOLTAGE, true, false};              // #14
-    Protocol.InputRegisters[P120_GRID_L2_OUTPUT_CURRENT] = sGrowattModbusReg_t{43, 0, SIZE_16BIT, "GridL2OutputCurrent", 0.1, CURRENT, true, false}; // #15
-    Protocol.InputRegisters[P120_GRID_L2_OUTPUT_POWER] = sGrowattModbusReg_t{44, 0, SIZE_32BIT, "GridL2OutputPower", 0.1, VA, true, false};          // #16
-
-    Protocol.InputRegisters[P120_GRID_L3_VOLTAGE] = sGrowattModbusReg_t{46, 0, SIZE_16BIT, "GridL3Voltage", 0.1, VOLTAGE, true, false};              // #17
-    Protocol.InputRegisters[P120_GRID_L3_OUTPUT_CURRENT] = sGrowattModbusReg_t{47, 0, SIZE_16BIT, "GridL3OutputCurrent", 0.1, CURRENT, true, false}; // #18
-    Protocol.InputRegisters[P120_GRID_L3_OUTPUT_POWER] = sGrowattModbusReg_t{48, 0, SIZE_32BIT, "GridL3OutputPower", 0.1, VA, true, false};          // #19
-    // FRAGMENT 1: END
-
-    // FEAGMENT 2: BEGIN
-    Protocol.InputRegisters[P120_ENERGY_TODAY] = sGrowattModbusReg_t{53, 0, SIZE_32BIT, "EnergyToday", 0.1, POWER_KWH, true, false};     // #20
-    Protocol.InputRegisters[P120_ENERGY_TOTAL] = sGrowattModbusReg_t{55, 0, SIZE_32BIT, "EnergyTotal", 0.1, POWER_KWH, true, false};     // #21
-    Protocol.InputRegisters[P120_WORK_TIME_TOTAL] = sGrowattModbusReg_t{57, 0, SIZE_32BIT, "WorkTimeTotal", 0.5, SECONDS, false, false}; // #22
-
-    Protocol.InputRegisters[P120_PV1_ENERGY_TODAY] = sGrowattModbusReg_t{59, 0, SIZE_32BIT, "PV1EnergyToday", 0.1, POWER_KWH, false, false}; // #23
-    Protocol.InputRegisters[P120_PV1_ENERGY_TOTAL] = sGrowattModbusReg_t{61, 0, SIZE_32BIT, "PV1EnergyTotal", 0.1, POWER_KWH, false, false}; // #24
-    Protocol.InputRegisters[P120_PV2_ENERGY_TODAY] = sGrowattModbusReg_t{63, 0, SIZE_32BIT, "PV2EnergyToday", 0.1, POWER_KWH, false, false}; // #25
-    Protocol.InputRegisters[P120_PV2_ENERGY_TOTAL] = sGrowattModbusReg_t{65, 0, SIZE_32BIT, "PV2EnergyTotal", 0.1, POWER_KWH, false, false}; // #26
-    Protocol.InputRegisters[P120_PV_ENERGY_TOTAL] = sGrowattModbusReg_t{91, 0, SIZE_32BIT, "PVEnergyTotal", 0.1, POWER_KWH, true, false};    // #27
-
-    Protocol.InputRegisters[P120_INVERTER_TEMPERATURE] = sGrowattModbusReg_t{93, 0, SIZE_16BIT, "InverterTemperature", 0.1, TEMPERATURE, true, true};          // #28
-    Protocol.InputRegisters[P120_INVERTER_IPM_TEMPERATURE] = sGrowattModbusReg_t{94, 0, SIZE_16BIT, "InverterIPMTemperature", 0.1, TEMPERATURE, false, false}; // #29
-    // FEAGMENT 2: END
-
-    // definition of holding registers
-    Protocol.HoldingRegisterCount = 3;
-    Protocol.HoldingFragmentCount = 1;
-    Protocol.HoldingFastFragmentCount = 1;
-    Protocol.HoldingReadFragments[0] = sGrowattReadFragment_t{0, 4};
-
-    // FRAGMENT 1: BEGIN
-    Protocol.HoldingRegisters[P120_OnOff] = sGrowattModbusReg_t{0, 0, SIZE_16BIT, "OnOff", 1, NONE, true, false};                         // #1
-    Protocol.HoldingRegisters[P120_CMD_MEMORY_STATE] = sGrowattModbusReg_t{2, 0, SIZE_16BIT, "CmdMemoryState", 1, NONE, true, false};     // #2
-    Protocol.HoldingRegisters[P120_Active_P_Rate] = sGrowattModbusReg_t{3, 0, SIZE_16BIT, "ActivePowerRate", 1, PRECENTAGE, true, false}; // #3
-    // FRAGMENT 1: END
+static const sGrowattModbusReg_t Growatt120InputRegisters[] PROGMEM = {
+    // address, size, name, scale, unit, frontend, plot[, polling class[, deadband]]
+    {0, SIZE_16BIT, "InverterStatus", SCALE(1, 0), NONE, true, false}, // P120_I_STATUS
+    {1, SIZE_32BIT, "InputPower", SCALE(1, -1), POWER_W, true, true}, // P120_INPUT_POWER
+    {3, SIZE_16BIT, "PV1Voltage", SCALE(1, -1), VOLTAGE, false, false}, // P120_PV1_VOLTAGE
+    {5, SIZE_32BIT, "PV1InputPower", SCALE(1, -1), POWER_W, false, false}, // P120_PV1_INPUT_POWER
+    {4, SIZE_16BIT, "PV1InputCurrent", SCALE(1, -1), CURRENT, false, false}, // P120_PV1_INPUT_CURRENT
+    {7, SIZE_16BIT, "PV2Voltage", SCALE(1, -1), VOLTAGE, false, false}, // P120_PV2_VOLTAGE
+    {9, SIZE_32BIT, "PV2InputPower", SCALE(1, -1), POWER_W, false, false}, // P120_PV2_INPUT_POWER
+    {8, SIZE_16BIT, "PV2InputCurrent", SCALE(1, -1), CURRENT, false, false}, // P120_PV2_INPUT_CURRENT
+    {35, SIZE_32BIT, "OutputPower", SCALE(1, -1), POWER_W, true, true}, // P120_OUTPUT_POWER
+    {37, SIZE_16BIT, "GridFrequency", SCALE(1, -2), FREQUENCY, false, false}, // P120_GRID_FREQUENCY
+    {38, SIZE_16BIT, "GridL1Voltage", SCALE(1, -1), VOLTAGE, true, false}, // P120_GRID_L1_VOLTAGE
+    {39, SIZE_16BIT, "GridL1OutputCurrent", SCALE(1, -1), CURRENT, true, false}, // P120_GRID_L1_OUTPUT_CURRENT
+    {40, SIZE_32BIT, "GridL1OutputPower", SCALE(1, -1), VA, true, false}, // P120_GRID_L1_OUTPUT_POWER
+    {42, SIZE_16BIT, "GridL2Voltage", SCALE(1, -1), VOLTAGE, true, false}, // P120_GRID_L2_VOLTAGE
+    {43, SIZE_16BIT, "GridL2OutputCurrent", SCALE(1, -1), CURRENT, true, false}, // P120_GRID_L2_OUTPUT_CURRENT
+    {44, SIZE_32BIT, "GridL2OutputPower", SCALE(1, -1), VA, true, false}, // P120_GRID_L2_OUTPUT_POWER
+    {46, SIZE_16BIT, "GridL3Voltage", SCALE(1, -1), VOLTAGE, true, false}, // P120_GRID_L3_VOLTAGE
+    {47, SIZE_16BIT, "GridL3OutputCurrent", SCALE(1, -1), CURRENT, true, false}, // P120_GRID_L3_OUTPUT_CURRENT
+    {48, SIZE_32BIT, "GridL3OutputPower", SCALE(1, -1), VA, true, false}, // P120_GRID_L3_OUTPUT_POWER
+    {53, SIZE_32BIT, "EnergyToday", SCALE(1, -1), POWER_KWH, true, false}, // P120_ENERGY_TODAY
+    {55, SIZE_32BIT, "EnergyTotal", SCALE(1, -1), POWER_KWH, true, false, POLL_SLOW}, // P120_ENERGY_TOTAL
+    {57, SIZE_32BIT, "WorkTimeTotal", SCALE(5, -1), SECONDS, false, false, POLL_SLOW, DEADBAND_ABS(3600)}, // P120_WORK_TIME_TOTAL
+    {59, SIZE_32BIT, "PV1EnergyToday", SCALE(1, -1), POWER_KWH, false, false, POLL_SLOW}, // P120_PV1_ENERGY_TODAY
+    {61, SIZE_32BIT, "PV1EnergyTotal", SCALE(1, -1), POWER_KWH, false, false, POLL_SLOW}, // P120_PV1_ENERGY_TOTAL
+    {63, SIZE_32BIT, "PV2EnergyToday", SCALE(1, -1), POWER_KWH, false, false, POLL_SLOW}, // P120_PV2_ENERGY_TODAY
+    {65, SIZE_32BIT, "PV2EnergyTotal", SCALE(1, -1), POWER_KWH, false, false, POLL_SLOW}, // P120_PV2_ENERGY_TOTAL
+    {91, SIZE_32BIT, "PVEnergyTotal", SCALE(1, -1), POWER_KWH, true, false, POLL_SLOW}, // P120_PV_ENERGY_TOTAL
+    {93, SIZE_16BIT, "InverterTemperature", SCALE(1, -1), TEMPERATURE, true, true}, // P120_INVERTER_TEMPERATURE
+    {94, SIZE_16BIT, "InverterIPMTemperature", SCALE(1, -1), TEMPERATURE, false, false, POLL_SLOW}, // P120_INVERTER_IPM_TEMPERATURE
+};
+static_assert(sizeof(Growatt120InputRegisters) / sizeof(Growatt120InputRegisters[0]) == P120_INVERTER_IPM_TEMPERATURE + 1,
+              "register table does not match eP120InputRegisters_t");
+static_assert(sizeof(Growatt120InputRegisters) / sizeof(Growatt120InputRegisters[0]) <= GROWATT_MAX_REGISTERS,
+              "register table exceeds GROWATT_MAX_REGISTERS");
+static uint32_t InputValues[sizeof(Growatt120InputRegisters) / sizeof(Growatt120InputRegisters[0])];
+
+static const sGrowattModbusReg_t Growatt120HoldingRegisters[] PROGMEM = {
+    // address, size, name, scale, unit, frontend, plot[, polling class[, deadband]]
+    {0, SIZE_16BIT, "OnOff", SCALE(1, 0), NONE, true, false, POLL_ON_STATUS}, // P120_OnOff
+    {2, SIZE_16BIT, "CmdMemoryState", SCALE(1, 0), NONE, true, false, POLL_ON_STATUS}, // P120_CMD_MEMORY_STATE
+    {3, SIZE_16BIT, "ActivePowerRate", SCALE(1, 0), PRECENTAGE, true, false, POLL_ON_STATUS}, // P120_Active_P_Rate
+};
+static_assert(sizeof(Growatt120HoldingRegisters) / sizeof(Growatt120HoldingRegisters[0]) == P120_Active_P_Rate + 1,
+              "register table does not match eP120HoldingRegisters_t");
+static_assert(sizeof(Growatt120HoldingRegisters) / sizeof(Growatt120HoldingRegisters[0]) <= GROWATT_MAX_REGISTERS,
+              "register table exceeds GROWATT_MAX_REGISTERS");
+static uint32_t HoldingValues[sizeof(Growatt120HoldingRegisters) / sizeof(Growatt120HoldingRegisters[0])];
+
+void init_growatt120(sProtocolDefinition_t &Protocol) {
+    // the register tables stay in flash, only the values are kept in RAM
+    Protocol.InputRegisterCount = sizeof(Growatt120InputRegisters) / sizeof(Growatt120InputRegisters[0]);
+    Protocol.InputRegisters = Growatt120InputRegisters;
+    Protocol.InputValues = InputValues;
+
+    Protocol.HoldingRegisterCount = sizeof(Growatt120HoldingRegisters) / sizeof(Growatt120HoldingRegisters[0]);
+    Protocol.HoldingRegisters = Growatt120HoldingRegisters;
+    Protocol.HoldingValues = HoldingValues;
+
+    // the read fragments are planned from the register table, see Growatt::InitProtocol()
 }
@@ -2,29 +2,36 @@
 
 #include "Growatt305.h"
 
-void init_growatt305(sProtocolDefinition_t &Protocol) {
-    // definition of input registers
-    Protocol.InputRegisterCount = 12;
-    // address, value, size, name, multiplier, unit, frontend, plot
-    // FEAGMENT 1: BEGIN
-    Protocol.InputRegisters[P305_I_STATUS] = sGrowattModbusReg_t{0, 0, SIZE_16BIT, "InverterStatus", 1, NONE, true, false}; // #1
-    Protocol.InputRegisters[P305_DC_POWER] = sGrowattModbusReg_t{1, 0, SIZE_32BIT, "DcPower", 0.1, POWER_W, true, true}; // #2
-    Protocol.InputRegisters[P305_DC_VOLTAGE] = sGrowattModbusReg_t{3, 0, SIZE_16BIT, "DcVoltage", 0.1, VOLTAGE, true, false}; // #3
-    Protocol.InputRegisters[P305_DC_INPUT_CURRENT] = sGrowattModbusReg_t{4, 0, SIZE_16BIT, "DcInputCurrent", 0.1, CURRENT, true, false}; // #4
-    Protocol.InputRegisters[P305_AC_FREQUENCY] = sGrowattModbusReg_t{13, 0, SIZE_16BIT, "AcFrequency", 0.01, FREQUENCY, true, false}; // #5
-    Protocol.InputRegisters[P305_AC_VOLTAGE] = sGrowattModbusReg_t{14, 0, SIZE_16BIT, "AcVoltage", 0.1, VOLTAGE, true, false}; // #6
-    Protocol.InputRegisters[P305_AC_OUTPUT_CURRENT] = sGrowattModbusReg_t{15, 0, SIZE_16BIT, "AcOutputCurrent", 0.1, CURRENT, true, false}; // #7
-    Protocol.InputRegisters[P305_AC_POWER] = sGrowattModbusReg_t{16, 0, SIZE_32BIT, "AcPower", 0.1, POWER_W, true, true}; // #8
-    Protocol.InputRegisters[P305_ENERGY_TODAY] = sGrowattModbusReg_t{26, 0, SIZE_32BIT, "EnergyToday", 0.1, POWER_KWH, true, false}; // #9
-    Protocol.InputRegisters[P305_ENERGY_TOTAL] = sGrowattModbusReg_t{28, 0, SIZE_32BIT, "EnergyTotal", 0.1, POWER_KWH, true, false}; // #10
-    Protocol.InputRegisters[P305_OPERATING_TIME] = sGrowattModbusReg_t{30, 0, SIZE_32BIT, "OperatingTime", 0.5, SECONDS, true, false}; // #11
-    Protocol.InputRegisters[P305_TEMPERATURE] = sGrowattModbusReg_t{32, 0, SIZE_16BIT, "Temperature", 0.1, TEMPERATURE, true, false}; // #12
+static const sGrowattModbusReg_t Growatt305InputRegisters[] PROGMEM = {
+    // address, size, name, scale, unit, frontend, plot[, polling class[, deadband]]
+    {0, SIZE_16BIT, "InverterStatus", SCALE(1, 0), NONE, true, false}, // P305_I_STATUS
+    {1, SIZE_32BIT, "DcPower", SCALE(1, -1), POWER_W, true, true}, // P305_DC_POWER
+    {3, SIZE_16BIT, "DcVoltage", SCALE(1, -1), VOLTAGE, true, false}, // P305_DC_VOLTAGE
+    {4, SIZE_16BIT, "DcInputCurrent", SCALE(1, -1), CURRENT, true, false}, // P305_DC_INPUT_CURRENT
+    {13, SIZE_16BIT, "AcFrequency", SCALE(1, -2), FREQUENCY, true, false}, // P305_AC_FREQUENCY
+    {14, SIZE_16BIT, "AcVoltage", SCALE(1, -1), VOLTAGE, true, false}, // P305_AC_VOLTAGE
+    {15, SIZE_16BIT, "AcOutputCurrent", SCALE(1, -1), CURRENT, true, false}, // P305_AC_OUTPUT_CURRENT
+    {16, SIZE_32BIT, "AcPower", SCALE(1, -1), POWER_W, true, true}, // P305_AC_POWER
+    {26, SIZE_32BIT, "EnergyToday", SCALE(1, -1), POWER_KWH, true, false}, // P305_ENERGY_TODAY
+    {28, SIZE_32BIT, "EnergyTotal", SCALE(1, -1), POWER_KWH, true, false, POLL_SLOW}, // P305_ENERGY_TOTAL
+    {30, SIZE_32BIT, "OperatingTime", SCALE(5, -1), SECONDS, true, false, POLL_SLOW, DEADBAND_ABS(3600)}, // P305_OPERATING_TIME
+    {32, SIZE_16BIT, "Temperature", SCALE(1, -1), TEMPERATURE, true, false}, // P305_TEMPERATURE
+};
+static_assert(sizeof(Growatt305InputRegisters) / sizeof(Growatt305InputRegisters[0]) == P305_TEMPERATURE + 1,
+              "register table does not match eP305InputRegisters_t");
+static_assert(sizeof(Growatt305InputRegisters) / sizeof(Growatt305InputRegisters[0]) <= GROWATT_MAX_REGISTERS,
+              "register table exceeds GROWATT_MAX_REGISTERS");
+static uint32_t InputValues[sizeof(Growatt305InputRegisters) / sizeof(Growatt305InputRegisters[0])];
 
-    Protocol.InputFragmentCount = 1;
-    Protocol.InputFastFragmentCount = 1;
-    Protocol.InputReadFragments[0] = sGrowattReadFragment_t{0, 33};
+void init_growatt305(sProtocolDefinition_t &Protocol) {
+    // the register tables stay in flash, only the values are kept in RAM
+    Protocol.InputRegisterCount = sizeof(Growatt305InputRegisters) / sizeof(Growatt305InputRegisters[0]);
+    Protocol.InputRegisters = Growatt305InputRegisters;
+    Protocol.InputValues = InputValues;
 
     Protocol.HoldingRegisterCount = 0;
-    Protocol.HoldingFragmentCount = 0;
-    Protocol.HoldingFastFragmentCount = 0;
+    Protocol.HoldingRegisters = NULL;
+    Protocol.HoldingValues = NULL;
+
+    // the read fragments are planned from the register table, see Growatt::InitProtocol()
 }
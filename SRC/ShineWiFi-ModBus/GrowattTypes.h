@@ -1,7 +1,7 @@
 #ifndef _GROWATT_TYPES_H_
 #define _GROWATT_TYPES_H_
 
-#include <cstring>
+#include <Arduino.h>
 
 typedef enum {
   Undef_stick  = 0,
@@ -10,6 +10,71 @@ typedef enum {
   ShineWiFi_F  = 3  // USB Type A DB9-style screws, (Baudrate and protocol unclear; likely 115200Bd / v1.05)
 } eDevice_t;
 
+// result of Growatt::Poll()
+typedef enum {
+  READ_IDLE      = 0, // no read cycle running
+  READ_BUSY      = 1, // stick detection or read cycle in progress
+  READ_SUCCEEDED = 2, // a read cycle has just completed, reported once
+  READ_FAILED    = 3  // a read cycle has just failed, reported once
+} eReadState_t;
+
+// step of the asynchronous inverter communication
+typedef enum {
+  STEP_IDLE = 0,
+  STEP_DETECT_S,    // probing for a ShineWiFi-S at 9600Bd
+  STEP_DETECT_WAIT, // pause before switching to 115200Bd
+  STEP_DETECT_X,    // probing for a ShineWiFi-X at 115200Bd
+  STEP_INPUT,       // reading the input register fragments of the cycle
+  STEP_HOLDING,     // reading the holding register fragments of the cycle
+  STEP_QUEUED,      // reading the registers queued by Growatt::QueueRead()
+  STEP_VERIFY       // checking whether a failed fragment was too long
+} eModbusStep_t;
+
+// state of a read queued by Growatt::QueueRead()
+typedef enum {
+  QUEUED_FREE = 0,
+  QUEUED_WAITING,  // waiting for the next read cycle
+  QUEUED_READING,  // being read by the running read cycle
+  QUEUED_DONE,
+  QUEUED_FAILED
+} eQueuedReadState_t;
+
+// Registers read on request besides the register tables (e.g. for Modbus TCP clients). Requests
+// of several clients are merged into one entry, it is read at the end of the next read cycle
+typedef struct {
+  uint8_t State;       // eQueuedReadState_t
+  bool Holding;
+  uint16_t Address;
+  uint8_t Count;
+  uint8_t Done;        // registers read so far
+  uint8_t Users;       // requests waiting for the entry, see Growatt::ReleaseRead()
+  uint8_t Result;      // Modbus result of a failed read
+  uint16_t Words[125];
+} sGrowattQueuedRead_t;
+
+// JSON documents of the web server, see Growatt::CreateJsonDocument()
+typedef enum {
+  JSON_STATUS = 0,          // /status
+  JSON_UI_STATUS,           // /uistatus
+  JSON_FRONIUS,             // /solar_api/v1/GetInverterRealtimeData.cgi
+  JSON_POWER_FLOW,          // /solar_api/v1/GetPowerFlowRealtimeData.fcgi
+  JSON_DEVICE_INFO,         // /solar_api/v1/GetDeviceInfo.cgi
+  JSON_INVERTER_INFO,       // /solar_api/v1/GetInverterInfo.cgi
+  JSON_LOGGER_INFO,         // /solar_api/v1/GetLoggerInfo.cgi
+  JSON_ACTIVE_DEVICE_INFO,  // /solar_api/v1/GetActiveDeviceInfo.cgi
+  JSON_UI_VALUES,           // /events, the values of JSON_UI_STATUS only
+  JSON_DOCUMENT_COUNT
+} eJsonDocument_t;
+
+// A rendered JSON document, valid as long as Generation matches the read cycle it was
+// rendered from (see Growatt::GetCachedJson())
+typedef struct {
+  char *Body;
+  size_t Length;
+  size_t Capacity;
+  uint32_t Generation;
+} sJsonCache_t;
+
 typedef enum {
   GwStatusWaiting,
   GwStatusNormal,
@@ -46,46 +111,115 @@ typedef enum {
     SIZE_32BIT,
 } RegisterSize_t;
 
+// How often a register is read by the poll scheduler (Growatt::ReadData)
+typedef enum {
+    POLL_ALWAYS,     // every refresh cycle
+    POLL_SLOW,       // every FULL_READ_INTERVAL refresh cycles
+    POLL_ON_STATUS,  // after the inverter status changed
+    POLL_ONCE,       // once after boot
+} RegisterPollClass_t;
+
+// Deadband of a register for change-only publishing: an absolute change in the unit of the
+// register, or a change relative to the last published value. 0 selects the default of the unit
+#define DEADBAND_ABS(delta) (delta)
+#define DEADBAND_REL(percent) (-(percent) / 100.0f)
+
+// Deadband of a register in raw register steps, computed once from the float deadband by
+// Growatt::InitProtocol() so a read cycle compares integers only
+typedef struct {
+  uint16_t Change;  // absolute: smallest change in raw steps, relative: in 1/10000 of the last value
+  bool Relative;
+} sRawDeadband_t;
+
+// Scale of a register as integer decimal exponent: the value in the unit of the register is
+// raw value * Factor * 10^Exponent, e.g. SCALE(1, -1) for 0.1 or SCALE(5, -1) for 0.5. The
+// scaled value stays an integer (raw * Factor) with a decimal point, see sFixedPoint_t
+typedef struct {
+  uint8_t Factor;
+  int8_t Exponent;
+} sRegisterScale_t;
+
+#define SCALE(factor, exponent) {(factor), (exponent)}
+
+// Static description of a register. The register tables are placed in flash (PROGMEM),
+// so the fields have to be read through the accessors. The values are kept separately in RAM
+// (sProtocolDefinition_t::InputValues / HoldingValues)
 typedef struct sGrowattModbusReg_t {
   uint16_t address;
-  uint32_t value;
-  RegisterSize_t size;
-  char name[64];
-  float multiplier;
-  RegisterUnit_t unit;
+  uint8_t size;       // RegisterSize_t
+  char name[32];
+  sRegisterScale_t scale;
+  uint8_t unit;       // RegisterUnit_t
   bool frontend;
   bool plot;
+  uint8_t poll;       // RegisterPollClass_t, POLL_ALWAYS if omitted
+  float deadband;     // change needed for a delta publish, DEADBAND_ABS/DEADBAND_REL, unit default if omitted
 
-  sGrowattModbusReg_t() : address(0), value(0), size(SIZE_16BIT), multiplier(1), unit(NONE), frontend(false), plot(false) {
-    name[0] = '\0';
-  }
-
-  sGrowattModbusReg_t(uint16_t a, uint32_t v, RegisterSize_t s, const char *n,
-                       float m, RegisterUnit_t u, bool f, bool p)
-      : address(a), value(v), size(s), multiplier(m), unit(u), frontend(f), plot(p) {
-    strncpy(name, n, sizeof(name));
-    name[sizeof(name) - 1] = '\0';
+  uint16_t Address() const { return pgm_read_word(&address); }
+  RegisterSize_t Size() const { return (RegisterSize_t)pgm_read_byte(&size); }
+  const __FlashStringHelper *Name() const { return FPSTR(name); }
+  uint8_t ScaleFactor() const { return pgm_read_byte(&scale.Factor); }
+  int8_t ScaleExponent() const { return (int8_t)pgm_read_byte(&scale.Exponent); }
+  float Multiplier() const {
+    // only for consumers that want a float, e.g. the history samples
+    uint32_t power = 1;
+    for (int8_t e = ScaleExponent(); e != 0; e += (e < 0) ? 1 : -1) {
+      power *= 10;
+    }
+    return (ScaleExponent() < 0) ? (float)ScaleFactor() / power : (float)ScaleFactor() * power;
   }
+  RegisterUnit_t Unit() const { return (RegisterUnit_t)pgm_read_byte(&unit); }
+  bool Frontend() const { return pgm_read_byte(&frontend); }
+  bool Plot() const { return pgm_read_byte(&plot); }
+  RegisterPollClass_t Poll() const { return (RegisterPollClass_t)pgm_read_byte(&poll); }
+  float Deadband() const { return pgm_read_float(&deadband); }
 } sGrowattModbusReg_t;
 
+// Registers per table, they are indexed with a uint8_t by the decode plan
+#define GROWATT_MAX_REGISTERS 125
+// Read windows per table in the worst case: one per register, with small frames (few
+// registers per read, see Growatt::SetMaxFragmentSize()) and registers far apart
+#define GROWATT_MAX_FRAGMENTS GROWATT_MAX_REGISTERS
+
 // Growatt limits maximal number of registers that can be polled
-// with a single read. Define reading frames using this. Can be nicer..
+// with a single read. The read frames are planned from the register
+// tables by Growatt::InitProtocol()
 typedef struct {
     uint16_t StartAddress;
     uint8_t FragmentSize;
 } sGrowattReadFragment_t;
 
+// Precomputed mapping from a fragment's response buffer to the register table.
+// Built once in Growatt::InitProtocol() so that decoding a fragment is a plain copy loop
+typedef struct {
+    uint8_t BufferOffset;  // position of the register in the response buffer
+    uint8_t RegisterIndex; // index into InputRegisters[] / HoldingRegisters[]
+    uint8_t Width;         // number of 16 bit words (1 or 2)
+} sGrowattDecodeEntry_t;
+
+typedef struct {
+    uint8_t FragmentStart[GROWATT_MAX_FRAGMENTS + 1]; // entries of fragment i are [FragmentStart[i], FragmentStart[i + 1])
+    sGrowattDecodeEntry_t Entries[GROWATT_MAX_REGISTERS];
+} sGrowattDecodePlan_t;
+
+// Fragments and decode plan of one read cycle of a register table
+typedef struct {
+    uint8_t FragmentCount;
+    sGrowattReadFragment_t Fragments[GROWATT_MAX_FRAGMENTS];
+    sGrowattDecodePlan_t Decode;
+} sGrowattReadPlan_t;
+
 typedef struct {
     uint16_t InputRegisterCount;
-    uint8_t InputFragmentCount;
-    uint8_t InputFastFragmentCount;
+    uint8_t InputFragmentCount;       // set by the fragment planner, covers the whole table
     uint16_t HoldingRegisterCount;
-    uint8_t HoldingFragmentCount;
-    uint8_t HoldingFastFragmentCount;
-    sGrowattModbusReg_t InputRegisters[125];
-    sGrowattModbusReg_t HoldingRegisters[125];
-    sGrowattReadFragment_t InputReadFragments[20];
-    sGrowattReadFragment_t HoldingReadFragments[20];
+    uint8_t HoldingFragmentCount;     // set by the fragment planner, covers the whole table
+    const sGrowattModbusReg_t *InputRegisters;   // register table in flash
+    const sGrowattModbusReg_t *HoldingRegisters; // register table in flash
+    uint32_t *InputValues;                       // raw values, one per entry of InputRegisters
+    uint32_t *HoldingValues;                     // raw values, one per entry of HoldingRegisters
+    sGrowattReadFragment_t InputReadFragments[GROWATT_MAX_FRAGMENTS];
+    sGrowattReadFragment_t HoldingReadFragments[GROWATT_MAX_FRAGMENTS];
 } sProtocolDefinition_t;
 
 
@@ -0,0 +1,470 @@
+#include <Arduino.h>
+
+#include "JsonWriter.h"
+
+// "00" to "99", the digits of a number are produced in pairs
+static const char DIGIT_PAIRS[] PROGMEM =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const uint32_t POWERS_OF_TEN[] = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL,
+                                         10000000UL, 100000000UL, 1000000000UL};
+
+static double _PowerOfTen(uint8_t exponent) {
+  double power = POWERS_OF_TEN[exponent < 9 ? exponent : 9];
+
+  for (; exponent > 9; exponent--) {
+    power *= 10;
+  }
+  return power;
+}
+
+JsonWriter::JsonWriter(Print &out) : _Out(out) {
+  _HasElement = 0;
+  _Depth = 0;
+  _AfterKey = false;
+}
+
+void JsonWriter::_Separate() {
+  /**
+   * @brief Write the comma in front of a member or element if the current level already has one
+   */
+  if (_AfterKey) {
+    _AfterKey = false;
+    return;
+  }
+  if (_HasElement & (1UL << _Depth))
+    _Out.write(',');
+  _HasElement |= (1UL << _Depth);
+}
+
+void JsonWriter::_Open(char c) {
+  _Separate();
+  _Out.write(c);
+  if (_Depth < 31)
+    _Depth++;
+  _HasElement &= ~(1UL << _Depth);
+}
+
+void JsonWriter::_Close(char c) {
+  _Out.write(c);
+  if (_Depth > 0)
+    _Depth--;
+}
+
+void JsonWriter::BeginObject() {
+  _Open('{');
+}
+
+void JsonWriter::EndObject() {
+  _Close('}');
+}
+
+void JsonWriter::BeginArray() {
+  _Open('[');
+}
+
+void JsonWriter::EndArray() {
+  _Close(']');
+}
+
+void JsonWriter::Key(const char *key) {
+  _Separate();
+  _String(key, false);
+  _Out.write(':');
+  _AfterKey = true;
+}
+
+void JsonWriter::Key(const __FlashStringHelper *key) {
+  _Separate();
+  _String((const char *)key, true);
+  _Out.write(':');
+  _AfterKey = true;
+}
+
+void JsonWriter::Value(const char *value) {
+  _Separate();
+  _String(value, false);
+}
+
+void JsonWriter::Value(const __FlashStringHelper *value) {
+  _Separate();
+  _String((const char *)value, true);
+}
+
+void JsonWriter::Value(bool value) {
+  _Separate();
+  _Out.print(value ? F("true") : F("false"));
+}
+
+void JsonWriter::Value(int value) {
+  Value((long)value);
+}
+
+void JsonWriter::Value(unsigned int value) {
+  Value((unsigned long)value);
+}
+
+void JsonWriter::Value(long value) {
+  _Separate();
+  _Out.print(value);
+}
+
+void JsonWriter::Value(unsigned long value) {
+  _Separate();
+  _Out.print(value);
+}
+
+void JsonWriter::Value(double value) {
+  char text[32];
+
+  _Separate();
+  _Out.write((const uint8_t *)text, FormatNumber(value, text, sizeof(text)));
+}
+
+void JsonWriter::Null() {
+  _Separate();
+  _Out.print(F("null"));
+}
+
+size_t JsonWriter::FormatNumber(double value, char *text, size_t size) {
+  /**
+   * @brief Format a number for JSON, integral values without decimals, otherwise up to six
+   *        decimals without trailing zeros. NaN and infinity are written as null. Only numbers
+   *        beyond 10^12 and fractions at half a digit go through printf, all others are rounded
+   *        to a fixed point number, with the same result
+   * @param value the number
+   * @param text receives the text, not terminated
+   * @param size size of text, at least 24
+   * @returns the length of the text
+   */
+  int len;
+
+  if (isnan(value) || isinf(value)) {
+    memcpy(text, "null", 4);
+    return 4;
+  }
+  if (fabs(value) < 2147483647.0 && value == (double)(long)value) {
+    sFixedPoint_t integral = {(long)value, 0};
+    return FormatFixed(integral, text, size, true);
+  }
+  // six decimals fit into the fixed point number up to 10^12. Only the fraction is scaled, the
+  // integer part would take the precision of the decimals; a fraction this close to half a
+  // digit is left to the exact rounding of printf
+  if (fabs(value) < 1e12) {
+    double integral = floor(fabs(value));
+    double micros = (fabs(value) - integral) * 1e6;
+    double rounded = floor(micros + 0.5);
+    if (fabs(micros - rounded) < 0.5 - 1e-6) {
+      int64_t digits = (int64_t)integral * 1000000 + (int64_t)rounded;
+      sFixedPoint_t fixed = {(value < 0) ? -digits : digits, -6};
+      return FormatFixed(fixed, text, size, true);
+    }
+  }
+
+  len = snprintf(text, size, "%.6f", value);
+  if (len >= (int)size)
+    return snprintf(text, size, "%.6g", value);
+  while (text[len - 1] == '0')
+    len--;
+  if (text[len - 1] == '.')
+    len--;
+  return len;
+}
+
+void JsonWriter::Value(sFixedPoint_t value) {
+  char text[32];
+
+  _Separate();
+  _Out.write((const uint8_t *)text, FormatFixed(value, text, sizeof(text), true));
+}
+
+size_t JsonWriter::FormatFixed(sFixedPoint_t value, char *text, size_t size, bool trim) {
+  /**
+   * @brief Format a fixed point number with integer arithmetic only, e.g. {2301, -1} as 230.1
+   * @param value the number
+   * @param text receives the text, not terminated
+   * @param size size of text, at least 24
+   * @param trim true: trailing zeros of the decimals are dropped (JSON), false: the number of
+   *        decimals follows the exponent (230.0)
+   * @returns the length of the text
+   */
+  char digits[24];
+  uint8_t count = 0;
+  uint8_t decimals = (value.Exponent < 0) ? -value.Exponent : 0;
+  uint64_t magnitude = (value.Value < 0) ? -(uint64_t)value.Value : value.Value;
+  size_t len = 0;
+
+  // digits in reverse order, most values fit the cheaper 32 bit division, which then yields
+  // two digits at a time from the table
+  while (magnitude > UINT32_MAX) {
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  }
+  uint32_t low = magnitude;
+  while (low >= 100) {
+    uint8_t pair = low % 100;
+    low /= 100;
+    digits[count++] = pgm_read_byte(&DIGIT_PAIRS[2 * pair + 1]);
+    digits[count++] = pgm_read_byte(&DIGIT_PAIRS[2 * pair]);
+  }
+  if (low >= 10) {
+    digits[count++] = pgm_read_byte(&DIGIT_PAIRS[2 * low + 1]);
+    digits[count++] = pgm_read_byte(&DIGIT_PAIRS[2 * low]);
+  } else {
+    digits[count++] = '0' + low;
+  }
+
+  // leading zeros up to the first integer digit, e.g. 0.05
+  while (count <= decimals && count < sizeof(digits)) {
+    digits[count++] = '0';
+  }
+  if (trim) {
+    uint8_t zeros = 0;
+    while (zeros < decimals && digits[zeros] == '0')
+      zeros++;
+    decimals -= zeros;
+    memmove(digits, &digits[zeros], count - zeros);
+    count -= zeros;
+  }
+
+  if (value.Value < 0)
+    text[len++] = '-';
+  while (count > 0 && len + 2 < size) {
+    if (count == decimals)
+      text[len++] = '.';
+    text[len++] = digits[--count];
+  }
+  // a positive exponent appends zeros
+  for (int8_t e = value.Exponent; e > 0 && len < size; e--) {
+    text[len++] = '0';
+  }
+  return len;
+}
+
+double sFixedPoint_t::ToDouble() const {
+  /**
+   * @brief The value as floating point number, for consumers that compute with it
+   */
+  if (Exponent < 0)
+    return Value / _PowerOfTen(-Exponent);
+  return Value * _PowerOfTen(Exponent);
+}
+
+sFixedPoint_t sFixedPoint_t::Rounded(int8_t exponent) const {
+  /**
+   * @brief The value with another exponent, rounded half away from zero when digits are
+   *        dropped, e.g. {2306, -1} with exponent 0 is {231, 0}
+   */
+  sFixedPoint_t fixed = {Value, exponent};
+  int64_t divisor = 1;
+
+  for (int8_t e = Exponent; e > exponent; e--) {
+    fixed.Value *= 10;
+  }
+  for (int8_t e = Exponent; e < exponent; e++) {
+    divisor *= 10;
+  }
+  if (divisor > 1)
+    fixed.Value = (Value + ((Value < 0) ? -divisor / 2 : divisor / 2)) / divisor;
+  return fixed;
+}
+
+sFixedPoint_t sFixedPoint_t::FromDouble(double value, int8_t exponent) {
+  /**
+   * @brief Round a computed value to a fixed point number, half away from zero, e.g. to
+   *        two decimals with exponent -2
+   */
+  double scaled = (exponent < 0) ? value * _PowerOfTen(-exponent) : value / _PowerOfTen(exponent);
+  sFixedPoint_t fixed = {(int64_t)(scaled + ((scaled < 0) ? -0.5 : 0.5)), exponent};
+  return fixed;
+}
+
+void JsonWriter::_String(const char *s, bool flash) {
+  /**
+   * @brief Write a quoted and escaped string
+   * @param s the string
+   * @param flash the string lives in PROGMEM
+   */
+  char c;
+
+  _Out.write('"');
+  if (s != NULL) {
+    while ((c = flash ? pgm_read_byte(s) : *s) != '\0') {
+      if (c == '"' || c == '\\') {
+        _Out.write('\\');
+        _Out.write(c);
+      } else if ((uint8_t)c < 0x20) {
+        char esc[7];
+        snprintf(esc, sizeof(esc), "\\u%04x", c);
+        _Out.write((const uint8_t *)esc, 6);
+      } else {
+        _Out.write(c);
+      }
+      s++;
+    }
+  }
+  _Out.write('"');
+}
+
+JsonTemplate::JsonTemplate(PGM_P text, uint8_t slots) {
+  _Text = text;
+  _Buffer = NULL;
+  _Length = 0;
+  _SlotCount = slots;
+}
+
+bool JsonTemplate::Begin() {
+  /**
+   * @brief Expand the template into RAM on first use: every slot marker becomes a run of
+   *        spaces of the slot width and its position is recorded
+   * @returns false if there is not enough memory or the template doesn't have the expected
+   *          number of slots
+   */
+  size_t length = 0;
+  uint8_t slots = 0;
+  char c;
+
+  if (_Buffer != NULL)
+    return true;
+
+  for (PGM_P p = _Text; (c = pgm_read_byte(p)) != '\0'; p++) {
+    if (c == JSON_SLOT_NUMBER[0])
+      length += JSON_NUMBER_SLOT_WIDTH;
+    else if (c == JSON_SLOT_STRING[0])
+      length += JSON_STRING_SLOT_WIDTH;
+    else
+      length++;
+  }
+
+  _Buffer = (char *)malloc(length);
+  if (_Buffer == NULL)
+    return false;
+
+  _Length = 0;
+  for (PGM_P p = _Text; (c = pgm_read_byte(p)) != '\0'; p++) {
+    uint8_t width = 1;
+    if (c == JSON_SLOT_NUMBER[0])
+      width = JSON_NUMBER_SLOT_WIDTH;
+    else if (c == JSON_SLOT_STRING[0])
+      width = JSON_STRING_SLOT_WIDTH;
+
+    if (width == 1) {
+      _Buffer[_Length++] = c;
+      continue;
+    }
+    if (slots < JSON_TEMPLATE_MAX_SLOTS)
+      _Slots[slots] = _Length;
+    slots++;
+    memset(&_Buffer[_Length], ' ', width);
+    // an empty slot still has to be valid JSON
+    _Buffer[_Length] = (width == JSON_NUMBER_SLOT_WIDTH) ? '0' : '"';
+    if (width == JSON_STRING_SLOT_WIDTH)
+      _Buffer[_Length + 1] = '"';
+    _Length += width;
+  }
+
+  if (slots != _SlotCount || slots > JSON_TEMPLATE_MAX_SLOTS) {
+    free(_Buffer);
+    _Buffer = NULL;
+    return false;
+  }
+  return true;
+}
+
+void JsonTemplate::SetNumber(uint8_t slot, double value) {
+  /**
+   * @brief Patch a number into a slot, a number too long for the slot is written as null
+   */
+  char text[32];
+  size_t len;
+
+  if (_Buffer == NULL || slot >= _SlotCount)
+    return;
+
+  len = JsonWriter::FormatNumber(value, text, sizeof(text));
+  if (len > JSON_NUMBER_SLOT_WIDTH) {
+    memcpy(text, "null", 4);
+    len = 4;
+  }
+  memcpy(&_Buffer[_Slots[slot]], text, len);
+  memset(&_Buffer[_Slots[slot] + len], ' ', JSON_NUMBER_SLOT_WIDTH - len);
+}
+
+void JsonTemplate::SetNumber(uint8_t slot, sFixedPoint_t value) {
+  /**
+   * @brief Patch a fixed point number into a slot, a number too long for the slot is written
+   *        as null
+   */
+  char text[32];
+  size_t len;
+
+  if (_Buffer == NULL || slot >= _SlotCount)
+    return;
+
+  len = JsonWriter::FormatFixed(value, text, sizeof(text), true);
+  if (len > JSON_NUMBER_SLOT_WIDTH) {
+    memcpy(text, "null", 4);
+    len = 4;
+  }
+  memcpy(&_Buffer[_Slots[slot]], text, len);
+  memset(&_Buffer[_Slots[slot] + len], ' ', JSON_NUMBER_SLOT_WIDTH - len);
+}
+
+void JsonTemplate::SetString(uint8_t slot, const char *value) {
+  /**
+   * @brief Patch a string into a slot, it is cut to the slot width. The string is not escaped.
+   */
+  char *p;
+  size_t len = strlen(value);
+
+  if (_Buffer == NULL || slot >= _SlotCount)
+    return;
+
+  if (len > JSON_STRING_SLOT_WIDTH - 2)
+    len = JSON_STRING_SLOT_WIDTH - 2;
+  p = &_Buffer[_Slots[slot]];
+  *p++ = '"';
+  memcpy(p, value, len);
+  p += len;
+  *p++ = '"';
+  memset(p, ' ', JSON_STRING_SLOT_WIDTH - 2 - len);
+}
+
+void JsonTemplate::Write(Print &out) {
+  if (_Buffer != NULL)
+    out.write((const uint8_t *)_Buffer, _Length);
+}
+
+ChunkedPrint::ChunkedPrint(Sink_t sink) {
+  _Sink = sink;
+  _Length = 0;
+}
+
+ChunkedPrint::~ChunkedPrint() {
+  flush();
+}
+
+size_t ChunkedPrint::write(uint8_t c) {
+  if (_Length == sizeof(_Buffer))
+    flush();
+  _Buffer[_Length++] = c;
+  return 1;
+}
+
+size_t ChunkedPrint::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+void ChunkedPrint::flush() {
+  /**
+   * @brief Hand the collected bytes to the sink
+   */
+  if (_Length > 0)
+    _Sink(_Buffer, _Length);
+  _Length = 0;
+}
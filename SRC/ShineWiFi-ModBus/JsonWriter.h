@@ -0,0 +1,146 @@
+#ifndef _JSON_WRITER_H_
+#define _JSON_WRITER_H_
+
+#include <Arduino.h>
+#include "Config.h"
+
+// A decimal number as scaled integer, Value * 10^Exponent, e.g. {2301, -1} is 230.1. Register
+// values are carried like this from the raw value to the text, so formatting them needs no
+// floating point, which the ESP8266 only has in software
+typedef struct sFixedPoint_t {
+  int64_t Value;
+  int8_t Exponent;
+
+  double ToDouble() const;
+  sFixedPoint_t Rounded(int8_t exponent) const;
+  static sFixedPoint_t FromDouble(double value, int8_t exponent);
+} sFixedPoint_t;
+
+// Writes a JSON document token by token to a Print, nothing of the document is kept in
+// memory. Commas between members and array elements are inserted automatically.
+class JsonWriter {
+  public:
+    JsonWriter(Print &out);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(const char *key);
+    void Key(const __FlashStringHelper *key);
+
+    void Value(const char *value);
+    void Value(const __FlashStringHelper *value);
+    void Value(bool value);
+    void Value(int value);
+    void Value(unsigned int value);
+    void Value(long value);
+    void Value(unsigned long value);
+    void Value(double value);
+    void Value(sFixedPoint_t value);
+    void Null();
+
+    static size_t FormatNumber(double value, char *text, size_t size);
+    static size_t FormatFixed(sFixedPoint_t value, char *text, size_t size, bool trim);
+
+    template <typename K> void BeginObject(K key) { Key(key); BeginObject(); }
+    template <typename K> void BeginArray(K key) { Key(key); BeginArray(); }
+    template <typename K, typename V> void Member(K key, V value) { Key(key); Value(value); }
+
+  private:
+    Print &_Out;
+    // one bit per nesting level: the level already has a member or element
+    uint32_t _HasElement;
+    uint8_t _Depth;
+    bool _AfterKey;
+
+    void _Separate();
+    void _Open(char c);
+    void _Close(char c);
+    void _String(const char *s, bool flash);
+};
+
+// Slot markers of a JsonTemplate text and the width of the slots
+#define JSON_SLOT_NUMBER "\x01"
+#define JSON_SLOT_STRING "\x02"
+#define JSON_NUMBER_SLOT_WIDTH 16
+#define JSON_STRING_SLOT_WIDTH 28 // including the quotes
+#define JSON_TEMPLATE_MAX_SLOTS 32
+
+// A JSON document of fixed structure, kept as expanded text in RAM. Only the values are
+// patched into slots of fixed width, the rest of a slot is filled with spaces, which JSON
+// allows between tokens. Slots are numbered in the order they appear in the text.
+class JsonTemplate {
+  public:
+    JsonTemplate(PGM_P text, uint8_t slots);
+
+    bool Begin();
+    void SetNumber(uint8_t slot, double value);
+    void SetNumber(uint8_t slot, sFixedPoint_t value);
+    void SetString(uint8_t slot, const char *value);
+    void Write(Print &out);
+
+  private:
+    PGM_P _Text;
+    char *_Buffer;
+    size_t _Length;
+    uint8_t _SlotCount;
+    uint16_t _Slots[JSON_TEMPLATE_MAX_SLOTS];
+};
+
+// Print that collects the output in a small buffer and hands it to a sink in chunks,
+// e.g. to the chunked transfer of the web server or to a streamed MQTT publish
+#ifndef JSON_CHUNK_SIZE
+#define JSON_CHUNK_SIZE 256
+#endif
+
+class ChunkedPrint : public Print {
+  public:
+    typedef void (*Sink_t)(const uint8_t *data, size_t length);
+
+    ChunkedPrint(Sink_t sink);
+    ~ChunkedPrint();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+
+  private:
+    Sink_t _Sink;
+    uint8_t _Buffer[JSON_CHUNK_SIZE];
+    size_t _Length;
+};
+
+// Print that only counts the bytes, used to get the length of a document up front
+class CountingPrint : public Print {
+  public:
+    CountingPrint() : _Count(0) {}
+
+    size_t write(uint8_t) override { _Count++; return 1; }
+    size_t write(const uint8_t *, size_t size) override { _Count += size; return size; }
+    size_t Count() const { return _Count; }
+
+  private:
+    size_t _Count;
+};
+
+// Print that writes into a fixed buffer, bytes beyond its size are dropped
+class BufferPrint : public Print {
+  public:
+    BufferPrint(char *buffer, size_t size) : _Buffer(buffer), _Size(size), _Length(0) {}
+
+    size_t write(uint8_t c) override {
+      if (_Length >= _Size)
+        return 0;
+      _Buffer[_Length++] = c;
+      return 1;
+    }
+    size_t Length() const { return _Length; }
+
+  private:
+    char *_Buffer;
+    size_t _Size;
+    size_t _Length;
+};
+
+#endif // _JSON_WRITER_H_
@@ -0,0 +1,215 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "ModbusCapture.h"
+#include "Config.h"
+
+#ifndef MODBUS_CAPTURE_BUFFER_SIZE
+#define MODBUS_CAPTURE_BUFFER_SIZE 512
+#endif
+#ifndef MODBUS_CAPTURE_MAX_SIZE
+#define MODBUS_CAPTURE_MAX_SIZE 65536
+#endif
+#ifndef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+#if MODBUS_POLL_TASK == 1 && !defined(ESP32)
+#undef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+
+// Longest record: time, function, result, address, quantity, latency and 125 registers
+#define CAPTURE_RECORD_SIZE(registers) (5 + 1 + 1 + 3 + 3 + 5 + 3 * (registers))
+#if MODBUS_CAPTURE_BUFFER_SIZE < CAPTURE_RECORD_SIZE(125)
+#error "MODBUS_CAPTURE_BUFFER_SIZE has to hold a read of 125 registers (393 bytes)"
+#endif
+
+#if MODBUS_POLL_TASK == 1
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+class CaptureGuard {
+  public:
+    CaptureGuard(void *mutex) : _Mutex((SemaphoreHandle_t)mutex) {
+      if (_Mutex != NULL)
+        xSemaphoreTake(_Mutex, portMAX_DELAY);
+    }
+    ~CaptureGuard() {
+      if (_Mutex != NULL)
+        xSemaphoreGive(_Mutex);
+    }
+
+  private:
+    SemaphoreHandle_t _Mutex;
+};
+#define CAPTURE_GUARD() CaptureGuard captureGuard(_Mutex)
+#else
+#define CAPTURE_GUARD()
+#endif
+
+ModbusCapture::ModbusCapture() {
+  _Active = false;
+  _Buffer = NULL;
+  _Length = 0;
+  _FileLength = 0;
+  _LastTime = 0;
+  _FirstRecord = true;
+  _Mutex = NULL;
+}
+
+void ModbusCapture::Start() {
+  /**
+   * @brief Start a new capture, the last one is deleted. The capture stops by itself when the
+   *        file reaches MODBUS_CAPTURE_MAX_SIZE bytes or can't be written.
+   */
+#if MODBUS_POLL_TASK == 1
+  if (_Mutex == NULL)
+    _Mutex = xSemaphoreCreateMutex();
+#endif
+  CAPTURE_GUARD();
+
+  if (_Buffer == NULL)
+    _Buffer = (uint8_t *)malloc(MODBUS_CAPTURE_BUFFER_SIZE);
+  if (_Buffer == NULL)
+    return;
+
+  LittleFS.remove(MODBUS_CAPTURE_FILE);
+  _Length = 0;
+  _FileLength = 0;
+  _FirstRecord = true;
+
+  for (int i = 0; i < 3; i++) {
+    _Put(MODBUS_CAPTURE_MAGIC[i]);
+  }
+  _Put(MODBUS_CAPTURE_FORMAT);
+  _Put(GROWATT_MODBUS_VERSION & 0xFF);
+  _Put(GROWATT_MODBUS_VERSION >> 8);
+  _Active = true;
+}
+
+void ModbusCapture::Stop() {
+  /**
+   * @brief Write the remaining records and release the buffer, the capture stays in the file
+   */
+  CAPTURE_GUARD();
+
+  _Flush();
+  _Active = false;
+  free(_Buffer);
+  _Buffer = NULL;
+}
+
+bool ModbusCapture::Active() {
+  return _Active;
+}
+
+uint32_t ModbusCapture::Size() {
+  /**
+   * @returns length of the capture in bytes, 0 if there is none
+   */
+  uint32_t size = 0;
+  CAPTURE_GUARD();
+
+  if (_Active)
+    return _FileLength + _Length;
+  if (!LittleFS.exists(MODBUS_CAPTURE_FILE))
+    return 0;
+  File file = LittleFS.open(MODBUS_CAPTURE_FILE, "r");
+  if (file) {
+    size = file.size();
+    file.close();
+  }
+  return size;
+}
+
+void ModbusCapture::Add(const sModbusTransaction_t &transaction) {
+  /**
+   * @brief Record a completed request, to be passed to Growatt::SetModbusTrace(). Records are
+   *        collected in RAM, the file is only written when the buffer is full.
+   */
+  uint16_t registers;
+
+  if (!_Active)
+    return;
+  CAPTURE_GUARD();
+  if (!_Active)
+    return;
+
+  registers = (transaction.Registers != NULL) ? transaction.Value : 0;
+  if (registers > ModbusRtu::ku8MaxBufferSize)
+    registers = ModbusRtu::ku8MaxBufferSize;
+  if (_FileLength + _Length + CAPTURE_RECORD_SIZE(registers) > MODBUS_CAPTURE_MAX_SIZE) {
+    _Flush();
+    _Active = false;
+    return;
+  }
+  if (_Length + CAPTURE_RECORD_SIZE(registers) > MODBUS_CAPTURE_BUFFER_SIZE)
+    _Flush();
+  if (!_Active)
+    return;
+
+  _PutVarint(_FirstRecord ? 0 : transaction.Time - _LastTime);
+  _LastTime = transaction.Time;
+  _FirstRecord = false;
+  _Put(transaction.Function);
+  _Put(transaction.Result);
+  _PutVarint(transaction.Address);
+  _PutVarint(transaction.Value);
+  _PutVarint(transaction.Latency);
+  for (uint16_t i = 0; i < registers; i++) {
+    _PutVarint(transaction.Registers[i]);
+  }
+}
+
+void ModbusCapture::_PutVarint(uint32_t value) {
+  while (value >= 0x80) {
+    _Put((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  _Put(value);
+}
+
+void ModbusCapture::_Flush() {
+  /**
+   * @brief Append the collected records to the file. If it can't be written, the capture stops.
+   */
+  if (_Length == 0)
+    return;
+
+  File file = LittleFS.open(MODBUS_CAPTURE_FILE, "a");
+  if (file && file.write(_Buffer, _Length) == _Length) {
+    _FileLength += _Length;
+  } else {
+    _Active = false;
+  }
+  if (file)
+    file.close();
+  _Length = 0;
+}
+
+void ModbusCapture::Export(Print &out) {
+  /**
+   * @brief Write the capture as it is, a running capture continues. Only the records written
+   *        up to the call are exported, the file is not locked while it is sent.
+   */
+  uint8_t buffer[64];
+  uint32_t remaining;
+  int len;
+
+  {
+    CAPTURE_GUARD();
+    _Flush();
+  }
+  remaining = Size();
+  if (remaining == 0)
+    return;
+
+  File file = LittleFS.open(MODBUS_CAPTURE_FILE, "r");
+  if (!file)
+    return;
+  while (remaining > 0 && (len = file.read(buffer, remaining < sizeof(buffer) ? remaining : sizeof(buffer))) > 0) {
+    out.write(buffer, len);
+    remaining -= len;
+  }
+  file.close();
+}
@@ -0,0 +1,45 @@
+#ifndef _MODBUS_CAPTURE_H_
+#define _MODBUS_CAPTURE_H_
+
+#include <Arduino.h>
+
+#include "ModbusRtu.h"
+
+// Capture header: magic, format version, protocol version
+#define MODBUS_CAPTURE_MAGIC "GWM"
+#define MODBUS_CAPTURE_FORMAT 1
+#define MODBUS_CAPTURE_HEADER_SIZE 6
+#define MODBUS_CAPTURE_FILE "/mbcap.bin"
+
+// Recording of the Modbus traffic into a file, to be replayed by the native build (native/replay).
+// Record: varint of the milliseconds since the previous request, function, result, varints of
+// the address, the quantity (the value of a write) and the latency in microseconds, and for a
+// successful read the varint of every register read.
+class ModbusCapture {
+  public:
+    ModbusCapture();
+
+    void Start();
+    void Stop();
+    bool Active();
+    uint32_t Size();
+    void Add(const sModbusTransaction_t &transaction);
+    void Export(Print &out);
+
+  private:
+    bool _Active;
+    // records not written yet
+    uint8_t *_Buffer;
+    size_t _Length;
+    uint32_t _FileLength;
+    uint32_t _LastTime;
+    bool _FirstRecord;
+    // with MODBUS_POLL_TASK the records are added by the polling task
+    void *_Mutex;
+
+    void _Flush();
+    void _Put(uint8_t c) { _Buffer[_Length++] = c; }
+    void _PutVarint(uint32_t value);
+};
+
+#endif // _MODBUS_CAPTURE_H_
@@ -0,0 +1,293 @@
+#include <Arduino.h>
+
+#include "ModbusRtu.h"
+#include "Config.h"
+
+#ifndef MODBUS_RESPONSE_TIMEOUT
+#define MODBUS_RESPONSE_TIMEOUT 2000
+#endif
+
+#define FC_READ_HOLDING_REGISTERS 0x03
+#define FC_READ_INPUT_REGISTERS 0x04
+#define FC_WRITE_SINGLE_REGISTER 0x06
+
+// slave, function, exception code, crc
+#define EXCEPTION_FRAME_LENGTH 5
+// slave, function, address, value, crc
+#define WRITE_FRAME_LENGTH 8
+// the length of a read response is known after slave, function and byte count
+#define LENGTH_UNKNOWN 0xFFFF
+
+ModbusRtu::ModbusRtu() {
+  _Serial = NULL;
+  _Slave = 1;
+  _Function = 0;
+  _Busy = false;
+  _Result = ku8MBSuccess;
+  _RequestTime = 0;
+  _RequestMicros = 0;
+  _Address = 0;
+  _Value = 0;
+  _Trace = NULL;
+  _FrameLength = 0;
+  _ExpectedLength = LENGTH_UNKNOWN;
+  _ResponseLength = 0;
+  memset(_ResponseBuffer, 0, sizeof(_ResponseBuffer));
+}
+
+void ModbusRtu::begin(uint8_t slave, Stream &serial) {
+  /**
+   * @brief Set the slave id and the serial interface, a running request is dropped
+   * @param slave Modbus slave id
+   * @param serial the serial interface, its baudrate has to be set by the caller
+   */
+  _Slave = slave;
+  _Serial = &serial;
+  _Busy = false;
+}
+
+bool ModbusRtu::startReadInputRegisters(uint16_t address, uint16_t quantity) {
+  /**
+   * @brief Send a read request for input registers (function 0x04)
+   * @param address first register
+   * @param quantity number of registers, 1..125
+   * @returns true if the request was sent, false if busy or the quantity is invalid
+   */
+  if (quantity == 0 || quantity > ku8MaxBufferSize)
+    return false;
+  return _Start(FC_READ_INPUT_REGISTERS, address, quantity);
+}
+
+bool ModbusRtu::startReadHoldingRegisters(uint16_t address, uint16_t quantity) {
+  /**
+   * @brief Send a read request for holding registers (function 0x03)
+   * @param address first register
+   * @param quantity number of registers, 1..125
+   * @returns true if the request was sent, false if busy or the quantity is invalid
+   */
+  if (quantity == 0 || quantity > ku8MaxBufferSize)
+    return false;
+  return _Start(FC_READ_HOLDING_REGISTERS, address, quantity);
+}
+
+bool ModbusRtu::startWriteSingleRegister(uint16_t address, uint16_t value) {
+  /**
+   * @brief Send a write request for a single holding register (function 0x06)
+   * @param address the register
+   * @param value the value to write
+   * @returns true if the request was sent, false if busy
+   */
+  return _Start(FC_WRITE_SINGLE_REGISTER, address, value);
+}
+
+bool ModbusRtu::_Start(uint8_t function, uint16_t address, uint16_t value) {
+  /**
+   * @brief Build and send a request frame, the answer is collected by poll()
+   * @param function Modbus function code
+   * @param address register address
+   * @param value quantity for reads, register value for writes
+   * @returns true if the request was sent
+   */
+  uint8_t request[8];
+  uint16_t crc;
+
+  if (_Busy || _Serial == NULL)
+    return false;
+
+  request[0] = _Slave;
+  request[1] = function;
+  request[2] = address >> 8;
+  request[3] = address & 0xFF;
+  request[4] = value >> 8;
+  request[5] = value & 0xFF;
+  crc = _Crc16(request, 6);
+  request[6] = crc & 0xFF;
+  request[7] = crc >> 8;
+
+  // drop anything left over from an earlier answer
+  while (_Serial->available()) {
+    _Serial->read();
+  }
+  _Serial->write(request, sizeof(request));
+
+  _Function = function;
+  _Address = address;
+  _Value = value;
+  _FrameLength = 0;
+  _ResponseLength = 0;
+  _ExpectedLength = (function == FC_WRITE_SINGLE_REGISTER) ? WRITE_FRAME_LENGTH : LENGTH_UNKNOWN;
+  _RequestTime = millis();
+  _RequestMicros = micros();
+  _Busy = true;
+  return true;
+}
+
+uint8_t ModbusRtu::poll() {
+  /**
+   * @brief Collect the received bytes of the running request, returns immediately
+   * @returns ku8MBBusy while the request is running, afterwards the result of the request
+   */
+  if (!_Busy)
+    return _Result;
+
+  while (_Serial->available()) {
+    uint8_t b = _Serial->read();
+    if (_FrameLength < sizeof(_Frame))
+      _Frame[_FrameLength++] = b;
+
+    // an exception is the answer to any function, also to a write of known answer length
+    if (_FrameLength == 3 && (_Frame[1] & 0x80)) {
+      _ExpectedLength = EXCEPTION_FRAME_LENGTH;
+    } else if (_FrameLength == 3 && _ExpectedLength == LENGTH_UNKNOWN) {
+      _ExpectedLength = 5 + _Frame[2];
+      // a byte count this large can only come from a corrupted frame
+      if (_ExpectedLength > sizeof(_Frame))
+        return _Complete(ku8MBInvalidCRC);
+    }
+
+    if (_FrameLength >= _ExpectedLength)
+      return _Complete(_CheckFrame());
+  }
+
+  if ((uint32_t)(millis() - _RequestTime) > MODBUS_RESPONSE_TIMEOUT)
+    return _Complete(ku8MBResponseTimedOut);
+  return ku8MBBusy;
+}
+
+bool ModbusRtu::busy() {
+  return _Busy;
+}
+
+void ModbusRtu::setTrace(ModbusTrace_t trace) {
+  /**
+   * @brief Set a function called with every completed request (also failed ones), NULL for none.
+   *        It is called from poll(), so it has to return quickly.
+   */
+  _Trace = trace;
+}
+
+uint8_t ModbusRtu::_Complete(uint8_t result) {
+  _Result = result;
+  _Busy = false;
+
+  if (_Trace != NULL) {
+    sModbusTransaction_t transaction;
+    transaction.Time = _RequestTime;
+    transaction.Latency = micros() - _RequestMicros;
+    transaction.Function = _Function;
+    transaction.Address = _Address;
+    transaction.Value = _Value;
+    transaction.Result = result;
+    transaction.Registers = (result == ku8MBSuccess && _Function != FC_WRITE_SINGLE_REGISTER) ? _ResponseBuffer : NULL;
+    _Trace(transaction);
+  }
+  return result;
+}
+
+uint8_t ModbusRtu::_CheckFrame() {
+  /**
+   * @brief Validate a complete answer and copy the registers of a read into the response buffer
+   * @returns the result of the request
+   */
+  uint16_t crc = _Crc16(_Frame, _ExpectedLength - 2);
+
+  if (_Frame[_ExpectedLength - 2] != (crc & 0xFF) || _Frame[_ExpectedLength - 1] != (crc >> 8))
+    return ku8MBInvalidCRC;
+  if (_Frame[0] != _Slave)
+    return ku8MBInvalidSlaveID;
+  if ((_Frame[1] & 0x7F) != _Function)
+    return ku8MBInvalidFunction;
+  // exception code 0 does not exist, it must not pass as success
+  if (_Frame[1] & 0x80)
+    return (_Frame[2] != 0) ? _Frame[2] : ku8MBInvalidFunction;
+
+  if (_Function == FC_WRITE_SINGLE_REGISTER) {
+    // the echo of another address or value is no confirmation of this write
+    if (((_Frame[2] << 8) | _Frame[3]) != _Address || ((_Frame[4] << 8) | _Frame[5]) != _Value)
+      return ku8MBInvalidFunction;
+  } else {
+    // a short answer would pass the registers of an earlier read off as current ones
+    if (_Frame[2] != 2 * _Value)
+      return ku8MBInvalidFunction;
+    for (int i = 0; i < _Value; i++) {
+      _ResponseBuffer[i] = (_Frame[3 + 2 * i] << 8) | _Frame[4 + 2 * i];
+    }
+    _ResponseLength = _Value;
+  }
+  return ku8MBSuccess;
+}
+
+uint8_t ModbusRtu::_Wait() {
+  /**
+   * @brief Poll the running request until it is finished, feeds the watchdog while waiting
+   * @returns the result of the request
+   */
+  uint8_t res;
+
+  while ((res = poll()) == ku8MBBusy) {
+    yield();
+  }
+  return res;
+}
+
+uint8_t ModbusRtu::readInputRegisters(uint16_t address, uint16_t quantity) {
+  /**
+   * @brief Read input registers and wait for the answer (up to MODBUS_RESPONSE_TIMEOUT ms)
+   * @returns the result of the request, ku8MBBusy if another request is running
+   */
+  if (!startReadInputRegisters(address, quantity))
+    return _Rejected();
+  return _Wait();
+}
+
+uint8_t ModbusRtu::readHoldingRegisters(uint16_t address, uint16_t quantity) {
+  /**
+   * @brief Read holding registers and wait for the answer (up to MODBUS_RESPONSE_TIMEOUT ms)
+   * @returns the result of the request, ku8MBBusy if another request is running
+   */
+  if (!startReadHoldingRegisters(address, quantity))
+    return _Rejected();
+  return _Wait();
+}
+
+uint8_t ModbusRtu::writeSingleRegister(uint16_t address, uint16_t value) {
+  /**
+   * @brief Write a single holding register and wait for the answer (up to MODBUS_RESPONSE_TIMEOUT ms)
+   * @returns the result of the request, ku8MBBusy if another request is running
+   */
+  if (!startWriteSingleRegister(address, value))
+    return _Rejected();
+  return _Wait();
+}
+
+uint8_t ModbusRtu::_Rejected() {
+  if (_Busy)
+    return ku8MBBusy;
+  return ku8MBInvalidFunction;
+}
+
+uint16_t ModbusRtu::getResponseBuffer(uint8_t index) {
+  /**
+   * @brief Get a register of the last successful read
+   * @param index offset from the first register of the read
+   * @returns the register value, 0xFFFF if the index is beyond the registers received
+   */
+  if (index >= _ResponseLength)
+    return 0xFFFF;
+  return _ResponseBuffer[index];
+}
+
+uint16_t ModbusRtu::_Crc16(const uint8_t *data, uint16_t length) {
+  uint16_t crc = 0xFFFF;
+
+  for (uint16_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      if (crc & 1)
+        crc = (crc >> 1) ^ 0xA001;
+      else
+        crc >>= 1;
+    }
+  }
+  return crc;
+}
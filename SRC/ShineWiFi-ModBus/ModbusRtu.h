@@ -0,0 +1,80 @@
+#ifndef _MODBUS_RTU_H_
+#define _MODBUS_RTU_H_
+
+#include <Arduino.h>
+
+// A completed request as passed to the trace function (s. ModbusRtu::setTrace())
+typedef struct {
+  // millis() when the request was sent and microseconds until its result
+  uint32_t Time;
+  uint32_t Latency;
+  uint8_t Function;
+  uint16_t Address;
+  // quantity of a read, value of a write
+  uint16_t Value;
+  uint8_t Result;
+  // registers of a successful read, NULL otherwise
+  const uint16_t *Registers;
+} sModbusTransaction_t;
+
+typedef void (*ModbusTrace_t)(const sModbusTransaction_t &transaction);
+
+// Modbus RTU master that does not block: a request is sent by one of the start*() functions
+// and completed by calling poll() from loop() until it no longer returns ku8MBBusy.
+// The blocking functions have the same names and result codes as the ModbusMaster library.
+class ModbusRtu {
+  public:
+    // results, Modbus exception codes (0x01..0x0B) are passed through
+    static const uint8_t ku8MBSuccess = 0x00;
+    static const uint8_t ku8MBInvalidSlaveID = 0xE0;
+    static const uint8_t ku8MBInvalidFunction = 0xE1;
+    static const uint8_t ku8MBResponseTimedOut = 0xE2;
+    static const uint8_t ku8MBInvalidCRC = 0xE3;
+    static const uint8_t ku8MBBusy = 0xFF;
+
+    // the largest read allowed by the Modbus specification
+    static const uint8_t ku8MaxBufferSize = 125;
+
+    ModbusRtu();
+    void begin(uint8_t slave, Stream &serial);
+
+    bool startReadInputRegisters(uint16_t address, uint16_t quantity);
+    bool startReadHoldingRegisters(uint16_t address, uint16_t quantity);
+    bool startWriteSingleRegister(uint16_t address, uint16_t value);
+    uint8_t poll();
+    bool busy();
+    void setTrace(ModbusTrace_t trace);
+
+    uint8_t readInputRegisters(uint16_t address, uint16_t quantity);
+    uint8_t readHoldingRegisters(uint16_t address, uint16_t quantity);
+    uint8_t writeSingleRegister(uint16_t address, uint16_t value);
+    uint16_t getResponseBuffer(uint8_t index);
+
+  private:
+    Stream *_Serial;
+    uint8_t _Slave;
+    uint8_t _Function;
+    bool _Busy;
+    uint8_t _Result;
+    uint32_t _RequestTime;
+    uint32_t _RequestMicros;
+    uint16_t _Address;
+    uint16_t _Value;
+    ModbusTrace_t _Trace;
+    // response frame as received: slave, function, byte count, 2 * 125 data bytes, crc
+    uint8_t _Frame[256];
+    uint16_t _FrameLength;
+    uint16_t _ExpectedLength;
+    // registers of the last successful read
+    uint16_t _ResponseBuffer[ku8MaxBufferSize];
+    uint8_t _ResponseLength;
+
+    bool _Start(uint8_t function, uint16_t address, uint16_t value);
+    uint8_t _Complete(uint8_t result);
+    uint8_t _CheckFrame();
+    uint8_t _Wait();
+    uint8_t _Rejected();
+    static uint16_t _Crc16(const uint8_t *data, uint16_t length);
+};
+
+#endif // _MODBUS_RTU_H_
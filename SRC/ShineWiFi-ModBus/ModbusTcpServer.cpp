@@ -0,0 +1,221 @@
+#include <Arduino.h>
+
+#include "ModbusTcpServer.h"
+#include "Config.h"
+
+#ifndef MODBUS_TCP_TIMEOUT
+#define MODBUS_TCP_TIMEOUT 15000
+#endif
+
+#define FC_READ_HOLDING_REGISTERS 0x03
+#define FC_READ_INPUT_REGISTERS 0x04
+
+#define EXCEPTION_ILLEGAL_FUNCTION 0x01
+#define EXCEPTION_ILLEGAL_DATA_ADDRESS 0x02
+#define EXCEPTION_ILLEGAL_DATA_VALUE 0x03
+#define EXCEPTION_SERVER_BUSY 0x06
+#define EXCEPTION_GATEWAY_PATH_UNAVAILABLE 0x0A
+#define EXCEPTION_GATEWAY_TARGET_FAILED 0x0B
+
+// the length field of the MBAP header counts the unit and the PDU (at most 253 bytes)
+#define MBAP_LENGTH_MAX 254
+
+ModbusTcpServer::ModbusTcpServer() : _Server(MODBUS_TCP_PORT) {
+  _Inverter = NULL;
+  for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+    _Clients[i].Length = 0;
+    _Clients[i].Discard = 0;
+    _Clients[i].Queued = -1;
+    _Clients[i].QueuedTime = 0;
+  }
+}
+
+void ModbusTcpServer::Begin(Growatt &inverter) {
+  /**
+   * @brief Start listening, to be called in setup() once the network is up
+   */
+  _Inverter = &inverter;
+  _Server.begin();
+  _Server.setNoDelay(true);
+}
+
+void ModbusTcpServer::Loop() {
+  /**
+   * @brief Accept clients, answer their requests and the requests waiting for a queued read,
+   *        to be called from loop(). Never blocks.
+   */
+  if (_Inverter == NULL)
+    return;
+
+  _Accept();
+  for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+    sModbusTcpClient_t &client = _Clients[i];
+    if (!client.Client.connected()) {
+      _Release(client);
+      continue;
+    }
+    if (client.Queued >= 0)
+      _Complete(client);
+    if (client.Queued < 0)
+      _Receive(client);
+  }
+}
+
+void ModbusTcpServer::_Accept() {
+  while (_Server.hasClient()) {
+    WiFiClient incoming = _Server.accept();
+    uint8_t i = 0;
+
+    while (i < MODBUS_TCP_MAX_CLIENTS && _Clients[i].Client.connected()) {
+      i++;
+    }
+    if (i == MODBUS_TCP_MAX_CLIENTS) {
+      // no room, the client has to try again later
+      incoming.stop();
+      continue;
+    }
+    _Release(_Clients[i]);
+    _Clients[i].Client = incoming;
+    _Clients[i].Client.setNoDelay(true);
+    _Clients[i].Length = 0;
+    _Clients[i].Discard = 0;
+  }
+}
+
+void ModbusTcpServer::_Receive(sModbusTcpClient_t &client) {
+  /**
+   * @brief Read the request of a client, a read request is answered as soon as it is complete.
+   *        Other requests are dropped and answered with the exception illegal function.
+   */
+  while (client.Queued < 0 && client.Client.available() > 0) {
+    int c = client.Client.read();
+    if (c < 0)
+      return;
+
+    if (client.Discard > 0) {
+      if (--client.Discard == 0)
+        _Exception(client, EXCEPTION_ILLEGAL_FUNCTION);
+      continue;
+    }
+
+    client.Frame[client.Length++] = c;
+    if (client.Length == 8) {
+      uint16_t protocol = (client.Frame[2] << 8) | client.Frame[3];
+      uint16_t length = (client.Frame[4] << 8) | client.Frame[5];
+      uint8_t function = client.Frame[7];
+
+      if (protocol != 0 || length < 2 || length > MBAP_LENGTH_MAX) {
+        // not Modbus, the stream can't be resynchronised
+        client.Client.stop();
+        client.Length = 0;
+        return;
+      }
+      if ((function != FC_READ_HOLDING_REGISTERS && function != FC_READ_INPUT_REGISTERS) ||
+          length != MODBUS_TCP_REQUEST_SIZE - 6) {
+        client.Discard = length - 2;
+        if (client.Discard == 0)
+          _Exception(client, EXCEPTION_ILLEGAL_FUNCTION);
+      }
+    } else if (client.Length == MODBUS_TCP_REQUEST_SIZE) {
+      _Request(client);
+    }
+  }
+}
+
+void ModbusTcpServer::_Request(sModbusTcpClient_t &client) {
+  /**
+   * @brief Answer a complete read request from the values of the last read cycle, or queue it
+   */
+  bool holding = (client.Frame[7] == FC_READ_HOLDING_REGISTERS);
+  uint16_t address = (client.Frame[8] << 8) | client.Frame[9];
+  uint16_t count = (client.Frame[10] << 8) | client.Frame[11];
+  uint16_t words[125];
+
+  if (count == 0 || count > 125) {
+    _Exception(client, EXCEPTION_ILLEGAL_DATA_VALUE);
+    return;
+  }
+  if ((uint32_t)address + count > 0x10000) {
+    _Exception(client, EXCEPTION_ILLEGAL_DATA_ADDRESS);
+    return;
+  }
+  if (_Inverter->GetCachedWords(holding, address, count, words)) {
+    _Reply(client, words, count);
+    return;
+  }
+  if (_Inverter->GetWiFiStickType() == Undef_stick) {
+    _Exception(client, EXCEPTION_GATEWAY_PATH_UNAVAILABLE);
+    return;
+  }
+
+  client.Queued = _Inverter->QueueRead(holding, address, count);
+  client.QueuedTime = millis();
+  if (client.Queued < 0)
+    _Exception(client, EXCEPTION_SERVER_BUSY);
+}
+
+void ModbusTcpServer::_Complete(sModbusTcpClient_t &client) {
+  /**
+   * @brief Answer a request waiting for a queued read once it is done
+   */
+  uint16_t address = (client.Frame[8] << 8) | client.Frame[9];
+  uint8_t count = client.Frame[11];
+  uint16_t words[125];
+  uint8_t result = 0;
+
+  switch (_Inverter->GetQueuedRead(client.Queued, address, count, words, &result)) {
+    case QUEUED_DONE:
+      _Reply(client, words, count);
+      break;
+    case QUEUED_FAILED:
+      // exceptions of the inverter are passed on, errors of the bus are the gateway's
+      _Exception(client, (result > 0 && result < ModbusRtu::ku8MBInvalidSlaveID) ? result : EXCEPTION_GATEWAY_TARGET_FAILED);
+      break;
+    default:
+      if ((uint32_t)(millis() - client.QueuedTime) < MODBUS_TCP_TIMEOUT)
+        return;
+      _Exception(client, EXCEPTION_GATEWAY_TARGET_FAILED);
+      break;
+  }
+  _Release(client);
+}
+
+void ModbusTcpServer::_Release(sModbusTcpClient_t &client) {
+  if (client.Queued >= 0)
+    _Inverter->ReleaseRead(client.Queued);
+  client.Queued = -1;
+}
+
+void ModbusTcpServer::_Reply(sModbusTcpClient_t &client, const uint16_t *words, uint8_t count) {
+  /**
+   * @brief Send the registers read, with the transaction and unit of the request
+   */
+  uint8_t frame[9 + 2 * 125];
+  uint16_t length = 3 + 2 * count;
+
+  memcpy(frame, client.Frame, 4);
+  frame[4] = length >> 8;
+  frame[5] = length & 0xFF;
+  frame[6] = client.Frame[6];
+  frame[7] = client.Frame[7];
+  frame[8] = 2 * count;
+  for (uint8_t i = 0; i < count; i++) {
+    frame[9 + 2 * i] = words[i] >> 8;
+    frame[10 + 2 * i] = words[i] & 0xFF;
+  }
+  client.Client.write(frame, 9 + 2 * count);
+  client.Length = 0;
+}
+
+void ModbusTcpServer::_Exception(sModbusTcpClient_t &client, uint8_t code) {
+  uint8_t frame[9];
+
+  memcpy(frame, client.Frame, 4);
+  frame[4] = 0;
+  frame[5] = 3;
+  frame[6] = client.Frame[6];
+  frame[7] = client.Frame[7] | 0x80;
+  frame[8] = code;
+  client.Client.write(frame, sizeof(frame));
+  client.Length = 0;
+}
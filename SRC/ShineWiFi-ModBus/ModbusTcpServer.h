@@ -0,0 +1,60 @@
+#ifndef _MODBUS_TCP_SERVER_H_
+#define _MODBUS_TCP_SERVER_H_
+
+#include <Arduino.h>
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#elif ESP32
+#include <WiFi.h>
+#endif
+
+#include "Growatt.h"
+
+#ifndef MODBUS_TCP_PORT
+#define MODBUS_TCP_PORT 502
+#endif
+#ifndef MODBUS_TCP_MAX_CLIENTS
+#define MODBUS_TCP_MAX_CLIENTS 4
+#endif
+
+// MBAP header (transaction, protocol, length, unit) and the PDU of a read request
+#define MODBUS_TCP_REQUEST_SIZE 12
+
+typedef struct {
+  WiFiClient Client;
+  uint8_t Frame[MODBUS_TCP_REQUEST_SIZE];
+  uint8_t Length;
+  // bytes of a request not supported still to be dropped
+  uint16_t Discard;
+  // entry of the read queue the request waits for (Growatt::QueueRead()), -1 if none
+  int8_t Queued;
+  uint32_t QueuedTime;
+} sModbusTcpClient_t;
+
+// Modbus TCP server for up to MODBUS_TCP_MAX_CLIENTS clients at once. Reads of input (04) and
+// holding (03) registers are answered from the values of the last read cycle without a
+// request to the inverter. Reads of registers not in the register tables are queued and carried
+// out with the next read cycle, the requests of all clients merged. A client gets the answer to
+// one request before the next one is read.
+class ModbusTcpServer {
+  public:
+    ModbusTcpServer();
+
+    void Begin(Growatt &inverter);
+    void Loop();
+
+  private:
+    WiFiServer _Server;
+    Growatt *_Inverter;
+    sModbusTcpClient_t _Clients[MODBUS_TCP_MAX_CLIENTS];
+
+    void _Accept();
+    void _Receive(sModbusTcpClient_t &client);
+    void _Request(sModbusTcpClient_t &client);
+    void _Complete(sModbusTcpClient_t &client);
+    void _Release(sModbusTcpClient_t &client);
+    static void _Reply(sModbusTcpClient_t &client, const uint16_t *words, uint8_t count);
+    static void _Exception(sModbusTcpClient_t &client, uint8_t code);
+};
+
+#endif // _MODBUS_TCP_SERVER_H_
@@ -0,0 +1,84 @@
+#include <Arduino.h>
+
+#include "MsgPackWriter.h"
+
+void MsgPackWriter::_Big(uint8_t code, uint32_t value, uint8_t bytes) {
+  /**
+   * @brief Write a type code followed by the value in big endian
+   */
+  _Out.write(code);
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+    _Out.write((uint8_t)(value >> shift));
+  }
+}
+
+void MsgPackWriter::_Header(uint8_t fix, uint8_t fixLimit, uint8_t code16, uint16_t count) {
+  if (count < fixLimit)
+    _Out.write((uint8_t)(fix | count));
+  else
+    _Big(code16, count, 2);
+}
+
+void MsgPackWriter::BeginMap(uint16_t count) {
+  _Header(0x80, 16, 0xDE, count);
+}
+
+void MsgPackWriter::BeginArray(uint16_t count) {
+  _Header(0x90, 16, 0xDC, count);
+}
+
+void MsgPackWriter::_String(const char *s, size_t length, bool flash) {
+  if (length < 32)
+    _Out.write((uint8_t)(0xA0 | length));
+  else if (length < 256)
+    _Big(0xD9, length, 1);
+  else
+    _Big(0xDA, length, 2);
+
+  for (size_t i = 0; i < length; i++) {
+    _Out.write(flash ? pgm_read_byte(s + i) : s[i]);
+  }
+}
+
+void MsgPackWriter::Value(const char *value) {
+  if (value == NULL)
+    Nil();
+  else
+    _String(value, strlen(value), false);
+}
+
+void MsgPackWriter::Value(const __FlashStringHelper *value) {
+  _String((const char *)value, strlen_P((const char *)value), true);
+}
+
+void MsgPackWriter::Value(bool value) {
+  _Out.write(value ? 0xC3 : 0xC2);
+}
+
+void MsgPackWriter::Value(unsigned long value) {
+  if (value < 0x80)
+    _Out.write((uint8_t)value);
+  else if (value < 0x100)
+    _Big(0xCC, value, 1);
+  else if (value < 0x10000)
+    _Big(0xCD, value, 2);
+  else
+    _Big(0xCE, value, 4);
+}
+
+void MsgPackWriter::Value(long value) {
+  if (value >= 0)
+    Value((unsigned long)value);
+  else if (value >= -32)
+    _Out.write((uint8_t)value);
+  else if (value >= -128)
+    _Big(0xD0, value, 1);
+  else if (value >= -32768)
+    _Big(0xD1, value, 2);
+  else
+    _Big(0xD2, value, 4);
+}
+
+void MsgPackWriter::Nil() {
+  _Out.write(0xC0);
+}
@@ -0,0 +1,34 @@
+#ifndef _MSGPACK_WRITER_H_
+#define _MSGPACK_WRITER_H_
+
+#include <Arduino.h>
+
+// Writes a MessagePack document token by token to a Print, like JsonWriter. Maps and arrays
+// are written with their number of entries up front. Integers take the shortest encoding.
+class MsgPackWriter {
+  public:
+    MsgPackWriter(Print &out) : _Out(out) {}
+
+    void BeginMap(uint16_t count);
+    void BeginArray(uint16_t count);
+
+    void Value(const char *value);
+    void Value(const __FlashStringHelper *value);
+    void Value(bool value);
+    void Value(int value) { Value((long)value); }
+    void Value(unsigned int value) { Value((unsigned long)value); }
+    void Value(long value);
+    void Value(unsigned long value);
+    void Nil();
+
+    template <typename K, typename V> void Member(K key, V value) { Value(key); Value(value); }
+
+  private:
+    Print &_Out;
+
+    void _Header(uint8_t fix, uint8_t fixLimit, uint8_t code16, uint16_t count);
+    void _String(const char *s, size_t length, bool flash);
+    void _Big(uint8_t code, uint32_t value, uint8_t bytes);
+};
+
+#endif // _MSGPACK_WRITER_H_
@@ -0,0 +1,309 @@
+#include <Arduino.h>
+
+#include "PerformanceMetrics.h"
+#include "JsonWriter.h"
+#include "Config.h"
+
+#ifndef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+#if MODBUS_POLL_TASK == 1 && !defined(ESP32)
+#undef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#if MODBUS_POLL_TASK == 1
+#include <freertos/semphr.h>
+
+class MetricsGuard {
+  public:
+    MetricsGuard(void *mutex) : _Mutex((SemaphoreHandle_t)mutex) {
+      if (_Mutex != NULL)
+        xSemaphoreTake(_Mutex, portMAX_DELAY);
+    }
+    ~MetricsGuard() {
+      if (_Mutex != NULL)
+        xSemaphoreGive(_Mutex);
+    }
+
+  private:
+    SemaphoreHandle_t _Mutex;
+};
+#define METRICS_GUARD() MetricsGuard metricsGuard(_Mutex)
+#else
+#define METRICS_GUARD()
+#endif
+
+#define FC_READ_HOLDING_REGISTERS 0x03
+#define FC_READ_INPUT_REGISTERS 0x04
+
+// upper bounds of the buckets in microseconds, the last bucket is +Inf
+static const uint32_t BUCKET_BOUNDS[METRICS_BUCKETS - 1] PROGMEM = {
+  250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000
+};
+
+static const char *const MODBUS_FUNCTIONS[] = {"input", "holding", "write"};
+
+// label of the Modbus results by slot, s. _ResultSlot()
+static const char *const MODBUS_RESULTS[METRICS_MODBUS_RESULTS] = {
+  "success", "illegal_function", "illegal_address", "illegal_value", "device_failure",
+  "acknowledge", "device_busy", "negative_acknowledge", "memory_parity_error", "exception_09",
+  "gateway_path_unavailable", "gateway_target_failed", "invalid_slave", "invalid_function",
+  "timeout", "invalid_crc", "other"
+};
+
+static uint8_t _ResultSlot(uint8_t result) {
+  if (result <= 0x0B)
+    return result;
+  if (result >= ModbusRtu::ku8MBInvalidSlaveID && result <= ModbusRtu::ku8MBInvalidCRC)
+    return 12 + result - ModbusRtu::ku8MBInvalidSlaveID;
+  return METRICS_MODBUS_RESULTS - 1;
+}
+
+PerformanceMetrics::PerformanceMetrics() {
+  memset(_Modbus, 0, sizeof(_Modbus));
+  memset(_ModbusResults, 0, sizeof(_ModbusResults));
+  memset(&_ReadCycle, 0, sizeof(_ReadCycle));
+  memset(_ReadCycles, 0, sizeof(_ReadCycles));
+  memset(_Routes, 0, sizeof(_Routes));
+  memset(_Http, 0, sizeof(_Http));
+  _RouteCount = 0;
+  memset(&_Mqtt, 0, sizeof(_Mqtt));
+  memset(&_Loop, 0, sizeof(_Loop));
+  _Mutex = NULL;
+  _ModbusTask = NULL;
+}
+
+void PerformanceMetrics::Begin() {
+  /**
+   * @brief To be called in setup() before the Modbus communication starts
+   */
+#if MODBUS_POLL_TASK == 1
+  if (_Mutex == NULL)
+    _Mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+void PerformanceMetrics::_Observe(sHistogram_t &histogram, uint32_t duration) {
+  uint8_t bucket = 0;
+
+  while (bucket < METRICS_BUCKETS - 1 && duration > pgm_read_dword(&BUCKET_BOUNDS[bucket])) {
+    bucket++;
+  }
+  histogram.Count[bucket]++;
+  histogram.Sum += duration;
+}
+
+void PerformanceMetrics::ModbusRequest(const sModbusTransaction_t &transaction) {
+  /**
+   * @brief Count a completed Modbus request, to be passed to Growatt::SetModbusTrace()
+   */
+  uint8_t function = 2;
+  METRICS_GUARD();
+
+  if (transaction.Function == FC_READ_INPUT_REGISTERS)
+    function = 0;
+  else if (transaction.Function == FC_READ_HOLDING_REGISTERS)
+    function = 1;
+  _Observe(_Modbus[function], transaction.Latency);
+  _ModbusResults[_ResultSlot(transaction.Result)]++;
+}
+
+void PerformanceMetrics::ReadCycle(bool ok, uint32_t duration) {
+  /**
+   * @brief Count a finished read cycle (Growatt::GetCycleDuration())
+   */
+  METRICS_GUARD();
+
+  _Observe(_ReadCycle, duration);
+  _ReadCycles[ok ? 0 : 1]++;
+}
+
+uint8_t PerformanceMetrics::AddRoute(const char *uri) {
+  /**
+   * @brief Measure a page of the web server
+   * @param uri the path, has to stay valid (a string literal)
+   * @returns the route to pass to HttpRequest(), 0xFF if there are METRICS_MAX_ROUTES already
+   */
+  if (_RouteCount >= METRICS_MAX_ROUTES)
+    return 0xFF;
+  _Routes[_RouteCount] = uri;
+  return _RouteCount++;
+}
+
+void PerformanceMetrics::HttpRequest(uint8_t route, uint32_t duration) {
+  if (route < _RouteCount)
+    _Observe(_Http[route], duration);
+}
+
+void PerformanceMetrics::MqttPublish(uint32_t duration) {
+  _Observe(_Mqtt, duration);
+}
+
+void PerformanceMetrics::LoopIteration(uint32_t duration) {
+  _Observe(_Loop, duration);
+}
+
+void PerformanceMetrics::SetModbusTask(void *task) {
+  /**
+   * @brief The task polling the inverter (MODBUS_POLL_TASK), to report its stack
+   */
+  _ModbusTask = task;
+}
+
+void PerformanceMetrics::_Copy(const sHistogram_t &histogram, sHistogram_t &copy) {
+  METRICS_GUARD();
+
+  copy = histogram;
+}
+
+void PerformanceMetrics::_Header(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *help,
+                                 const __FlashStringHelper *type) {
+  out.print(F("# HELP "));
+  out.print(name);
+  out.write(' ');
+  out.print(help);
+  out.print(F("\n# TYPE "));
+  out.print(name);
+  out.write(' ');
+  out.print(type);
+  out.write('\n');
+}
+
+void PerformanceMetrics::_Series(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *suffix,
+                                 const __FlashStringHelper *label, const char *value, const char *le) {
+  /**
+   * @brief Write the name and the labels of a sample, up to the value
+   * @param suffix appended to the name, NULL for none
+   * @param label name of the label of the series, NULL for none
+   * @param le upper bound of a histogram bucket, NULL for none
+   */
+  out.print(name);
+  if (suffix != NULL)
+    out.print(suffix);
+  if (label != NULL || le != NULL) {
+    out.write('{');
+    if (label != NULL) {
+      out.print(label);
+      out.print(F("=\""));
+      out.print(value);
+      out.write('"');
+    }
+    if (le != NULL) {
+      if (label != NULL)
+        out.write(',');
+      out.print(F("le=\""));
+      out.print(le);
+      out.write('"');
+    }
+    out.write('}');
+  }
+  out.write(' ');
+}
+
+void PerformanceMetrics::_Sample(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *label,
+                                 const char *value, uint32_t sample) {
+  _Series(out, name, NULL, label, value, NULL);
+  out.print((unsigned long)sample);
+  out.write('\n');
+}
+
+void PerformanceMetrics::_Histogram(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *label,
+                                    const char *value, const sHistogram_t &histogram) {
+  /**
+   * @brief Write the cumulative buckets, the sum and the count of a histogram in seconds
+   * @param label name of the label of the series, NULL for none
+   */
+  char text[32];
+  uint32_t count = 0;
+
+  for (uint8_t bucket = 0; bucket < METRICS_BUCKETS; bucket++) {
+    count += histogram.Count[bucket];
+    if (bucket < METRICS_BUCKETS - 1) {
+      sFixedPoint_t bound = {(int64_t)pgm_read_dword(&BUCKET_BOUNDS[bucket]), -6};
+      text[JsonWriter::FormatFixed(bound, text, sizeof(text) - 1, true)] = '\0';
+    } else {
+      strcpy(text, "+Inf");
+    }
+    _Series(out, name, F("_bucket"), label, value, text);
+    out.print((unsigned long)count);
+    out.write('\n');
+  }
+
+  sFixedPoint_t sum = {(int64_t)histogram.Sum, -6};
+  text[JsonWriter::FormatFixed(sum, text, sizeof(text) - 1, true)] = '\0';
+  _Series(out, name, F("_sum"), label, value, NULL);
+  out.print(text);
+  out.write('\n');
+  _Series(out, name, F("_count"), label, value, NULL);
+  out.print((unsigned long)count);
+  out.write('\n');
+}
+
+void PerformanceMetrics::Write(Print &out) {
+  /**
+   * @brief Write all metrics in the text format of Prometheus (version 0.0.4)
+   */
+  sHistogram_t histogram;
+  uint32_t results[METRICS_MODBUS_RESULTS];
+  uint32_t cycles[2];
+
+  _Header(out, F("growatt_modbus_request_duration_seconds"), F("Round trip time of the Modbus requests"), F("histogram"));
+  for (uint8_t function = 0; function < 3; function++) {
+    _Copy(_Modbus[function], histogram);
+    _Histogram(out, F("growatt_modbus_request_duration_seconds"), F("function"), MODBUS_FUNCTIONS[function], histogram);
+  }
+
+  {
+    METRICS_GUARD();
+    memcpy(results, _ModbusResults, sizeof(results));
+    memcpy(cycles, _ReadCycles, sizeof(cycles));
+  }
+  _Header(out, F("growatt_modbus_requests_total"), F("Modbus requests by result"), F("counter"));
+  for (uint8_t slot = 0; slot < METRICS_MODBUS_RESULTS; slot++) {
+    // the rare errors only once they occurred
+    if (results[slot] > 0 || slot == 0 || slot == _ResultSlot(ModbusRtu::ku8MBResponseTimedOut))
+      _Sample(out, F("growatt_modbus_requests_total"), F("result"), MODBUS_RESULTS[slot], results[slot]);
+  }
+
+  _Header(out, F("growatt_read_cycle_duration_seconds"), F("Duration of the read cycles of the inverter"), F("histogram"));
+  _Copy(_ReadCycle, histogram);
+  _Histogram(out, F("growatt_read_cycle_duration_seconds"), NULL, NULL, histogram);
+  _Header(out, F("growatt_read_cycles_total"), F("Read cycles of the inverter by result"), F("counter"));
+  _Sample(out, F("growatt_read_cycles_total"), F("result"), "succeeded", cycles[0]);
+  _Sample(out, F("growatt_read_cycles_total"), F("result"), "failed", cycles[1]);
+
+  // measured by loop() only, no copies needed
+  _Header(out, F("growatt_http_request_duration_seconds"), F("Time to handle a request of the web server"), F("histogram"));
+  for (uint8_t route = 0; route < _RouteCount; route++) {
+    _Histogram(out, F("growatt_http_request_duration_seconds"), F("route"), _Routes[route], _Http[route]);
+  }
+  _Header(out, F("growatt_mqtt_publish_duration_seconds"), F("Time to publish a read cycle by MQTT"), F("histogram"));
+  _Histogram(out, F("growatt_mqtt_publish_duration_seconds"), NULL, NULL, _Mqtt);
+  _Header(out, F("growatt_loop_duration_seconds"), F("Duration of the iterations of loop()"), F("histogram"));
+  _Histogram(out, F("growatt_loop_duration_seconds"), NULL, NULL, _Loop);
+
+#if defined(ESP8266) || defined(ESP32)
+  _Header(out, F("growatt_heap_free_bytes"), F("Free heap"), F("gauge"));
+  _Sample(out, F("growatt_heap_free_bytes"), NULL, NULL, ESP.getFreeHeap());
+  _Header(out, F("growatt_heap_largest_free_block_bytes"), F("Largest block of the heap that can be allocated"), F("gauge"));
+#if defined(ESP8266)
+  _Sample(out, F("growatt_heap_largest_free_block_bytes"), NULL, NULL, ESP.getMaxFreeBlockSize());
+#else
+  _Sample(out, F("growatt_heap_largest_free_block_bytes"), NULL, NULL, ESP.getMaxAllocHeap());
+#endif
+  _Header(out, F("growatt_stack_free_min_bytes"), F("Stack never used so far (high-water mark)"), F("gauge"));
+#if defined(ESP8266)
+  _Sample(out, F("growatt_stack_free_min_bytes"), F("task"), "loop", ESP.getFreeContStack());
+#else
+  _Sample(out, F("growatt_stack_free_min_bytes"), F("task"), "loop", uxTaskGetStackHighWaterMark(NULL));
+  if (_ModbusTask != NULL)
+    _Sample(out, F("growatt_stack_free_min_bytes"), F("task"), "modbus", uxTaskGetStackHighWaterMark((TaskHandle_t)_ModbusTask));
+#endif
+#endif
+}
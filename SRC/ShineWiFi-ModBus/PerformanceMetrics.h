@@ -0,0 +1,68 @@
+#ifndef _PERFORMANCE_METRICS_H_
+#define _PERFORMANCE_METRICS_H_
+
+#include <Arduino.h>
+
+#include "ModbusRtu.h"
+
+#ifndef METRICS_MAX_ROUTES
+#define METRICS_MAX_ROUTES 24
+#endif
+
+// Upper bounds of the histogram buckets: 0.25 ms .. 2.5 s, and +Inf
+#define METRICS_BUCKETS 14
+
+// Durations in microseconds: count per bucket (not cumulative) and their sum
+typedef struct {
+  uint32_t Count[METRICS_BUCKETS];
+  uint64_t Sum;
+} sHistogram_t;
+
+// Modbus results counted: success, exceptions 0x01..0x0B, master errors 0xE0..0xE3, others
+#define METRICS_MODBUS_RESULTS 17
+
+// Counters and latency histograms of the stick, kept in static memory. Written in the text
+// format of Prometheus (<ip>/metrics) together with the heap and stack of the moment.
+class PerformanceMetrics {
+  public:
+    PerformanceMetrics();
+
+    void Begin();
+
+    void ModbusRequest(const sModbusTransaction_t &transaction);
+    void ReadCycle(bool ok, uint32_t duration);
+    uint8_t AddRoute(const char *uri);
+    void HttpRequest(uint8_t route, uint32_t duration);
+    void MqttPublish(uint32_t duration);
+    void LoopIteration(uint32_t duration);
+    void SetModbusTask(void *task);
+    void Write(Print &out);
+
+  private:
+    // requests for input registers, holding registers and writes
+    sHistogram_t _Modbus[3];
+    uint32_t _ModbusResults[METRICS_MODBUS_RESULTS];
+    sHistogram_t _ReadCycle;
+    uint32_t _ReadCycles[2];
+    const char *_Routes[METRICS_MAX_ROUTES];
+    sHistogram_t _Http[METRICS_MAX_ROUTES];
+    uint8_t _RouteCount;
+    sHistogram_t _Mqtt;
+    sHistogram_t _Loop;
+    // with MODBUS_POLL_TASK the Modbus side is measured by the polling task
+    void *_Mutex;
+    void *_ModbusTask;
+
+    static void _Observe(sHistogram_t &histogram, uint32_t duration);
+    void _Copy(const sHistogram_t &histogram, sHistogram_t &copy);
+    static void _Header(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *help,
+                        const __FlashStringHelper *type);
+    static void _Series(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *suffix,
+                        const __FlashStringHelper *label, const char *value, const char *le);
+    static void _Histogram(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *label,
+                           const char *value, const sHistogram_t &histogram);
+    static void _Sample(Print &out, const __FlashStringHelper *name, const __FlashStringHelper *label,
+                        const char *value, uint32_t sample);
+};
+
+#endif // _PERFORMANCE_METRICS_H_
@@ -0,0 +1,250 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <stddef.h>
+
+#include "PhaseEnergy.h"
+#include "Config.h"
+
+#ifndef PHASE_ENERGY_SAVE_INTERVAL
+#define PHASE_ENERGY_SAVE_INTERVAL 1800
+#endif
+#ifndef PHASE_ENERGY_MAX_GAP
+#define PHASE_ENERGY_MAX_GAP 300
+#endif
+#ifndef PHASE_ENERGY_RESET_CYCLES
+#define PHASE_ENERGY_RESET_CYCLES 10
+#endif
+
+#define PHASE_ENERGY_FILE "/energy.bin"
+#define PHASE_ENERGY_TEMP_FILE "/energy.tmp"
+
+// Ws per Wh, and the sum of two powers [0.1 W] times ms per Ws of the trapezoidal rule
+#define WS_PER_WH 3600
+#define TRAPEZOID_PER_WS 20000
+
+// The state saved by the firmware before the energies were integers
+typedef struct {
+  uint32_t Magic;
+  double Energy[PHASE_COUNT];
+  double Pending[PHASE_COUNT];
+  double Counter;
+  double Reported[PHASE_COUNT];
+  uint32_t Checksum;
+} sPhaseEnergyStateV1_t;
+
+PhaseEnergy::PhaseEnergy() {
+  memset(&_State, 0, sizeof(_State));
+  memset(_LastPower, 0, sizeof(_LastPower));
+  memset(_Fraction, 0, sizeof(_Fraction));
+  _LastTime = 0;
+  _LastValid = false;
+  _CounterValid = false;
+  _LowCounter = 0;
+  _LowCycles = 0;
+  _SavedTime = 0;
+  _SavedSum = 0;
+}
+
+void PhaseEnergy::Begin() {
+  /**
+   * @brief Restore the energies saved before the last reboot, to be called after mounting the
+   *        file system. The counter increase while the stick was down is split on the first
+   *        read cycle.
+   */
+  uint8_t data[(sizeof(sPhaseEnergyState_t) > sizeof(sPhaseEnergyStateV1_t)) ? sizeof(sPhaseEnergyState_t)
+                                                                              : sizeof(sPhaseEnergyStateV1_t)];
+  sPhaseEnergyState_t state;
+
+  if (!LittleFS.exists(PHASE_ENERGY_FILE))
+    return;
+  File file = LittleFS.open(PHASE_ENERGY_FILE, "r");
+  if (!file)
+    return;
+  size_t length = file.read(data, sizeof(data));
+  file.close();
+
+  memcpy(&state, data, sizeof(state));
+  if (length == sizeof(state) && state.Magic == PHASE_ENERGY_MAGIC &&
+      state.Checksum == _Checksum(&state, offsetof(sPhaseEnergyState_t, Checksum))) {
+    _State = state;
+  } else if (length != sizeof(sPhaseEnergyStateV1_t) || !_Migrate(data, _State)) {
+    return;
+  }
+  _CounterValid = true;
+  _SavedSum = _Sum(_State.Reported);
+}
+
+bool PhaseEnergy::_Migrate(const uint8_t *data, sPhaseEnergyState_t &state) {
+  /**
+   * @brief Take over a state saved in double Wh (PHASE_ENERGY_MAGIC_V1)
+   * @returns false if it is none or damaged
+   */
+  sPhaseEnergyStateV1_t old;
+
+  memcpy(&old, data, sizeof(old));
+  if (old.Magic != PHASE_ENERGY_MAGIC_V1 || old.Checksum != _Checksum(&old, offsetof(sPhaseEnergyStateV1_t, Checksum)))
+    return false;
+
+  memset(&state, 0, sizeof(state));
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    state.Energy[i] = llround(old.Energy[i] * WS_PER_WH);
+    state.Pending[i] = llround(old.Pending[i] * WS_PER_WH);
+    state.Reported[i] = llround(old.Reported[i] * WS_PER_WH);
+  }
+  state.Counter = llround(old.Counter * WS_PER_WH);
+  return true;
+}
+
+void PhaseEnergy::Add(uint32_t time, const int32_t power[PHASE_COUNT], int64_t counter) {
+  /**
+   * @brief Add the values of a read cycle
+   * @param time millis() of the read cycle
+   * @param power [0.1 W] per phase
+   * @param counter [Wh] total energy counter of the inverter
+   */
+  int32_t lastPower = 0;
+  int32_t instant = 0;
+
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    lastPower += _LastValid ? _LastPower[i] : 0;
+    instant += power[i];
+  }
+  counter *= WS_PER_WH;
+
+  // trapezoidal rule, but not across a gap in the read cycles. What is left below a Ws is
+  // carried to the next cycle, at low power a cycle integrates less than a Ws.
+  if (_LastValid && (uint32_t)(time - _LastTime) <= PHASE_ENERGY_MAX_GAP * 1000UL) {
+    uint32_t elapsed = time - _LastTime;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      _Fraction[i] += ((int64_t)_LastPower[i] + power[i]) * elapsed;
+      _State.Pending[i] += _Fraction[i] / TRAPEZOID_PER_WS;
+      _Fraction[i] %= TRAPEZOID_PER_WS;
+    }
+  }
+
+  if (!_CounterValid) {
+    // first reading: it becomes the reference, unless it is the 0 of an inverter starting up
+    if (counter > 0) {
+      _State.Counter = counter;
+      _CounterValid = true;
+    }
+  } else if (counter < _State.Counter) {
+    // the inverter reports 0 or a low value for a while around start-up, taken as reference the
+    // next reading would add the whole counter to the phases. Only a counter which stays below
+    // the reference for PHASE_ENERGY_RESET_CYCLES read cycles and then counts up was reset.
+    if (_LowCycles == 0 || counter < _LowCounter)
+      _LowCounter = counter;
+    if (_LowCycles < PHASE_ENERGY_RESET_CYCLES)
+      _LowCycles++;
+    if (_LowCycles >= PHASE_ENERGY_RESET_CYCLES && counter > _LowCounter) {
+      _State.Counter = _LowCounter;
+      _LowCycles = 0;
+    }
+  } else {
+    _LowCycles = 0;
+  }
+
+  if (counter > _State.Counter) {
+    int64_t step = counter - _State.Counter;
+    int64_t pending = _Sum(_State.Pending);
+    int64_t energy = _Sum(_State.Energy);
+    const int64_t *share = _State.Pending;
+    int64_t shares = pending;
+    int64_t instantShares[PHASE_COUNT] = {power[0], power[1], power[2]};
+    static const int64_t FIRST_PHASE[PHASE_COUNT] = {1, 0, 0};
+    int64_t before = 0;
+    int64_t split = 0;
+
+    // nothing integrated (e.g. the first cycle after a reboot): split by the current power, at
+    // night by the energies so far, or all to L1
+    if (pending <= 0) {
+      if (instant > 0) {
+        share = instantShares;
+        shares = instant;
+      } else if (energy > 0) {
+        share = _State.Energy;
+        shares = energy;
+      } else {
+        share = FIRST_PHASE;
+        shares = 1;
+      }
+    }
+    // split by the running sum of the shares, so the parts add up to the step exactly
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      before += share[i];
+      int64_t upTo = step * before / shares;
+      _State.Energy[i] += upTo - split;
+      split = upTo;
+    }
+    memset(_State.Pending, 0, sizeof(_State.Pending));
+    _State.Counter = counter;
+  }
+
+  // the integration may run ahead of the counter, the totals must not go back then
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    int64_t total = _State.Energy[i] + _State.Pending[i];
+    if (total > _State.Reported[i])
+      _State.Reported[i] = total;
+  }
+
+  memcpy(_LastPower, power, sizeof(_LastPower));
+  _LastTime = time;
+  _LastValid = true;
+
+  // saved every PHASE_ENERGY_SAVE_INTERVAL seconds and when the inverter stops feeding in
+  if (_Sum(_State.Reported) != _SavedSum &&
+      ((uint32_t)(time - _SavedTime) >= PHASE_ENERGY_SAVE_INTERVAL * 1000UL || (lastPower > 0 && instant <= 0))) {
+    Save();
+  }
+}
+
+int64_t PhaseEnergy::Total(uint8_t phase) {
+  /**
+   * @returns [Wh] energy fed in by a phase (0: L1)
+   */
+  if (phase >= PHASE_COUNT)
+    return 0;
+  return (_State.Reported[phase] + WS_PER_WH / 2) / WS_PER_WH;
+}
+
+void PhaseEnergy::Save() {
+  /**
+   * @brief Write the state to the file system. It is written to a temporary file first which
+   *        then replaces the saved state, so a power loss leaves one of them complete. Nothing
+   *        is written while the totals are those saved or restored last, so a restart before
+   *        Begin() keeps the saved state.
+   */
+  if (_Sum(_State.Reported) == _SavedSum)
+    return;
+  _SavedTime = _LastTime;
+  _SavedSum = _Sum(_State.Reported);
+
+  _State.Magic = PHASE_ENERGY_MAGIC;
+  _State.Checksum = _Checksum(&_State, offsetof(sPhaseEnergyState_t, Checksum));
+  File file = LittleFS.open(PHASE_ENERGY_TEMP_FILE, "w");
+  if (!file)
+    return;
+  bool ok = file.write((const uint8_t *)&_State, sizeof(_State)) == sizeof(_State);
+  file.close();
+  if (ok)
+    LittleFS.rename(PHASE_ENERGY_TEMP_FILE, PHASE_ENERGY_FILE);
+}
+
+int64_t PhaseEnergy::_Sum(const int64_t *values) {
+  int64_t sum = 0;
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    sum += values[i];
+  }
+  return sum;
+}
+
+uint32_t PhaseEnergy::_Checksum(const void *state, size_t length) {
+  // FNV-1a over everything before the checksum
+  const uint8_t *bytes = (const uint8_t *)state;
+  uint32_t hash = 2166136261UL;
+
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ bytes[i]) * 16777619UL;
+  }
+  return hash;
+}
@@ -0,0 +1,51 @@
+#ifndef _PHASE_ENERGY_H_
+#define _PHASE_ENERGY_H_
+
+#include <Arduino.h>
+
+#define PHASE_COUNT 3
+#define PHASE_ENERGY_MAGIC 0x32455747UL    // "GWE2"
+#define PHASE_ENERGY_MAGIC_V1 0x31455747UL // "GWE1", the same fields in double Wh
+
+// Stored state, written as a whole to a temporary file which then replaces the old one
+typedef struct {
+  uint32_t Magic;
+  int64_t Energy[PHASE_COUNT];   // [Ws] reconciled with the counter of the inverter
+  int64_t Pending[PHASE_COUNT];  // [Ws] integrated since the last step of the counter
+  int64_t Counter;               // [Ws] total energy counter at the last step
+  int64_t Reported[PHASE_COUNT]; // [Ws] largest total reported so far
+  uint32_t Checksum;
+} sPhaseEnergyState_t;
+
+// Energy per phase, integrated from the power of every read cycle with the trapezoidal rule.
+// Whenever the total energy counter of the inverter (0.1 kWh resolution) steps, its increase
+// is split among the phases in the ratio of the integrated energies, so the sum of the phases
+// follows the counter while the phases resolve the energy between its steps. The energies are
+// integers in Ws, nothing of it needs floating point.
+class PhaseEnergy {
+  public:
+    PhaseEnergy();
+
+    void Begin();
+    void Add(uint32_t time, const int32_t power[PHASE_COUNT], int64_t counter);
+    int64_t Total(uint8_t phase);
+    void Save();
+
+  private:
+    sPhaseEnergyState_t _State;
+    int32_t _LastPower[PHASE_COUNT];   // [0.1 W]
+    int64_t _Fraction[PHASE_COUNT];    // sums of two powers [0.1 W] * ms left below a Ws
+    uint32_t _LastTime;
+    bool _LastValid;
+    bool _CounterValid;
+    int64_t _LowCounter; // [Ws] lowest reading since the counter went below the reference
+    uint16_t _LowCycles; // read cycles with the counter below the reference
+    uint32_t _SavedTime;
+    int64_t _SavedSum;
+
+    static int64_t _Sum(const int64_t *values);
+    static uint32_t _Checksum(const void *state, size_t length);
+    static bool _Migrate(const uint8_t *data, sPhaseEnergyState_t &state);
+};
+
+#endif // _PHASE_ENERGY_H_
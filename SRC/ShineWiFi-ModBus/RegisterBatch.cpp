@@ -0,0 +1,294 @@
+#include <Arduino.h>
+
+#include "RegisterBatch.h"
+#include "JsonWriter.h"
+#include "Config.h"
+
+#ifndef MODBUS_REQUEST_COST
+#define MODBUS_REQUEST_COST 50
+#endif
+
+RegisterBatch::RegisterBatch() {
+  _RangeCount = 0;
+  _RegisterCount = 0;
+  _Values = NULL;
+  _Valid = NULL;
+  _ErrorCount = 0;
+  _Cached = 0;
+  _Requests = 0;
+  _TimedOut = false;
+  _ValuesTime = 0;
+}
+
+RegisterBatch::~RegisterBatch() {
+  free(_Values);
+  free(_Valid);
+}
+
+bool RegisterBatch::Add(bool holding, const char *list) {
+  /**
+   * @brief Add registers of a table to the batch
+   * @param holding true for holding registers, false for input registers
+   * @param list comma separated addresses and ranges of addresses, e.g. "0-10,35"
+   * @returns false if the list is malformed or exceeds REGISTER_BATCH_MAX_RANGES ranges or
+   *          REGISTER_BATCH_MAX_REGISTERS registers
+   */
+  const char *p = list;
+
+  while (*p != '\0') {
+    char *end;
+    unsigned long first = strtoul(p, &end, 10);
+    unsigned long last = first;
+
+    if (end == p)
+      return false;
+    if (*end == '-') {
+      p = end + 1;
+      last = strtoul(p, &end, 10);
+      if (end == p)
+        return false;
+    }
+    // the count is checked before it is narrowed, 0-65535 would wrap to 0
+    if (last < first || last > 0xFFFF || last - first + 1 > REGISTER_BATCH_MAX_REGISTERS)
+      return false;
+    if (!_AddRange(holding, first, last - first + 1))
+      return false;
+
+    p = end;
+    if (*p == ',')
+      p++;
+    else if (*p != '\0')
+      return false;
+  }
+  return true;
+}
+
+bool RegisterBatch::_AddRange(bool holding, uint16_t address, uint16_t count) {
+  if (_RangeCount >= REGISTER_BATCH_MAX_RANGES || count > REGISTER_BATCH_MAX_REGISTERS - _RegisterCount)
+    return false;
+
+  sRegisterRange_t &range = _Ranges[_RangeCount++];
+  range.Holding = holding;
+  range.Address = address;
+  range.Count = count;
+  range.Offset = 0;
+  _RegisterCount += count;
+  return true;
+}
+
+void RegisterBatch::_Merge() {
+  /**
+   * @brief Sort the ranges by table and address, merge overlapping and adjacent ones and
+   *        assign their place in the value list
+   */
+  uint8_t n = 0;
+
+  // insertion sort, there are few ranges
+  for (uint8_t i = 1; i < _RangeCount; i++) {
+    sRegisterRange_t range = _Ranges[i];
+    uint8_t j = i;
+    while (j > 0 && (_Ranges[j - 1].Holding > range.Holding ||
+                     (_Ranges[j - 1].Holding == range.Holding && _Ranges[j - 1].Address > range.Address))) {
+      _Ranges[j] = _Ranges[j - 1];
+      j--;
+    }
+    _Ranges[j] = range;
+  }
+
+  _RegisterCount = 0;
+  for (uint8_t i = 0; i < _RangeCount; i++) {
+    const sRegisterRange_t &range = _Ranges[i];
+    if (n > 0 && _Ranges[n - 1].Holding == range.Holding &&
+        range.Address <= (uint32_t)_Ranges[n - 1].Address + _Ranges[n - 1].Count) {
+      sRegisterRange_t &last = _Ranges[n - 1];
+      uint32_t end = (uint32_t)range.Address + range.Count;
+      if (end > (uint32_t)last.Address + last.Count) {
+        _RegisterCount += end - last.Address - last.Count;
+        last.Count = end - last.Address;
+      }
+      continue;
+    }
+    _Ranges[n] = range;
+    _Ranges[n].Offset = _RegisterCount;
+    _RegisterCount += range.Count;
+    n++;
+  }
+  _RangeCount = n;
+}
+
+bool RegisterBatch::Read(Growatt &inverter, uint32_t maxAge) {
+  /**
+   * @brief Get the values of the registers added, blocks while reading from the inverter
+   * @param inverter the inverter
+   * @param maxAge registers read by the last read cycle at most maxAge ms ago are taken from
+   *        its values, UINT32_MAX for any age, 0 to read all registers from the inverter
+   * @returns false if there is not enough memory
+   */
+  _Merge();
+  _Values = (uint16_t *)malloc((_RegisterCount + 1) * sizeof(uint16_t));
+  _Valid = (uint8_t *)calloc(_RegisterCount / 8 + 1, 1);
+  if (_Values == NULL || _Valid == NULL)
+    return false;
+
+  _ValuesTime = inverter.GetValuesTime();
+  if (maxAge > 0)
+    _ReadCached(inverter, maxAge);
+  _ReadMissing(inverter, false);
+  _ReadMissing(inverter, true);
+  return true;
+}
+
+void RegisterBatch::_ReadCached(Growatt &inverter, uint32_t maxAge) {
+  for (uint8_t r = 0; r < _RangeCount; r++) {
+    const sRegisterRange_t &range = _Ranges[r];
+
+    for (uint16_t done = 0; done < range.Count;) {
+      uint8_t count = (range.Count - done > 125) ? 125 : range.Count - done;
+      uint8_t covered[16];
+
+      inverter.GetCachedWords(range.Holding, range.Address + done, count, _Values + range.Offset + done, maxAge,
+                              covered);
+      for (uint8_t i = 0; i < count; i++) {
+        if (covered[i >> 3] & (1 << (i & 7))) {
+          _SetValid(range.Offset + done + i);
+          _Cached++;
+        }
+      }
+      done += count;
+    }
+  }
+}
+
+void RegisterBatch::_ReadMissing(Growatt &inverter, bool holding) {
+  /**
+   * @brief Read the registers of a table without a value, the addresses are ascending. A read
+   *        is extended to the next register missing while it stays within the fragment size and
+   *        the registers in between cost less than a request.
+   */
+  uint8_t maxCount = inverter.GetMaxFragmentSize();
+  bool open = false;
+  uint16_t start = 0;
+  uint16_t last = 0;
+
+  for (uint8_t r = 0; r < _RangeCount; r++) {
+    const sRegisterRange_t &range = _Ranges[r];
+    if (range.Holding != holding)
+      continue;
+
+    for (uint16_t i = 0; i < range.Count; i++) {
+      uint16_t address = range.Address + i;
+      if (_IsValid(range.Offset + i))
+        continue;
+      if (open && address - start < maxCount && address - last - 1 <= MODBUS_REQUEST_COST) {
+        last = address;
+        continue;
+      }
+      if (open)
+        _ReadWindow(inverter, holding, start, last - start + 1);
+      open = true;
+      start = address;
+      last = address;
+    }
+  }
+  if (open)
+    _ReadWindow(inverter, holding, start, last - start + 1);
+}
+
+void RegisterBatch::_ReadWindow(Growatt &inverter, bool holding, uint16_t address, uint8_t count) {
+  uint16_t words[125];
+  uint8_t result = REGISTER_BATCH_NOT_SENT;
+  bool ok = false;
+
+  // an inverter that doesn't answer one read won't answer the next ones either
+  if (!_TimedOut && _Requests < REGISTER_BATCH_MAX_REQUESTS) {
+    _Requests++;
+    ok = inverter.ReadWords(holding, address, count, words, &result);
+    _TimedOut = (result == ModbusRtu::ku8MBResponseTimedOut);
+  }
+  if (!ok) {
+    if (_ErrorCount < REGISTER_BATCH_MAX_RANGES) {
+      sRegisterBatchError_t &error = _Errors[_ErrorCount++];
+      error.Holding = holding;
+      error.Address = address;
+      error.Count = count;
+      error.Result = result;
+    }
+    return;
+  }
+
+  // the registers of the ranges within the window, the ones in between were read along only
+  for (uint8_t r = 0; r < _RangeCount; r++) {
+    const sRegisterRange_t &range = _Ranges[r];
+    if (range.Holding != holding)
+      continue;
+
+    uint32_t rangeEnd = (uint32_t)range.Address + range.Count;
+    uint32_t windowEnd = (uint32_t)address + count;
+    uint32_t from = (range.Address > address) ? range.Address : address;
+    uint32_t to = (rangeEnd < windowEnd) ? rangeEnd : windowEnd;
+    for (uint32_t a = from; a < to; a++) {
+      uint16_t index = range.Offset + (a - range.Address);
+      if (!_IsValid(index)) {
+        _Values[index] = words[a - address];
+        _SetValid(index);
+      }
+    }
+  }
+}
+
+void RegisterBatch::Write(Print &out) {
+  /**
+   * @brief Write the values as JSON: every range with the values of its registers (null if
+   *        the read failed), the age of the values of the last read cycle, how many registers
+   *        were taken from them and the requests sent, and the reads that failed with their
+   *        Modbus result (null for the reads left out)
+   */
+  JsonWriter json(out);
+
+  json.BeginObject();
+  json.Key(F("values_age_ms"));
+  if (_ValuesTime == 0)
+    json.Null();
+  else
+    json.Value((unsigned long)(millis() - _ValuesTime));
+  json.Member(F("cached"), (unsigned int)_Cached);
+  json.Member(F("requests"), (unsigned int)_Requests);
+
+  for (uint8_t table = 0; table < 2; table++) {
+    json.BeginArray(table ? F("holding") : F("input"));
+    for (uint8_t r = 0; r < _RangeCount; r++) {
+      const sRegisterRange_t &range = _Ranges[r];
+      if (range.Holding != (table == 1))
+        continue;
+
+      json.BeginObject();
+      json.Member(F("address"), (unsigned int)range.Address);
+      json.BeginArray(F("values"));
+      for (uint16_t i = 0; i < range.Count; i++) {
+        if (_IsValid(range.Offset + i))
+          json.Value((unsigned int)_Values[range.Offset + i]);
+        else
+          json.Null();
+      }
+      json.EndArray();
+      json.EndObject();
+    }
+    json.EndArray();
+  }
+
+  json.BeginArray(F("errors"));
+  for (uint8_t e = 0; e < _ErrorCount; e++) {
+    json.BeginObject();
+    json.Member(F("table"), _Errors[e].Holding ? F("holding") : F("input"));
+    json.Member(F("address"), (unsigned int)_Errors[e].Address);
+    json.Member(F("count"), (unsigned int)_Errors[e].Count);
+    json.Key(F("result"));
+    if (_Errors[e].Result == REGISTER_BATCH_NOT_SENT)
+      json.Null();
+    else
+      json.Value((unsigned int)_Errors[e].Result);
+    json.EndObject();
+  }
+  json.EndArray();
+  json.EndObject();
+}
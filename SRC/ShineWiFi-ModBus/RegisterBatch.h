@@ -0,0 +1,75 @@
+#ifndef _REGISTER_BATCH_H_
+#define _REGISTER_BATCH_H_
+
+#include <Arduino.h>
+
+#include "Growatt.h"
+
+#ifndef REGISTER_BATCH_MAX_RANGES
+#define REGISTER_BATCH_MAX_RANGES 32
+#endif
+#ifndef REGISTER_BATCH_MAX_REGISTERS
+#define REGISTER_BATCH_MAX_REGISTERS 500
+#endif
+// every request blocks the web server up to the response timeout if the inverter doesn't answer
+#ifndef REGISTER_BATCH_MAX_REQUESTS
+#define REGISTER_BATCH_MAX_REQUESTS 16
+#endif
+
+// result of a read that was not sent (s. sRegisterBatchError_t)
+#define REGISTER_BATCH_NOT_SENT 0
+
+// Registers asked for, sorted by table and address and merged where they overlap or touch
+typedef struct {
+  bool Holding;
+  uint16_t Address;
+  uint16_t Count;
+  uint16_t Offset;   // of the first register in the value list
+} sRegisterRange_t;
+
+// A failed read of a batch and its Modbus result, REGISTER_BATCH_NOT_SENT if it was left out
+typedef struct {
+  bool Holding;
+  uint16_t Address;
+  uint8_t Count;
+  uint8_t Result;
+} sRegisterBatchError_t;
+
+// Reads a list of input and holding registers at once (<ip>/registers). Registers read by the
+// last read cycle recently enough are taken from its values, the others are read in as few
+// requests as possible: neighbours are read along when the registers in between cost less than
+// a request (MODBUS_REQUEST_COST), no request is longer than the fragment size of the inverter.
+// After a read timed out or REGISTER_BATCH_MAX_REQUESTS requests the remaining reads are left out.
+class RegisterBatch {
+  public:
+    RegisterBatch();
+    ~RegisterBatch();
+
+    bool Add(bool holding, const char *list);
+    bool Read(Growatt &inverter, uint32_t maxAge);
+    void Write(Print &out);
+
+  private:
+    sRegisterRange_t _Ranges[REGISTER_BATCH_MAX_RANGES];
+    uint8_t _RangeCount;
+    uint16_t _RegisterCount;
+    // values and the bit set of the registers that have one
+    uint16_t *_Values;
+    uint8_t *_Valid;
+    sRegisterBatchError_t _Errors[REGISTER_BATCH_MAX_RANGES];
+    uint8_t _ErrorCount;
+    uint16_t _Cached;
+    uint16_t _Requests;
+    bool _TimedOut;
+    uint32_t _ValuesTime;
+
+    bool _AddRange(bool holding, uint16_t address, uint16_t count);
+    void _Merge();
+    void _ReadCached(Growatt &inverter, uint32_t maxAge);
+    void _ReadMissing(Growatt &inverter, bool holding);
+    void _ReadWindow(Growatt &inverter, bool holding, uint16_t address, uint8_t count);
+    bool _IsValid(uint16_t index) const { return _Valid[index >> 3] & (1 << (index & 7)); }
+    void _SetValid(uint16_t index) { _Valid[index >> 3] |= 1 << (index & 7); }
+};
+
+#endif // _REGISTER_BATCH_H_
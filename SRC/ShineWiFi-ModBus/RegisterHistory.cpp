@@ -0,0 +1,246 @@
+#include <Arduino.h>
+
+#include "RegisterHistory.h"
+#include "Growatt.h"
+#include "JsonWriter.h"
+#include "Config.h"
+
+#ifndef HISTORY_RAW_POINTS
+#define HISTORY_RAW_POINTS 60
+#endif
+#ifndef HISTORY_MINUTE_POINTS
+#define HISTORY_MINUTE_POINTS 60
+#endif
+#ifndef HISTORY_QUARTER_POINTS
+#define HISTORY_QUARTER_POINTS 48
+#endif
+
+enum { TIER_RAW, TIER_MINUTE, TIER_QUARTER };
+
+RegisterHistory::RegisterHistory() {
+  _Inverter = NULL;
+  _SeriesCount = 0;
+  memset(_Tiers, 0, sizeof(_Tiers));
+}
+
+bool RegisterHistory::Begin(Growatt &inverter) {
+  /**
+   * @brief Select the registers flagged plot in the protocol tables and allocate the tiers,
+   *        to be called after Growatt::InitProtocol()
+   * @returns false if there is not enough memory, the history stays empty then
+   */
+  _Inverter = &inverter;
+  _FreeTiers();
+  _SeriesCount = 0;
+
+  for (int i = 0; i < inverter._Protocol.InputRegisterCount && _SeriesCount < HISTORY_MAX_SERIES; i++) {
+    if (inverter.GetInputRegister(i).Plot())
+      _Series[_SeriesCount++] = i;
+  }
+  for (int i = 0; i < inverter._Protocol.HoldingRegisterCount && _SeriesCount < HISTORY_MAX_SERIES; i++) {
+    if (inverter.GetHoldingRegister(i).Plot())
+      _Series[_SeriesCount++] = i | HISTORY_HOLDING;
+  }
+  if (_SeriesCount == 0)
+    return true;
+
+  if (!_AllocateTier(_Tiers[TIER_RAW], HISTORY_RAW_POINTS, 0) ||
+      !_AllocateTier(_Tiers[TIER_MINUTE], HISTORY_MINUTE_POINTS, 60) ||
+      !_AllocateTier(_Tiers[TIER_QUARTER], HISTORY_QUARTER_POINTS, 900)) {
+    _FreeTiers();
+    _SeriesCount = 0;
+    return false;
+  }
+  return true;
+}
+
+bool RegisterHistory::_AllocateTier(sHistoryTier_t &tier, uint16_t capacity, uint16_t interval) {
+  tier.Capacity = capacity;
+  tier.Interval = interval;
+  tier.Width = (interval == 0) ? 1 : 3;
+  tier.Head = 0;
+  tier.Count = 0;
+  tier.PendingSamples = 0;
+  tier.Time = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+  tier.Values = (float *)malloc(capacity * tier.Width * _SeriesCount * sizeof(float));
+  if (interval != 0)
+    tier.Pending = (float *)malloc(3 * _SeriesCount * sizeof(float));
+  return tier.Time != NULL && tier.Values != NULL && (interval == 0 || tier.Pending != NULL);
+}
+
+void RegisterHistory::_FreeTiers() {
+  for (int i = 0; i < HISTORY_TIER_COUNT; i++) {
+    free(_Tiers[i].Time);
+    free(_Tiers[i].Values);
+    free(_Tiers[i].Pending);
+  }
+  memset(_Tiers, 0, sizeof(_Tiers));
+}
+
+void RegisterHistory::Add() {
+  /**
+   * @brief Add the values of a completed read cycle. A finished minute or quarter of an hour
+   *        is closed as soon as the first sample of the next one arrives.
+   */
+  float samples[HISTORY_MAX_SERIES];
+  uint32_t now = millis() / 1000;
+
+  if (_SeriesCount == 0)
+    return;
+
+  for (int s = 0; s < _SeriesCount; s++) {
+    uint16_t reg = _Series[s] & ~HISTORY_HOLDING;
+    if (_Series[s] & HISTORY_HOLDING)
+      samples[s] = _Inverter->GetHoldingValue(reg) * _Inverter->GetHoldingRegister(reg).Multiplier();
+    else
+      samples[s] = _Inverter->GetInputValue(reg) * _Inverter->GetInputRegister(reg).Multiplier();
+  }
+
+  _Push(_Tiers[TIER_RAW], now, samples);
+  _Collect(_Tiers[TIER_MINUTE], now, samples);
+  _Collect(_Tiers[TIER_QUARTER], now, samples);
+}
+
+void RegisterHistory::_Push(sHistoryTier_t &tier, uint32_t time, const float *values) {
+  /**
+   * @brief Append a point to a tier, the oldest one is overwritten when the tier is full
+   * @param values Width values per series
+   */
+  uint8_t stride = tier.Width * _SeriesCount;
+
+  tier.Time[tier.Head] = time;
+  memcpy(&tier.Values[tier.Head * stride], values, stride * sizeof(float));
+  tier.Head = (tier.Head + 1) % tier.Capacity;
+  if (tier.Count < tier.Capacity)
+    tier.Count++;
+}
+
+void RegisterHistory::_Collect(sHistoryTier_t &tier, uint32_t now, const float *samples) {
+  /**
+   * @brief Add the samples to the running interval of an aggregated tier
+   */
+  uint32_t start = now - now % tier.Interval;
+  float *p = tier.Pending;
+
+  if (tier.PendingSamples > 0 && start != tier.PendingStart) {
+    // the interval is complete: sum -> mean, then store
+    for (int s = 0; s < _SeriesCount; s++) {
+      p[3 * s] /= tier.PendingSamples;
+    }
+    _Push(tier, tier.PendingStart, p);
+    tier.PendingSamples = 0;
+  }
+
+  for (int s = 0; s < _SeriesCount; s++) {
+    if (tier.PendingSamples == 0) {
+      p[3 * s] = samples[s];
+      p[3 * s + 1] = samples[s];
+      p[3 * s + 2] = samples[s];
+    } else {
+      p[3 * s] += samples[s];
+      if (samples[s] < p[3 * s + 1])
+        p[3 * s + 1] = samples[s];
+      if (samples[s] > p[3 * s + 2])
+        p[3 * s + 2] = samples[s];
+    }
+  }
+  if (tier.PendingSamples == 0)
+    tier.PendingStart = start;
+  tier.PendingSamples++;
+}
+
+uint16_t RegisterHistory::_Oldest(const sHistoryTier_t &tier) {
+  return (tier.Head + tier.Capacity - tier.Count) % tier.Capacity;
+}
+
+static void _WritePoint(JsonWriter &json, uint32_t time, float mean, float min, float max) {
+  json.BeginArray();
+  json.Value((unsigned long)time);
+  json.Value(sFixedPoint_t::FromDouble(mean, -2));
+  json.Value(sFixedPoint_t::FromDouble(min, -2));
+  json.Value(sFixedPoint_t::FromDouble(max, -2));
+  json.EndArray();
+}
+
+void RegisterHistory::CreateJson(Print &out, uint32_t range, uint16_t points) {
+  /**
+   * @brief Write the history of the last range seconds, reduced to about the given number of
+   *        points: {"Now":<uptime>,"Series":{"<register>":[[<uptime>,<mean>,<min>,<max>],...]}}
+   *        Each time span is taken from the finest tier still holding it, the points are
+   *        merged into range / points seconds wide buckets.
+   * @param range time span in seconds before now
+   * @param points number of buckets, at least 1
+   */
+  JsonWriter json(out);
+  uint32_t now = millis() / 1000;
+  uint32_t from = (range < now) ? now - range : 0;
+  uint32_t bucketWidth;
+
+  if (points == 0)
+    points = 1;
+  bucketWidth = (range + points - 1) / points;
+  if (bucketWidth == 0)
+    bucketWidth = 1;
+
+  json.BeginObject();
+  json.Member(F("Now"), (unsigned long)now);
+  json.BeginObject(F("Series"));
+
+  for (int s = 0; s < _SeriesCount; s++) {
+    uint16_t reg = _Series[s] & ~HISTORY_HOLDING;
+    uint32_t bucket = 0;
+    uint32_t bucketTime = 0;
+    uint16_t merged = 0;
+    float sum = 0, min = 0, max = 0;
+
+    if (_Series[s] & HISTORY_HOLDING)
+      json.BeginArray(_Inverter->GetHoldingRegister(reg).Name());
+    else
+      json.BeginArray(_Inverter->GetInputRegister(reg).Name());
+
+    // coarse to fine, a tier ends where the next finer one starts
+    for (int t = HISTORY_TIER_COUNT - 1; t >= 0; t--) {
+      const sHistoryTier_t &tier = _Tiers[t];
+      uint32_t limit = UINT32_MAX;
+
+      if (t > 0 && _Tiers[t - 1].Count > 0)
+        limit = _Tiers[t - 1].Time[_Oldest(_Tiers[t - 1])];
+
+      // a raw point is its own mean, min and max
+      uint8_t minOffset = (tier.Width == 3) ? 1 : 0;
+      uint8_t maxOffset = (tier.Width == 3) ? 2 : 0;
+
+      for (uint16_t n = 0, i = _Oldest(tier); n < tier.Count; n++, i = (i + 1) % tier.Capacity) {
+        uint32_t time = tier.Time[i];
+        const float *v = &tier.Values[(i * _SeriesCount + s) * tier.Width];
+
+        if (time < from || time >= limit)
+          continue;
+
+        if (merged > 0 && (time - from) / bucketWidth != bucket) {
+          _WritePoint(json, bucketTime, sum / merged, min, max);
+          merged = 0;
+        }
+        if (merged == 0) {
+          bucket = (time - from) / bucketWidth;
+          bucketTime = time;
+          sum = 0;
+          min = v[minOffset];
+          max = v[maxOffset];
+        }
+        merged++;
+        sum += v[0];
+        if (v[minOffset] < min)
+          min = v[minOffset];
+        if (v[maxOffset] > max)
+          max = v[maxOffset];
+      }
+    }
+    if (merged > 0)
+      _WritePoint(json, bucketTime, sum / merged, min, max);
+    json.EndArray();
+  }
+
+  json.EndObject();
+  json.EndObject();
+}
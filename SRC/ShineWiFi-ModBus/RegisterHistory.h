@@ -0,0 +1,52 @@
+#ifndef _REGISTER_HISTORY_H_
+#define _REGISTER_HISTORY_H_
+
+#include <Arduino.h>
+
+class Growatt;
+
+#define HISTORY_MAX_SERIES 8
+#define HISTORY_TIER_COUNT 3
+// marks a holding register in the series list
+#define HISTORY_HOLDING 0x8000
+
+// One resolution of the history: a ring of points with the start time of the point and per
+// series either the value (Width 1) or mean, min and max of the interval (Width 3)
+typedef struct {
+  uint32_t *Time;     // uptime [s]
+  float *Values;
+  uint16_t Capacity;
+  uint16_t Head;      // next point to write
+  uint16_t Count;
+  uint16_t Interval;  // [s], 0: a point per read cycle
+  uint8_t Width;
+  // the interval being collected: start, number of samples and sum, min, max per series
+  uint32_t PendingStart;
+  uint16_t PendingSamples;
+  float *Pending;
+} sHistoryTier_t;
+
+// History of the registers plotted by the web frontend, kept in RAM of fixed size: every read
+// cycle, 1 minute and 15 minute aggregates. The aggregates are built while the samples come in.
+class RegisterHistory {
+  public:
+    RegisterHistory();
+
+    bool Begin(Growatt &inverter);
+    void Add();
+    void CreateJson(Print &out, uint32_t range, uint16_t points);
+
+  private:
+    Growatt *_Inverter;
+    uint8_t _SeriesCount;
+    uint16_t _Series[HISTORY_MAX_SERIES];
+    sHistoryTier_t _Tiers[HISTORY_TIER_COUNT];
+
+    bool _AllocateTier(sHistoryTier_t &tier, uint16_t capacity, uint16_t interval);
+    void _FreeTiers();
+    void _Push(sHistoryTier_t &tier, uint32_t time, const float *values);
+    void _Collect(sHistoryTier_t &tier, uint32_t now, const float *samples);
+    uint16_t _Oldest(const sHistoryTier_t &tier);
+};
+
+#endif // _REGISTER_HISTORY_H_
@@ -8,7 +8,6 @@ Used Libs
   - WiFiManager         by tzapu           https://github.com/tzapu/WiFiManager
   - PubSubClient        by Nick O´Leary    https://github.com/knolleary/pubsubclient
   - DoubleResetDetector by Khai Hoang      https://github.com/khoih-prog/ESP_DoubleResetDetector
-  - ModbusMaster        by Doc Walker      https://github.com/knolleary/pubsubclient
   - ArduinoJson         by Benoit Blanchon https://github.com/bblanchon/ArduinoJson
 
 To install the used libraries, use the embedded library manager (Sketch -> Include Library -> Manage Libraries),
@@ -44,12 +43,87 @@ e.g. C:\Users\<username>\AppData\Local\Temp\arduino_build_533155
 #define ENABLE_WEB_DEBUG 0
 #endif
 
+#ifndef MQTT_DELTA_PUBLISH
+#define MQTT_DELTA_PUBLISH 0
+#endif
+
+#ifndef MQTT_FULL_SNAPSHOT_INTERVAL
+#define MQTT_FULL_SNAPSHOT_INTERVAL 30
+#endif
+
+#ifndef HTTP_RESPONSE_CACHE
+#define HTTP_RESPONSE_CACHE 1
+#endif
+
+#ifndef MQTT_TOPIC_PER_REGISTER
+#define MQTT_TOPIC_PER_REGISTER 0
+#endif
+
+#ifndef MQTT_PAYLOAD_MSGPACK
+#define MQTT_PAYLOAD_MSGPACK 0
+#endif
+
+#ifndef HISTORY_SUPPORTED
+#define HISTORY_SUPPORTED 0
+#endif
+
+#ifndef TELEMETRY_LOG_SUPPORTED
+#define TELEMETRY_LOG_SUPPORTED 0
+#endif
+
+#ifndef WEB_EVENTS_SUPPORTED
+#define WEB_EVENTS_SUPPORTED 0
+#endif
+
+#ifndef MODBUS_CAPTURE_SUPPORTED
+#define MODBUS_CAPTURE_SUPPORTED 0
+#endif
+
+#ifndef METRICS_SUPPORTED
+#define METRICS_SUPPORTED 0
+#endif
+
+#ifndef MODBUS_TCP_SUPPORTED
+#define MODBUS_TCP_SUPPORTED 0
+#endif
+
+#ifndef WEB_EVENTS_MAX_CLIENTS
+#define WEB_EVENTS_MAX_CLIENTS 4
+#endif
+
+#ifndef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+#if MODBUS_POLL_TASK == 1 && !defined(ESP32)
+// the ESP8266 polls from loop()
+#undef MODBUS_POLL_TASK
+#define MODBUS_POLL_TASK 0
+#endif
+
+#ifndef MODBUS_TASK_CORE
+#define MODBUS_TASK_CORE 0
+#endif
+
+#ifndef MODBUS_TASK_STACK_SIZE
+#define MODBUS_TASK_STACK_SIZE 8192
+#endif
+
+#ifndef MQTT_REGISTER_BUFFER_SIZE
+#define MQTT_REGISTER_BUFFER_SIZE 768
+#endif
+
+#ifndef MQTT_DISCOVERY_PREFIX
+#define MQTT_DISCOVERY_PREFIX "homeassistant"
+#endif
+
 
 
 #ifdef ESP8266
 #include <ESP8266HTTPUpdateServer.h>
+#include <Updater.h>
 #elif ESP32
 #include <ESPHTTPUpdateServer.h>
+#include <Update.h>
 #endif
 
 
@@ -92,6 +166,24 @@ uint16_t u16WebMsgNo = 0;
 
 
 #include "Growatt.h"
+#include "JsonWriter.h"
+#include "MsgPackWriter.h"
+#include "RegisterBatch.h"
+#if HISTORY_SUPPORTED == 1
+#include "RegisterHistory.h"
+#endif
+#if TELEMETRY_LOG_SUPPORTED == 1
+#include "TelemetryLog.h"
+#endif
+#if MODBUS_CAPTURE_SUPPORTED == 1
+#include "ModbusCapture.h"
+#endif
+#if METRICS_SUPPORTED == 1
+#include "PerformanceMetrics.h"
+#endif
+#if MODBUS_TCP_SUPPORTED == 1
+#include "ModbusTcpServer.h"
+#endif
 bool StartedConfigAfterBoot = false;
 #define CONFIG_PORTAL_MAX_TIME_SECONDS 300
 #include <WiFiManager.h> // https://github.com/tzapu/WiFiManager
@@ -113,6 +205,27 @@ byte btnPressed = 0;
 
 #define NUM_OF_RETRIES 5
 char u8RetryCounter = NUM_OF_RETRIES;
+#if MODBUS_POLL_TASK == 1
+// result of the last read cycle of the polling task, taken by loop()
+QueueHandle_t InverterResults;
+#endif
+#if MQTT_DELTA_PUBLISH == 1
+uint16_t u16SnapshotCycle = 0;
+#endif
+#if MQTT_PAYLOAD_MSGPACK == 1
+// {"InverterStatus": -1} as MessagePack
+#define MQTT_STATUS_OFFLINE "\x81\xAEInverterStatus\xFF"
+#else
+#define MQTT_STATUS_OFFLINE "{\"InverterStatus\": -1 }"
+#endif
+#if MQTT_TOPIC_PER_REGISTER == 1 || MQTT_DELTA_PUBLISH == 1
+// all registers are published after a (re)connect
+bool bMqttRepublish = true;
+#endif
+#if MQTT_TOPIC_PER_REGISTER == 1
+// availability last sent
+bool bMqttOnline = false;
+#endif
 
 const char* update_path = "/firmware";
 uint16_t u16PacketCnt = 0;
@@ -127,6 +240,25 @@ PubSubClient MqttClient(espClient);
 long previousConnectTryMillis = 0;
 #endif
 Growatt      Inverter;
+#if HISTORY_SUPPORTED == 1
+RegisterHistory History;
+#endif
+#if TELEMETRY_LOG_SUPPORTED == 1
+TelemetryLog Telemetry;
+#endif
+#if MODBUS_CAPTURE_SUPPORTED == 1
+ModbusCapture Capture;
+#endif
+#if METRICS_SUPPORTED == 1
+PerformanceMetrics Metrics;
+#endif
+#if MODBUS_TCP_SUPPORTED == 1
+ModbusTcpServer ModbusTcp;
+#endif
+#if WEB_EVENTS_SUPPORTED == 1
+// browsers subscribed to /events
+WiFiClient EventClients[WEB_EVENTS_MAX_CLIENTS];
+#endif
 #ifdef ESP8266
 ESP8266WebServer httpServer(80);
 #elif ESP32
@@ -150,6 +282,10 @@ const static char* portfile = "/mqttp";
 const static char* topicfile = "/mqttt";
 const static char* userfile = "/mqttu";
 const static char* secretfile = "/mqttw";
+#if MODBUS_PROBE_FRAGMENT_SIZE == 1
+const static char* framesizefile = "/mbframe";
+uint8_t u8ReportedFrameSize = 0;
+#endif
 
 String mqttserver = "";
 String mqttport = "";
@@ -157,7 +293,6 @@ String mqtttopic = "";
 String mqttuser = "";
 String mqttpwd = "";
 
-char JsonString[MQTT_MAX_PACKET_SIZE] = "{\"InverterStatus\": -1 }";
 
 // -------------------------------------------------------
 // Check the WiFi status and reconnect if necessary
@@ -202,14 +337,17 @@ void WiFi_Reconnect()
 
 // Conection can fail after sunrise. The stick powers up before the inverter.
 // So the detection of the inverter will fail. If no inverter is detected, we have to retry later (s. loop() )
-// The detection without running inverter will take several seconds, because the ModBus-Lib has a timeout of 2s 
-// for each read access (and we do several of them). The WiFi can crash during this function. Perhaps we can fix 
-// this by using the callback function of the ModBus-Lib
+// The detection runs in the background (s. Inverter.Poll() in loop()) and takes several seconds without
+// running inverter, because each read access has a timeout of 2s. InverterDetected() is called by loop() when
+// it succeeded, also with MODBUS_POLL_TASK, as it uses the file system and the web debug messages.
 void InverterReconnect(void)
 {
     // Baudrate will be set here, depending on the version of the stick
     Inverter.begin(Serial);
+}
 
+void InverterDetected(void)
+{
     #if ENABLE_WEB_DEBUG == 1
         if (Inverter.GetWiFiStickType() == ShineWiFi_S)
             WEB_DEBUG_PRINT("ShineWiFi-S (Serial) found")
@@ -218,8 +356,58 @@ void InverterReconnect(void)
         else
             WEB_DEBUG_PRINT("Error: Unknown Shine Stick")
     #endif
+
+    #if MODBUS_PROBE_FRAGMENT_SIZE == 1
+        InverterFrameSizeSetup();
+    #endif
+
+    #if GROWATT_MODBUS_VERSION == 125
+        Inverter.ConfigureExportLimit(100);
+    #endif
 }
 
+#if MODBUS_PROBE_FRAGMENT_SIZE == 1
+// Use the stored maximal read size of the inverter. If none is stored yet, it will be measured
+// (takes a few seconds if the inverter rejects long reads)
+void InverterFrameSizeSetup(void)
+{
+    char msg[48];
+    uint8_t size = load_from_file(framesizefile, "0").toInt();
+
+    if (size == 0)
+    {
+        size = Inverter.ProbeMaxFragmentSize();
+        if (size == 0)
+        {
+            WEB_DEBUG_PRINT("Frame size probing failed")
+            return;
+        }
+        write_to_file(framesizefile, String(size));
+    }
+    Inverter.SetMaxFragmentSize(size);
+    u8ReportedFrameSize = Inverter.GetMaxFragmentSize();
+
+    sprintf(msg, "Max. registers per read: %d", u8ReportedFrameSize);
+    WEB_DEBUG_PRINT(msg)
+}
+
+// The read size is reduced for a while if long reads start failing and raised again later on.
+// Only the probed size is stored, a reduction caused by a noisy line is forgotten on reboot
+void InverterFrameSizeReport(void)
+{
+    char msg[48];
+
+    if ((u8ReportedFrameSize != 0) && (Inverter.GetMaxFragmentSize() != u8ReportedFrameSize))
+    {
+        sprintf(msg, "Max. registers per read %s to %d",
+                (Inverter.GetMaxFragmentSize() < u8ReportedFrameSize) ? "reduced" : "raised",
+                Inverter.GetMaxFragmentSize());
+        u8ReportedFrameSize = Inverter.GetMaxFragmentSize();
+        WEB_DEBUG_PRINT(msg)
+    }
+}
+#endif
+
 
 
 // -------------------------------------------------------
@@ -252,8 +440,23 @@ bool MqttReconnect()
         //Run only once every 5 seconds
         previousConnectTryMillis = millis();
         // Attempt to connect with last will
-        if (MqttClient.connect(getId().c_str(), mqttuser.c_str(), mqttpwd.c_str(), mqtttopic.c_str(), 1, 1, "{\"InverterStatus\": -1 }"))
+        #if MQTT_TOPIC_PER_REGISTER == 1
+        String availabilityTopic = mqtttopic + "/availability";
+        if (MqttClient.connect(getId().c_str(), mqttuser.c_str(), mqttpwd.c_str(), availabilityTopic.c_str(), 1, 1, "offline"))
+        {
+            MqttPublishDiscovery();
+            bMqttOnline = false;
+            bMqttRepublish = true;
+        #else
+        if (MqttClient.connect(getId().c_str(), mqttuser.c_str(), mqttpwd.c_str(), mqtttopic.c_str(), 1, 1, MQTT_STATUS_OFFLINE))
         {
+            #if MQTT_PAYLOAD_MSGPACK == 1
+            MqttPublishSchema();
+            #endif
+            #if MQTT_DELTA_PUBLISH == 1
+            bMqttRepublish = true;
+            #endif
+        #endif
             #if ENABLE_DEBUG_OUTPUT == 1
                 Serial.println("connected");
                 return true;
@@ -274,6 +477,144 @@ bool MqttReconnect()
 }
 #endif
 
+#if MQTT_TOPIC_PER_REGISTER == 1
+// -------------------------------------------------------
+// Topic per register: Home Assistant discovery and plain values
+// -------------------------------------------------------
+String MqttDeviceId()
+{
+    String mac = WiFi.macAddress();
+    mac.replace(":", "");
+    return "growatt_" + mac;
+}
+
+void MqttPublishDiscovery()
+{
+    String deviceId = MqttDeviceId();
+
+    for (int i = 0; i < Inverter._Protocol.InputRegisterCount + Inverter._Protocol.HoldingRegisterCount; i++)
+    {
+        // a holding register named like an input register would share its topic and entity
+        if (i >= Inverter._Protocol.InputRegisterCount && Inverter.IsDuplicateHolding(i - Inverter._Protocol.InputRegisterCount))
+            continue;
+        const sGrowattModbusReg_t &reg = (i < Inverter._Protocol.InputRegisterCount) ?
+            Inverter.GetInputRegister(i) : Inverter.GetHoldingRegister(i - Inverter._Protocol.InputRegisterCount);
+        String name = reg.Name();
+        String stateTopic = mqtttopic + "/" + name;
+        String configTopic = String(MQTT_DISCOVERY_PREFIX "/sensor/") + deviceId + "/" + name + "/config";
+
+        CountingPrint counter;
+
+        // streamed, but a config beyond the packet size would be cut off by the broker or by
+        // Home Assistant: fixed header, topic length and topic come on top of the payload
+        Inverter.CreateDiscoveryJson(counter, reg, stateTopic.c_str(), deviceId.c_str());
+        if (counter.Count() + configTopic.length() + 7 > MQTT_MAX_PACKET_SIZE)
+        {
+            WEB_DEBUG_PRINT("MQTT discovery config too large")
+            continue;
+        }
+        if (!MqttClient.beginPublish(configTopic.c_str(), counter.Count(), true))
+            continue;
+        ChunkedPrint out(MqttSendChunk);
+        Inverter.CreateDiscoveryJson(out, reg, stateTopic.c_str(), deviceId.c_str());
+        out.flush();
+        MqttClient.endPublish();
+    }
+}
+
+void MqttPublishRegisters(bool full)
+{
+    char payload[16];
+
+    for (int i = 0; i < Inverter._Protocol.InputRegisterCount; i++)
+    {
+        if (Inverter.InputPublishDue(i, full))
+        {
+            Inverter.FormatValue(Inverter.GetInputRegister(i), Inverter.GetInputValue(i), payload, sizeof(payload));
+            MqttClient.publish((mqtttopic + "/" + Inverter.GetInputRegister(i).Name()).c_str(), payload, true);
+        }
+    }
+    for (int i = 0; i < Inverter._Protocol.HoldingRegisterCount; i++)
+    {
+        if (!Inverter.IsDuplicateHolding(i) && Inverter.HoldingPublishDue(i, full))
+        {
+            Inverter.FormatValue(Inverter.GetHoldingRegister(i), Inverter.GetHoldingValue(i), payload, sizeof(payload));
+            MqttClient.publish((mqtttopic + "/" + Inverter.GetHoldingRegister(i).Name()).c_str(), payload, true);
+        }
+    }
+}
+
+void MqttPublishAvailability(bool online)
+{
+    if (online == bMqttOnline)
+        return;
+    if (MqttClient.publish((mqtttopic + "/availability").c_str(), online ? "online" : "offline", true))
+        bMqttOnline = online;
+}
+#endif
+
+#if MQTT_SUPPORTED == 1
+// -------------------------------------------------------
+// Publish the JSON document without buffering it: its length is measured first,
+// then it is streamed in chunks of JSON_CHUNK_SIZE bytes
+// -------------------------------------------------------
+void MqttSendChunk(const uint8_t *data, size_t length)
+{
+    MqttClient.write(data, length);
+}
+
+// The document published to mqtttopic, JSON or with MQTT_PAYLOAD_MSGPACK MessagePack
+void MqttWriteDocument(Print &out, bool delta, const char *mac)
+{
+    #if MQTT_PAYLOAD_MSGPACK == 1
+    if (delta)
+        Inverter.CreateDeltaMsgPack(out, mac);
+    else
+        Inverter.CreateMsgPack(out, mac);
+    #else
+    if (delta)
+        Inverter.CreateDeltaJson(out, mac);
+    else
+        Inverter.CreateJson(out, mac);
+    #endif
+}
+
+bool MqttPublishJson(bool delta, bool retained)
+{
+    String mac = WiFi.macAddress();
+    CountingPrint counter;
+
+    MqttWriteDocument(counter, delta, mac.c_str());
+
+    if (!MqttClient.beginPublish(mqtttopic.c_str(), counter.Count(), retained))
+        return false;
+
+    ChunkedPrint out(MqttSendChunk);
+    MqttWriteDocument(out, delta, mac.c_str());
+    out.flush();
+    return MqttClient.endPublish() != 0;
+}
+
+#if MQTT_PAYLOAD_MSGPACK == 1
+// The MessagePack documents carry register IDs only, names, units and multipliers are
+// published once per connection (retained) to <mqtt topic>/schema
+void MqttPublishSchema()
+{
+    String topic = mqtttopic + "/schema";
+    CountingPrint counter;
+
+    Inverter.CreateSchemaJson(counter);
+    if (!MqttClient.beginPublish(topic.c_str(), counter.Count(), true))
+        return;
+
+    ChunkedPrint out(MqttSendChunk);
+    Inverter.CreateSchemaJson(out);
+    out.flush();
+    MqttClient.endPublish();
+}
+#endif
+#endif
+
 String load_from_file(const char* file_name, String defaultvalue) {
     String result = "";
 
@@ -306,6 +647,13 @@ bool write_to_file(const char* file_name, String contents) {
     return true;
 }
 
+// The update server restarts the stick once the firmware is written, the per phase energy is
+// saved while it is received (only if it changed since the last save)
+void UpdateProgress(size_t progress, size_t total)
+{
+    Inverter.SaveEnergy();
+}
+
 void saveParamCallback()
 {
     Serial.println("[CALLBACK] saveParamCallback fired");
@@ -326,6 +674,7 @@ void saveParamCallback()
 
     if (StartedConfigAfterBoot)
     {
+        Inverter.SaveEnergy();
         ESP.restart();
     }
 }
@@ -385,7 +734,11 @@ void setup()
 
     #if MQTT_SUPPORTED == 1
         // make sure the packet size is set correctly in the library
+        #if MQTT_TOPIC_PER_REGISTER == 1
+        MqttClient.setBufferSize(MQTT_REGISTER_BUFFER_SIZE);
+        #else
         MqttClient.setBufferSize(MQTT_MAX_PACKET_SIZE);
+        #endif
 
         custom_mqtt_server = new WiFiManagerParameter("server", "mqtt server", mqttserver.c_str(), 40);
         custom_mqtt_port = new WiFiManagerParameter("port", "mqtt port", mqttport.c_str(), 6);
@@ -417,6 +770,7 @@ void setup()
         #if ENABLE_DEBUG_OUTPUT == 1
             Serial.println(F("Failed to connect"));
         #endif
+        Inverter.SaveEnergy();
         ESP.restart();
     }
     else
@@ -454,86 +808,366 @@ void setup()
     #endif
     
 
-    httpServer.on("/status", SendJsonSite);
-    httpServer.on("/uistatus", SendUiJsonSite);
-    httpServer.on("/solar_api/v1/GetInverterRealtimeData.cgi", SendFroniusSite);
-    httpServer.on("/solar_api/v1/GetPowerFlowRealtimeData.fcgi", SendPowerFlowSite);
-    httpServer.on("/solar_api/v1/GetDeviceInfo.cgi", SendDeviceInfoSite);
-    httpServer.on("/solar_api/v1/GetInverterInfo.cgi", SendInverterInfoSite);
-    httpServer.on("/solar_api/v1/GetLoggerInfo.cgi", SendLoggerInfoSite);
-    httpServer.on("/solar_api/v1/GetActiveDeviceInfo.cgi", SendActiveDeviceInfoSite);
-    httpServer.on("/StartAp", StartConfigAccessPoint);
-    httpServer.on("/postCommunicationModbus", SendPostSite);
-    httpServer.on("/postCommunicationModbus_p", HTTP_POST, handlePostData);
-    httpServer.on("/", MainPage);
+    HttpOn("/status", SendJsonSite);
+    HttpOn("/schema", SendSchemaSite);
+    HttpOn("/uistatus", SendUiJsonSite);
+    HttpOn("/solar_api/v1/GetInverterRealtimeData.cgi", SendFroniusSite);
+    HttpOn("/solar_api/v1/GetPowerFlowRealtimeData.fcgi", SendPowerFlowSite);
+    HttpOn("/solar_api/v1/GetDeviceInfo.cgi", SendDeviceInfoSite);
+    HttpOn("/solar_api/v1/GetInverterInfo.cgi", SendInverterInfoSite);
+    HttpOn("/solar_api/v1/GetLoggerInfo.cgi", SendLoggerInfoSite);
+    HttpOn("/solar_api/v1/GetActiveDeviceInfo.cgi", SendActiveDeviceInfoSite);
+    #if HISTORY_SUPPORTED == 1
+        HttpOn("/history", SendHistorySite);
+    #endif
+    #if TELEMETRY_LOG_SUPPORTED == 1
+        HttpOn("/log", SendLogSite);
+    #endif
+    #if MODBUS_CAPTURE_SUPPORTED == 1
+        HttpOn("/capture", SendCaptureSite);
+    #endif
+    #if METRICS_SUPPORTED == 1
+        HttpOn("/metrics", SendMetricsSite);
+    #endif
+    #if WEB_EVENTS_SUPPORTED == 1
+        HttpOn("/events", SendEventsSite);
+    #endif
+    HttpOn("/StartAp", StartConfigAccessPoint);
+    HttpOn("/postCommunicationModbus", SendPostSite);
+    HttpOn("/postCommunicationModbus_p", HTTP_POST, handlePostData);
+    HttpOn("/registers", SendRegistersSite);
+    HttpOn("/", MainPage);
+    HttpOn("/chart.js", SendChartLibrary);
+    // for the revalidation of the cached web UI
+    const char *headerKeys[] = {"If-None-Match"};
+    httpServer.collectHeaders(headerKeys, 1);
     #if ENABLE_WEB_DEBUG == 1
-        httpServer.on("/debug", SendDebug);
+        HttpOn("/debug", SendDebug);
     #endif
 
     Inverter.InitProtocol();
+    #if HISTORY_SUPPORTED == 1
+        if (!History.Begin(Inverter))
+            WEB_DEBUG_PRINT("Not enough memory for the history")
+    #endif
+    #if TELEMETRY_LOG_SUPPORTED == 1
+        Telemetry.Begin(Inverter);
+    #endif
+    #if METRICS_SUPPORTED == 1
+        Metrics.Begin();
+    #endif
+    #if MODBUS_CAPTURE_SUPPORTED == 1 || METRICS_SUPPORTED == 1
+        Inverter.SetModbusTrace(ModbusRequestDone);
+    #endif
     InverterReconnect();
-#if GROWATT_MODBUS_VERSION == 125
-    Inverter.ConfigureExportLimit(100);
-#endif
 
     httpUpdater.setup(&httpServer, update_path, UPDATE_USER, UPDATE_PASSWORD);
+    Update.onProgress(UpdateProgress);
     httpServer.begin();
+    #if MODBUS_TCP_SUPPORTED == 1
+        ModbusTcp.Begin(Inverter);
+    #endif
+
+    #if MODBUS_POLL_TASK == 1
+    InverterResults = xQueueCreate(1, sizeof(eReadState_t));
+    TaskHandle_t inverterTask = NULL;
+    xTaskCreatePinnedToCore(InverterTask, "Modbus", MODBUS_TASK_STACK_SIZE, NULL, 1, &inverterTask, MODBUS_TASK_CORE);
+    #if METRICS_SUPPORTED == 1
+    Metrics.SetModbusTask(inverterTask);
+    #endif
+    #endif
+}
+
+// Registers a page of the web server, with METRICS_SUPPORTED the time its handler takes is
+// measured for /metrics
+void HttpOn(const char *uri, HTTPMethod method, void (*handler)(void))
+{
+    #if METRICS_SUPPORTED == 1
+    uint8_t route = Metrics.AddRoute(uri);
+    httpServer.on(uri, method, [route, handler]() {
+        uint32_t start = micros();
+        handler();
+        Metrics.HttpRequest(route, micros() - start);
+    });
+    #else
+    httpServer.on(uri, method, handler);
+    #endif
+}
+
+void HttpOn(const char *uri, void (*handler)(void))
+{
+    HttpOn(uri, HTTP_ANY, handler);
+}
+
+// -------------------------------------------------------
+// JSON documents and the log are streamed to the client in chunks of JSON_CHUNK_SIZE bytes
+// -------------------------------------------------------
+void HttpSendChunk(const uint8_t *data, size_t length)
+{
+    httpServer.sendContent((const char *)data, length);
+}
+
+void HttpBeginChunked(const char *type)
+{
+    httpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    httpServer.send(200, type, "");
+}
+
+void HttpBeginJson(void)
+{
+    HttpBeginChunked("application/json");
+}
+
+void HttpEndChunked(ChunkedPrint &out)
+{
+    out.flush();
+    // an empty chunk ends the response
+    httpServer.sendContent("");
+}
+
+void SendJsonDocument(eJsonDocument_t document)
+{
+    #if HTTP_RESPONSE_CACHE == 1
+    // rendered once per read cycle, afterwards it is only copied to the client
+    const char *json;
+    size_t length;
+    if (Inverter.GetCachedJson(document, WiFi.macAddress().c_str(), &json, &length))
+    {
+        httpServer.setContentLength(length);
+        httpServer.send(200, "application/json", "");
+        httpServer.sendContent(json, length);
+        return;
+    }
+    #endif
+
+    ChunkedPrint out(HttpSendChunk);
+
+    HttpBeginJson();
+    Inverter.CreateJsonDocument(document, out, WiFi.macAddress().c_str());
+    HttpEndChunked(out);
+}
+
+#if TELEMETRY_LOG_SUPPORTED == 1
+// Telemetry log as CSV, ?format=bin for the raw segments, &segment=<n> for a single segment
+void SendLogSite(void)
+{
+    bool csv = !(httpServer.hasArg("format") && httpServer.arg("format") == "bin");
+    int32_t segment = -1;
+
+    if (httpServer.hasArg("segment"))
+        segment = httpServer.arg("segment").toInt();
+
+    ChunkedPrint out(HttpSendChunk);
+
+    HttpBeginChunked(csv ? "text/csv" : "application/octet-stream");
+    Telemetry.Export(out, csv, segment);
+    HttpEndChunked(out);
+}
+#endif
+
+#if MODBUS_CAPTURE_SUPPORTED == 1 || METRICS_SUPPORTED == 1
+// Every completed Modbus request, with MODBUS_POLL_TASK called by the polling task
+void ModbusRequestDone(const sModbusTransaction_t &transaction)
+{
+    #if METRICS_SUPPORTED == 1
+    Metrics.ModbusRequest(transaction);
+    #endif
+    #if MODBUS_CAPTURE_SUPPORTED == 1
+    Capture.Add(transaction);
+    #endif
+}
+#endif
+
+#if METRICS_SUPPORTED == 1
+// Counters, latency histograms, heap and stack in the text format of Prometheus
+void SendMetricsSite(void)
+{
+    ChunkedPrint out(HttpSendChunk);
+
+    HttpBeginChunked("text/plain; version=0.0.4");
+    Metrics.Write(out);
+    HttpEndChunked(out);
+}
+#endif
+
+#if MODBUS_CAPTURE_SUPPORTED == 1
+// Recording of the Modbus traffic: ?action=start replaces the last capture, ?action=stop ends
+// it, without action the capture is downloaded (also while it is running)
+void SendCaptureSite(void)
+{
+    String action = httpServer.arg("action");
+
+    if (action == "start")
+    {
+        Capture.Start();
+        httpServer.send(200, "text/plain", Capture.Active() ? "Capture started" : "Capture could not be started");
+        return;
+    }
+    if (action == "stop")
+    {
+        Capture.Stop();
+        httpServer.send(200, "text/plain", "Capture stopped");
+        return;
+    }
+    if (Capture.Size() == 0)
+    {
+        httpServer.send(404, "text/plain", "No capture");
+        return;
+    }
+
+    ChunkedPrint out(HttpSendChunk);
+
+    httpServer.sendHeader("Content-Disposition", "attachment; filename=\"mbcap.bin\"");
+    HttpBeginChunked("application/octet-stream");
+    Capture.Export(out);
+    HttpEndChunked(out);
 }
+#endif
+
+#if WEB_EVENTS_SUPPORTED == 1
+// -------------------------------------------------------
+// Server-Sent Events: the connection of a browser is kept open and gets the values of
+// /uistatus (without names and units) after every read cycle
+// -------------------------------------------------------
+void SendEventsSite(void)
+{
+    WiFiClient client = httpServer.client();
+    int slot = -1;
+
+    for (int i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++)
+    {
+        if (!EventClients[i].connected())
+        {
+            EventClients[i].stop();
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+    {
+        // the page falls back to polling /uistatus
+        httpServer.send(503, "text/plain", "Too many subscribers");
+        return;
+    }
+
+    client.setNoDelay(true);
+    // a stalled browser must not hold up the loop for long
+    client.setTimeout(1000);
+    client.print(F("HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/event-stream\r\n"
+                   "Cache-Control: no-cache\r\n"
+                   "Connection: keep-alive\r\n\r\n"
+                   "retry: 5000\n\n"));
+    // the web server drops its reference after this handler, the copy keeps the connection
+    EventClients[slot] = client;
+}
+
+void WebEventsPublish(void)
+{
+    const char *json;
+    size_t length;
+    bool subscribed = false;
+
+    for (int i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++)
+    {
+        if (EventClients[i].connected())
+            subscribed = true;
+    }
+    // rendered once, no matter how many browsers are subscribed
+    if (!subscribed || !Inverter.GetCachedJson(JSON_UI_VALUES, "", &json, &length))
+        return;
+
+    for (int i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++)
+    {
+        if (!EventClients[i].connected())
+            continue;
+        if (EventClients[i].write((const uint8_t *)"data: ", 6) != 6 ||
+            EventClients[i].write((const uint8_t *)json, length) != length ||
+            EventClients[i].write((const uint8_t *)"\n\n", 2) != 2)
+        {
+            EventClients[i].stop();
+        }
+    }
+}
+#endif
+
+#if HISTORY_SUPPORTED == 1
+// History of the plotted registers, ?range=<seconds back>&points=<number of points>
+void SendHistorySite(void)
+{
+    uint32_t range = 3600;
+    uint16_t points = 120;
+
+    if (httpServer.hasArg("range"))
+        range = httpServer.arg("range").toInt();
+    if (httpServer.hasArg("points"))
+        points = constrain(httpServer.arg("points").toInt(), 1, 1000);
+
+    ChunkedPrint out(HttpSendChunk);
 
+    HttpBeginJson();
+    History.CreateJson(out, range, points);
+    HttpEndChunked(out);
+}
+#endif
+
+// All registers, ?format=msgpack for the MessagePack document described by /schema
 void SendJsonSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateJson(JsonString, WiFi.macAddress().c_str());
-    httpServer.send(200, "application/json", JsonString);
+    if (httpServer.hasArg("format") && httpServer.arg("format") == "msgpack")
+    {
+        ChunkedPrint out(HttpSendChunk);
+
+        HttpBeginChunked("application/msgpack");
+        Inverter.CreateMsgPack(out, WiFi.macAddress().c_str());
+        HttpEndChunked(out);
+        return;
+    }
+    SendJsonDocument(JSON_STATUS);
+}
+
+void SendSchemaSite(void)
+{
+    ChunkedPrint out(HttpSendChunk);
+
+    HttpBeginJson();
+    Inverter.CreateSchemaJson(out);
+    HttpEndChunked(out);
 }
 
 void SendUiJsonSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateUIJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_UI_STATUS);
 }
 
 void SendFroniusSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateFroniusJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_FRONIUS);
 }
 
 void SendPowerFlowSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreatePowerFlowJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_POWER_FLOW);
 }
 
 void SendDeviceInfoSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateDeviceInfoJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_DEVICE_INFO);
 }
 
 void SendInverterInfoSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateInverterInfoJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_INVERTER_INFO);
 }
 
 void SendLoggerInfoSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateLoggerInfoJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_LOGGER_INFO);
 }
 
 void SendActiveDeviceInfoSite(void)
 {
-    JsonString[0] = '\0';
-    Inverter.CreateActiveDeviceInfoJson(JsonString);
-    httpServer.send(200, "application/json", JsonString);
+    SendJsonDocument(JSON_ACTIVE_DEVICE_INFO);
 }
 
 void StartConfigAccessPoint(void)
@@ -552,9 +1186,33 @@ void SendDebug(void)
 }
 #endif
 
+// -------------------------------------------------------
+// The web UI is stored gzip compressed (index.h, built from web/ by web_assets.py)
+// and revalidated by the browser with its ETag
+// -------------------------------------------------------
+void SendCompressedAsset(const uint8_t *data, size_t length, const char *type, const char *etag, bool immutable)
+{
+    httpServer.sendHeader("ETag", etag);
+    // the chart library is requested with its ETag as version, the page itself after
+    // a firmware update has to be fetched again
+    httpServer.sendHeader("Cache-Control", immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    if (httpServer.header("If-None-Match") == etag)
+    {
+        httpServer.send(304, type, "");
+        return;
+    }
+    httpServer.sendHeader("Content-Encoding", "gzip");
+    httpServer.send_P(200, type, (PGM_P)data, length);
+}
+
 void MainPage(void)
 {
-    httpServer.send(200, "text/html", MAIN_page);
+    SendCompressedAsset(INDEX_HTML_GZ, sizeof(INDEX_HTML_GZ), INDEX_HTML_TYPE, INDEX_HTML_ETAG, false);
+}
+
+void SendChartLibrary(void)
+{
+    SendCompressedAsset(CHART_JS_GZ, sizeof(CHART_JS_GZ), CHART_JS_TYPE, CHART_JS_ETAG, true);
 }
 
 void SendPostSite(void)
@@ -574,29 +1232,63 @@ void SendPostSite(void)
     httpServer.sendContent("<h3>Input Registers</h3><table border=\"1\"><tr><th>Name</th><th>Address</th><th>Value</th></tr>");
     for (int i = 0; i < Inverter._Protocol.InputRegisterCount; i++)
     {
-        httpServer.sendContent("<tr><td>" + String(Inverter._Protocol.InputRegisters[i].name) + "</td><td>" +
-                               String(Inverter._Protocol.InputRegisters[i].address) + "</td><td>" +
-                               String(Inverter._Protocol.InputRegisters[i].value) + "</td></tr>");
+        httpServer.sendContent("<tr><td>" + String(Inverter._Protocol.InputRegisters[i].Name()) + "</td><td>" +
+                               String(Inverter._Protocol.InputRegisters[i].Address()) + "</td><td>" +
+                               String(Inverter._Protocol.InputValues[i]) + "</td></tr>");
     }
     httpServer.sendContent("</table>");
 
     httpServer.sendContent("<h3>Holding Registers</h3><table border=\"1\"><tr><th>Name</th><th>Address</th><th>Value</th></tr>");
     for (int i = 0; i < Inverter._Protocol.HoldingRegisterCount; i++)
     {
-        httpServer.sendContent("<tr><td>" + String(Inverter._Protocol.HoldingRegisters[i].name) + "</td><td>" +
-                               String(Inverter._Protocol.HoldingRegisters[i].address) + "</td><td>" +
-                               String(Inverter._Protocol.HoldingRegisters[i].value) + "</td></tr>");
+        httpServer.sendContent("<tr><td>" + String(Inverter._Protocol.HoldingRegisters[i].Name()) + "</td><td>" +
+                               String(Inverter._Protocol.HoldingRegisters[i].Address()) + "</td><td>" +
+                               String(Inverter._Protocol.HoldingValues[i]) + "</td></tr>");
     }
     httpServer.sendContent("</table>");
 }
 
+// Many registers in one request: ?input=0-10,35&holding=30 (addresses and ranges). Registers
+// the last read cycle read at most max_age seconds ago are taken from its values (by default
+// of any age, 0 reads all from the inverter), the others are read in as few requests as possible:
+// at most REGISTER_BATCH_MAX_REQUESTS and none after a read timed out
+void SendRegistersSite(void)
+{
+    RegisterBatch batch;
+    uint32_t maxAge = UINT32_MAX;
+
+    if (!batch.Add(false, httpServer.arg("input").c_str()) || !batch.Add(true, httpServer.arg("holding").c_str()))
+    {
+        httpServer.send(400, "text/plain", "400: Invalid register list");
+        return;
+    }
+    if (httpServer.hasArg("max_age"))
+    {
+        // negative ages read all from the inverter, large ones accept any age
+        long seconds = httpServer.arg("max_age").toInt();
+        if (seconds < 0)
+            seconds = 0;
+        maxAge = ((unsigned long)seconds < UINT32_MAX / 1000) ? seconds * 1000UL : UINT32_MAX;
+    }
+    if (!batch.Read(Inverter, maxAge))
+    {
+        httpServer.send(503, "text/plain", "503: Not enough memory");
+        return;
+    }
+
+    ChunkedPrint out(HttpSendChunk);
+
+    HttpBeginJson();
+    batch.Write(out);
+    HttpEndChunked(out);
+}
+
 void handlePostData()
 {
-    char* msg;
+    char msg[128];
     uint16_t u16Tmp;
     uint32_t u32Tmp;
 
-    msg = JsonString;
     msg[0] = 0;
 
     if (!httpServer.hasArg("reg") || !httpServer.hasArg("val"))
@@ -626,7 +1318,7 @@ void handlePostData()
                 {
                     if (Inverter.ReadInputReg(httpServer.arg("reg").toInt(), &u32Tmp))
                     {
-                        sprintf(msg, "Read 32b Input register %ld with value %d", httpServer.arg("reg").toInt(), u32Tmp);
+                        sprintf(msg, "Read 32b Input register %ld with value %lu", httpServer.arg("reg").toInt(), (unsigned long)u32Tmp);
                     }
                     else
                     {
@@ -651,7 +1343,7 @@ void handlePostData()
                 {
                     if (Inverter.ReadHoldingReg(httpServer.arg("reg").toInt(), &u32Tmp))
                     {
-                        sprintf(msg, "Read 32b Holding register %ld with value %d", httpServer.arg("reg").toInt(), u32Tmp);
+                        sprintf(msg, "Read 32b Holding register %ld with value %lu", httpServer.arg("reg").toInt(), (unsigned long)u32Tmp);
                     }
                     else
                     {
@@ -691,22 +1383,214 @@ void handlePostData()
 }
 
 // -------------------------------------------------------
+// A read cycle of the inverter succeeded, publish the new data
+void InverterReadoutDone(void)
+{
+    WEB_DEBUG_PRINT("ReadData() successful")
+    u16PacketCnt++;
+
+    #if HISTORY_SUPPORTED == 1
+    History.Add();
+    #endif
+    #if TELEMETRY_LOG_SUPPORTED == 1
+    Telemetry.Add();
+    #endif
+    #if WEB_EVENTS_SUPPORTED == 1
+    WebEventsPublish();
+    #endif
+
+    #if MQTT_SUPPORTED == 1 && METRICS_SUPPORTED == 1
+    bool mqttPublish = MqttClient.connected();
+    uint32_t mqttStart = micros();
+    #endif
+
+    #if MQTT_TOPIC_PER_REGISTER == 1
+    // Plain values on one topic per register, with MQTT_DELTA_PUBLISH only the changed ones
+    #if MQTT_DELTA_PUBLISH == 1
+    bool fullSnapshot = (u16SnapshotCycle == 0);
+    if (++u16SnapshotCycle >= MQTT_FULL_SNAPSHOT_INTERVAL)
+        u16SnapshotCycle = 0;
+    #else
+    bool fullSnapshot = true;
+    #endif
+
+    #if MQTT_SUPPORTED == 1
+    if (MqttClient.connected())
+    {
+        MqttPublishRegisters(fullSnapshot || bMqttRepublish);
+        bMqttRepublish = false;
+        MqttPublishAvailability(true);
+    }
+    #endif
+    #elif MQTT_DELTA_PUBLISH == 1
+    // Changed registers only, every MQTT_FULL_SNAPSHOT_INTERVAL cycles the complete
+    // document is published retained, so new subscribers start from a full state
+    #if MQTT_SUPPORTED == 1
+    bool fullSnapshot = (u16SnapshotCycle == 0);
+    if (++u16SnapshotCycle >= MQTT_FULL_SNAPSHOT_INTERVAL)
+        u16SnapshotCycle = 0;
+
+    // PrepareDeltaJson() takes the changes as sent, so it is only called when they can be. The
+    // changes missed during an outage or by a failed publish are covered by a full document
+    fullSnapshot = fullSnapshot || bMqttRepublish;
+    if (MqttClient.connected() && Inverter.PrepareDeltaJson(fullSnapshot))
+        bMqttRepublish = !MqttPublishJson(true, fullSnapshot);
+    #endif
+    #else
+    #if MQTT_SUPPORTED == 1
+    if (MqttClient.connected())
+        MqttPublishJson(false, true);
+    #endif
+    #endif
+
+    #if MQTT_SUPPORTED == 1 && METRICS_SUPPORTED == 1
+    if (mqttPublish)
+        Metrics.MqttPublish(micros() - mqttStart);
+    #endif
+
+    digitalWrite(LED_RT, 0); // clear red led if everything is ok
+
+    #if MODBUS_PROBE_FRAGMENT_SIZE == 1
+        InverterFrameSizeReport();
+    #endif
+}
+
+// All read cycles of the inverter failed
+void InverterReadoutFailed(void)
+{
+    WEB_DEBUG_PRINT("ReadData() NOT successful")
+    #if MQTT_SUPPORTED == 1
+    if (MqttClient.connected())
+    {
+        #if MQTT_TOPIC_PER_REGISTER == 1
+        MqttPublishAvailability(false);
+        #else
+        MqttClient.publish(mqtttopic.c_str(), MQTT_STATUS_OFFLINE, true);
+        #endif
+    }
+    #endif
+    digitalWrite(LED_RT, 1); // set red led in case of error
+    #if MODBUS_PROBE_FRAGMENT_SIZE == 1
+        InverterFrameSizeReport();
+    #endif
+}
+
+// Modbus side of the main loop: detection of the inverter, the read cycles and their retries.
+// Returns READ_SUCCEEDED when a read cycle succeeded, READ_FAILED when all retries failed.
+// With MODBUS_POLL_TASK it runs in InverterTask(): nothing but the Modbus communication and the
+// metrics, the results are handled by loop()
+// -------------------------------------------------------
+long InverterTimer = 0;
+long InverterRetryTimer = 0;
+// stick set up by InverterDetected(), read by the polling task
+volatile eDevice_t eDetectedStick = Undef_stick;
+
+// A stick was detected by the Modbus communication (in InverterLoop()): set up the inverter
+// from loop(), the read cycles start afterwards
+void InverterCheckDetected(void)
+{
+    eDevice_t stick = Inverter.GetWiFiStickType();
+
+    if (stick != eDetectedStick)
+    {
+        if (stick != Undef_stick)
+            InverterDetected();
+        eDetectedStick = stick;
+    }
+}
+
+eReadState_t InverterLoop(long now)
+{
+    eReadState_t result = READ_IDLE;
+
+    // Retry the detection of the inverter every two minutes
+    if ((now - InverterRetryTimer) > WIFI_RETRY_TIMER)
+    {
+        if (Inverter.GetWiFiStickType() == Undef_stick)
+            InverterReconnect();
+        InverterRetryTimer = now;
+    }
+
+    switch (Inverter.Poll())
+    {
+        case READ_SUCCEEDED:
+            #if METRICS_SUPPORTED == 1
+            Metrics.ReadCycle(true, Inverter.GetCycleDuration());
+            #endif
+            u8RetryCounter = NUM_OF_RETRIES;
+            result = READ_SUCCEEDED;
+            break;
+        case READ_FAILED:
+            #if METRICS_SUPPORTED == 1
+            // every attempt counts, also the ones retried
+            Metrics.ReadCycle(false, Inverter.GetCycleDuration());
+            #endif
+            if (--u8RetryCounter > 0)
+            {
+                Inverter.StartReadData();
+            }
+            else
+            {
+                u8RetryCounter = NUM_OF_RETRIES;
+                result = READ_FAILED;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Read Inverter every REFRESH_TIMER ms [defined in config.h], once loop() set it up
+    if ((now - InverterTimer) > REFRESH_TIMER)
+    {
+        if ((WiFi.status() == WL_CONNECTED) && (Inverter.GetWiFiStickType()) &&
+            (Inverter.GetWiFiStickType() == eDetectedStick))
+        {
+            #if SIMULATE_INVERTER == 1
+                result = READ_SUCCEEDED; // do it always
+            #else
+                // a cycle still running from the last interval is not restarted
+                if (Inverter.StartReadData())
+                    u8RetryCounter = NUM_OF_RETRIES;
+            #endif
+        }
+        InverterTimer = now;
+    }
+
+    return result;
+}
+
+#if MODBUS_POLL_TASK == 1
+// The Modbus communication on its own core. The register values reach loop() as complete
+// snapshots (s. Inverter.AcquireSnapshot()), a blocked loop() doesn't delay the polling
+void InverterTask(void *parameter)
+{
+    for (;;)
+    {
+        eReadState_t result = InverterLoop(millis());
+        if (result != READ_IDLE)
+            xQueueOverwrite(InverterResults, &result);
+        vTaskDelay(1);
+    }
+}
+#endif
+
 // Main loop
 // -------------------------------------------------------
 long ButtonTimer = 0;
 long LEDTimer = 0;
 long RefreshTimer = 0;
-long WifiRetryTimer = 0;
-uint8_t refreshCycle = 0;
 
 void loop()
 {
+    #if METRICS_SUPPORTED == 1
+    uint32_t loopStart = micros();
+    #endif
+
     #ifdef ENABLE_DOUBLE_RESET
     drd->loop();
     #endif
 
     long now = millis();
-    char readoutSucceeded;
 
     if ((now - ButtonTimer) > BUTTON_TIMER)
     {
@@ -746,6 +1630,7 @@ void loop()
         wm.startConfigPortal("GrowattConfig", APPassword);
         digitalWrite(LED_BL, 0);
         delay(3000);
+        Inverter.SaveEnergy();
         ESP.restart();
     }
 
@@ -760,6 +1645,10 @@ void loop()
 
     httpServer.handleClient();
 
+    #if MODBUS_TCP_SUPPORTED == 1
+        ModbusTcp.Loop();
+    #endif
+
     // Toggle green LED with 1 Hz (alive)
     // ------------------------------------------------------------
     if ((now - LEDTimer) > LED_TIMER)
@@ -772,72 +1661,27 @@ void loop()
         LEDTimer = now;
     }
 
-    // InverterReconnect() takes a long time --> wifi will crash
-    // Do it only every two minutes
-    if ((now - WifiRetryTimer) > WIFI_RETRY_TIMER)
-    {
-        if (Inverter.GetWiFiStickType() == Undef_stick)
-            InverterReconnect();
-        WifiRetryTimer = now;
-    }
+    // Carry out the Modbus communication with the inverter step by step, returns immediately.
+    // With MODBUS_POLL_TASK it runs in InverterTask(), only the results are handled here
+    // ------------------------------------------------------------
+    #if MODBUS_POLL_TASK == 1
+    eReadState_t result = READ_IDLE;
+    xQueueReceive(InverterResults, &result, 0);
+    Inverter.AcquireSnapshot();
+    #else
+    eReadState_t result = InverterLoop(now);
+    #endif
+    InverterCheckDetected();
 
-    // Read Inverter every REFRESH_TIMER ms [defined in config.h]
+    if (result == READ_SUCCEEDED)
+        InverterReadoutDone();
+    else if (result == READ_FAILED)
+        InverterReadoutFailed();
+
+    // Check the connections every REFRESH_TIMER ms [defined in config.h]
     // ------------------------------------------------------------
     if ((now - RefreshTimer) > REFRESH_TIMER)
     {
-        if ((WiFi.status() == WL_CONNECTED) && (Inverter.GetWiFiStickType()))
-        {
-            readoutSucceeded = 0;
-            bool fullRead = (refreshCycle % FULL_READ_INTERVAL) == 0;
-            refreshCycle++;
-            while ((u8RetryCounter) && !(readoutSucceeded))
-            {
-                #if SIMULATE_INVERTER == 1
-                if (1) // do it always
-                #else
-                if (Inverter.ReadData(fullRead)) // get new data from inverter
-                #endif
-                {
-                    WEB_DEBUG_PRINT("ReadData() successful")
-                    u16PacketCnt++;
-                    u8RetryCounter = NUM_OF_RETRIES;
-
-
-                    // Create JSON string
-                    JsonString[0] = '\0';
-                    Inverter.CreateJson(JsonString, WiFi.macAddress().c_str());
-
-                    #if MQTT_SUPPORTED == 1
-                    if (MqttClient.connected())
-                        MqttClient.publish(mqtttopic.c_str(), JsonString, true);
-                    #endif
-
-                    digitalWrite(LED_RT, 0); // clear red led if everything is ok
-                    // leave while-loop
-                    readoutSucceeded = 1;
-                }
-                else
-                {
-                    WEB_DEBUG_PRINT("ReadData() NOT successful")
-                    if (u8RetryCounter)
-                    {
-                        u8RetryCounter--;
-                    }
-                    else
-                    {
-                        WEB_DEBUG_PRINT("Retry counter\n")
-                        sprintf(JsonString, "{\"InverterStatus\": -1 }");
-                        #if MQTT_SUPPORTED == 1
-                        if (MqttClient.connected())
-                            MqttClient.publish(mqtttopic.c_str(), JsonString, true);
-                        #endif
-                        digitalWrite(LED_RT, 1); // set red led in case of error
-                    }
-                }
-            }
-            u8RetryCounter = NUM_OF_RETRIES;
-        }
-
         #if MQTT_SUPPORTED == 1
             if (!MqttClient.connected())
                 digitalWrite(LED_RT, 1);
@@ -853,4 +1697,8 @@ void loop()
 
         RefreshTimer = now;
     }
+
+    #if METRICS_SUPPORTED == 1
+    Metrics.LoopIteration(micros() - loopStart);
+    #endif
 }
\ No newline at end of file
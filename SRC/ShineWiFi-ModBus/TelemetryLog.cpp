@@ -0,0 +1,378 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <time.h>
+
+#include "TelemetryLog.h"
+#include "Growatt.h"
+#include "Config.h"
+
+#ifndef TELEMETRY_LOG_INTERVAL
+#define TELEMETRY_LOG_INTERVAL 12
+#endif
+#ifndef TELEMETRY_LOG_BUFFER_SIZE
+#define TELEMETRY_LOG_BUFFER_SIZE 512
+#endif
+#ifndef TELEMETRY_SEGMENT_SIZE
+#define TELEMETRY_SEGMENT_SIZE 16384
+#endif
+#ifndef TELEMETRY_MAX_SEGMENTS
+#define TELEMETRY_MAX_SEGMENTS 16
+#endif
+
+// Records are written once the time has been set by NTP (2020-09-13)
+#define TELEMETRY_VALID_TIME 1600000000UL
+
+static void _SegmentName(uint8_t slot, char *name, size_t size) {
+  snprintf(name, size, "/tlog%u.bin", slot);
+}
+
+// Reads a segment file through a small buffer
+class SegmentReader {
+  public:
+    SegmentReader(File &file) : _File(file), _Pos(0), _Len(0) {}
+
+    bool Byte(uint8_t &c) {
+      if (_Pos == _Len) {
+        int len = _File.read(_Buf, sizeof(_Buf));
+        if (len <= 0)
+          return false;
+        _Len = len;
+        _Pos = 0;
+      }
+      c = _Buf[_Pos++];
+      return true;
+    }
+
+    bool Varint(uint32_t &value) {
+      uint8_t c;
+      value = 0;
+      for (int shift = 0; shift < 35; shift += 7) {
+        if (!Byte(c))
+          return false;
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+          return true;
+      }
+      return false;
+    }
+
+  private:
+    File &_File;
+    uint8_t _Buf[64];
+    uint8_t _Pos;
+    uint8_t _Len;
+};
+
+TelemetryLog::TelemetryLog() {
+  _Inverter = NULL;
+  _RegisterCount = 0;
+  _Cycle = 0;
+  _Buffer = NULL;
+  _BufferSize = 0;
+  _Length = 0;
+  _Slot = TELEMETRY_MAX_SEGMENTS - 1;
+  _Sequence = 0;
+  _SegmentLength = 0;
+  _SegmentStarted = false;
+  _Values = NULL;
+  _LastTime = 0;
+  _LastDelta = 0;
+  _FirstRecord = true;
+}
+
+void TelemetryLog::Begin(Growatt &inverter) {
+  /**
+   * @brief Allocate the batch buffer and find the newest segment, logging continues with a
+   *        new segment after it. To be called after Growatt::InitProtocol() and mounting the
+   *        file system.
+   */
+  uint32_t sequence;
+  uint8_t count;
+  uint16_t protocol;
+
+  _Inverter = &inverter;
+  _RegisterCount = inverter._Protocol.InputRegisterCount;
+
+  // a record with all registers changed has to fit behind a segment header
+  _BufferSize = TELEMETRY_HEADER_SIZE + 5 + (_RegisterCount + 7) / 8 + 5 * _RegisterCount;
+  if (_BufferSize < TELEMETRY_LOG_BUFFER_SIZE)
+    _BufferSize = TELEMETRY_LOG_BUFFER_SIZE;
+  _Buffer = (uint8_t *)malloc(_BufferSize);
+  _Values = (uint32_t *)calloc(_RegisterCount + 1, sizeof(uint32_t));
+
+  for (uint8_t slot = 0; slot < TELEMETRY_MAX_SEGMENTS; slot++) {
+    if (_ReadHeader(slot, &sequence, &count, &protocol) && sequence > _Sequence) {
+      _Sequence = sequence;
+      _Slot = slot;
+    }
+  }
+}
+
+void TelemetryLog::Add() {
+  /**
+   * @brief Log the input registers of a completed read cycle, every TELEMETRY_LOG_INTERVAL
+   *        calls. The record is collected in RAM, the file system is only written when the
+   *        batch buffer is full or the segment is complete.
+   */
+  uint8_t maskBytes = (_RegisterCount + 7) / 8;
+  size_t worst = 5 + maskBytes + 5 * _RegisterCount;
+  uint32_t now;
+
+  if (_Buffer == NULL || _Values == NULL)
+    return;
+  if (++_Cycle < TELEMETRY_LOG_INTERVAL)
+    return;
+  _Cycle = 0;
+
+  now = time(nullptr);
+  if (now < TELEMETRY_VALID_TIME)
+    return;
+
+  if (!_SegmentStarted || _SegmentLength + _Length + worst > TELEMETRY_SEGMENT_SIZE) {
+    Flush();
+    _StartSegment();
+  }
+  if (_Length + worst > _BufferSize)
+    Flush();
+
+  int32_t delta = now - _LastTime;
+  int32_t dod = delta - _LastDelta;
+  _PutVarint(((uint32_t)dod << 1) ^ (uint32_t)(dod >> 31));
+  _LastTime = now;
+  _LastDelta = _FirstRecord ? 0 : delta;
+  _FirstRecord = false;
+
+  size_t mask = _Length;
+  memset(&_Buffer[mask], 0, maskBytes);
+  _Length += maskBytes;
+  for (int i = 0; i < _RegisterCount; i++) {
+    uint32_t value = _Inverter->GetInputValue(i);
+    uint32_t change = value ^ _Values[i];
+    if (change != 0) {
+      _Buffer[mask + (i >> 3)] |= 1 << (i & 7);
+      _PutVarint(change);
+      _Values[i] = value;
+    }
+  }
+}
+
+void TelemetryLog::_PutVarint(uint32_t value) {
+  while (value >= 0x80) {
+    _Put((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  _Put(value);
+}
+
+void TelemetryLog::_StartSegment() {
+  /**
+   * @brief Begin a new segment in the next file of the ring, replacing the oldest segment.
+   *        The batch buffer has to be empty.
+   */
+  char name[16];
+
+  _Slot = (_Slot + 1) % TELEMETRY_MAX_SEGMENTS;
+  _Sequence++;
+  _SegmentName(_Slot, name, sizeof(name));
+  LittleFS.remove(name);
+  _SegmentLength = 0;
+  _SegmentStarted = true;
+
+  for (int i = 0; i < 3; i++) {
+    _Put(TELEMETRY_MAGIC[i]);
+  }
+  _Put(TELEMETRY_FORMAT);
+  for (int i = 0; i < 32; i += 8) {
+    _Put(_Sequence >> i);
+  }
+  _Put(GROWATT_MODBUS_VERSION & 0xFF);
+  _Put(GROWATT_MODBUS_VERSION >> 8);
+  _Put(_RegisterCount);
+
+  // every segment starts from zero, so it can be decoded without its predecessors
+  memset(_Values, 0, _RegisterCount * sizeof(uint32_t));
+  _LastTime = 0;
+  _LastDelta = 0;
+  _FirstRecord = true;
+}
+
+void TelemetryLog::Flush() {
+  /**
+   * @brief Append the collected records to the current segment. If the file system can't be
+   *        written, the records are dropped and the next record starts a new segment.
+   */
+  char name[16];
+
+  if (_Length == 0)
+    return;
+
+  _SegmentName(_Slot, name, sizeof(name));
+  File file = LittleFS.open(name, "a");
+  if (file && file.write(_Buffer, _Length) == _Length) {
+    _SegmentLength += _Length;
+  } else {
+    _SegmentStarted = false;
+  }
+  if (file)
+    file.close();
+  _Length = 0;
+}
+
+bool TelemetryLog::_ReadHeader(uint8_t slot, uint32_t *sequence, uint8_t *registerCount, uint16_t *protocol) {
+  /**
+   * @brief Read the header of the segment in a slot of the ring
+   * @returns false if the slot is empty or does not hold a segment of this format
+   */
+  char name[16];
+  uint8_t header[TELEMETRY_HEADER_SIZE];
+
+  _SegmentName(slot, name, sizeof(name));
+  if (!LittleFS.exists(name))
+    return false;
+  File file = LittleFS.open(name, "r");
+  if (!file)
+    return false;
+  bool ok = (file.read(header, sizeof(header)) == sizeof(header)) &&
+            memcmp(header, TELEMETRY_MAGIC, 3) == 0 && header[3] == TELEMETRY_FORMAT;
+  file.close();
+  if (!ok)
+    return false;
+
+  *sequence = header[4] | (header[5] << 8) | ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+  *protocol = header[8] | (header[9] << 8);
+  *registerCount = header[10];
+  return true;
+}
+
+void TelemetryLog::Export(Print &out, bool csv, int32_t segment) {
+  /**
+   * @brief Write the log oldest segment first, file by file through a small buffer
+   * @param csv true: decoded as CSV with a column per input register, segments of another
+   *        protocol are skipped. false: the segment files as they are, each with its header
+   * @param segment sequence number of a single segment, -1 for all
+   */
+  uint32_t last = 0;
+
+  Flush();
+
+  if (csv) {
+    out.print(F("Time"));
+    for (int i = 0; i < _RegisterCount; i++) {
+      out.write(',');
+      out.print(_Inverter->GetInputRegister(i).Name());
+    }
+    out.write('\n');
+  }
+
+  for (;;) {
+    // next segment in order of the sequence numbers
+    uint32_t next = UINT32_MAX;
+    uint8_t nextSlot = 0;
+    for (uint8_t slot = 0; slot < TELEMETRY_MAX_SEGMENTS; slot++) {
+      uint32_t sequence;
+      uint8_t count;
+      uint16_t protocol;
+      if (_ReadHeader(slot, &sequence, &count, &protocol) && sequence > last && sequence < next) {
+        next = sequence;
+        nextSlot = slot;
+      }
+    }
+    if (next == UINT32_MAX)
+      break;
+    last = next;
+
+    if (segment >= 0 && next != (uint32_t)segment)
+      continue;
+    if (csv)
+      _ExportCsv(out, nextSlot);
+    else
+      _ExportRaw(out, nextSlot);
+  }
+}
+
+void TelemetryLog::_ExportRaw(Print &out, uint8_t slot) {
+  char name[16];
+  uint8_t buffer[64];
+  int len;
+
+  _SegmentName(slot, name, sizeof(name));
+  File file = LittleFS.open(name, "r");
+  if (!file)
+    return;
+  while ((len = file.read(buffer, sizeof(buffer))) > 0) {
+    out.write(buffer, len);
+  }
+  file.close();
+}
+
+void TelemetryLog::_ExportCsv(Print &out, uint8_t slot) {
+  /**
+   * @brief Decode a segment record by record into CSV lines
+   */
+  char name[16];
+  char text[24];
+  uint8_t header[TELEMETRY_HEADER_SIZE];
+  uint8_t mask[16];
+  uint8_t maskBytes = (_RegisterCount + 7) / 8;
+  uint32_t *values;
+  uint32_t timestamp = 0;
+  int32_t lastDelta = 0;
+  bool first = true;
+  uint32_t zigzag;
+
+  _SegmentName(slot, name, sizeof(name));
+  File file = LittleFS.open(name, "r");
+  if (!file)
+    return;
+  SegmentReader reader(file);
+
+  for (int i = 0; i < TELEMETRY_HEADER_SIZE; i++) {
+    reader.Byte(header[i]);
+  }
+  // the register columns only fit segments of the running protocol
+  if ((header[8] | (header[9] << 8)) != GROWATT_MODBUS_VERSION || header[10] != _RegisterCount ||
+      maskBytes > sizeof(mask)) {
+    file.close();
+    return;
+  }
+  values = (uint32_t *)calloc(_RegisterCount + 1, sizeof(uint32_t));
+  if (values == NULL) {
+    file.close();
+    return;
+  }
+
+  while (reader.Varint(zigzag)) {
+    int32_t dod = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    int32_t delta = lastDelta + dod;
+    bool complete = true;
+
+    timestamp += delta;
+    lastDelta = first ? 0 : delta;
+    first = false;
+
+    for (int i = 0; i < maskBytes && complete; i++) {
+      complete = reader.Byte(mask[i]);
+    }
+    for (int i = 0; i < _RegisterCount && complete; i++) {
+      uint32_t change;
+      if (mask[i >> 3] & (1 << (i & 7))) {
+        complete = reader.Varint(change);
+        values[i] ^= change;
+      }
+    }
+    // a record cut off by a power loss
+    if (!complete)
+      break;
+
+    out.print((unsigned long)timestamp);
+    for (int i = 0; i < _RegisterCount; i++) {
+      out.write(',');
+      Growatt::FormatValue(_Inverter->GetInputRegister(i), values[i], text, sizeof(text));
+      out.print(text);
+    }
+    out.write('\n');
+  }
+
+  free(values);
+  file.close();
+}
@@ -0,0 +1,54 @@
+#ifndef _TELEMETRY_LOG_H_
+#define _TELEMETRY_LOG_H_
+
+#include <Arduino.h>
+
+class Growatt;
+
+// Segment header: magic, format version, sequence number, protocol version, register count
+#define TELEMETRY_MAGIC "GWL"
+#define TELEMETRY_FORMAT 1
+#define TELEMETRY_HEADER_SIZE 11
+
+// Append-only log of the input registers in the file system. The log is split into segments
+// of fixed maximal size kept in a ring of files, every segment can be decoded on its own.
+// Record: zigzag varint of the delta-of-delta of the time (the first record of a segment
+// carries the absolute time), a bit mask of the registers that changed, and for each of them
+// the varint of the value XORed with its previous value.
+class TelemetryLog {
+  public:
+    TelemetryLog();
+
+    void Begin(Growatt &inverter);
+    void Add();
+    void Flush();
+    void Export(Print &out, bool csv, int32_t segment);
+
+  private:
+    Growatt *_Inverter;
+    uint8_t _RegisterCount;
+    uint16_t _Cycle;
+    // records not written yet
+    uint8_t *_Buffer;
+    size_t _BufferSize;
+    size_t _Length;
+    // current segment: slot in the ring of files, sequence number and bytes already written
+    uint8_t _Slot;
+    uint32_t _Sequence;
+    size_t _SegmentLength;
+    bool _SegmentStarted;
+    // encoder state
+    uint32_t *_Values;
+    uint32_t _LastTime;
+    int32_t _LastDelta;
+    bool _FirstRecord;
+
+    void _StartSegment();
+    void _Put(uint8_t c) { _Buffer[_Length++] = c; }
+    void _PutVarint(uint32_t value);
+    bool _ReadHeader(uint8_t slot, uint32_t *sequence, uint8_t *registerCount, uint16_t *protocol);
+    void _ExportCsv(Print &out, uint8_t slot);
+    void _ExportRaw(Print &out, uint8_t slot);
+};
+
+#endif // _TELEMETRY_LOG_H_
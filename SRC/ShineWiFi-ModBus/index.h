@@ -1,146 +1,302 @@
-const char MAIN_page[] PROGMEM = R"=====(
-<!DOCTYPE HTML><html>
-<!-- Rui Santos - Complete project details at https://RandomNerdTutorials.com
+// Generated by web_assets.py from the files in web/, do not edit.
+// The web UI, gzip compressed, with ETags of the uncompressed files
+#ifndef _INDEX_H_
+#define _INDEX_H_
 
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files.
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software. -->
-<head>
-  <meta name="viewport" content="width=device-width, initial-scale=1">
-  <script src="https://code.highcharts.com/highcharts.js"></script>
-  <style>
-    body {
-      min-width: 310px;
-      max-width: 800px;
-      height: 400px;
-      margin: 0 auto;
-    }
-    h2 {
-      font-family: Arial;
-      font-size: 2.5rem;
-      text-align: center;
-    }
-  </style>
-</head>
-<body>
-  <h2>Growatt Inverter</h2>
-  <div id="chart-power" class="container"></div>
+// chart.js: 7308 bytes, 2664 bytes compressed
+#define CHART_JS_TYPE "application/javascript"
+#define CHART_JS_ETAG "\"7dbdc6579858da41\""
+const uint8_t CHART_JS_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x59, 0x6d, 0x6f, 0xdb, 0x38,
+  0x12, 0xfe, 0xee, 0x5f, 0xc1, 0x6e, 0x70, 0x27, 0xf9, 0xe2, 0xf7, 0x24, 0xde, 0x56, 0x8e, 0xb3,
+  0xe8, 0xe6, 0x7a, 0xd7, 0x05, 0xda, 0xee, 0xa1, 0x09, 0xee, 0xf6, 0x10, 0x04, 0x0b, 0x5a, 0xa2,
+  0x62, 0x6e, 0x64, 0x51, 0x10, 0xe9, 0xd8, 0xbe, 0x6e, 0xfe, 0xfb, 0xcd, 0x0c, 0x29, 0x89, 0x72,
+  0x9c, 0xa6, 0xb7, 0xb8, 0x2d, 0x10, 0x8b, 0xe4, 0x70, 0x38, 0xaf, 0xcf, 0x0c, 0xb9, 0xc3, 0x21,
+  0xbb, 0x5a, 0xf1, 0x2c, 0x63, 0x57, 0xff, 0xfc, 0x3b, 0xcb, 0x64, 0x2e, 0x58, 0xbc, 0xe4, 0xa5,
+  0x61, 0xa9, 0x2a, 0x99, 0x59, 0x0a, 0xa6, 0x0d, 0x37, 0x6b, 0xcd, 0x0a, 0x7e, 0x27, 0x7a, 0x6c,
+  0xb1, 0xce, 0x93, 0x4c, 0x24, 0x6c, 0x23, 0xcd, 0x92, 0x56, 0x53, 0x59, 0xae, 0x36, 0xbc, 0x04,
+  0x32, 0x45, 0x63, 0x24, 0x63, 0x1b, 0x55, 0xde, 0x6b, 0xa2, 0x51, 0x6b, 0xd3, 0x19, 0x0e, 0x99,
+  0xcc, 0x8d, 0x28, 0x73, 0x61, 0x18, 0x8f, 0x63, 0xa1, 0x75, 0xc4, 0x8c, 0x5c, 0x09, 0xc6, 0xb7,
+  0x52, 0xf7, 0x98, 0x16, 0x0f, 0xa2, 0xe4, 0x19, 0xfc, 0x96, 0x52, 0xc0, 0x98, 0xb3, 0x4c, 0xdc,
+  0x89, 0x3c, 0x61, 0x46, 0xb1, 0xa5, 0x4c, 0x84, 0x5b, 0x60, 0x1c, 0xa6, 0x38, 0xd3, 0x20, 0x9b,
+  0xc0, 0x35, 0x95, 0x19, 0x59, 0x74, 0x3a, 0x0f, 0xbc, 0x64, 0x97, 0xef, 0xdf, 0x7e, 0xbe, 0xfe,
+  0xf5, 0xf2, 0xe7, 0x0f, 0x3f, 0x7f, 0xbe, 0x62, 0x73, 0x76, 0x13, 0x1c, 0x4d, 0x62, 0x9e, 0xa6,
+  0x22, 0xe8, 0xb1, 0xe0, 0xe8, 0xec, 0xf4, 0x34, 0x8d, 0xcf, 0xe8, 0x73, 0x34, 0x12, 0x93, 0xef,
+  0x27, 0xf4, 0x99, 0x8a, 0x29, 0x3f, 0xb1, 0xb3, 0xd3, 0xc5, 0x6b, 0xbe, 0x88, 0xe9, 0x33, 0x39,
+  0x9b, 0xbe, 0x4e, 0x17, 0xf4, 0x39, 0x11, 0x62, 0x14, 0x73, 0x4b, 0xcb, 0x4f, 0x17, 0xa7, 0x93,
+  0xe0, 0x76, 0x46, 0x87, 0x81, 0x95, 0x7e, 0xfd, 0x84, 0xc7, 0x04, 0x4b, 0x63, 0x8a, 0x68, 0x38,
+  0xdc, 0x6c, 0x36, 0x83, 0xcd, 0xc9, 0x40, 0x95, 0x77, 0xc3, 0xc9, 0x68, 0x34, 0x1a, 0xea, 0x87,
+  0xbb, 0x60, 0xd6, 0xe9, 0xa4, 0xeb, 0x3c, 0x36, 0x52, 0xe5, 0xec, 0x03, 0x98, 0xf4, 0x12, 0x2d,
+  0x1a, 0xc6, 0x2a, 0x37, 0x1c, 0x46, 0x65, 0x0f, 0xf4, 0x37, 0x99, 0xe8, 0xb2, 0x2f, 0x1d, 0xc6,
+  0x90, 0xa9, 0xb5, 0xf8, 0x1c, 0x2c, 0x28, 0x35, 0xec, 0x65, 0xf4, 0x31, 0xa8, 0xe9, 0x61, 0x25,
+  0x51, 0xf1, 0x7a, 0x25, 0x72, 0x33, 0xb8, 0x13, 0xe6, 0x5d, 0x26, 0xf0, 0xf3, 0xc7, 0xdd, 0x4f,
+  0x49, 0xc3, 0xb3, 0x3b, 0xab, 0xb6, 0x11, 0x6f, 0x64, 0x86, 0xbf, 0xf5, 0xac, 0xb3, 0x22, 0x98,
+  0xe7, 0xb6, 0x9e, 0x5b, 0x0a, 0x79, 0xb7, 0xc4, 0x73, 0x4f, 0x47, 0xa3, 0x03, 0xc7, 0x0e, 0xb4,
+  0xd9, 0x65, 0x62, 0x50, 0x28, 0x2d, 0x49, 0x13, 0xd0, 0xb9, 0x14, 0x19, 0x37, 0xf2, 0x41, 0x04,
+  0xb3, 0xe7, 0xa8, 0x53, 0x18, 0x23, 0xe5, 0x78, 0x52, 0x6c, 0xd9, 0xdb, 0x52, 0xf2, 0xac, 0xa1,
+  0x75, 0x8e, 0xf5, 0xb4, 0x89, 0x4b, 0xc1, 0x8d, 0x70, 0x0a, 0x85, 0x41, 0x22, 0x1f, 0x82, 0xee,
+  0x01, 0xd6, 0xbc, 0x28, 0x60, 0xe3, 0xe5, 0x52, 0x66, 0x49, 0xe8, 0x71, 0x6a, 0x48, 0xc1, 0xe8,
+  0xcf, 0xb2, 0xfd, 0x74, 0x15, 0x5a, 0xa7, 0x81, 0x33, 0xd1, 0x39, 0xad, 0x5d, 0x4e, 0xea, 0x44,
+  0xea, 0x22, 0xe3, 0x3b, 0x14, 0x7c, 0x91, 0xa9, 0xf8, 0x3e, 0xf8, 0x16, 0x21, 0x60, 0xbb, 0x6f,
+  0xf5, 0xe2, 0x9b, 0x15, 0x03, 0x5a, 0x77, 0x6e, 0xac, 0xf5, 0xb5, 0xd8, 0x92, 0xc1, 0x2a, 0x33,
+  0x47, 0x7c, 0xa1, 0x55, 0xb6, 0x36, 0x62, 0xe6, 0x84, 0x8a, 0x72, 0x95, 0x8b, 0x59, 0xa1, 0x28,
+  0x89, 0xfa, 0x90, 0x2d, 0xb9, 0xd1, 0x76, 0x6e, 0xc1, 0xe3, 0xfb, 0xbb, 0x52, 0x41, 0x4e, 0x46,
+  0x47, 0x69, 0x9a, 0xce, 0x02, 0x76, 0x0c, 0x47, 0x30, 0xd0, 0x41, 0x95, 0x89, 0x28, 0xa3, 0x31,
+  0xb8, 0x00, 0x78, 0xc9, 0x84, 0x1d, 0xbd, 0x79, 0xf3, 0x66, 0x66, 0x67, 0xfb, 0x25, 0x4f, 0xe4,
+  0x5a, 0x47, 0x27, 0xc5, 0x76, 0x56, 0xf0, 0x24, 0x91, 0xf9, 0x5d, 0x74, 0x0a, 0xdf, 0x9b, 0xa5,
+  0x34, 0xa2, 0xaf, 0x0b, 0x1e, 0x0b, 0xe0, 0xbe, 0x29, 0x79, 0xf1, 0x4d, 0x46, 0x00, 0x5d, 0xba,
+  0x4d, 0xec, 0xa0, 0x45, 0x81, 0xe7, 0x3b, 0x14, 0xf2, 0x83, 0xd4, 0x46, 0xc0, 0x9e, 0x30, 0x58,
+  0xa9, 0xb5, 0x16, 0x2b, 0xf5, 0x80, 0x19, 0x59, 0xe5, 0x45, 0x88, 0xe1, 0x6f, 0x03, 0x7f, 0xa0,
+  0x97, 0x6a, 0x73, 0x2d, 0x0b, 0x98, 0x9a, 0xb1, 0xc7, 0xb6, 0x7b, 0x9e, 0x61, 0x96, 0x09, 0xde,
+  0xe6, 0xd6, 0x30, 0x43, 0xcc, 0x40, 0x66, 0x35, 0xaf, 0x8d, 0xcc, 0x13, 0xb5, 0x39, 0xc0, 0xa9,
+  0x14, 0x5a, 0xfe, 0xe7, 0x19, 0x2e, 0x00, 0x32, 0x25, 0xdf, 0x84, 0x6d, 0x81, 0xea, 0xc9, 0xce,
+  0x63, 0x07, 0x61, 0xad, 0x14, 0x66, 0x5d, 0xe6, 0x9a, 0x80, 0x0f, 0x0e, 0x11, 0x5b, 0xa6, 0x52,
+  0x1a, 0xe4, 0x62, 0xe3, 0x60, 0xab, 0x53, 0xa7, 0xff, 0xa0, 0x28, 0x95, 0x51, 0x66, 0x57, 0x08,
+  0x14, 0xe5, 0xaa, 0x4a, 0xc7, 0xfa, 0xec, 0x9c, 0xaf, 0x1c, 0x22, 0x78, 0xf9, 0x3a, 0x28, 0xd6,
+  0x7a, 0x19, 0x7e, 0x61, 0xb8, 0x18, 0xd1, 0xdf, 0x1e, 0x4b, 0xb8, 0xe1, 0x11, 0xa4, 0x71, 0x8f,
+  0x3d, 0x48, 0x2d, 0x17, 0x19, 0x2c, 0x98, 0x72, 0x0d, 0x0b, 0xb1, 0xca, 0x54, 0x19, 0xb5, 0xe0,
+  0xf0, 0xc6, 0xe7, 0x95, 0x89, 0xfc, 0x0e, 0x60, 0xfb, 0x4f, 0x2d, 0x0a, 0x37, 0x7b, 0xeb, 0xf4,
+  0xb4, 0x2a, 0xb1, 0x03, 0xdb, 0xfa, 0x6c, 0x0c, 0x7a, 0xcf, 0x48, 0x71, 0x27, 0xc2, 0x0d, 0xc1,
+  0xb8, 0xcc, 0xd9, 0x0a, 0x70, 0xfb, 0x81, 0x67, 0x6b, 0x01, 0x42, 0x0d, 0x06, 0x83, 0x5b, 0x9c,
+  0xe3, 0x3a, 0x86, 0x48, 0x81, 0xe8, 0x22, 0xb0, 0x3f, 0x68, 0x07, 0x2d, 0xcc, 0x5f, 0x81, 0x93,
+  0x6f, 0x05, 0x32, 0xa3, 0xd5, 0xf1, 0x89, 0x31, 0x6e, 0x68, 0xf1, 0x76, 0x90, 0xd8, 0x3d, 0xf8,
+  0x53, 0x4b, 0xa4, 0x97, 0x32, 0x35, 0x11, 0x4b, 0x4a, 0x55, 0x90, 0x07, 0x54, 0x96, 0x08, 0x6d,
+  0x18, 0x65, 0x4d, 0xaf, 0x2a, 0x4e, 0xf9, 0x7a, 0xb5, 0x00, 0x34, 0x05, 0x27, 0xd1, 0xbc, 0xc6,
+  0xda, 0xb6, 0xb3, 0xee, 0xd3, 0xfc, 0x19, 0x19, 0xc1, 0x57, 0xff, 0x40, 0xe2, 0x03, 0x42, 0x56,
+  0xcc, 0xf1, 0xe8, 0x06, 0xcb, 0x9d, 0x74, 0xcf, 0xc8, 0x8d, 0x36, 0xc6, 0x5f, 0xeb, 0x58, 0xe2,
+  0x40, 0x76, 0x97, 0x29, 0x0b, 0x3d, 0x46, 0x8e, 0x88, 0x66, 0x42, 0x22, 0x78, 0x24, 0x4d, 0xeb,
+  0xaa, 0x42, 0x51, 0x5a, 0xc1, 0x4b, 0x01, 0x35, 0x11, 0x25, 0xb1, 0xf1, 0xc1, 0x8d, 0x29, 0xe5,
+  0x02, 0x00, 0x04, 0x9c, 0x62, 0x00, 0x5c, 0x1a, 0xd1, 0x84, 0xa5, 0xff, 0x16, 0xa4, 0xa4, 0x68,
+  0xc4, 0x73, 0xb1, 0x0d, 0x08, 0x71, 0xf3, 0xbd, 0xd8, 0x91, 0x5b, 0x6b, 0xee, 0x95, 0xa4, 0x8e,
+  0x2b, 0x7a, 0xf3, 0x6d, 0xb5, 0x18, 0x02, 0xb5, 0x2f, 0xc9, 0x0d, 0x8c, 0x6f, 0x9d, 0x1e, 0x56,
+  0x59, 0x94, 0x8c, 0xbd, 0x9a, 0xcf, 0x19, 0xa0, 0x97, 0x48, 0xc1, 0xf0, 0xc9, 0x3e, 0x3f, 0xa4,
+  0xb8, 0x04, 0xe0, 0xb1, 0x12, 0xe3, 0xa8, 0xda, 0x6f, 0xf5, 0x6d, 0x61, 0x91, 0xdb, 0xe4, 0xc7,
+  0xb0, 0x9b, 0xaa, 0x92, 0x15, 0xb2, 0xbe, 0x40, 0xd7, 0x8f, 0x7b, 0x6c, 0xc2, 0x40, 0xa9, 0x33,
+  0x8a, 0x4b, 0xe8, 0x2b, 0xc0, 0x8f, 0x1b, 0x1b, 0x15, 0x70, 0x14, 0x03, 0xc8, 0x95, 0xc6, 0x60,
+  0xd8, 0x02, 0x14, 0xe6, 0xd8, 0xb9, 0x28, 0xc6, 0x17, 0xd0, 0xc7, 0x40, 0x7a, 0xad, 0x41, 0x12,
+  0x42, 0x61, 0x88, 0x75, 0xbd, 0xe7, 0x8b, 0x2b, 0x60, 0x1f, 0xe2, 0x96, 0x9e, 0x25, 0x6c, 0xac,
+  0x4e, 0x07, 0xcf, 0xd9, 0x47, 0x6e, 0x96, 0x50, 0x4b, 0x37, 0xe1, 0x78, 0xd4, 0xb3, 0x83, 0x34,
+  0x53, 0xaa, 0x0c, 0xe9, 0x33, 0x53, 0x77, 0xe3, 0x11, 0x6d, 0x67, 0x43, 0xb7, 0xbf, 0x4b, 0xba,
+  0x20, 0x83, 0x14, 0x76, 0xfb, 0x4b, 0xcc, 0x2a, 0xe3, 0xa9, 0x4a, 0x47, 0xfc, 0x85, 0x85, 0x29,
+  0xbb, 0x00, 0xbd, 0x7e, 0x60, 0xe3, 0x11, 0x8b, 0x18, 0x0e, 0x26, 0x30, 0x38, 0x73, 0xdf, 0x63,
+  0xf8, 0x9e, 0xc0, 0xf7, 0xd8, 0xe2, 0x57, 0x5b, 0xfc, 0x6b, 0xb0, 0x45, 0xe8, 0x47, 0x31, 0x9c,
+  0x89, 0x28, 0x06, 0xf9, 0x89, 0xf3, 0xde, 0x59, 0x37, 0x09, 0xf6, 0x20, 0xef, 0xd5, 0xba, 0xd4,
+  0x61, 0x17, 0x32, 0x15, 0x47, 0x1f, 0x65, 0x8e, 0x5e, 0xae, 0xc7, 0x57, 0x02, 0x2a, 0x46, 0x02,
+  0xe3, 0xdb, 0xc1, 0x8a, 0x17, 0x61, 0x83, 0x71, 0x95, 0x8f, 0x1d, 0xaf, 0x30, 0x67, 0xe7, 0x28,
+  0xec, 0x0f, 0x2c, 0x18, 0x05, 0x20, 0x5a, 0x10, 0x74, 0xd9, 0x31, 0xcb, 0xc9, 0xcf, 0xdd, 0xc1,
+  0x6f, 0x90, 0x1d, 0x61, 0x10, 0x05, 0x87, 0xe4, 0xfd, 0x44, 0xa9, 0x1c, 0x3e, 0x58, 0x86, 0x8e,
+  0x1d, 0x99, 0x92, 0xea, 0x61, 0xf8, 0x00, 0xe6, 0x18, 0x8f, 0x46, 0x5d, 0xb0, 0xd5, 0x18, 0x9b,
+  0x1b, 0x60, 0x70, 0x28, 0xbb, 0x2d, 0xa2, 0xfb, 0xb9, 0xfd, 0x5c, 0x53, 0xe6, 0x7c, 0x49, 0x7d,
+  0x46, 0x55, 0x9d, 0xaa, 0xd9, 0x8d, 0x4c, 0x00, 0x20, 0xe7, 0xfb, 0xb5, 0x32, 0xce, 0x24, 0xc4,
+  0xdf, 0xbf, 0x68, 0xf1, 0xf7, 0xdf, 0xd9, 0x14, 0xe5, 0xb0, 0x1b, 0xb6, 0x60, 0x30, 0xa0, 0xff,
+  0x29, 0x87, 0xc0, 0x97, 0x06, 0x32, 0x65, 0xfb, 0x91, 0x6f, 0x61, 0xa2, 0xdf, 0xcc, 0xec, 0x2c,
+  0xc9, 0x08, 0xbf, 0x68, 0xcd, 0x76, 0x68, 0x10, 0xc8, 0xb6, 0xf7, 0xc1, 0x46, 0x19, 0x0e, 0x88,
+  0xef, 0xa9, 0x49, 0xd6, 0x18, 0xd1, 0x58, 0x46, 0x1d, 0x9a, 0xd9, 0xda, 0xd3, 0x6a, 0xbb, 0x06,
+  0x32, 0x07, 0xa1, 0xde, 0x5f, 0x7f, 0xfc, 0x80, 0xdd, 0x46, 0xb0, 0xd7, 0x18, 0x42, 0xdf, 0x56,
+  0xbe, 0xe3, 0xf1, 0xb2, 0xf1, 0x55, 0x9d, 0xdf, 0x28, 0x30, 0xb4, 0x06, 0xab, 0xaf, 0xb4, 0x37,
+  0x18, 0x9d, 0xb6, 0xbf, 0x61, 0x44, 0xfa, 0xb4, 0xbb, 0x89, 0x21, 0x5c, 0xa0, 0x38, 0xb9, 0x2e,
+  0x66, 0xb6, 0xe2, 0xe5, 0x9d, 0xcc, 0xfb, 0x25, 0xf6, 0x9f, 0x11, 0xb6, 0x8a, 0x75, 0xb3, 0x23,
+  0x73, 0xbc, 0x83, 0xf4, 0xa9, 0x0b, 0x9b, 0x29, 0xe8, 0x46, 0xc0, 0x1a, 0x11, 0x34, 0x36, 0x00,
+  0x8f, 0x03, 0x57, 0xef, 0x30, 0xc0, 0x21, 0x58, 0x46, 0x83, 0x53, 0xff, 0xc8, 0x96, 0x7a, 0xe7,
+  0x94, 0x2f, 0x24, 0xc5, 0xfc, 0x3b, 0x5b, 0x17, 0x91, 0x07, 0x7a, 0x07, 0xbe, 0xe1, 0x2b, 0xf8,
+  0xee, 0xe2, 0xcf, 0x47, 0x6f, 0xa6, 0xdf, 0xbf, 0x99, 0x9d, 0x0f, 0x91, 0xf6, 0x82, 0x05, 0x1e,
+  0x2f, 0x1f, 0x59, 0xf6, 0x74, 0x46, 0x85, 0x3e, 0xa9, 0x44, 0x80, 0x38, 0x84, 0x91, 0xbe, 0x08,
+  0x2a, 0xb7, 0x1e, 0x79, 0x12, 0x4e, 0xf8, 0x5f, 0x23, 0xfe, 0x9c, 0xbd, 0xaa, 0x07, 0x33, 0xb7,
+  0xba, 0xd7, 0x75, 0xd0, 0xec, 0xa3, 0xfd, 0xb1, 0x4b, 0xce, 0x89, 0xbe, 0x64, 0x78, 0xa6, 0xc5,
+  0x54, 0xbf, 0x03, 0x7b, 0xc9, 0x9d, 0x08, 0xbe, 0xcd, 0xf9, 0x8d, 0x7c, 0x36, 0x87, 0xdc, 0xc9,
+  0x1d, 0x2b, 0x31, 0x15, 0xa1, 0x27, 0xac, 0x8a, 0x66, 0x93, 0x0b, 0x64, 0x4a, 0xbc, 0x15, 0x64,
+  0x2b, 0x8e, 0xa1, 0x30, 0xde, 0x8c, 0x6e, 0xbb, 0xb3, 0x9a, 0x84, 0xc2, 0xd7, 0x92, 0xf0, 0x6d,
+  0x88, 0xe3, 0x3d, 0x92, 0xdd, 0x1e, 0x97, 0x9d, 0xe3, 0x32, 0xf6, 0x49, 0xda, 0x5c, 0x76, 0x8e,
+  0x4b, 0x4d, 0xf2, 0x58, 0x5b, 0xc2, 0xaa, 0x48, 0x92, 0x5d, 0xd0, 0xe9, 0x95, 0xb8, 0x4e, 0x92,
+  0xb0, 0xc6, 0xb5, 0x6e, 0x17, 0xc1, 0x8a, 0xa0, 0xcf, 0x71, 0x71, 0xfa, 0x10, 0x65, 0x1f, 0x33,
+  0xd6, 0xe6, 0xec, 0x23, 0x14, 0x13, 0x2d, 0x1a, 0xbe, 0xf3, 0xf9, 0x1e, 0x63, 0x98, 0xeb, 0xcf,
+  0x3d, 0x7a, 0x97, 0xe7, 0xbb, 0x2b, 0x8b, 0xfd, 0x4d, 0x85, 0x20, 0xc1, 0x81, 0x35, 0xaa, 0xd8,
+  0x45, 0x54, 0x80, 0x72, 0x74, 0x46, 0x87, 0xfb, 0x46, 0xb0, 0x95, 0x81, 0x66, 0x86, 0x96, 0x49,
+  0x17, 0xf0, 0x8c, 0x3e, 0x2c, 0x69, 0xdb, 0x18, 0xf4, 0x11, 0x0b, 0x99, 0x59, 0xee, 0xfb, 0x5b,
+  0x1c, 0x98, 0x1c, 0xbb, 0x69, 0x8a, 0x15, 0x94, 0x2e, 0x13, 0x29, 0xe6, 0xe6, 0x14, 0x30, 0xa6,
+  0x74, 0x17, 0x41, 0x8b, 0x64, 0xd0, 0xea, 0x9d, 0x41, 0xef, 0xa0, 0x50, 0xf4, 0x13, 0x58, 0x5d,
+  0x28, 0x63, 0xd4, 0xaa, 0x02, 0x38, 0x77, 0x6b, 0xec, 0xb3, 0xc9, 0x59, 0x03, 0x22, 0x31, 0xcf,
+  0xc4, 0x2f, 0x7e, 0xe0, 0xa3, 0x71, 0x2a, 0x5c, 0xa6, 0x83, 0x20, 0x83, 0x51, 0xf1, 0x2d, 0x29,
+  0x3e, 0x64, 0xa1, 0xb3, 0xb1, 0x1d, 0x43, 0xed, 0x2a, 0x1d, 0x57, 0x24, 0xc6, 0xb6, 0xdb, 0xbb,
+  0x2d, 0xad, 0xc4, 0xdb, 0x56, 0xff, 0x55, 0xf8, 0xcc, 0xb7, 0x56, 0x37, 0x98, 0xac, 0x36, 0x23,
+  0xf7, 0x16, 0x37, 0x64, 0xef, 0x1f, 0xe7, 0xb8, 0x13, 0xa0, 0xa3, 0xe0, 0xff, 0xf6, 0x99, 0xef,
+  0x3c, 0xde, 0x4e, 0xf1, 0x3e, 0x0b, 0x77, 0xb5, 0xcf, 0x80, 0x79, 0xcb, 0x87, 0xc0, 0xbb, 0x26,
+  0x03, 0x93, 0xb5, 0x44, 0x2f, 0x32, 0x85, 0x82, 0x7f, 0x21, 0x31, 0x22, 0xfa, 0xeb, 0x6c, 0x1d,
+  0xd9, 0x1f, 0xb2, 0x72, 0x84, 0x7f, 0x2a, 0x2b, 0x47, 0xd5, 0xa1, 0x8f, 0xe4, 0x27, 0xb8, 0x95,
+  0x01, 0x62, 0x84, 0x78, 0x15, 0x4a, 0x65, 0xa9, 0x0d, 0x65, 0x7e, 0x15, 0x77, 0x38, 0x5b, 0xd2,
+  0xc5, 0xca, 0x02, 0xc2, 0x1e, 0x55, 0x15, 0x89, 0x74, 0xcd, 0xf5, 0x9b, 0xb3, 0x80, 0xdc, 0x0c,
+  0x17, 0x1f, 0xfa, 0x25, 0xba, 0xa7, 0x34, 0xd6, 0xcd, 0x40, 0xe4, 0x39, 0x9d, 0x48, 0x5b, 0xad,
+  0x27, 0xec, 0x83, 0x6b, 0x35, 0x36, 0x67, 0x40, 0xf9, 0x85, 0x6d, 0x23, 0x17, 0x42, 0x43, 0x36,
+  0x81, 0xb0, 0x83, 0x66, 0xe3, 0xb5, 0x5b, 0xee, 0xf3, 0x3c, 0x5e, 0xaa, 0x32, 0x80, 0x22, 0xbf,
+  0x92, 0x49, 0x92, 0xd1, 0xeb, 0x0c, 0x3e, 0x16, 0xf4, 0xe9, 0x12, 0x06, 0x94, 0x53, 0xb8, 0x88,
+  0xc9, 0x2c, 0x03, 0x82, 0xa3, 0x93, 0x93, 0x93, 0x80, 0x3d, 0xf6, 0xbc, 0xf7, 0x0c, 0x1b, 0xb5,
+  0x75, 0x33, 0x8a, 0x37, 0x75, 0x34, 0xff, 0x0c, 0xbe, 0xce, 0xe7, 0x36, 0x21, 0x5c, 0x7c, 0xe3,
+  0xd1, 0x38, 0x7d, 0x3c, 0xaf, 0xd2, 0xe0, 0x4b, 0x03, 0xa3, 0x6d, 0xb1, 0xb1, 0xd2, 0x58, 0xb1,
+  0xc7, 0x95, 0x73, 0xb6, 0x93, 0xda, 0x33, 0x3b, 0x98, 0xb4, 0xe1, 0x01, 0x31, 0x01, 0xc3, 0x49,
+  0x6b, 0xa8, 0x4d, 0xa9, 0xee, 0x05, 0x0a, 0x2b, 0xa6, 0xf8, 0x2f, 0x70, 0xd8, 0xf3, 0xa2, 0x7d,
+  0x28, 0x19, 0x00, 0x5b, 0xc8, 0x3c, 0x35, 0x43, 0x90, 0xfe, 0xf4, 0xa9, 0xa5, 0x00, 0xea, 0x83,
+  0xc6, 0x2a, 0xd3, 0xe9, 0x94, 0xac, 0xe2, 0x37, 0x40, 0xbb, 0x6e, 0xd7, 0x07, 0x1c, 0x03, 0xe5,
+  0x47, 0xfb, 0xd0, 0x30, 0x69, 0xf5, 0x9a, 0x7b, 0x69, 0x41, 0xbd, 0x51, 0xb7, 0xdd, 0xe6, 0x4b,
+  0x6a, 0x35, 0xe0, 0xe7, 0x7c, 0x6e, 0xb9, 0xc1, 0xf7, 0xf1, 0xb1, 0xdf, 0x0b, 0x6c, 0x09, 0x20,
+  0x6d, 0xd2, 0xed, 0x25, 0xb1, 0x04, 0x96, 0x76, 0xd3, 0xb7, 0x58, 0xc2, 0x43, 0x0e, 0x80, 0x0b,
+  0xb2, 0x87, 0x8b, 0xfd, 0xe3, 0xaf, 0xc7, 0xcd, 0x41, 0x83, 0x10, 0x8c, 0x6f, 0x2b, 0x73, 0xfc,
+  0xc1, 0x72, 0x88, 0x88, 0xec, 0xca, 0x9e, 0xbb, 0xf6, 0x02, 0xd4, 0x8f, 0xbe, 0x56, 0x24, 0xd1,
+  0x22, 0xee, 0x36, 0x39, 0xaf, 0xb6, 0xb6, 0x7a, 0xde, 0x62, 0x7f, 0x77, 0xf5, 0xe8, 0x61, 0x15,
+  0xa7, 0x42, 0x38, 0x30, 0xea, 0x6f, 0x72, 0x2b, 0x92, 0x70, 0x8c, 0x81, 0x10, 0xf4, 0xa8, 0x57,
+  0xb1, 0xa1, 0x41, 0x25, 0xce, 0x5b, 0xf7, 0xab, 0xdd, 0x41, 0x0b, 0x17, 0x2a, 0xdb, 0xd5, 0x81,
+  0x6d, 0x25, 0x8b, 0xdc, 0xaf, 0xeb, 0xa8, 0x59, 0xd0, 0xad, 0x6d, 0x88, 0xef, 0x48, 0x41, 0x13,
+  0xcd, 0xae, 0x41, 0xc2, 0x97, 0x32, 0x9a, 0xe9, 0x5b, 0xa4, 0x88, 0xe0, 0xe2, 0xf0, 0xf8, 0xa4,
+  0xd5, 0x88, 0x4b, 0xa5, 0x75, 0x55, 0xdd, 0x9e, 0xc9, 0x2c, 0x4c, 0x22, 0x42, 0x37, 0x4c, 0x1f,
+  0xeb, 0x5d, 0x3f, 0x77, 0xe2, 0x18, 0x5f, 0x5e, 0xc9, 0xf8, 0x32, 0xc3, 0x4e, 0x8f, 0x05, 0xd0,
+  0xce, 0x26, 0x22, 0xb7, 0xe9, 0xe4, 0x2e, 0xf7, 0xd8, 0xd2, 0xd2, 0xf3, 0x82, 0xc6, 0x5b, 0x1a,
+  0xbe, 0x55, 0x57, 0xee, 0x72, 0xaf, 0x9a, 0x39, 0x76, 0x99, 0xc6, 0x5e, 0xf2, 0xe9, 0x7d, 0x88,
+  0x55, 0xaf, 0x69, 0x87, 0xdf, 0x1d, 0xec, 0x7b, 0x93, 0x8f, 0xfa, 0xde, 0x63, 0xec, 0x42, 0x6d,
+  0xbd, 0x1e, 0x1f, 0x3b, 0x84, 0x1f, 0xf1, 0x4a, 0x01, 0x57, 0xc2, 0x4b, 0x6a, 0xe8, 0x3f, 0x8b,
+  0xd8, 0xdd, 0xc9, 0xc9, 0xf7, 0x48, 0x2c, 0x5c, 0xaf, 0xff, 0x0b, 0xe4, 0x02, 0x6c, 0x1f, 0x60,
+  0x7a, 0xcd, 0xea, 0x94, 0x5c, 0x89, 0x8a, 0x9f, 0x2d, 0x65, 0x58, 0xbf, 0xaa, 0x55, 0x34, 0x54,
+  0xf3, 0x2a, 0x6b, 0xe9, 0x8b, 0x6b, 0xbb, 0x25, 0x5f, 0x67, 0x19, 0x59, 0x1b, 0x63, 0x14, 0xce,
+  0x39, 0x6f, 0x8a, 0x0a, 0x9d, 0x80, 0xc1, 0x0a, 0xd3, 0x17, 0xde, 0x34, 0xe5, 0x77, 0x15, 0x70,
+  0x16, 0xb8, 0xeb, 0xe7, 0xb0, 0x4e, 0x3b, 0x80, 0x1f, 0xff, 0xa7, 0x0b, 0xc0, 0x02, 0x5f, 0x53,
+  0x2a, 0x91, 0xfe, 0xef, 0x6d, 0x24, 0x32, 0xb3, 0x27, 0xd8, 0x23, 0x50, 0x33, 0x82, 0x2d, 0xbe,
+  0xd0, 0x94, 0x21, 0x58, 0x5b, 0x25, 0xbe, 0x8f, 0x9d, 0x37, 0xf3, 0xb8, 0xc1, 0x5b, 0x6a, 0xb8,
+  0xb1, 0x4a, 0xda, 0xa2, 0xea, 0x1e, 0x1f, 0x5b, 0x49, 0x53, 0x9f, 0xf6, 0xca, 0x9e, 0xd6, 0xec,
+  0x6c, 0x6c, 0xef, 0x98, 0x57, 0x0c, 0xc8, 0x4d, 0xf6, 0xcd, 0xe6, 0x0f, 0xdd, 0x2d, 0x68, 0x1d,
+  0xef, 0x0b, 0xb8, 0x1c, 0xb1, 0xf3, 0xc5, 0x05, 0x4e, 0xf9, 0x40, 0x4e, 0x07, 0x42, 0xaa, 0x23,
+  0xc1, 0xf9, 0x10, 0xd6, 0xbb, 0x8d, 0x0d, 0x9b, 0xae, 0xd6, 0xca, 0x71, 0x00, 0x9a, 0x5e, 0xf2,
+  0x75, 0xa7, 0xc1, 0x6e, 0x1f, 0x76, 0x9d, 0xc2, 0xde, 0x9b, 0x3b, 0xe6, 0xf4, 0x5e, 0x27, 0xb0,
+  0x1d, 0x43, 0x8e, 0x6e, 0x5f, 0xa0, 0x99, 0xbc, 0x4c, 0xd3, 0xa4, 0x39, 0xd6, 0x7e, 0x17, 0x39,
+  0x7b, 0xcf, 0xe2, 0xfe, 0x2d, 0xce, 0x7b, 0x98, 0x70, 0x62, 0x92, 0x71, 0x16, 0x25, 0x19, 0xcf,
+  0x9a, 0xc2, 0x22, 0x1a, 0xcd, 0x1d, 0x7a, 0x5f, 0x3f, 0xf8, 0xae, 0xef, 0xb2, 0xec, 0x83, 0x6d,
+  0x7f, 0xb1, 0x71, 0x18, 0x4f, 0x2a, 0x03, 0x57, 0xf3, 0xc7, 0x0d, 0x27, 0x95, 0xa6, 0xa0, 0x87,
+  0xbd, 0xc6, 0x3f, 0x9f, 0x6b, 0x1e, 0x3f, 0x68, 0x9f, 0x27, 0x18, 0x95, 0x07, 0x18, 0xb4, 0x12,
+  0xaf, 0x11, 0xd3, 0x75, 0xe2, 0xcd, 0xe1, 0x41, 0xb1, 0x0d, 0x0e, 0xa8, 0x63, 0x5b, 0x72, 0xff,
+  0x7f, 0x81, 0x38, 0xe6, 0xef, 0x6d, 0x4f, 0x7e, 0xec, 0x89, 0x87, 0xb4, 0xa0, 0xd9, 0xa8, 0x5b,
+  0xb3, 0x43, 0x34, 0x3d, 0x04, 0x87, 0x2e, 0x6c, 0x9e, 0x5e, 0x5b, 0x9f, 0x37, 0x26, 0x95, 0x8d,
+  0xda, 0x66, 0xb5, 0xc3, 0x5b, 0xd1, 0xf8, 0x72, 0x08, 0x38, 0xa8, 0x6f, 0xde, 0x37, 0xff, 0x0b,
+  0x19, 0x93, 0x6a, 0x5b, 0x8c, 0x1c, 0x00, 0x00,
+};
 
-  <div id="DataCointainer"> </div>
+// index.html: 4573 bytes, 1858 bytes compressed
+#define INDEX_HTML_TYPE "text/html"
+#define INDEX_HTML_ETAG "\"d1d7df68a92ad8cd\""
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xd5, 0x58, 0x59, 0x73, 0x1b, 0xc7,
+  0x11, 0x7e, 0xc7, 0xaf, 0x68, 0xed, 0x83, 0x04, 0x24, 0xc0, 0x02, 0xa4, 0x25, 0x5b, 0x26, 0x01,
+  0xa8, 0x18, 0x8a, 0x96, 0xe8, 0xa2, 0x8e, 0x22, 0xe1, 0x38, 0x29, 0x16, 0x2a, 0x35, 0xd8, 0x6d,
+  0x60, 0x47, 0x5e, 0xec, 0x6c, 0x66, 0x66, 0x01, 0x22, 0x2e, 0xfe, 0xf7, 0x74, 0xcf, 0xec, 0x29,
+  0x91, 0x31, 0xfd, 0x98, 0x17, 0x62, 0x8e, 0x9e, 0x3e, 0xbf, 0x3e, 0x96, 0xd3, 0x67, 0x6f, 0x3f,
+  0x9d, 0x2f, 0xfe, 0xf9, 0xf9, 0x02, 0xde, 0x2f, 0x3e, 0x5c, 0xcd, 0xa7, 0x89, 0xdd, 0xa6, 0xf3,
+  0xde, 0xf4, 0xd9, 0x68, 0x04, 0xd7, 0x85, 0x84, 0x1b, 0x91, 0x59, 0x65, 0x60, 0x04, 0xe7, 0x6a,
+  0x9b, 0xa7, 0x68, 0x11, 0x72, 0xad, 0xbe, 0x60, 0x64, 0x21, 0x46, 0x2b, 0x64, 0x6a, 0x40, 0x58,
+  0x48, 0xac, 0xcd, 0xcd, 0xc9, 0x78, 0x7c, 0x2d, 0xb2, 0x58, 0x6d, 0x3f, 0xa2, 0x8e, 0x17, 0x85,
+  0x55, 0x5a, 0x8a, 0xd4, 0x84, 0x91, 0xda, 0xf6, 0x7a, 0x9f, 0x51, 0x6f, 0xa5, 0x31, 0x52, 0x65,
+  0x20, 0x0d, 0x24, 0xa8, 0x71, 0x75, 0x80, 0x8d, 0x26, 0xde, 0x18, 0x0f, 0x61, 0xad, 0x11, 0x41,
+  0xad, 0x21, 0x4a, 0x84, 0xde, 0xe0, 0x10, 0xac, 0x02, 0x91, 0x1d, 0x20, 0x47, 0x6d, 0xe8, 0x81,
+  0x5a, 0x91, 0x9c, 0x4c, 0x66, 0x1b, 0x10, 0x10, 0xa9, 0xfc, 0xd0, 0x23, 0x4a, 0x9b, 0x10, 0x1b,
+  0xa3, 0xd6, 0x76, 0x2f, 0x34, 0x12, 0x71, 0x0c, 0xc2, 0x18, 0x15, 0x49, 0x41, 0xfc, 0x20, 0x56,
+  0x51, 0xb1, 0xc5, 0xcc, 0x0a, 0xcb, 0xf2, 0xd6, 0x32, 0x45, 0x13, 0xf6, 0x16, 0x09, 0xd1, 0xad,
+  0xd4, 0x0e, 0x1d, 0x0f, 0x2d, 0x37, 0x89, 0x85, 0x4c, 0x59, 0x19, 0xf9, 0xe7, 0x8e, 0x61, 0xde,
+  0x68, 0x59, 0x5e, 0x99, 0x44, 0xa4, 0x29, 0xac, 0x10, 0x64, 0x16, 0xa5, 0x45, 0x4c, 0xcc, 0x65,
+  0x06, 0x74, 0xd4, 0x23, 0x26, 0x12, 0x0d, 0x28, 0x0d, 0xa6, 0x58, 0x19, 0x4b, 0x86, 0x90, 0xb1,
+  0x90, 0x2b, 0xcd, 0x32, 0x0d, 0x38, 0x15, 0x11, 0x6e, 0x4a, 0x0d, 0x43, 0x18, 0x8d, 0xc8, 0xa7,
+  0x09, 0x8a, 0x78, 0xde, 0x03, 0x98, 0x6e, 0xc9, 0x75, 0x90, 0x89, 0x2d, 0xce, 0x82, 0x9d, 0xc4,
+  0x3d, 0x3f, 0x0b, 0x48, 0x2f, 0xf2, 0x46, 0x66, 0x67, 0xc1, 0x5e, 0xc6, 0x36, 0x99, 0xc5, 0xb8,
+  0x23, 0x0d, 0x46, 0x6e, 0x33, 0x24, 0xb1, 0x92, 0x25, 0x8c, 0x4c, 0x24, 0x52, 0x9c, 0x1d, 0x05,
+  0x8e, 0x8d, 0x89, 0xb4, 0xcc, 0x2d, 0x18, 0x1d, 0xcd, 0x82, 0x70, 0xcc, 0xde, 0xb3, 0xe1, 0x17,
+  0xf3, 0x66, 0x37, 0xfb, 0x21, 0x5e, 0xc5, 0xd1, 0xf7, 0xaf, 0x7e, 0xf8, 0xf1, 0xf5, 0xab, 0xd7,
+  0xb1, 0x78, 0x49, 0xe4, 0xd3, 0xb1, 0x27, 0xf6, 0xef, 0xec, 0x21, 0x45, 0x5e, 0x01, 0xac, 0x54,
+  0x7c, 0x80, 0xdf, 0xdd, 0x12, 0x60, 0x2b, 0x33, 0x2f, 0xef, 0x04, 0xbe, 0x3b, 0x9a, 0xe4, 0x77,
+  0xa7, 0xd5, 0xb9, 0xb8, 0xab, 0xce, 0x5f, 0x4f, 0x5a, 0xe7, 0x09, 0xb2, 0x1b, 0x4f, 0xe0, 0xe5,
+  0xa4, 0x43, 0xac, 0x37, 0x32, 0x3b, 0x81, 0x09, 0x08, 0xc2, 0x80, 0x3f, 0xbd, 0x77, 0x7f, 0x93,
+  0xe3, 0x5a, 0xd2, 0x9a, 0x6c, 0x1d, 0xad, 0xc5, 0x56, 0xa6, 0x87, 0x13, 0x38, 0x63, 0xa0, 0x9c,
+  0xb6, 0x6f, 0x8c, 0xfc, 0x0f, 0x9e, 0xc0, 0x71, 0xf8, 0x4a, 0xe3, 0xb6, 0xba, 0xb0, 0x78, 0x67,
+  0x47, 0x22, 0x95, 0x1b, 0xe2, 0x1d, 0x91, 0x9f, 0x50, 0x37, 0xbc, 0xc9, 0x3a, 0x6f, 0xd2, 0x74,
+  0xec, 0x7d, 0x3c, 0x65, 0xbb, 0x9c, 0xad, 0xc9, 0xf1, 0xfc, 0x9d, 0x56, 0x7b, 0x61, 0x2d, 0x5c,
+  0x66, 0x3b, 0xd4, 0xf4, 0x8e, 0x88, 0x8e, 0xdd, 0x5d, 0x2c, 0x77, 0x20, 0xe3, 0x59, 0xe0, 0x3c,
+  0x37, 0xca, 0xd5, 0x1e, 0x35, 0x85, 0x21, 0x25, 0x28, 0xd1, 0x19, 0xe9, 0x41, 0xb0, 0xa3, 0x13,
+  0xf2, 0x1d, 0x11, 0xce, 0x7b, 0xed, 0x17, 0x6f, 0x85, 0x15, 0xe7, 0x4a, 0xd6, 0x24, 0xd0, 0xa2,
+  0x11, 0x90, 0x68, 0x5c, 0x73, 0x44, 0xd6, 0x52, 0x6f, 0x39, 0xfc, 0xc1, 0xfc, 0xa7, 0x72, 0x05,
+  0x45, 0x1e, 0x13, 0x46, 0xa7, 0x63, 0x31, 0x87, 0x51, 0x97, 0x98, 0x40, 0x64, 0x0b, 0x13, 0xcc,
+  0x7f, 0x26, 0xcc, 0x3f, 0x74, 0x1f, 0xe3, 0xaa, 0xd8, 0x04, 0xf3, 0x2b, 0xb5, 0x79, 0xe8, 0xf6,
+  0xc6, 0x92, 0x09, 0x67, 0x79, 0x30, 0xbf, 0x41, 0x5b, 0xe4, 0x0f, 0x51, 0xe4, 0xca, 0x58, 0xca,
+  0xe1, 0x6d, 0x91, 0xc9, 0xc8, 0x65, 0xc6, 0x07, 0x15, 0xaf, 0x58, 0xe0, 0xf5, 0xaf, 0xe0, 0x97,
+  0x0f, 0x6a, 0xa5, 0x52, 0xa1, 0xff, 0x25, 0x72, 0x39, 0xde, 0x1d, 0x8d, 0xdf, 0xa1, 0xad, 0x7c,
+  0x78, 0x8d, 0x22, 0xb5, 0x72, 0x8b, 0xec, 0x88, 0x30, 0xda, 0x48, 0x32, 0x51, 0xab, 0x4c, 0x16,
+  0xa6, 0xf6, 0x32, 0xf0, 0xd5, 0x9f, 0x61, 0x79, 0x99, 0xad, 0xd5, 0x23, 0xac, 0xf8, 0xea, 0x29,
+  0xac, 0xde, 0xba, 0x9c, 0xf9, 0x96, 0x91, 0x3f, 0x7f, 0x32, 0x1b, 0xf2, 0xf1, 0xe6, 0x21, 0x7d,
+  0xfc, 0xf9, 0x93, 0xd9, 0x9c, 0x45, 0x56, 0xee, 0xf0, 0x31, 0x9d, 0xfc, 0x6d, 0xa9, 0xda, 0x53,
+  0xd8, 0x7d, 0x66, 0x7c, 0xfe, 0x94, 0xaa, 0x7d, 0xc7, 0xf7, 0xeb, 0x0e, 0x53, 0x47, 0x03, 0x4c,
+  0xc4, 0x1c, 0x7b, 0x94, 0x0f, 0x3e, 0x11, 0xa6, 0x55, 0xf6, 0xf7, 0xa8, 0x84, 0x57, 0xc5, 0x44,
+  0x1a, 0xaa, 0x67, 0x33, 0x58, 0x53, 0x95, 0xc6, 0x53, 0x77, 0xc1, 0x25, 0x69, 0xa1, 0x2e, 0xf9,
+  0xf4, 0xf7, 0x7b, 0x7f, 0xf4, 0x1b, 0x1e, 0x0c, 0x6d, 0x6f, 0x97, 0x7e, 0x4b, 0xe8, 0xb1, 0xa6,
+  0x75, 0x9d, 0xab, 0x34, 0x25, 0x89, 0x33, 0xc8, 0x8a, 0x94, 0x72, 0xb8, 0xb7, 0x13, 0xda, 0x95,
+  0x71, 0xbb, 0xe0, 0x33, 0xdc, 0xc3, 0x15, 0x25, 0xc8, 0x39, 0x1f, 0xf4, 0x5f, 0xb4, 0xd2, 0xec,
+  0xc5, 0x10, 0x5e, 0x74, 0x80, 0xf2, 0x62, 0x40, 0x8f, 0xc7, 0x63, 0xae, 0xd6, 0xa9, 0x2b, 0x9d,
+  0x8e, 0x18, 0xf6, 0xd2, 0x26, 0x6e, 0x4b, 0xe5, 0x99, 0x1a, 0xca, 0x81, 0xd4, 0xa1, 0x82, 0x47,
+  0xbd, 0x83, 0xcf, 0x0c, 0x95, 0xe8, 0xdf, 0x7a, 0xeb, 0x22, 0x8b, 0x5c, 0xa1, 0x4f, 0x95, 0x88,
+  0xdf, 0x7b, 0xb2, 0xfe, 0xc0, 0x55, 0x1a, 0x56, 0xe6, 0x8e, 0x7b, 0x53, 0xa9, 0xcb, 0x3f, 0x3e,
+  0x5c, 0xbd, 0xa7, 0xdd, 0x35, 0xfe, 0xbb, 0x40, 0x63, 0xfb, 0x03, 0x2e, 0x20, 0xee, 0x3e, 0x54,
+  0x99, 0xa6, 0xba, 0x71, 0xe0, 0x1c, 0x44, 0x92, 0x9c, 0x6d, 0x90, 0x1d, 0x53, 0x72, 0x2e, 0xb9,
+  0x01, 0xc8, 0x35, 0xf4, 0xb9, 0x51, 0x84, 0x8e, 0xf8, 0x86, 0x89, 0x61, 0x36, 0x83, 0x97, 0xf0,
+  0xfc, 0xb9, 0x6b, 0x20, 0xa1, 0xcf, 0x61, 0x3e, 0x3b, 0x9e, 0x4c, 0x06, 0x75, 0xb5, 0x63, 0x3d,
+  0xd4, 0xea, 0x0b, 0xb1, 0xfc, 0xf9, 0xe6, 0xd3, 0xc7, 0x30, 0x17, 0xda, 0x60, 0xc5, 0xc8, 0xe4,
+  0xd4, 0x2f, 0x70, 0x41, 0xc5, 0x6d, 0x50, 0x55, 0x3a, 0x72, 0x03, 0x9b, 0x97, 0x73, 0x7d, 0x31,
+  0x10, 0x09, 0xad, 0xbd, 0xbd, 0x45, 0xce, 0x51, 0xaf, 0x7a, 0x8b, 0xb3, 0x9e, 0xdb, 0x91, 0x41,
+  0xaa, 0x55, 0xb1, 0x29, 0x1f, 0x73, 0x50, 0xee, 0x48, 0x52, 0x9f, 0x0d, 0x26, 0xcf, 0x62, 0x7f,
+  0x30, 0x08, 0x37, 0x68, 0x17, 0xf4, 0xb4, 0x3f, 0x68, 0xaa, 0xac, 0x86, 0x3e, 0xab, 0x45, 0xe1,
+  0x65, 0x1e, 0xa4, 0x5d, 0x78, 0x83, 0x9a, 0x5a, 0x5a, 0xa3, 0xb5, 0xb7, 0xb7, 0x24, 0xa8, 0x90,
+  0xd1, 0xbe, 0x86, 0x32, 0xd2, 0xa1, 0xa1, 0xcc, 0xa3, 0x18, 0xf6, 0x2b, 0xa2, 0x5b, 0x7a, 0xb4,
+  0x1c, 0xb6, 0x98, 0xba, 0x83, 0x70, 0x2b, 0xf2, 0x7e, 0xed, 0xd3, 0xbc, 0xcb, 0x09, 0x40, 0x53,
+  0xe1, 0xd2, 0x19, 0xdc, 0xde, 0xd1, 0xac, 0xd1, 0xe7, 0xa7, 0x1f, 0xd5, 0x9e, 0x96, 0xf9, 0xed,
+  0x64, 0x39, 0x80, 0xbf, 0xc0, 0xd1, 0x64, 0x32, 0x19, 0xd2, 0xee, 0x68, 0xb9, 0x3c, 0x6d, 0xbd,
+  0xbb, 0x1f, 0x0c, 0x9a, 0xed, 0x7d, 0xaf, 0xfb, 0x5b, 0xaa, 0xa7, 0x31, 0xd6, 0x62, 0x5f, 0x19,
+  0xcf, 0x97, 0xf7, 0xad, 0xc8, 0xe7, 0x98, 0xf5, 0x83, 0x77, 0x17, 0x8b, 0x60, 0x08, 0x94, 0x74,
+  0x25, 0xce, 0xde, 0x68, 0xc6, 0xc0, 0xec, 0xbb, 0xef, 0x27, 0x93, 0xe7, 0x3e, 0x0e, 0xb3, 0xa3,
+  0xe3, 0x09, 0x91, 0x58, 0x5d, 0x60, 0x0b, 0x37, 0x06, 0xb3, 0x98, 0x19, 0xdf, 0x3b, 0xf0, 0x9a,
+  0x84, 0x54, 0xe6, 0xd8, 0xec, 0x44, 0x5a, 0xa0, 0x9b, 0x02, 0x04, 0x30, 0x56, 0x20, 0x3a, 0x44,
+  0x29, 0x0d, 0x36, 0xb7, 0xee, 0x62, 0xe8, 0xb2, 0x88, 0x8c, 0x49, 0x95, 0x5d, 0xf2, 0xd0, 0x41,
+  0x34, 0x1b, 0x92, 0x4b, 0x0b, 0x0a, 0x8b, 0xca, 0xd2, 0x43, 0x8b, 0x09, 0xf3, 0x25, 0xff, 0xf3,
+  0x81, 0xd2, 0x31, 0x93, 0xf8, 0xf0, 0x57, 0x4f, 0x48, 0x8a, 0xbf, 0xcd, 0xc5, 0x06, 0x9b, 0x64,
+  0x60, 0x55, 0xfe, 0xee, 0x18, 0xf4, 0x3d, 0x1f, 0xef, 0xee, 0x3f, 0x46, 0x07, 0xe7, 0x7b, 0x48,
+  0xf0, 0xb8, 0x10, 0x51, 0xd2, 0x44, 0x8b, 0x4e, 0x69, 0x06, 0xa9, 0x42, 0xc6, 0xc0, 0x71, 0x5c,
+  0x89, 0xd3, 0x99, 0xd6, 0xe2, 0x10, 0x4a, 0xe3, 0x7e, 0x6b, 0x59, 0x6f, 0x4a, 0xed, 0x6f, 0xe5,
+  0x12, 0x4e, 0xaa, 0x35, 0x83, 0x80, 0xa2, 0xe9, 0xc3, 0x40, 0x66, 0xf9, 0x5e, 0x08, 0x46, 0xd2,
+  0x1f, 0x5a, 0x09, 0x77, 0x5e, 0x0d, 0x6f, 0xac, 0xd5, 0x45, 0x8a, 0xbc, 0xfc, 0xdb, 0xe1, 0x32,
+  0x66, 0x0d, 0x06, 0xa1, 0xcc, 0xa8, 0xdb, 0xf2, 0x98, 0x4a, 0x82, 0x19, 0x98, 0x7f, 0x85, 0xe0,
+  0x04, 0x02, 0xfa, 0xf1, 0xda, 0xd0, 0xd6, 0xed, 0x5c, 0x91, 0x72, 0xe2, 0xbe, 0x96, 0xe5, 0xab,
+  0x4a, 0x2d, 0xec, 0x7f, 0x02, 0xbc, 0x44, 0x8f, 0x88, 0xe3, 0xcf, 0x8c, 0x80, 0xaf, 0xd1, 0x7d,
+  0x7b, 0x37, 0xf4, 0x62, 0x69, 0x5d, 0xe7, 0x81, 0x03, 0x7b, 0x87, 0x70, 0x19, 0xb2, 0xb4, 0x30,
+  0xc5, 0x6c, 0x43, 0xa5, 0x6c, 0x0e, 0xaf, 0x26, 0x6d, 0x1c, 0xba, 0xf5, 0x37, 0x30, 0x25, 0x34,
+  0xd5, 0x81, 0x6c, 0x6a, 0x35, 0x27, 0x85, 0xd7, 0x8e, 0xec, 0x21, 0x38, 0x51, 0x10, 0x98, 0x35,
+  0xd4, 0x93, 0x0a, 0x7c, 0x29, 0x0c, 0x17, 0x77, 0x2a, 0x19, 0x06, 0x99, 0x6f, 0x7d, 0x31, 0x7b,
+  0xd4, 0xad, 0x5f, 0x4f, 0x32, 0x5e, 0xa1, 0xea, 0x61, 0xc7, 0xe1, 0x41, 0x70, 0xca, 0xf3, 0xcd,
+  0x03, 0xa5, 0xa3, 0xf2, 0x99, 0xc3, 0x4e, 0x5e, 0x98, 0xc4, 0x45, 0xcb, 0x9b, 0xd9, 0xc4, 0x82,
+  0x58, 0x10, 0xad, 0x47, 0xc1, 0x51, 0x13, 0x19, 0x36, 0xd0, 0xbb, 0xa0, 0x0e, 0x49, 0x4d, 0x76,
+  0xbc, 0xe4, 0x5a, 0xea, 0x72, 0xae, 0x0e, 0x4b, 0xc7, 0xbb, 0xc4, 0xb3, 0x09, 0x93, 0xaf, 0x35,
+  0xfd, 0x12, 0x18, 0x70, 0xcb, 0x50, 0x68, 0x49, 0xe4, 0xc3, 0x65, 0x30, 0x68, 0x4f, 0xa4, 0x95,
+  0xf8, 0xae, 0x1f, 0x6b, 0x8c, 0xa3, 0x77, 0x54, 0xdb, 0x7d, 0x11, 0xa5, 0xb3, 0xc5, 0xd2, 0x83,
+  0xfd, 0x20, 0xaf, 0xf8, 0x95, 0xa4, 0x8f, 0x23, 0xb4, 0x56, 0x64, 0xb2, 0xac, 0x71, 0xfa, 0x8d,
+  0x3b, 0x2a, 0x2e, 0x54, 0x50, 0xcf, 0xac, 0xd5, 0x72, 0x55, 0x50, 0x86, 0x06, 0x32, 0xa6, 0xc2,
+  0xd3, 0x78, 0xb4, 0x89, 0x8e, 0xc8, 0xa9, 0x78, 0xc5, 0xe7, 0x89, 0x4c, 0xe3, 0x7e, 0xf9, 0xd4,
+  0xd1, 0xb0, 0x71, 0xdd, 0x1e, 0xcf, 0x2e, 0xe4, 0x9b, 0x4e, 0x8f, 0xec, 0x02, 0xcd, 0x67, 0xc8,
+  0xff, 0x6b, 0xe7, 0x6c, 0x5a, 0xa7, 0x0b, 0x28, 0x17, 0xc4, 0x5f, 0x2e, 0x59, 0x2c, 0x7d, 0xc8,
+  0xd1, 0x07, 0x9b, 0x13, 0x4b, 0x51, 0xcc, 0xb0, 0xd7, 0xb4, 0xb6, 0x8e, 0x8b, 0xca, 0x39, 0xa8,
+  0xd3, 0xfe, 0xba, 0xa9, 0xd7, 0xf4, 0x19, 0xfe, 0xe4, 0xa3, 0x79, 0x6a, 0xd5, 0x6a, 0xa8, 0xf7,
+  0x14, 0x3b, 0x83, 0xad, 0xc7, 0xad, 0x02, 0xdc, 0x7e, 0xec, 0x71, 0x77, 0x5f, 0x45, 0xe9, 0xc1,
+  0x1e, 0x54, 0xc8, 0xf2, 0x5b, 0xe0, 0x0f, 0xda, 0x4d, 0x33, 0x05, 0x70, 0xce, 0x51, 0xbf, 0x69,
+  0xb5, 0x1e, 0xb1, 0xe6, 0x76, 0x82, 0x34, 0x61, 0x1d, 0x3a, 0x1d, 0x88, 0xe7, 0x35, 0xfe, 0x94,
+  0x96, 0xa6, 0x69, 0x34, 0x64, 0x78, 0xba, 0x12, 0x34, 0x4a, 0xb1, 0xf7, 0xd6, 0xc0, 0xf9, 0xa0,
+  0x88, 0x05, 0x7b, 0xce, 0x14, 0x39, 0x7f, 0x9c, 0xf2, 0x19, 0xa5, 0x7d, 0x22, 0xf8, 0xd4, 0x7f,
+  0xae, 0x1b, 0x6a, 0x5e, 0xad, 0x76, 0xd3, 0x78, 0xc4, 0xf9, 0x80, 0xdd, 0xfb, 0x6c, 0x2f, 0xb3,
+  0x58, 0xed, 0xc3, 0x8b, 0x1d, 0xe1, 0xf2, 0x46, 0x15, 0x3a, 0xaa, 0xbd, 0x5b, 0x4f, 0x8d, 0x86,
+  0xc7, 0x7f, 0xd2, 0x94, 0xb4, 0xee, 0x7b, 0x00, 0x0e, 0xa9, 0x42, 0x4e, 0xaa, 0x1a, 0xe9, 0x67,
+  0x82, 0xca, 0x59, 0x2e, 0x25, 0x99, 0x99, 0x29, 0x51, 0xd9, 0xe2, 0xdc, 0x27, 0xbf, 0xf9, 0x3b,
+  0x9f, 0x91, 0x7e, 0x4d, 0xe8, 0xdc, 0xa2, 0x31, 0xa2, 0x0b, 0xca, 0x5a, 0x8d, 0x56, 0x8c, 0x5a,
+  0xf0, 0x42, 0x57, 0xb1, 0xfd, 0x5c, 0x71, 0xdf, 0xe1, 0x85, 0x5a, 0x2b, 0xfd, 0x18, 0xbc, 0x4b,
+  0xaa, 0x2e, 0xc0, 0x5b, 0x1a, 0x86, 0xe7, 0x57, 0x9f, 0x6e, 0x2e, 0xde, 0x32, 0xe2, 0x2b, 0xf3,
+  0xfd, 0xd4, 0xdc, 0x40, 0xee, 0xa9, 0x6e, 0x29, 0x47, 0x18, 0x42, 0x41, 0x95, 0xb4, 0xa7, 0x3c,
+  0xea, 0xd7, 0x33, 0x3e, 0x6f, 0xfc, 0xbf, 0x71, 0xfe, 0x0b, 0x46, 0x7c, 0x17, 0x12, 0xdd, 0x11,
+  0x00, 0x00,
+};
 
-  <a href="./firmware">Firmware update</a> -
-  <a href="./status">Json</a> -
-  <a href="./debug">Log</a> -
-  <a href="./StartAp">Setup</a> -
-  <a href="./postCommunicationModbus">RW Modbus</a> -
-  <a href="./solar_api/v1/GetInverterRealtimeData.cgi">Fronius Inverter Data</a> -
-  <a href="./solar_api/v1/GetInverterInfo.cgi">Fronius Inverter Info</a> -
-  <a href="./solar_api/v1/GetDeviceInfo.cgi">Fronius Device Info</a> -
-  <a href="./solar_api/v1/GetLoggerInfo.cgi">Fronius Logger Info</a> -
-  <a href="./solar_api/v1/GetActiveDeviceInfo.cgi">Fronius Active Device</a> -
-  <a href="./solar_api/v1/GetPowerFlowRealtimeData.fcgi">Fronius Power Flow</a>
-
-</body>
-<script>
-
-const d = new Date();
-let diff = d.getTimezoneOffset();
-let initialised = false;
-let nameToId = {};
-
-Highcharts.setOptions({
-time: {
-timezoneOffset: diff
-}
-});
-
-var chartT = new Highcharts.Chart({
-  chart:{ renderTo : 'chart-power' },
-  title: { text: 'Inverter Data' },
-  series: [],
-  plotOptions: {
-    line: { animation: false,
-      dataLabels: { enabled: true }
-    },
-  },
-  xAxis: { type: 'datetime',
-    dateTimeLabelFormats: { second: '%H:%M:%S' }
-  },
-  credits: {
-    enabled: false
-  },
-  legend: {
-    align: 'left',
-    verticalAlign: 'top',
-    borderWidth: 0,
-  },
-  tooltip: {
-    shared: true,
-    crosshairs: true,
-  }
-});
-
-setInterval(function ( ) {
-  var xhttp = new XMLHttpRequest();
-  xhttp.onreadystatechange = function() {
-    if (this.readyState == 4 && this.status == 200) {
-
-      // add data fields to the main page
-      var obj = JSON.parse(this.responseText);
-
-      // init the UI if not already done
-      if (initialised == false) {
-        var i = 0;
-
-        // clear data container just in case
-        container = document.getElementById("DataCointainer");
-        container.innerHTML = "";
-
-        for (var key in obj) {
-          // init chart
-          if (obj[key][2] == true) {
-            chartT.addSeries({
-              name: key + " [" + obj[key][1] + "]",
-              data: []
-            });
-            nameToId[key] = i;
-            i++;
-          }
-          // init data container
-          var element = document.createElement("p");
-          element.innerHTML = key + ": " + obj[key][0] + " " + obj[key][1];
-          element.setAttribute("id", key);
-          container.appendChild(element);
-        }
-        initialised = true;
-      } else {
-        let x = (new Date()).getTime();
-        for (var key in obj) {
-          // update site data
-          var element = document.getElementById(key);
-          element.innerHTML = key + ": " + obj[key][0] + " " + obj[key][1];
-          // update chart data
-          if (obj[key][2] == true) {
-            if (chartT.series[nameToId[key]].data.length <= 50) {
-              chartT.series[nameToId[key]].addPoint([x, obj[key][0]], true, false, true);
-            } else {
-              chartT.series[nameToId[key]].addPoint([x, obj[key][0]], true, true, true);
-            }
-          }
-        }
-      }
-    };
-  }
-  xhttp.open("GET", "./uistatus", true);
-  xhttp.send();
-}, 5000 ) ;
-
-</script>
-
-
-
-</html>
-
-
-)=====";
+#endif // _INDEX_H_
@@ -0,0 +1,211 @@
+// Small SVG line chart for the status page, bundled with the firmware so the page works without
+// internet access: time axis, several series, a legend to hide series and a shared tooltip
+
+var CHART_COLORS = ['#2caffe', '#544fc5', '#00e272', '#fe6a35', '#6b8abc', '#d568fb', '#2ee0ca', '#fa4b42'];
+var SVG_NS = 'http://www.w3.org/2000/svg';
+
+function LineChart(container, title) {
+  var chart = this;
+
+  this.container = document.getElementById(container);
+  this.title = title;
+  this.series = [];
+  this.height = 400;
+
+  this.container.style.position = 'relative';
+  this.container.style.font = '12px Arial';
+  this.legend = document.createElement('div');
+  this.container.appendChild(this.legend);
+  this.svg = document.createElementNS(SVG_NS, 'svg');
+  this.svg.style.display = 'block';
+  this.container.appendChild(this.svg);
+  this.tip = document.createElement('div');
+  this.tip.style.cssText = 'position:absolute;display:none;pointer-events:none;background:#fff;' +
+    'border:1px solid #999;border-radius:3px;padding:4px;white-space:nowrap';
+  this.container.appendChild(this.tip);
+
+  this.svg.addEventListener('mousemove', function(e) { chart.showTip(e); });
+  this.svg.addEventListener('mouseleave', function() { chart.hideTip(); });
+  window.addEventListener('resize', function() { chart.redraw(); });
+  this.redraw();
+}
+
+// returns the index of the new series
+LineChart.prototype.addSeries = function(name) {
+  this.series.push({ name: name, data: [], visible: true, color: CHART_COLORS[this.series.length % CHART_COLORS.length] });
+  return this.series.length - 1;
+};
+
+// data: [[time in ms, value], ...] in ascending time
+LineChart.prototype.setData = function(index, data) {
+  this.series[index].data = data;
+};
+
+// shift: drop the oldest point, so the number of points stays the same
+LineChart.prototype.addPoint = function(index, point, shift) {
+  var data = this.series[index].data;
+  data.push(point);
+  if (shift) {
+    data.shift();
+  }
+};
+
+function chartElement(parent, name, attributes, text) {
+  var element = document.createElementNS(SVG_NS, name);
+  for (var key in attributes) {
+    element.setAttribute(key, attributes[key]);
+  }
+  if (text !== undefined) {
+    element.textContent = text;
+  }
+  parent.appendChild(element);
+  return element;
+}
+
+// step of 1, 2 or 5 times a power of ten splitting span into about count intervals
+function chartStep(span, count) {
+  var step = Math.pow(10, Math.floor(Math.log10(span / count)));
+  var f = span / count / step;
+  return step * (f > 5 ? 10 : f > 2 ? 5 : f > 1 ? 2 : 1);
+}
+
+function chartTime(t) {
+  var d = new Date(t);
+  return [d.getHours(), d.getMinutes(), d.getSeconds()].map(function(n) {
+    return (n < 10 ? '0' : '') + n;
+  }).join(':');
+}
+
+function chartNumber(v) {
+  return Math.round(v * 100) / 100;
+}
+
+LineChart.prototype.redraw = function() {
+  var chart = this;
+  var svg = this.svg;
+  var width = this.container.clientWidth || 600;
+  var xMin = Infinity, xMax = -Infinity, yMin = 0, yMax = 0;
+
+  // legend, a click hides or shows the series
+  this.legend.innerHTML = '';
+  this.series.forEach(function(s) {
+    var item = document.createElement('span');
+    item.style.cssText = 'cursor:pointer;margin-right:12px;display:inline-block;opacity:' + (s.visible ? 1 : 0.4);
+    item.innerHTML = '<span style="color:' + s.color + '">&#9679;</span> ';
+    item.appendChild(document.createTextNode(s.name));
+    item.onclick = function() {
+      s.visible = !s.visible;
+      chart.redraw();
+    };
+    chart.legend.appendChild(item);
+  });
+
+  this.series.forEach(function(s) {
+    if (!s.visible) {
+      return;
+    }
+    s.data.forEach(function(p) {
+      xMin = Math.min(xMin, p[0]);
+      xMax = Math.max(xMax, p[0]);
+      yMin = Math.min(yMin, p[1]);
+      yMax = Math.max(yMax, p[1]);
+    });
+  });
+  if (xMin > xMax) {
+    xMax = (new Date()).getTime();
+    xMin = xMax - 60000;
+  } else if (xMin == xMax) {
+    xMin -= 60000;
+  }
+  var yStep = chartStep((yMax - yMin) || 1, 5);
+  yMin = Math.floor(yMin / yStep) * yStep;
+  yMax = Math.max(Math.ceil(yMax / yStep) * yStep, yMin + yStep);
+
+  var left = 60, right = width - 15, top = 30, bottom = this.height - 25;
+  this.scaleX = function(x) { return left + (x - xMin) / (xMax - xMin) * (right - left); };
+  this.timeAt = function(px) { return xMin + (px - left) / (right - left) * (xMax - xMin); };
+  var scaleY = function(y) { return bottom - (y - yMin) / (yMax - yMin) * (bottom - top); };
+  this.plot = { left: left, right: right, top: top, bottom: bottom };
+
+  while (svg.firstChild) {
+    svg.removeChild(svg.firstChild);
+  }
+  svg.setAttribute('width', width);
+  svg.setAttribute('height', this.height);
+  chartElement(svg, 'text', { x: width / 2, y: 18, 'text-anchor': 'middle', 'font-size': 16, fill: '#333' }, this.title);
+
+  for (var y = yMin; y <= yMax + yStep / 2; y += yStep) {
+    chartElement(svg, 'line', { x1: left, x2: right, y1: scaleY(y), y2: scaleY(y), stroke: '#e6e6e6' });
+    chartElement(svg, 'text', { x: left - 6, y: scaleY(y) + 4, 'text-anchor': 'end', fill: '#666' }, chartNumber(y));
+  }
+  var ticks = Math.max(2, Math.floor((right - left) / 100));
+  for (var i = 0; i <= ticks; i++) {
+    var x = xMin + (xMax - xMin) * i / ticks;
+    chartElement(svg, 'text', { x: this.scaleX(x), y: bottom + 18, 'text-anchor': 'middle', fill: '#666' }, chartTime(x));
+  }
+
+  this.series.forEach(function(s) {
+    if (!s.visible || s.data.length == 0) {
+      return;
+    }
+    var points = s.data.map(function(p) {
+      return chart.scaleX(p[0]).toFixed(1) + ',' + scaleY(p[1]).toFixed(1);
+    });
+    chartElement(svg, 'polyline', { points: points.join(' '), fill: 'none', stroke: s.color, 'stroke-width': 2 });
+  });
+
+  this.cross = chartElement(svg, 'line', { y1: top, y2: bottom, stroke: '#ccc', visibility: 'hidden' });
+};
+
+// the values of all visible series next to the mouse position
+LineChart.prototype.showTip = function(e) {
+  var box = this.svg.getBoundingClientRect();
+  var px = e.clientX - box.left;
+  var time = this.timeAt(px);
+  var lines = [];
+  var tipTime = null;
+
+  if (px < this.plot.left || px > this.plot.right) {
+    this.hideTip();
+    return;
+  }
+  this.series.forEach(function(s) {
+    var best = null;
+    if (!s.visible) {
+      return;
+    }
+    s.data.forEach(function(p) {
+      if (best == null || Math.abs(p[0] - time) < Math.abs(best[0] - time)) {
+        best = p;
+      }
+    });
+    if (best != null) {
+      tipTime = best[0];
+      lines.push('<span style="color:' + s.color + '">&#9679;</span> ' + s.name + ': <b>' + chartNumber(best[1]) + '</b>');
+    }
+  });
+  if (lines.length == 0) {
+    this.hideTip();
+    return;
+  }
+
+  var x = this.scaleX(tipTime);
+  this.cross.setAttribute('x1', x);
+  this.cross.setAttribute('x2', x);
+  this.cross.setAttribute('visibility', 'visible');
+  this.tip.innerHTML = chartTime(tipTime) + '<br>' + lines.join('<br>');
+  this.tip.style.display = 'block';
+  var tipLeft = x + 12;
+  if (tipLeft + this.tip.offsetWidth > this.plot.right) {
+    tipLeft = x - 12 - this.tip.offsetWidth;
+  }
+  this.tip.style.left = tipLeft + 'px';
+  this.tip.style.top = (this.legend.offsetHeight + this.plot.top + 10) + 'px';
+};
+
+LineChart.prototype.hideTip = function() {
+  this.tip.style.display = 'none';
+  if (this.cross) {
+    this.cross.setAttribute('visibility', 'hidden');
+  }
+};
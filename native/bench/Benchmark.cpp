@@ -0,0 +1,647 @@
+// Benchmarks of the hot paths, built by env:native and run on the development machine:
+//   pio run -e native -t exec
+// or, for the benchmarks with a name containing <filter>, after the build:
+//   .pio/build/native/program <filter>
+// Every benchmark writes one JSON line to stdout, so runs can be kept and compared
+// (native/compare.py). The inverter answers from the simulated register maps at once, so the
+// read cycle benchmarks time the request building, the CRC and the decoding only.
+// cycles_per_op is counted with rdtsc on x86 (reference cycles), null elsewhere.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES 1
+#endif
+
+#include "Growatt.h"
+#include "JsonWriter.h"
+#include "Allocations.h"
+#include "InverterSimulator.h"
+#include "StdoutPrint.h"
+
+#if GROWATT_MODBUS_VERSION == 120
+  #include "Growatt120.h"
+#elif GROWATT_MODBUS_VERSION == 124
+  #include "Growatt124.h"
+#elif GROWATT_MODBUS_VERSION == 125
+  #include "Growatt125.h"
+#elif GROWATT_MODBUS_VERSION == 305
+  #include "Growatt305.h"
+#endif
+
+#ifndef BENCH_MIN_TIME_MS
+#define BENCH_MIN_TIME_MS 200
+#endif
+
+// ---- the register scaling before the fixed point numbers, for the .../float benchmarks ----
+
+static size_t _FloatNumber(double value, char *text, size_t size) {
+  int len;
+
+  if (isnan(value) || isinf(value)) {
+    memcpy(text, "null", 4);
+    return 4;
+  }
+  if (fabs(value) < 2147483647.0 && value == (double)(long)value)
+    return snprintf(text, size, "%ld", (long)value);
+
+  len = snprintf(text, size, "%.6f", value);
+  if (len >= (int)size)
+    return snprintf(text, size, "%.6g", value);
+  while (text[len - 1] == '0')
+    len--;
+  if (text[len - 1] == '.')
+    len--;
+  return len;
+}
+
+static double _FloatJsonValue(const sGrowattModbusReg_t &reg, uint32_t value) {
+  float multiplier = reg.Multiplier();
+
+  if (multiplier == (int)multiplier)
+    return value * multiplier;
+  return (int)(value * multiplier * 100 + 0.5) / 100.0;
+}
+
+static void _FloatFormatValue(const sGrowattModbusReg_t &reg, uint32_t value, char *Buffer, size_t size) {
+  float multiplier = reg.Multiplier();
+  float scale = multiplier;
+  int decimals = 0;
+
+  while (decimals < 2 && fabs(scale - round(scale)) > 0.001) {
+    scale *= 10;
+    decimals++;
+  }
+  if (decimals == 0)
+    snprintf(Buffer, size, "%ld", (long)round(value * multiplier));
+  else
+    snprintf(Buffer, size, "%.*f", decimals, (double)value * multiplier);
+}
+
+static void _FloatMember(Print &out, const sGrowattModbusReg_t &reg, uint32_t value) {
+  char text[32];
+
+  out.write('"');
+  out.print(reg.Name());
+  out.write((const uint8_t *)"\":", 2);
+  out.write((const uint8_t *)text, _FloatNumber(_FloatJsonValue(reg, value), text, sizeof(text)));
+  out.write(',');
+}
+
+// Input registers of the values of the Fronius documents, -1 for none (0). The status is not
+// scaled, IDC is the sum of both PV currents.
+enum {
+  FV_PAC, FV_FAC, FV_UAC, FV_IAC, FV_PDC, FV_UDC, FV_IDC1, FV_IDC2, FV_DAY_ENERGY, FV_TOTAL_ENERGY,
+  FV_UAC_L1, FV_UAC_L2, FV_UAC_L3, FV_IAC_L1, FV_IAC_L2, FV_IAC_L3, FV_PAC_L1, FV_PAC_L2, FV_PAC_L3,
+  FV_STATUS, FV_COUNT
+};
+
+static const int FRONIUS_VALUES[FV_COUNT] = {
+#if GROWATT_MODBUS_VERSION == 305
+  P305_AC_POWER, P305_AC_FREQUENCY, P305_AC_VOLTAGE, P305_AC_OUTPUT_CURRENT, P305_DC_POWER, P305_DC_VOLTAGE,
+  P305_DC_INPUT_CURRENT, -1, P305_ENERGY_TODAY, P305_ENERGY_TOTAL,
+  P305_AC_VOLTAGE, -1, -1, P305_AC_OUTPUT_CURRENT, -1, -1, P305_AC_POWER, -1, -1,
+  P305_I_STATUS
+#elif GROWATT_MODBUS_VERSION == 120
+  P120_OUTPUT_POWER, P120_GRID_FREQUENCY, P120_GRID_L1_VOLTAGE, P120_GRID_L1_OUTPUT_CURRENT, P120_INPUT_POWER,
+  P120_PV1_VOLTAGE, P120_PV1_INPUT_CURRENT, P120_PV2_INPUT_CURRENT, P120_ENERGY_TODAY, P120_ENERGY_TOTAL,
+  P120_GRID_L1_VOLTAGE, P120_GRID_L2_VOLTAGE, P120_GRID_L3_VOLTAGE,
+  P120_GRID_L1_OUTPUT_CURRENT, P120_GRID_L2_OUTPUT_CURRENT, P120_GRID_L3_OUTPUT_CURRENT,
+  P120_GRID_L1_OUTPUT_POWER, P120_GRID_L2_OUTPUT_POWER, P120_GRID_L3_OUTPUT_POWER,
+  P120_I_STATUS
+#elif GROWATT_MODBUS_VERSION == 124
+  P124_PAC, P124_FAC, P124_VAC1, P124_IAC1, P124_INPUT_POWER, P124_PV1_VOLTAGE, P124_PV1_CURRENT,
+  P124_PV2_CURRENT, P124_EAC_TODAY, P124_EAC_TOTAL,
+  P124_VAC1, P124_VAC2, P124_VAC3, P124_IAC1, P124_IAC2, P124_IAC3, P124_PAC1, P124_PAC2, P124_PAC3,
+  P124_I_STATUS
+#elif GROWATT_MODBUS_VERSION == 125
+  P125_PAC, P125_FAC, P125_VAC1, P125_IAC1, P125_INPUT_POWER, P125_PV1_VOLTAGE, P125_PV1_CURRENT,
+  P125_PV2_CURRENT, P125_EAC_TODAY, P125_EAC_TOTAL,
+  P125_VAC1, P125_VAC2, P125_VAC3, P125_IAC1, P125_IAC2, P125_IAC3, P125_PAC1, P125_PAC2, P125_PAC3,
+  -1
+#endif
+};
+
+// The Fronius documents of Growatt.cpp, for the .../float benchmarks, which patch the values
+// as doubles into templates of their own
+#define BENCH_FRONIUS_STR(x) #x
+#define BENCH_FRONIUS_DEVICE_TYPE(x) BENCH_FRONIUS_STR(x)
+#define BENCH_FRONIUS_HEAD(arguments) \
+  "{\"Head\":{\"RequestArguments\":{" arguments "}," \
+  "\"Status\":{\"Code\":0,\"Reason\":\"\",\"UserMessage\":\"\"},\"Timestamp\":" JSON_SLOT_STRING "},"
+#define BENCH_FRONIUS_VALUE(name, unit) "\"" name "\":{\"Value\":" JSON_SLOT_NUMBER ",\"Unit\":\"" unit "\"}"
+
+static const char BENCH_REALTIME_TEXT[] PROGMEM =
+  BENCH_FRONIUS_HEAD("\"DeviceId\":1,\"Scope\":\"Device\",\"DataCollection\":\"CommonInverterData\"")
+  "\"Body\":{\"Data\":{"
+  BENCH_FRONIUS_VALUE("PAC", "W") "," BENCH_FRONIUS_VALUE("PDC", "W") "," BENCH_FRONIUS_VALUE("FAC", "Hz") ","
+  BENCH_FRONIUS_VALUE("UAC", "V") "," BENCH_FRONIUS_VALUE("IAC", "A") ","
+  BENCH_FRONIUS_VALUE("UAC_L1", "V") "," BENCH_FRONIUS_VALUE("UAC_L2", "V") "," BENCH_FRONIUS_VALUE("UAC_L3", "V") ","
+  BENCH_FRONIUS_VALUE("IAC_L1", "A") "," BENCH_FRONIUS_VALUE("IAC_L2", "A") "," BENCH_FRONIUS_VALUE("IAC_L3", "A") ","
+  "\"DeviceStatus\":{\"ErrorCode\":0,\"StatusCode\":" JSON_SLOT_NUMBER ",\"Status\":" JSON_SLOT_STRING "},"
+  BENCH_FRONIUS_VALUE("PAC_L1", "W") "," BENCH_FRONIUS_VALUE("PAC_L2", "W") "," BENCH_FRONIUS_VALUE("PAC_L3", "W") ","
+  BENCH_FRONIUS_VALUE("UDC", "V") "," BENCH_FRONIUS_VALUE("IDC", "A") ","
+  BENCH_FRONIUS_VALUE("DAY_ENERGY", "Wh") "," BENCH_FRONIUS_VALUE("DAY_ENERGY_L1", "Wh") ","
+  BENCH_FRONIUS_VALUE("DAY_ENERGY_L2", "Wh") "," BENCH_FRONIUS_VALUE("DAY_ENERGY_L3", "Wh") ","
+  BENCH_FRONIUS_VALUE("TOTAL_ENERGY", "Wh") "," BENCH_FRONIUS_VALUE("TOTAL_ENERGY_L1", "Wh") ","
+  BENCH_FRONIUS_VALUE("TOTAL_ENERGY_L2", "Wh") "," BENCH_FRONIUS_VALUE("TOTAL_ENERGY_L3", "Wh")
+  "}}}";
+
+static const char BENCH_POWER_FLOW_TEXT[] PROGMEM =
+  BENCH_FRONIUS_HEAD("")
+  "\"Body\":{\"Data\":{\"Site\":{\"P_PV\":" JSON_SLOT_NUMBER ",\"P_Load\":" JSON_SLOT_NUMBER ","
+  "\"E_DAY\":" JSON_SLOT_NUMBER ",\"E_TOTAL\":" JSON_SLOT_NUMBER "},"
+  "\"Inverters\":{\"1\":{\"DT\":" BENCH_FRONIUS_DEVICE_TYPE(FRONIUS_DEVICE_TYPE) ",\"P\":" JSON_SLOT_NUMBER "}}}}}";
+
+static const char BENCH_INVERTER_INFO_TEXT[] PROGMEM =
+  BENCH_FRONIUS_HEAD("")
+  "\"Body\":{\"Data\":{\"1\":{\"CustomName\":\"Growatt Inverter\","
+  "\"DT\":" BENCH_FRONIUS_DEVICE_TYPE(FRONIUS_DEVICE_TYPE) ",\"ErrorCode\":0,\"PVPower\":" JSON_SLOT_NUMBER ",\"Show\":1,"
+  "\"StatusCode\":" JSON_SLOT_NUMBER ",\"Status\":" JSON_SLOT_STRING ",\"UniqueID\":\"" FRONIUS_SERIAL "\"}}}}";
+
+static JsonTemplate BenchRealtimeTemplate(BENCH_REALTIME_TEXT, 27);
+static JsonTemplate BenchPowerFlowTemplate(BENCH_POWER_FLOW_TEXT, 6);
+static JsonTemplate BenchInverterInfoTemplate(BENCH_INVERTER_INFO_TEXT, 4);
+
+static double _FloatRound2(double value) {
+  return (int)(value * 100 + 0.5) / 100.0;
+}
+
+static void _FloatUIEntry(JsonWriter &json, const __FlashStringHelper *name, double value, const char *unit, bool plot) {
+  json.BeginArray(name);
+  json.Value(value);
+  json.Value(unit);
+  json.Value(plot);
+  json.EndArray();
+}
+
+// Reaches the private steps of the inverter class. The .../ArduinoJson benchmarks build the
+// Fronius documents as before the templates (JsonTemplate), the .../float ones render the
+// documents as before the fixed point numbers, for comparison with them.
+class GrowattBenchmark {
+  public:
+    static void UpdateEnergyAccumulation(Growatt &inverter) { inverter._UpdateEnergyAccumulation(); }
+
+    static void CreateJsonFloat(Growatt &inverter, Print &out, const char *MacAddress) {
+      // CreateJson() with the float multiplier and printf, the names need no escaping
+      const sProtocolDefinition_t &protocol = inverter._Protocol;
+
+      out.write('{');
+      for (int i = 0; i < protocol.InputRegisterCount; i++) {
+        _FloatMember(out, protocol.InputRegisters[i], protocol.InputValues[i]);
+      }
+      for (int i = 0; i < protocol.HoldingRegisterCount; i++) {
+        if (inverter.IsDuplicateHolding(i))
+          continue;
+        _FloatMember(out, protocol.HoldingRegisters[i], protocol.HoldingValues[i]);
+      }
+      out.print("\"Mac\":\"");
+      out.print(MacAddress);
+      out.print("\",\"Cnt\":");
+      out.print((unsigned long)inverter._ValuesPacketCnt);
+      out.write('}');
+    }
+
+    static double FloatScaled(Growatt &inverter, int reg) {
+      // the scaling before the fixed point numbers: the raw value times the float multiplier
+      if (reg < 0)
+        return 0;
+      return inverter._Protocol.InputValues[reg] * inverter._Protocol.InputRegisters[reg].Multiplier();
+    }
+
+    static void CreateUIJsonFloat(Growatt &inverter, Print &out) {
+      // CreateUIJson() with the float multiplier and the aggregates in doubles
+      const sProtocolDefinition_t &protocol = inverter._Protocol;
+      const char *unitStr[] = {"", "W", "kWh", "V", "A", "s", "%", "Hz", "C", "VA"};
+      JsonWriter json(out);
+      double v[FV_COUNT];
+
+      json.BeginObject();
+      for (int i = 0; i < protocol.InputRegisterCount; i++) {
+        const sGrowattModbusReg_t &reg = protocol.InputRegisters[i];
+        if (reg.Frontend() || reg.Plot())
+          _FloatUIEntry(json, reg.Name(), _FloatJsonValue(reg, protocol.InputValues[i]), unitStr[reg.Unit()], reg.Plot());
+      }
+      for (int i = 0; i < protocol.HoldingRegisterCount; i++) {
+        const sGrowattModbusReg_t &reg = protocol.HoldingRegisters[i];
+        if (inverter.IsDuplicateHolding(i))
+          continue;
+        if (reg.Frontend() || reg.Plot())
+          _FloatUIEntry(json, reg.Name(), _FloatJsonValue(reg, protocol.HoldingValues[i]), unitStr[reg.Unit()], reg.Plot());
+      }
+
+      for (int i = 0; i < FV_COUNT; i++) {
+        v[i] = FloatScaled(inverter, FRONIUS_VALUES[i]);
+      }
+      double dayE = v[FV_DAY_ENERGY] * 1000.0;
+      double uacAvg = (v[FV_UAC_L1] + v[FV_UAC_L2] + v[FV_UAC_L3]) / 3.0;
+      double iacAvg = (v[FV_IAC_L1] + v[FV_IAC_L2] + v[FV_IAC_L3]) / 3.0;
+      double sumPac = v[FV_PAC_L1] + v[FV_PAC_L2] + v[FV_PAC_L3];
+      double dayE_l1 = (sumPac != 0) ? dayE * v[FV_PAC_L1] / sumPac : 0;
+      double dayE_l2 = (sumPac != 0) ? dayE * v[FV_PAC_L2] / sumPac : 0;
+      double dayE_l3 = (sumPac != 0) ? dayE * v[FV_PAC_L3] / sumPac : 0;
+
+      _FloatUIEntry(json, F("VoltageAvg"), _FloatRound2(uacAvg), "V", false);
+      _FloatUIEntry(json, F("LineVoltageAvg"), _FloatRound2(uacAvg * 1.7320508), "V", false);
+      _FloatUIEntry(json, F("CurrentAvg"), _FloatRound2(iacAvg), "A", false);
+      _FloatUIEntry(json, F("PowerSum"), _FloatRound2(sumPac), "W", false);
+      _FloatUIEntry(json, F("DayEnergyL1"), _FloatRound2(dayE_l1 / 1000.0), "kWh", false);
+      _FloatUIEntry(json, F("DayEnergyL2"), _FloatRound2(dayE_l2 / 1000.0), "kWh", false);
+      _FloatUIEntry(json, F("DayEnergyL3"), _FloatRound2(dayE_l3 / 1000.0), "kWh", false);
+      _FloatUIEntry(json, F("TotalEnergyL1"), _FloatRound2(inverter._PhaseEnergy.Total(0) / 1000.0), "kWh", false);
+      _FloatUIEntry(json, F("TotalEnergyL2"), _FloatRound2(inverter._PhaseEnergy.Total(1) / 1000.0), "kWh", false);
+      _FloatUIEntry(json, F("TotalEnergyL3"), _FloatRound2(inverter._PhaseEnergy.Total(2) / 1000.0), "kWh", false);
+      json.EndObject();
+    }
+
+    static void FroniusFloat(Growatt &inverter, Print &out) {
+      // CreateFroniusJson() with the float multiplier and the day energy split in doubles
+      char ts[30];
+      double v[FV_COUNT];
+
+      if (!BenchRealtimeTemplate.Begin())
+        return;
+      for (int i = 0; i < FV_COUNT; i++) {
+        v[i] = FloatScaled(inverter, FRONIUS_VALUES[i]);
+      }
+      double dayE = v[FV_DAY_ENERGY] * 1000.0;
+      double sumPac = v[FV_PAC_L1] + v[FV_PAC_L2] + v[FV_PAC_L3];
+      uint32_t gwStatus = (FRONIUS_VALUES[FV_STATUS] < 0) ? 0 : inverter._Protocol.InputValues[FRONIUS_VALUES[FV_STATUS]];
+      uint8_t froniusStatus = Growatt::MapStatusToFronius(gwStatus);
+      uint8_t slot = 0;
+
+      Growatt::_FroniusTimestamp(ts, sizeof(ts));
+      BenchRealtimeTemplate.SetString(slot++, ts);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_PAC]);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_PDC]);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_FAC]);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_UAC]);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_IAC]);
+      for (int i = FV_UAC_L1; i <= FV_IAC_L3; i++) {
+        BenchRealtimeTemplate.SetNumber(slot++, v[i]);
+      }
+      BenchRealtimeTemplate.SetNumber(slot++, (double)froniusStatus);
+      BenchRealtimeTemplate.SetString(slot++, Growatt::FroniusStatusToString(froniusStatus));
+      for (int i = FV_PAC_L1; i <= FV_PAC_L3; i++) {
+        BenchRealtimeTemplate.SetNumber(slot++, v[i]);
+      }
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_UDC]);
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_IDC1] + v[FV_IDC2]);
+      BenchRealtimeTemplate.SetNumber(slot++, dayE);
+      for (int i = FV_PAC_L1; i <= FV_PAC_L3; i++) {
+        BenchRealtimeTemplate.SetNumber(slot++, (sumPac != 0) ? dayE * v[i] / sumPac : 0);
+      }
+      BenchRealtimeTemplate.SetNumber(slot++, v[FV_TOTAL_ENERGY] * 1000.0);
+      for (int i = 0; i < 3; i++) {
+        BenchRealtimeTemplate.SetNumber(slot++, (double)inverter._PhaseEnergy.Total(i));
+      }
+      BenchRealtimeTemplate.Write(out);
+    }
+
+    static void PowerFlowFloat(Growatt &inverter, Print &out) {
+      char ts[30];
+      double pac = FloatScaled(inverter, FRONIUS_VALUES[FV_PAC]);
+
+      if (!BenchPowerFlowTemplate.Begin())
+        return;
+      Growatt::_FroniusTimestamp(ts, sizeof(ts));
+      BenchPowerFlowTemplate.SetString(0, ts);
+      BenchPowerFlowTemplate.SetNumber(1, FloatScaled(inverter, FRONIUS_VALUES[FV_PDC]));
+      BenchPowerFlowTemplate.SetNumber(2, pac);
+      BenchPowerFlowTemplate.SetNumber(3, FloatScaled(inverter, FRONIUS_VALUES[FV_DAY_ENERGY]) * 1000.0);
+      BenchPowerFlowTemplate.SetNumber(4, FloatScaled(inverter, FRONIUS_VALUES[FV_TOTAL_ENERGY]) * 1000.0);
+      BenchPowerFlowTemplate.SetNumber(5, pac);
+      BenchPowerFlowTemplate.Write(out);
+    }
+
+    static void InverterInfoFloat(Growatt &inverter, Print &out) {
+      char ts[30];
+      double pdc = (GROWATT_MODBUS_VERSION == 125) ? 0 : FloatScaled(inverter, FRONIUS_VALUES[FV_PDC]) * 1000.0;
+      uint32_t gwStatus = (FRONIUS_VALUES[FV_STATUS] < 0) ? 0 : inverter._Protocol.InputValues[FRONIUS_VALUES[FV_STATUS]];
+      uint8_t froniusStatus = Growatt::MapStatusToFronius(gwStatus);
+
+      if (!BenchInverterInfoTemplate.Begin())
+        return;
+      Growatt::_FroniusTimestamp(ts, sizeof(ts));
+      BenchInverterInfoTemplate.SetString(0, ts);
+      BenchInverterInfoTemplate.SetNumber(1, (double)(uint32_t)pdc);
+      BenchInverterInfoTemplate.SetNumber(2, (double)froniusStatus);
+      BenchInverterInfoTemplate.SetString(3, Growatt::FroniusStatusToString(froniusStatus));
+      BenchInverterInfoTemplate.Write(out);
+    }
+
+    static void FroniusHead(JsonDocument &doc) {
+      char ts[30];
+      JsonObject head = doc.createNestedObject("Head");
+      head.createNestedObject("RequestArguments");
+      JsonObject status = head.createNestedObject("Status");
+      status["Code"] = 0;
+      status["Reason"] = "";
+      status["UserMessage"] = "";
+      Growatt::_FroniusTimestamp(ts, sizeof(ts));
+      head["Timestamp"] = ts;
+    }
+
+    static void FroniusValue(JsonObject data, const char *key, double value, const char *unit) {
+      JsonObject object = data.createNestedObject(key);
+      object["Value"] = value;
+      object["Unit"] = unit;
+    }
+
+    static void FroniusArduinoJson(Growatt &inverter, Print &out) {
+      StaticJsonDocument<2048> doc;
+      double v[FV_COUNT];
+
+      for (int i = 0; i < FV_COUNT; i++) {
+        v[i] = FloatScaled(inverter, FRONIUS_VALUES[i]);
+      }
+      double dayE = v[FV_DAY_ENERGY] * 1000.0;
+      double sumPac = v[FV_PAC_L1] + v[FV_PAC_L2] + v[FV_PAC_L3];
+      uint32_t gwStatus = (FRONIUS_VALUES[FV_STATUS] < 0) ? 0 : inverter._Protocol.InputValues[FRONIUS_VALUES[FV_STATUS]];
+      uint8_t froniusStatus = Growatt::MapStatusToFronius(gwStatus);
+
+      FroniusHead(doc);
+      JsonObject req = doc["Head"]["RequestArguments"];
+      req["DeviceId"] = 1;
+      req["Scope"] = "Device";
+      req["DataCollection"] = "CommonInverterData";
+      JsonObject data = doc.createNestedObject("Body").createNestedObject("Data");
+      FroniusValue(data, "PAC", v[FV_PAC], "W");
+      FroniusValue(data, "PDC", v[FV_PDC], "W");
+      FroniusValue(data, "FAC", v[FV_FAC], "Hz");
+      FroniusValue(data, "UAC", v[FV_UAC], "V");
+      FroniusValue(data, "IAC", v[FV_IAC], "A");
+      FroniusValue(data, "UAC_L1", v[FV_UAC_L1], "V");
+      FroniusValue(data, "UAC_L2", v[FV_UAC_L2], "V");
+      FroniusValue(data, "UAC_L3", v[FV_UAC_L3], "V");
+      FroniusValue(data, "IAC_L1", v[FV_IAC_L1], "A");
+      FroniusValue(data, "IAC_L2", v[FV_IAC_L2], "A");
+      FroniusValue(data, "IAC_L3", v[FV_IAC_L3], "A");
+      JsonObject devStat = data.createNestedObject("DeviceStatus");
+      devStat["ErrorCode"] = 0;
+      devStat["StatusCode"] = froniusStatus;
+      devStat["Status"] = Growatt::FroniusStatusToString(froniusStatus);
+      FroniusValue(data, "PAC_L1", v[FV_PAC_L1], "W");
+      FroniusValue(data, "PAC_L2", v[FV_PAC_L2], "W");
+      FroniusValue(data, "PAC_L3", v[FV_PAC_L3], "W");
+      FroniusValue(data, "UDC", v[FV_UDC], "V");
+      FroniusValue(data, "IDC", v[FV_IDC1] + v[FV_IDC2], "A");
+      FroniusValue(data, "DAY_ENERGY", dayE, "Wh");
+      FroniusValue(data, "DAY_ENERGY_L1", (sumPac != 0) ? dayE * v[FV_PAC_L1] / sumPac : 0, "Wh");
+      FroniusValue(data, "DAY_ENERGY_L2", (sumPac != 0) ? dayE * v[FV_PAC_L2] / sumPac : 0, "Wh");
+      FroniusValue(data, "DAY_ENERGY_L3", (sumPac != 0) ? dayE * v[FV_PAC_L3] / sumPac : 0, "Wh");
+      FroniusValue(data, "TOTAL_ENERGY", v[FV_TOTAL_ENERGY] * 1000.0, "Wh");
+      FroniusValue(data, "TOTAL_ENERGY_L1", inverter._PhaseEnergy.Total(0), "Wh");
+      FroniusValue(data, "TOTAL_ENERGY_L2", inverter._PhaseEnergy.Total(1), "Wh");
+      FroniusValue(data, "TOTAL_ENERGY_L3", inverter._PhaseEnergy.Total(2), "Wh");
+      serializeJson(doc, out);
+    }
+
+    static void PowerFlowArduinoJson(Growatt &inverter, Print &out) {
+      StaticJsonDocument<2048> doc;
+      double pac = FloatScaled(inverter, FRONIUS_VALUES[FV_PAC]);
+
+      FroniusHead(doc);
+      JsonObject data = doc.createNestedObject("Body").createNestedObject("Data");
+      JsonObject site = data.createNestedObject("Site");
+      site["P_PV"] = FloatScaled(inverter, FRONIUS_VALUES[FV_PDC]);
+      site["P_Load"] = pac;
+      site["E_DAY"] = FloatScaled(inverter, FRONIUS_VALUES[FV_DAY_ENERGY]) * 1000.0;
+      site["E_TOTAL"] = FloatScaled(inverter, FRONIUS_VALUES[FV_TOTAL_ENERGY]) * 1000.0;
+      JsonObject inv = data.createNestedObject("Inverters").createNestedObject("1");
+      inv["DT"] = FRONIUS_DEVICE_TYPE;
+      inv["P"] = pac;
+      serializeJson(doc, out);
+    }
+
+    static void InverterInfoArduinoJson(Growatt &inverter, Print &out) {
+      StaticJsonDocument<512> doc;
+      double pdc = (GROWATT_MODBUS_VERSION == 125) ? 0 : FloatScaled(inverter, FRONIUS_VALUES[FV_PDC]) * 1000.0;
+      uint32_t gwStatus = (FRONIUS_VALUES[FV_STATUS] < 0) ? 0 : inverter._Protocol.InputValues[FRONIUS_VALUES[FV_STATUS]];
+      uint8_t froniusStatus = Growatt::MapStatusToFronius(gwStatus);
+
+      FroniusHead(doc);
+      JsonObject inv = doc.createNestedObject("Body").createNestedObject("Data").createNestedObject("1");
+      inv["CustomName"] = "Growatt Inverter";
+      inv["DT"] = FRONIUS_DEVICE_TYPE;
+      inv["ErrorCode"] = 0;
+      inv["PVPower"] = (uint32_t)pdc;
+      inv["Show"] = 1;
+      inv["StatusCode"] = froniusStatus;
+      inv["Status"] = Growatt::FroniusStatusToString(froniusStatus);
+      inv["UniqueID"] = FRONIUS_SERIAL;
+      serializeJson(doc, out);
+    }
+};
+
+typedef void (*Operation_t)(Growatt &inverter, Print &out);
+
+typedef struct {
+  const char *Name;
+  Operation_t Run;
+} sBenchmark_t;
+
+static const char MAC[] = "AA:BB:CC:DD:EE:FF";
+
+static const sBenchmark_t BENCHMARKS[] = {
+  {"ReadData/full", [](Growatt &inverter, Print &) { inverter.ReadData(true); }},
+  {"ReadData/scheduled", [](Growatt &inverter, Print &) { inverter.ReadData(false); }},
+  {"UpdateEnergyAccumulation", [](Growatt &inverter, Print &) { GrowattBenchmark::UpdateEnergyAccumulation(inverter); }},
+  {"CreateJson", [](Growatt &inverter, Print &out) { inverter.CreateJson(out, MAC); }},
+  {"CreateJson/float", [](Growatt &inverter, Print &out) { GrowattBenchmark::CreateJsonFloat(inverter, out, MAC); }},
+  {"CreateDeltaJson", [](Growatt &inverter, Print &out) {
+    inverter.PrepareDeltaJson(true);
+    inverter.CreateDeltaJson(out, MAC);
+  }},
+  {"CreateMsgPack", [](Growatt &inverter, Print &out) { inverter.CreateMsgPack(out, MAC); }},
+  {"CreateDeltaMsgPack", [](Growatt &inverter, Print &out) {
+    inverter.PrepareDeltaJson(true);
+    inverter.CreateDeltaMsgPack(out, MAC);
+  }},
+  {"CreateSchemaJson", [](Growatt &inverter, Print &out) { inverter.CreateSchemaJson(out); }},
+  {"CreateUIJson", [](Growatt &inverter, Print &out) { inverter.CreateUIJson(out, false); }},
+  {"CreateUIJson/values", [](Growatt &inverter, Print &out) { inverter.CreateUIJson(out, true); }},
+  {"CreateUIJson/float", GrowattBenchmark::CreateUIJsonFloat},
+  {"CreateFroniusJson", [](Growatt &inverter, Print &out) { inverter.CreateFroniusJson(out); }},
+  {"CreateFroniusJson/float", GrowattBenchmark::FroniusFloat},
+  {"CreateFroniusJson/ArduinoJson", GrowattBenchmark::FroniusArduinoJson},
+  {"CreatePowerFlowJson", [](Growatt &inverter, Print &out) { inverter.CreatePowerFlowJson(out); }},
+  {"CreatePowerFlowJson/float", GrowattBenchmark::PowerFlowFloat},
+  {"CreatePowerFlowJson/ArduinoJson", GrowattBenchmark::PowerFlowArduinoJson},
+  {"CreateDeviceInfoJson", [](Growatt &inverter, Print &out) { inverter.CreateDeviceInfoJson(out); }},
+  {"CreateInverterInfoJson", [](Growatt &inverter, Print &out) { inverter.CreateInverterInfoJson(out); }},
+  {"CreateInverterInfoJson/float", GrowattBenchmark::InverterInfoFloat},
+  {"CreateInverterInfoJson/ArduinoJson", GrowattBenchmark::InverterInfoArduinoJson},
+  {"CreateLoggerInfoJson", [](Growatt &inverter, Print &out) { inverter.CreateLoggerInfoJson(out); }},
+  {"CreateActiveDeviceInfoJson", [](Growatt &inverter, Print &out) { inverter.CreateActiveDeviceInfoJson(out); }},
+  {"CreateDiscoveryJson/all", [](Growatt &inverter, Print &out) {
+    for (int i = 0; i < inverter._Protocol.InputRegisterCount; i++) {
+      Growatt::CreateDiscoveryJson(out, inverter.GetInputRegister(i), "growatt/r", "growatt");
+    }
+  }},
+  {"FormatValue/all", [](Growatt &inverter, Print &out) {
+    char text[24];
+    for (int i = 0; i < inverter._Protocol.InputRegisterCount; i++) {
+      Growatt::FormatValue(inverter.GetInputRegister(i), inverter.GetInputValue(i), text, sizeof(text));
+      out.write(text);
+    }
+  }},
+  {"FormatValue/all/float", [](Growatt &inverter, Print &out) {
+    char text[24];
+    for (int i = 0; i < inverter._Protocol.InputRegisterCount; i++) {
+      _FloatFormatValue(inverter.GetInputRegister(i), inverter.GetInputValue(i), text, sizeof(text));
+      out.write(text);
+    }
+  }},
+  // everything a read cycle renders for the web server and the Fronius clients
+  {"Snapshot", [](Growatt &inverter, Print &out) {
+    inverter.CreateJson(out, MAC);
+    inverter.CreateUIJson(out, false);
+    inverter.CreateFroniusJson(out);
+    inverter.CreatePowerFlowJson(out);
+    inverter.CreateInverterInfoJson(out);
+  }},
+  {"Snapshot/float", [](Growatt &inverter, Print &out) {
+    GrowattBenchmark::CreateJsonFloat(inverter, out, MAC);
+    GrowattBenchmark::CreateUIJsonFloat(inverter, out);
+    GrowattBenchmark::FroniusFloat(inverter, out);
+    GrowattBenchmark::PowerFlowFloat(inverter, out);
+    GrowattBenchmark::InverterInfoFloat(inverter, out);
+  }},
+  {"GetCachedJson/status", [](Growatt &inverter, Print &out) {
+    const char *json;
+    size_t length;
+    if (inverter.GetCachedJson(JSON_STATUS, MAC, &json, &length))
+      out.write((const uint8_t *)json, length);
+  }},
+};
+
+static uint64_t _Nanoseconds() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint64_t _Cycles() {
+#if BENCH_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void _FillRegisters(Growatt &inverter) {
+  /**
+   * @brief Give every register of the tables a plausible value of a few digits, the output
+   *        length then resembles a running inverter. Status registers read 1 (normal).
+   */
+  const sGrowattModbusReg_t *tables[] = {inverter._Protocol.InputRegisters, inverter._Protocol.HoldingRegisters};
+  uint16_t counts[] = {inverter._Protocol.InputRegisterCount, inverter._Protocol.HoldingRegisterCount};
+
+  for (int t = 0; t < 2; t++) {
+    for (int i = 0; i < counts[t]; i++) {
+      const sGrowattModbusReg_t &reg = tables[t][i];
+      uint16_t value = (i == 0) ? 1 : 1000 + (reg.Address() * 7919UL) % 4000;
+
+      if (reg.Size() == SIZE_32BIT) {
+        if (t == 0) {
+          Inverter485.SetInput(reg.Address(), 0);
+          Inverter485.SetInput(reg.Address() + 1, value);
+        } else {
+          Inverter485.SetHolding(reg.Address(), 0);
+          Inverter485.SetHolding(reg.Address() + 1, value);
+        }
+      } else if (t == 0) {
+        Inverter485.SetInput(reg.Address(), value);
+      } else {
+        Inverter485.SetHolding(reg.Address(), value);
+      }
+    }
+  }
+}
+
+static void _Run(Growatt &inverter, const sBenchmark_t &benchmark) {
+  /**
+   * @brief Run a benchmark in growing batches until a batch takes BENCH_MIN_TIME_MS and
+   *        report that batch
+   */
+  CountingPrint counter;
+  StdoutPrint out;
+  JsonWriter json(out);
+  uint64_t iterations = 1;
+  uint64_t elapsed, cycles, count, bytes;
+
+  // warm up: caches, templates and lazily allocated buffers
+  benchmark.Run(inverter, counter);
+
+  for (;;) {
+    CountingPrint output;
+    uint64_t allocations = Allocations::Count();
+    uint64_t allocated = Allocations::Bytes();
+    uint64_t start = _Nanoseconds();
+    uint64_t startCycles = _Cycles();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+      benchmark.Run(inverter, output);
+    }
+    cycles = _Cycles() - startCycles;
+    elapsed = _Nanoseconds() - start;
+    count = Allocations::Count() - allocations;
+    bytes = Allocations::Bytes() - allocated;
+    if (elapsed >= BENCH_MIN_TIME_MS * 1000000ULL || iterations >= (1ULL << 32)) {
+      counter = output;
+      break;
+    }
+    iterations *= 2;
+  }
+
+  json.BeginObject();
+  json.Member(F("protocol"), GROWATT_MODBUS_VERSION);
+  json.Member(F("benchmark"), benchmark.Name);
+  json.Member(F("iterations"), (unsigned long)iterations);
+  json.Member(F("ns_per_op"), sFixedPoint_t::FromDouble((double)elapsed / iterations, -1));
+#if BENCH_CYCLES
+  json.Member(F("cycles_per_op"), sFixedPoint_t::FromDouble((double)cycles / iterations, 0));
+#else
+  (void)cycles;
+  json.Key(F("cycles_per_op"));
+  json.Null();
+#endif
+  if (Allocations::Counted()) {
+    json.Member(F("allocs_per_op"), sFixedPoint_t::FromDouble((double)count / iterations, -2));
+    json.Member(F("alloc_bytes_per_op"), sFixedPoint_t::FromDouble((double)bytes / iterations, -1));
+  } else {
+    json.Key(F("allocs_per_op"));
+    json.Null();
+    json.Key(F("alloc_bytes_per_op"));
+    json.Null();
+  }
+  json.Member(F("output_bytes"), (unsigned long)(counter.Count() / iterations));
+  json.EndObject();
+  out.write('\n');
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  Growatt inverter;
+  const char *filter = (argc > 1) ? argv[1] : NULL;
+
+  inverter.InitProtocol();
+  _FillRegisters(inverter);
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  if (inverter.GetWiFiStickType() == Undef_stick || !inverter.ReadData(true)) {
+    fprintf(stderr, "the simulated inverter did not answer\n");
+    return 1;
+  }
+
+  for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++) {
+    if (filter == NULL || strstr(BENCHMARKS[i].Name, filter) != NULL)
+      _Run(inverter, BENCHMARKS[i]);
+  }
+  return 0;
+}
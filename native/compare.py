@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compare two benchmark runs of the native build.
+
+    pio run -e native -t exec > before.jsonl
+    ... change something ...
+    pio run -e native -t exec > after.jsonl
+    python3 native/compare.py before.jsonl after.jsonl [--threshold 10]
+
+Exits with 1 if a benchmark got slower or allocates more than the threshold (percent).
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue  # PlatformIO output around the results
+            result = json.loads(line)
+            results[(result["protocol"], result["benchmark"])] = result
+    return results
+
+
+def change(before, after):
+    if before is None or after is None:
+        return None
+    if before == 0:
+        return 0.0 if after == 0 else float("inf")
+    return 100.0 * (after - before) / before
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    regressions = 0
+
+    print("%-8s %-28s %12s %12s %8s %10s" % ("protocol", "benchmark", "ns before", "ns after", "change", "allocs"))
+    for key in sorted(before.keys() & after.keys()):
+        b, a = before[key], after[key]
+        time = change(b["ns_per_op"], a["ns_per_op"])
+        allocs = change(b["allocs_per_op"], a["allocs_per_op"])
+        flag = ""
+        if time > args.threshold or (allocs is not None and allocs > args.threshold):
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-8s %-28s %12.1f %12.1f %+7.1f%% %10s%s" % (
+            key[0], key[1], b["ns_per_op"], a["ns_per_op"], time,
+            "-" if a["allocs_per_op"] is None else a["allocs_per_op"], flag))
+    for key in sorted(before.keys() - after.keys()):
+        print("%-8s %-28s missing in %s" % (key[0], key[1], args.after))
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
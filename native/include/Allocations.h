@@ -0,0 +1,16 @@
+#ifndef _ALLOCATIONS_H_
+#define _ALLOCATIONS_H_
+
+// Heap accounting of the native build: malloc/calloc/realloc (and new, which uses them) are
+// counted. Only available with glibc, elsewhere Counted() is false and the counters stay 0.
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Allocations {
+  bool Counted();
+  uint64_t Count();
+  uint64_t Bytes();
+}
+
+#endif // _ALLOCATIONS_H_
@@ -0,0 +1,70 @@
+#ifndef _CAPTURE_REPLAY_H_
+#define _CAPTURE_REPLAY_H_
+
+// Answers of the simulated inverter taken from a capture of the Modbus traffic of a real site
+// (ModbusCapture.h, <ip>/capture). A request gets the answer of the next recorded request with
+// the same function, address and quantity, looking ahead at most REPLAY_WINDOW records. The
+// records passed over are counted as skipped. Requests the capture doesn't contain (e.g. the
+// detection of the inverter) are answered at once from the registers seen in the capture.
+
+#include <Arduino.h>
+
+#include <map>
+#include <vector>
+
+#define REPLAY_WINDOW 32
+
+typedef struct {
+  // milliseconds since the first request of the capture, latency in microseconds
+  uint32_t Time;
+  uint32_t Latency;
+  uint8_t Function;
+  uint8_t Result;
+  uint16_t Address;
+  uint16_t Value;
+  // index of the registers of a successful read in the register list
+  uint32_t Registers;
+} sReplayRecord_t;
+
+typedef struct {
+  uint8_t Result;
+  uint32_t Latency;
+  // registers of a successful read
+  const uint16_t *Registers;
+  uint16_t Count;
+} sReplayAnswer_t;
+
+class CaptureReplay {
+  public:
+    CaptureReplay();
+
+    bool Load(const char *path);
+    uint16_t Protocol() const { return _Protocol; }
+    size_t RecordCount() const { return _Records.size(); }
+    uint32_t Duration() const { return _Records.empty() ? 0 : _Records.back().Time; }
+
+    bool Done() const { return _Next >= _Records.size(); }
+    uint32_t NextTime() const { return Done() ? Duration() : _Records[_Next].Time; }
+    void Skip();
+    void Answer(uint8_t function, uint16_t address, uint16_t value, sReplayAnswer_t &answer);
+
+    uint32_t Matched() const { return _Matched; }
+    uint32_t Skipped() const { return _Skipped; }
+    uint32_t Unmatched() const { return _Unmatched; }
+    uint64_t MatchedLatency() const { return _MatchedLatency; }
+
+  private:
+    uint16_t _Protocol;
+    std::vector<sReplayRecord_t> _Records;
+    std::vector<uint16_t> _Registers;
+    // first value seen of every input (0) and holding (1) register
+    std::map<uint16_t, uint16_t> _Image[2];
+    std::vector<uint16_t> _Scratch;
+    size_t _Next;
+    uint32_t _Matched;
+    uint32_t _Skipped;
+    uint32_t _Unmatched;
+    uint64_t _MatchedLatency;
+};
+
+#endif // _CAPTURE_REPLAY_H_
@@ -0,0 +1,18 @@
+#ifndef _NATIVE_CONFIG_H_
+#define _NATIVE_CONFIG_H_
+
+// Configuration of the native build: Config.h.example with the protocol of the environment
+// (NATIVE_PROTOCOL). It is included ahead of every file (-include), so a Config.h of your own
+// in the source directory is skipped by its include guard and the results stay comparable.
+
+#include "../../SRC/ShineWiFi-ModBus/Config.h.example"
+
+#ifndef NATIVE_PROTOCOL
+#define NATIVE_PROTOCOL 124
+#endif
+#undef GROWATT_MODBUS_VERSION
+#define GROWATT_MODBUS_VERSION NATIVE_PROTOCOL
+#undef SIMULATE_INVERTER
+#define SIMULATE_INVERTER 0
+
+#endif // _NATIVE_CONFIG_H_
@@ -0,0 +1,58 @@
+#ifndef _INVERTER_SIMULATOR_H_
+#define _INVERTER_SIMULATOR_H_
+
+// Stand-in for the inverter at the other end of Serial in the native build, taking the place
+// of ModbusMaster's slave: answers Modbus RTU requests (read input / holding registers, write
+// single register) at once from two register maps. With a replay the answers, errors and
+// latencies of a capture are reproduced instead (CaptureReplay.h), Fault() spoils a single answer.
+
+#include <Arduino.h>
+
+#include "CaptureReplay.h"
+
+class InverterSimulator {
+  public:
+    InverterSimulator();
+
+    void SetInput(uint16_t address, uint16_t value) { _Input[address] = value; }
+    void SetHolding(uint16_t address, uint16_t value) { _Holding[address] = value; }
+    uint32_t Requests() const { return _Requests; }
+    void SetReplay(CaptureReplay *replay, double speed);
+    void Fault(uint8_t result, uint16_t count = 0);
+
+    void Receive(uint8_t c);
+    int Available();
+    int Read() { return (Available() > 0) ? _Tx[_TxPosition++] : -1; }
+    int Peek() { return (Available() > 0) ? _Tx[_TxPosition] : -1; }
+
+    static uint16_t Crc16(const uint8_t *data, size_t length);
+
+  private:
+    uint16_t _Input[0x10000];
+    uint16_t _Holding[0x10000];
+    uint8_t _Rx[8];
+    uint8_t _RxLength;
+    uint8_t _Tx[260];
+    uint16_t _TxLength;
+    uint16_t _TxPosition;
+    uint32_t _Requests;
+    // replay: the answer is held back for the recorded latency, in real time divided by the speed
+    CaptureReplay *_Replay;
+    double _Speed;
+    bool _Pending;
+    uint32_t _Latency;
+    uint32_t _Wait;
+    uint32_t _RequestMicros;
+    // fault for the next answer: ModbusRtu result and the registers of a successful read
+    bool _Fault;
+    uint8_t _FaultResult;
+    uint16_t _FaultCount;
+
+    void _Answer();
+    void _AnswerReplay(uint8_t function, uint16_t address, uint16_t value);
+    void _AnswerWith(uint8_t function, const sReplayAnswer_t &answer);
+};
+
+extern InverterSimulator Inverter485;
+
+#endif // _INVERTER_SIMULATOR_H_
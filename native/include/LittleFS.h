@@ -0,0 +1,43 @@
+#ifndef _NATIVE_LITTLEFS_H_
+#define _NATIVE_LITTLEFS_H_
+
+// Stand-in of LittleFS for the native build: the files are kept in memory
+
+#include <Arduino.h>
+
+struct sNativeFile_t;
+
+class File : public Stream {
+  public:
+    File() : _File(NULL), _Position(0), _Writable(false) {}
+    File(sNativeFile_t *file, bool writable) : _File(file), _Position(0), _Writable(writable) {}
+
+    explicit operator bool() const { return _File != NULL; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(uint8_t *buffer, size_t size);
+    size_t size() const;
+    void close() { _File = NULL; }
+
+  private:
+    sNativeFile_t *_File;
+    size_t _Position;
+    bool _Writable;
+};
+
+class FS {
+  public:
+    bool begin() { return true; }
+    File open(const char *path, const char *mode);
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool rename(const char *from, const char *to);
+};
+
+extern FS LittleFS;
+
+#endif // _NATIVE_LITTLEFS_H_
@@ -0,0 +1,15 @@
+#ifndef _STDOUT_PRINT_H_
+#define _STDOUT_PRINT_H_
+
+// Print to the standard output of the native programs
+
+#include <Arduino.h>
+
+class StdoutPrint : public Print {
+  public:
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    using Print::write;
+};
+
+#endif // _STDOUT_PRINT_H_
@@ -0,0 +1,137 @@
+// Replays a capture of the Modbus traffic of a site (<ip>/capture) against the firmware on the
+// development machine. Built by env:native_replay for the protocol of the capture:
+//   PLATFORMIO_BUILD_FLAGS=-DNATIVE_PROTOCOL=124 pio run -e native_replay
+//   .pio/build/native_replay/program <capture> [speed] [--json]
+// Read cycles are started at the recorded times. Speed 1 waits the recorded time between them
+// and the recorded latencies, 10 a tenth of it, 0 (default) doesn't wait at all, then
+// poll_ns_per_cycle is the processing time of a read cycle. The firmware sees the recorded
+// time in any case. The result is a JSON line like the benchmarks (native/bench), with --json
+// the document of every successful read cycle (as /status) is printed before it.
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "Growatt.h"
+#include "JsonWriter.h"
+#include "CaptureReplay.h"
+#include "InverterSimulator.h"
+#include "StdoutPrint.h"
+
+static const char MAC[] = "AA:BB:CC:DD:EE:FF";
+
+static uint64_t _Nanoseconds() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void _WaitUntil(uint64_t target, double speed) {
+  /**
+   * @brief Let the clock of the firmware reach a time (micros()), in real time divided by speed
+   */
+  uint64_t now = micros();
+
+  if (target <= now)
+    return;
+  if (speed > 0) {
+    uint64_t wait = (target - now) / speed * 1000;
+    struct timespec duration = {(time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL)};
+    nanosleep(&duration, NULL);
+    now = micros();
+  }
+  if (target > now)
+    NativeClock::Advance(target - now);
+}
+
+int main(int argc, char **argv) {
+  CaptureReplay replay;
+  Growatt inverter;
+  StdoutPrint out;
+  JsonWriter json(out);
+  const char *path = NULL;
+  double speed = 0;
+  bool documents = false;
+  uint32_t cycles = 0;
+  uint32_t succeeded = 0;
+  uint64_t pollTime = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0)
+      documents = true;
+    else if (path == NULL)
+      path = argv[i];
+    else
+      speed = atof(argv[i]);
+  }
+  if (path == NULL) {
+    fprintf(stderr, "usage: %s <capture> [speed] [--json]\n", argv[0]);
+    return 2;
+  }
+  if (!replay.Load(path))
+    return 1;
+  if (replay.Protocol() != GROWATT_MODBUS_VERSION) {
+    fprintf(stderr, "the capture is of protocol %u, build with NATIVE_PROTOCOL=%u\n", replay.Protocol(), replay.Protocol());
+    return 1;
+  }
+
+  Inverter485.SetReplay(&replay, speed);
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  if (inverter.GetWiFiStickType() == Undef_stick) {
+    fprintf(stderr, "the inverter was not detected\n");
+    return 1;
+  }
+
+  uint64_t realStart = _Nanoseconds();
+  uint64_t replayStart = micros();
+  uint32_t captureStart = replay.NextTime();
+
+  while (!replay.Done()) {
+    uint32_t progress = replay.Matched() + replay.Skipped();
+    eReadState_t result;
+
+    _WaitUntil(replayStart + (uint64_t)(replay.NextTime() - captureStart) * 1000, speed);
+    if (!inverter.StartReadData())
+      break;
+
+    uint64_t start = _Nanoseconds();
+    while ((result = inverter.Poll()) == READ_BUSY) {
+    }
+    pollTime += _Nanoseconds() - start;
+
+    cycles++;
+    if (result == READ_SUCCEEDED) {
+      succeeded++;
+      if (documents) {
+        inverter.CreateJson(out, MAC);
+        out.write('\n');
+      }
+    }
+    // the firmware didn't ask for anything of the capture any more
+    if (replay.Matched() + replay.Skipped() == progress)
+      replay.Skip();
+  }
+
+  json.BeginObject();
+  json.Member(F("protocol"), GROWATT_MODBUS_VERSION);
+  json.Member(F("capture"), path);
+  json.Member(F("records"), (unsigned long)replay.RecordCount());
+  json.Member(F("cycles"), (unsigned long)cycles);
+  json.Member(F("cycles_ok"), (unsigned long)succeeded);
+  json.Member(F("cycles_failed"), (unsigned long)(cycles - succeeded));
+  json.Member(F("requests"), (unsigned long)Inverter485.Requests());
+  json.Member(F("matched"), (unsigned long)replay.Matched());
+  json.Member(F("skipped"), (unsigned long)replay.Skipped());
+  json.Member(F("unmatched"), (unsigned long)replay.Unmatched());
+  json.Member(F("latency_ms"), sFixedPoint_t::FromDouble(replay.Matched() ? replay.MatchedLatency() / 1000.0 / replay.Matched() : 0, -1));
+  json.Member(F("recorded_ms"), (unsigned long)(replay.Duration() - captureStart));
+  json.Member(F("replayed_ms"), (unsigned long)((micros() - replayStart) / 1000));
+  json.Member(F("real_ms"), (unsigned long)((_Nanoseconds() - realStart) / 1000000));
+  json.Member(F("poll_ns_per_cycle"), sFixedPoint_t::FromDouble(cycles ? (double)pollTime / cycles : 0, -1));
+  json.EndObject();
+  out.write('\n');
+  return 0;
+}
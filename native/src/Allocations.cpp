@@ -0,0 +1,54 @@
+#include <stdlib.h>
+
+#include "Allocations.h"
+
+static uint64_t _Count = 0;
+static uint64_t _Bytes = 0;
+
+#ifdef __GLIBC__
+// glibc lets a program replace malloc and friends, the originals stay reachable
+extern "C" {
+  void *__libc_malloc(size_t size);
+  void *__libc_calloc(size_t count, size_t size);
+  void *__libc_realloc(void *ptr, size_t size);
+  void __libc_free(void *ptr);
+
+  void *malloc(size_t size) {
+    _Count++;
+    _Bytes += size;
+    return __libc_malloc(size);
+  }
+
+  void *calloc(size_t count, size_t size) {
+    _Count++;
+    _Bytes += count * size;
+    return __libc_calloc(count, size);
+  }
+
+  void *realloc(void *ptr, size_t size) {
+    _Count++;
+    _Bytes += size;
+    return __libc_realloc(ptr, size);
+  }
+
+  void free(void *ptr) {
+    __libc_free(ptr);
+  }
+}
+#endif
+
+bool Allocations::Counted() {
+#ifdef __GLIBC__
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t Allocations::Count() {
+  return _Count;
+}
+
+uint64_t Allocations::Bytes() {
+  return _Bytes;
+}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <time.h>
+
+#include "InverterSimulator.h"
+
+HardwareSerial Serial;
+
+static uint64_t _Now() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static const uint64_t _Start = _Now();
+static uint64_t _Advanced = 0;
+
+unsigned long millis() {
+  return (_Now() - _Start + _Advanced) / 1000;
+}
+
+unsigned long micros() {
+  return _Now() - _Start + _Advanced;
+}
+
+void NativeClock::Advance(uint64_t microseconds) {
+  _Advanced += microseconds;
+}
+
+void delay(unsigned long ms) {
+  struct timespec wait = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+
+  nanosleep(&wait, NULL);
+}
+
+void yield() {
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  Inverter485.Receive(c);
+  return 1;
+}
+
+int HardwareSerial::available() {
+  return Inverter485.Available();
+}
+
+int HardwareSerial::read() {
+  return Inverter485.Read();
+}
+
+int HardwareSerial::peek() {
+  return Inverter485.Peek();
+}
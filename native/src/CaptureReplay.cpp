@@ -0,0 +1,155 @@
+#include <Arduino.h>
+
+#include "CaptureReplay.h"
+#include "ModbusCapture.h"
+#include "ModbusRtu.h"
+
+#define FC_READ_HOLDING_REGISTERS 0x03
+#define FC_WRITE_SINGLE_REGISTER 0x06
+
+// Reads a capture file byte by byte
+class CaptureReader {
+  public:
+    CaptureReader(FILE *file) : _File(file) {}
+
+    bool Byte(uint8_t &c) {
+      int b = fgetc(_File);
+      if (b == EOF)
+        return false;
+      c = b;
+      return true;
+    }
+
+    bool Varint(uint32_t &value) {
+      uint8_t c;
+      value = 0;
+      for (int shift = 0; shift < 35; shift += 7) {
+        if (!Byte(c))
+          return false;
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+          return true;
+      }
+      return false;
+    }
+
+  private:
+    FILE *_File;
+};
+
+CaptureReplay::CaptureReplay() {
+  _Protocol = 0;
+  _Next = 0;
+  _Matched = 0;
+  _Skipped = 0;
+  _Unmatched = 0;
+  _MatchedLatency = 0;
+}
+
+bool CaptureReplay::Load(const char *path) {
+  /**
+   * @brief Read a capture file of the stick (<ip>/capture)
+   * @returns false if it can't be read or is no capture, the reason is printed to stderr
+   */
+  uint8_t header[MODBUS_CAPTURE_HEADER_SIZE];
+  uint32_t time = 0;
+  FILE *file = fopen(path, "rb");
+
+  if (file == NULL) {
+    fprintf(stderr, "%s can't be opened\n", path);
+    return false;
+  }
+  if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+      memcmp(header, MODBUS_CAPTURE_MAGIC, 3) != 0 || header[3] != MODBUS_CAPTURE_FORMAT) {
+    fprintf(stderr, "%s is no Modbus capture of this format\n", path);
+    fclose(file);
+    return false;
+  }
+  _Protocol = header[4] | (header[5] << 8);
+
+  CaptureReader reader(file);
+  for (;;) {
+    sReplayRecord_t record;
+    uint32_t delta, address, value, latency;
+    bool complete;
+
+    if (!reader.Varint(delta))
+      break;
+    complete = reader.Byte(record.Function) && reader.Byte(record.Result) && reader.Varint(address) &&
+               reader.Varint(value) && reader.Varint(latency);
+    // a record cut off by a power loss
+    if (!complete)
+      break;
+    time += delta;
+    record.Time = time;
+    record.Latency = latency;
+    record.Address = address;
+    record.Value = value;
+    record.Registers = _Registers.size();
+
+    if (record.Result == ModbusRtu::ku8MBSuccess && record.Function != FC_WRITE_SINGLE_REGISTER) {
+      std::map<uint16_t, uint16_t> &image = _Image[record.Function == FC_READ_HOLDING_REGISTERS];
+      for (uint16_t i = 0; i < record.Value && complete; i++) {
+        uint32_t reg;
+        complete = reader.Varint(reg);
+        _Registers.push_back(reg);
+        image.insert(std::make_pair((uint16_t)(record.Address + i), (uint16_t)reg));
+      }
+    }
+    if (!complete)
+      break;
+    _Records.push_back(record);
+  }
+  fclose(file);
+  return true;
+}
+
+void CaptureReplay::Skip() {
+  /**
+   * @brief Pass over the next record, e.g. when the firmware doesn't ask for it any more
+   */
+  if (!Done()) {
+    _Next++;
+    _Skipped++;
+  }
+}
+
+void CaptureReplay::Answer(uint8_t function, uint16_t address, uint16_t value, sReplayAnswer_t &answer) {
+  /**
+   * @brief Find the answer to a request
+   * @param function Modbus function code of the request
+   * @param address register address
+   * @param value quantity of a read, value of a write
+   */
+  for (size_t i = _Next; i < _Records.size() && i < _Next + REPLAY_WINDOW; i++) {
+    const sReplayRecord_t &record = _Records[i];
+    if (record.Function != function || record.Address != address || record.Value != value)
+      continue;
+
+    _Skipped += i - _Next;
+    _Next = i + 1;
+    _Matched++;
+    _MatchedLatency += record.Latency;
+    answer.Result = record.Result;
+    answer.Latency = record.Latency;
+    answer.Registers = _Registers.data() + record.Registers;
+    answer.Count = (record.Result == ModbusRtu::ku8MBSuccess && function != FC_WRITE_SINGLE_REGISTER) ? value : 0;
+    return;
+  }
+
+  _Unmatched++;
+  answer.Result = ModbusRtu::ku8MBSuccess;
+  answer.Latency = 0;
+  answer.Count = 0;
+  if (function != FC_WRITE_SINGLE_REGISTER) {
+    const std::map<uint16_t, uint16_t> &image = _Image[function == FC_READ_HOLDING_REGISTERS];
+    _Scratch.assign(value, 0);
+    for (uint16_t i = 0; i < value; i++) {
+      std::map<uint16_t, uint16_t>::const_iterator it = image.find(address + i);
+      if (it != image.end())
+        _Scratch[i] = it->second;
+    }
+    answer.Count = value;
+  }
+  answer.Registers = _Scratch.data();
+}
@@ -0,0 +1,186 @@
+#include <Arduino.h>
+
+#include "InverterSimulator.h"
+#include "CaptureReplay.h"
+#include "ModbusRtu.h"
+
+#define FC_READ_HOLDING_REGISTERS 0x03
+#define FC_READ_INPUT_REGISTERS 0x04
+#define FC_WRITE_SINGLE_REGISTER 0x06
+
+InverterSimulator Inverter485;
+
+InverterSimulator::InverterSimulator() {
+  memset(_Input, 0, sizeof(_Input));
+  memset(_Holding, 0, sizeof(_Holding));
+  _RxLength = 0;
+  _TxLength = 0;
+  _TxPosition = 0;
+  _Requests = 0;
+  _Replay = NULL;
+  _Speed = 0;
+  _Pending = false;
+  _Latency = 0;
+  _Wait = 0;
+  _RequestMicros = 0;
+  _Fault = false;
+  _FaultResult = 0;
+  _FaultCount = 0;
+}
+
+void InverterSimulator::SetReplay(CaptureReplay *replay, double speed) {
+  /**
+   * @brief Answer from a capture instead of the register maps
+   * @param speed 1 waits the recorded latencies, 10 a tenth of them, 0 doesn't wait. The clock
+   *        of the firmware always advances by the recorded latency.
+   */
+  _Replay = replay;
+  _Speed = speed;
+}
+
+void InverterSimulator::Fault(uint8_t result, uint16_t count) {
+  /**
+   * @brief Answer the next request like a replay records a failure: no answer for
+   *        ku8MBResponseTimedOut, a broken checksum for ku8MBInvalidCRC, an exception frame for
+   *        the other results. With ku8MBSuccess a read returns the first count registers only.
+   */
+  _Fault = true;
+  _FaultResult = result;
+  _FaultCount = count;
+}
+
+int InverterSimulator::Available() {
+  if (_Pending) {
+    uint32_t elapsed = micros() - _RequestMicros;
+    if (elapsed < _Wait)
+      return 0;
+    if (_Latency > elapsed)
+      NativeClock::Advance(_Latency - elapsed);
+    _Pending = false;
+  }
+  return _TxLength - _TxPosition;
+}
+
+void InverterSimulator::Receive(uint8_t c) {
+  /**
+   * @brief Collect a request byte by byte, all requests of the firmware are 8 bytes long
+   */
+  _Rx[_RxLength++] = c;
+  if (_RxLength < sizeof(_Rx))
+    return;
+  _RxLength = 0;
+  if (Crc16(_Rx, 6) == (_Rx[6] | (_Rx[7] << 8)))
+    _Answer();
+}
+
+void InverterSimulator::_Answer() {
+  uint8_t function = _Rx[1];
+  uint16_t address = (_Rx[2] << 8) | _Rx[3];
+  uint16_t count = (_Rx[4] << 8) | _Rx[5];
+  uint16_t crc;
+
+  _Requests++;
+  _TxLength = 0;
+  _TxPosition = 0;
+  _Pending = false;
+  if (_Fault) {
+    sReplayAnswer_t answer;
+    _Fault = false;
+    answer.Result = _FaultResult;
+    answer.Latency = 0;
+    answer.Registers = ((function == FC_READ_INPUT_REGISTERS) ? _Input : _Holding) + address;
+    answer.Count = (address + _FaultCount <= 0x10000) ? _FaultCount : 0x10000 - address;
+    _AnswerWith(function, answer);
+    return;
+  }
+  if (_Replay != NULL) {
+    _AnswerReplay(function, address, count);
+    return;
+  }
+  _Tx[_TxLength++] = _Rx[0];
+
+  if ((function == FC_READ_INPUT_REGISTERS || function == FC_READ_HOLDING_REGISTERS) && count <= 125) {
+    const uint16_t *registers = (function == FC_READ_INPUT_REGISTERS) ? _Input : _Holding;
+    _Tx[_TxLength++] = function;
+    _Tx[_TxLength++] = 2 * count;
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t value = registers[(uint16_t)(address + i)];
+      _Tx[_TxLength++] = value >> 8;
+      _Tx[_TxLength++] = value & 0xFF;
+    }
+  } else if (function == FC_WRITE_SINGLE_REGISTER) {
+    _Holding[address] = count;
+    memcpy(&_Tx[_TxLength], &_Rx[1], 5);
+    _TxLength += 5;
+  } else {
+    // illegal data address
+    _Tx[_TxLength++] = function | 0x80;
+    _Tx[_TxLength++] = 0x02;
+  }
+
+  crc = Crc16(_Tx, _TxLength);
+  _Tx[_TxLength++] = crc & 0xFF;
+  _Tx[_TxLength++] = crc >> 8;
+}
+
+void InverterSimulator::_AnswerReplay(uint8_t function, uint16_t address, uint16_t value) {
+  sReplayAnswer_t answer;
+
+  _Replay->Answer(function, address, value, answer);
+  _AnswerWith(function, answer);
+}
+
+void InverterSimulator::_AnswerWith(uint8_t function, const sReplayAnswer_t &answer) {
+  /**
+   * @brief Answer with the recorded result. The errors found by the master are reproduced by a
+   *        frame it rejects for the same reason, a timeout by no answer at all.
+   */
+  uint16_t crc;
+
+  _Pending = true;
+  _Latency = answer.Latency;
+  _Wait = (_Speed > 0) ? answer.Latency / _Speed : 0;
+  _RequestMicros = micros();
+
+  if (answer.Result == ModbusRtu::ku8MBResponseTimedOut)
+    return;
+
+  _Tx[_TxLength++] = _Rx[0];
+  if (answer.Result == ModbusRtu::ku8MBSuccess && function == FC_WRITE_SINGLE_REGISTER) {
+    memcpy(&_Tx[_TxLength], &_Rx[1], 5);
+    _TxLength += 5;
+  } else if (answer.Result == ModbusRtu::ku8MBSuccess) {
+    _Tx[_TxLength++] = function;
+    _Tx[_TxLength++] = 2 * answer.Count;
+    for (uint16_t i = 0; i < answer.Count; i++) {
+      _Tx[_TxLength++] = answer.Registers[i] >> 8;
+      _Tx[_TxLength++] = answer.Registers[i] & 0xFF;
+    }
+  } else {
+    // exception frame, the Modbus exception code is passed on by the master
+    _Tx[_TxLength++] = function | 0x80;
+    _Tx[_TxLength++] = answer.Result;
+    if (answer.Result == ModbusRtu::ku8MBInvalidSlaveID)
+      _Tx[0]++;
+    else if (answer.Result == ModbusRtu::ku8MBInvalidFunction)
+      _Tx[1] = (function + 1) | 0x80;
+  }
+
+  crc = Crc16(_Tx, _TxLength);
+  if (answer.Result == ModbusRtu::ku8MBInvalidCRC)
+    crc = ~crc;
+  _Tx[_TxLength++] = crc & 0xFF;
+  _Tx[_TxLength++] = crc >> 8;
+}
+
+uint16_t InverterSimulator::Crc16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0xFFFF;
+
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,77 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct sNativeFile_t {
+  std::vector<uint8_t> Data;
+};
+
+FS LittleFS;
+
+static std::map<std::string, sNativeFile_t> _Files;
+
+File FS::open(const char *path, const char *mode) {
+  /**
+   * @brief Open a file, "r" for reading, "w" replaces the file, "a" appends to it
+   */
+  bool exists = _Files.count(path) > 0;
+
+  if (mode[0] == 'r') {
+    return exists ? File(&_Files[path], false) : File();
+  }
+  sNativeFile_t &file = _Files[path];
+  if (mode[0] == 'w')
+    file.Data.clear();
+  return File(&file, true);
+}
+
+bool FS::exists(const char *path) {
+  return _Files.count(path) > 0;
+}
+
+bool FS::remove(const char *path) {
+  return _Files.erase(path) > 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  if (_Files.count(from) == 0)
+    return false;
+  _Files[to] = _Files[from];
+  _Files.erase(from);
+  return true;
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+  if (_File == NULL || !_Writable)
+    return 0;
+  _File->Data.insert(_File->Data.end(), buffer, buffer + size);
+  return size;
+}
+
+int File::available() {
+  return (_File != NULL) ? (int)(_File->Data.size() - _Position) : 0;
+}
+
+int File::read() {
+  return (available() > 0) ? _File->Data[_Position++] : -1;
+}
+
+int File::peek() {
+  return (available() > 0) ? _File->Data[_Position] : -1;
+}
+
+int File::read(uint8_t *buffer, size_t size) {
+  size_t n = 0;
+
+  while (n < size && available() > 0) {
+    buffer[n++] = _File->Data[_Position++];
+  }
+  return n;
+}
+
+size_t File::size() const {
+  return (_File != NULL) ? _File->Data.size() : 0;
+}
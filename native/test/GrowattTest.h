@@ -0,0 +1,28 @@
+#ifndef _GROWATT_TEST_H_
+#define _GROWATT_TEST_H_
+
+// Reaches the private parts of the inverter class the native tests check
+
+#include "Growatt.h"
+
+class GrowattTest {
+  public:
+    static const sProtocolDefinition_t &Protocol(Growatt &inverter) { return inverter._Protocol; }
+    static uint8_t PlanFragments(const sGrowattModbusReg_t *registers, const uint8_t *indices, uint8_t indexCount,
+                                 uint8_t maxFragmentSize, sGrowattReadFragment_t *fragments) {
+      return Growatt::_PlanFragments(registers, indices, indexCount, maxFragmentSize, fragments);
+    }
+    static sFixedPoint_t Fixed(const sGrowattModbusReg_t &reg, uint32_t value) { return Growatt::_Fixed(reg, value); }
+    static sFixedPoint_t FixedSum(sFixedPoint_t a, sFixedPoint_t b) { return Growatt::_FixedSum(a, b); }
+    static sFixedPoint_t FixedRatio(sFixedPoint_t value, int64_t numerator, int64_t denominator, int8_t exponent) {
+      return Growatt::_FixedRatio(value, numerator, denominator, exponent);
+    }
+    static sFixedPoint_t FixedShare(sFixedPoint_t value, sFixedPoint_t part, sFixedPoint_t whole, int8_t exponent) {
+      return Growatt::_FixedShare(value, part, whole, exponent);
+    }
+    static bool ExceedsDeadband(const sGrowattModbusReg_t &reg, uint32_t value, uint32_t last) {
+      return Growatt::_ExceedsDeadband(Growatt::_RawDeadband(reg), value, last);
+    }
+};
+
+#endif // _GROWATT_TEST_H_
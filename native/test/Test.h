@@ -0,0 +1,43 @@
+#ifndef _NATIVE_TEST_H_
+#define _NATIVE_TEST_H_
+
+// Minimal harness of the native tests (env:native_test): TEST() registers a test, CHECK() and
+// CHECK_EQUAL() report a failed check with its location and the test goes on, so a run lists
+// all mismatches. Context() describes what is checked, e.g. the register, for the reports.
+// native/test/TestMain.cpp runs the tests.
+
+#include <Arduino.h>
+
+typedef void (*TestFunction_t)();
+
+class Test {
+  public:
+    Test(const char *name, TestFunction_t run);
+
+    static int RunAll(const char *filter);
+    static void Context(const char *format, ...);
+    static bool Check(bool ok, const char *expression, const char *file, int line);
+    static bool CheckEqual(long long actual, long long expected, const char *expression, const char *file, int line);
+    static bool CheckString(const char *actual, const char *expected, const char *expression, const char *file,
+                            int line);
+
+  private:
+    const char *_Name;
+    TestFunction_t _Run;
+    Test *_Next;
+
+    static void _Fail(const char *file, int line, const char *format, ...);
+};
+
+#define TEST(name)                      \
+  static void name();                   \
+  static Test name##_Test(#name, name); \
+  static void name()
+
+#define CHECK(condition) Test::Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) \
+  Test::CheckEqual((long long)(actual), (long long)(expected), #actual " == " #expected, __FILE__, __LINE__)
+#define CHECK_STRING(actual, expected) \
+  Test::CheckString((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#endif // _NATIVE_TEST_H_
@@ -0,0 +1,65 @@
+// The deadbands of change-only publishing (Growatt::InputPublishDue(), HoldingPublishDue()) are
+// compared in raw register steps. Every register of both tables against the decimal deadband:
+// the float deadbands and multipliers are rounded to their decimals first, 0.05 Hz at 0.01 Hz
+// are 5 steps.
+
+#include <Arduino.h>
+
+#include "Test.h"
+#include "GrowattTest.h"
+
+// the unit defaults of Growatt.cpp, in millionths (negative: relative)
+static const int64_t UNIT_DEFAULTS[] = {0, -20000, 0, 500000, 100000, 0, 1000000, 50000, 500000, -20000};
+
+static bool _Expected(const sGrowattModbusReg_t &reg, uint32_t value, uint32_t last) {
+  /**
+   * @brief The decimal comparison: the change in millionths of the unit against the deadband
+   */
+  int64_t deadband = llround(reg.Deadband() * 1e6);
+  sFixedPoint_t step = GrowattTest::Fixed(reg, 1);
+  int64_t change = (value > last) ? value - last : last - value;
+
+  if (deadband == 0)
+    deadband = UNIT_DEFAULTS[reg.Unit()];
+  if (change == 0)
+    return false;
+  if (deadband < 0)
+    return (__int128)change * 1000000 >= (__int128)-deadband * last;
+
+  // change * Factor * 10^Exponent >= deadband / 10^6
+  __int128 left = (__int128)change * step.Value;
+  __int128 right = deadband;
+  for (int8_t e = step.Exponent + 6; e > 0; e--) {
+    left *= 10;
+  }
+  for (int8_t e = step.Exponent + 6; e < 0; e++) {
+    right *= 10;
+  }
+  return left >= right;
+}
+
+TEST(Deadband_Registers) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+  const uint32_t lasts[] = {0, 1, 7, 99, 100, 1000, 2301, 12345, 65535, 1000000, 4000000000UL};
+
+  inverter.InitProtocol();
+  for (int t = 0; t < 2; t++) {
+    int count = (t == 0) ? protocol.InputRegisterCount : protocol.HoldingRegisterCount;
+    for (int i = 0; i < count; i++) {
+      const sGrowattModbusReg_t &reg = (t == 0) ? protocol.InputRegisters[i] : protocol.HoldingRegisters[i];
+
+      for (uint32_t last : lasts) {
+        for (uint32_t change = 0; change <= 2000; change++) {
+          bool expected = _Expected(reg, last + change, last);
+          if (expected == GrowattTest::ExceedsDeadband(reg, last + change, last) &&
+              (change > last || expected == GrowattTest::ExceedsDeadband(reg, last - change, last)))
+            continue;
+          Test::Context("%s: %u -> +-%u", reg.name, last, change);
+          CHECK(false);
+          break;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,84 @@
+// Every register of the tables of the protocol is decoded from the answers of the simulated
+// inverter, by every read path and at every fragment size (Growatt::_BuildDecodePlan())
+
+#include <Arduino.h>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "InverterSimulator.h"
+
+static uint16_t _Word(bool holding, uint16_t address, uint16_t round) {
+  /**
+   * @brief The register of the simulated inverter: distinct per table, address and round, so a
+   *        register not decoded keeps the value of an earlier round and is noticed
+   */
+  return (uint16_t)(address * 40503U + round * 2654435761U + (holding ? 0x5A5A : 0));
+}
+
+static void _FillRegisters(uint16_t round) {
+  for (uint32_t address = 0; address <= 0xFFFF; address++) {
+    Inverter485.SetInput(address, _Word(false, address, round));
+    Inverter485.SetHolding(address, _Word(true, address, round));
+  }
+}
+
+static uint32_t _Expected(const sGrowattModbusReg_t &reg, bool holding, uint16_t round) {
+  if (reg.Size() == SIZE_16BIT)
+    return _Word(holding, reg.Address(), round);
+  return ((uint32_t)_Word(holding, reg.Address(), round) << 16) | _Word(holding, reg.Address() + 1, round);
+}
+
+static void _CheckValues(Growatt &inverter, uint16_t round, const char *path) {
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+
+  for (int i = 0; i < protocol.InputRegisterCount; i++) {
+    const sGrowattModbusReg_t &reg = inverter.GetInputRegister(i);
+    Test::Context("%s, fragment size %u, input register %d (address %u)", path, inverter.GetMaxFragmentSize(), i,
+                  reg.Address());
+    CHECK_EQUAL(inverter.GetInputValue(i), _Expected(reg, false, round));
+  }
+  for (int i = 0; i < protocol.HoldingRegisterCount; i++) {
+    const sGrowattModbusReg_t &reg = inverter.GetHoldingRegister(i);
+    Test::Context("%s, fragment size %u, holding register %d (address %u)", path, inverter.GetMaxFragmentSize(), i,
+                  reg.Address());
+    CHECK_EQUAL(inverter.GetHoldingValue(i), _Expected(reg, true, round));
+  }
+}
+
+static bool _Detect(Growatt &inverter) {
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  return CHECK(inverter.GetWiFiStickType() != Undef_stick);
+}
+
+TEST(DecodePlan_ReadDataAtEveryFragmentSize) {
+  Growatt inverter;
+
+  if (!_Detect(inverter))
+    return;
+  for (uint8_t size = 2; size <= MODBUS_MAX_FRAGMENT_SIZE; size++) {
+    inverter.SetMaxFragmentSize(size);
+    _FillRegisters(size);
+    Test::Context("fragment size %u", size);
+    if (CHECK(inverter.ReadData(true)))
+      _CheckValues(inverter, size, "ReadData()");
+  }
+}
+
+TEST(DecodePlan_ReadInputAndHoldingRegisters) {
+  Growatt inverter;
+  const uint8_t sizes[] = {MODBUS_MAX_FRAGMENT_SIZE, 7, 2};
+
+  if (!_Detect(inverter))
+    return;
+  for (uint8_t size : sizes) {
+    inverter.SetMaxFragmentSize(size);
+    _FillRegisters(1000 + size);
+    Test::Context("fragment size %u", size);
+    CHECK(inverter.ReadInputRegisters());
+    CHECK(inverter.ReadHoldingRegisters());
+    _CheckValues(inverter, 1000 + size, "ReadInputRegisters()/ReadHoldingRegisters()");
+  }
+}
@@ -0,0 +1,325 @@
+// The fixed point formatting (JsonWriter::FormatFixed(), FormatNumber(), Growatt::FormatValue())
+// against the output before it: the float multiplier of the register tables with printf, kept
+// below as the reference. Every 16 bit value with every scale of the tables, a sample of 32 bit
+// values and of doubles. Beyond float precision the old output was off, there the exact decimal
+// is expected. The aggregates of /uistatus (averages, sums and shares of the phases) against
+// their computation in double.
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "JsonWriter.h"
+
+// ---- the formatting before the fixed point numbers ----
+
+static size_t _OldFormatNumber(double value, char *text, size_t size) {
+  int len;
+
+  if (isnan(value) || isinf(value)) {
+    memcpy(text, "null", 4);
+    return 4;
+  }
+  if (fabs(value) < 2147483647.0 && value == (double)(long)value)
+    return snprintf(text, size, "%ld", (long)value);
+
+  len = snprintf(text, size, "%.6f", value);
+  if (len >= (int)size)
+    return snprintf(text, size, "%.6g", value);
+  while (text[len - 1] == '0')
+    len--;
+  if (text[len - 1] == '.')
+    len--;
+  return len;
+}
+
+static double _OldRound2(double value) {
+  return (int)(value * 100 + 0.5) / 100.0;
+}
+
+static double _OldJsonValue(float multiplier, uint32_t value) {
+  if (multiplier == (int)multiplier)
+    return value * multiplier;
+  return _OldRound2(value * multiplier);
+}
+
+static void _OldFormatValue(float multiplier, uint32_t value, char *Buffer, size_t size) {
+  float scale = multiplier;
+  int decimals = 0;
+
+  while (decimals < 2 && fabs(scale - round(scale)) > 0.001) {
+    scale *= 10;
+    decimals++;
+  }
+  if (decimals == 0)
+    snprintf(Buffer, size, "%ld", (long)round(value * multiplier));
+  else
+    snprintf(Buffer, size, "%.*f", decimals, (double)value * multiplier);
+}
+
+// ---- helpers ----
+
+static std::string _Number(double value) {
+  char text[32];
+  return std::string(text, _OldFormatNumber(value, text, sizeof(text)));
+}
+
+static std::string _Fixed(sFixedPoint_t value, bool trim) {
+  char text[32];
+  return std::string(text, JsonWriter::FormatFixed(value, text, sizeof(text), trim));
+}
+
+static std::string _Exact(int64_t value, int8_t exponent, bool trim) {
+  /**
+   * @brief The decimal of value * 10^exponent built from the digits of the integer
+   */
+  char digits[32];
+  std::string text;
+
+  snprintf(digits, sizeof(digits), "%llu", (unsigned long long)((value < 0) ? -(uint64_t)value : value));
+  text = digits;
+  if (exponent > 0)
+    text.append(exponent, '0');
+  if (exponent < 0) {
+    size_t decimals = -exponent;
+    if (text.size() <= decimals)
+      text.insert(0, decimals + 1 - text.size(), '0');
+    text.insert(text.size() - decimals, ".");
+    while (trim && text.back() == '0') {
+      text.pop_back();
+    }
+    if (text.back() == '.')
+      text.pop_back();
+  }
+  return (value < 0) ? "-" + text : text;
+}
+
+static uint32_t _Random(uint64_t &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 32;
+}
+
+static int _Scales(const sGrowattModbusReg_t **scales, bool only32Bit) {
+  /**
+   * @brief One register of every scale in the tables of the protocol
+   */
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+  int count = 0;
+
+  inverter.InitProtocol();
+  for (int t = 0; t < 2; t++) {
+    const sGrowattModbusReg_t *table = (t == 0) ? protocol.InputRegisters : protocol.HoldingRegisters;
+    int n = (t == 0) ? protocol.InputRegisterCount : protocol.HoldingRegisterCount;
+    for (int i = 0; i < n; i++) {
+      bool known = only32Bit && table[i].Size() != SIZE_32BIT;
+      for (int k = 0; k < count && !known; k++) {
+        known = scales[k]->ScaleFactor() == table[i].ScaleFactor() &&
+                scales[k]->ScaleExponent() == table[i].ScaleExponent();
+      }
+      if (!known)
+        scales[count++] = &table[i];
+    }
+  }
+  return count;
+}
+
+static void _CheckRegisterValue(const sGrowattModbusReg_t &reg, uint32_t value) {
+  /**
+   * @brief The JSON value and the plain value (FormatValue()) of a raw register value, like the
+   *        float path within float precision and exact beyond
+   */
+  float multiplier = reg.Multiplier();
+  sFixedPoint_t fixed = GrowattTest::Fixed(reg, value);
+  std::string json = _Fixed(fixed, true);
+  std::string plain = _Fixed(fixed, false);
+  double exact = fixed.ToDouble();
+  char text[32];
+
+  Growatt::FormatValue(reg, value, text, sizeof(text));
+  CHECK_STRING(text, plain.c_str());
+  CHECK_STRING(json.c_str(), _Exact(fixed.Value, fixed.Exponent, true).c_str());
+  CHECK_STRING(plain.c_str(), _Exact(fixed.Value, fixed.Exponent, false).c_str());
+
+  // the old JSON value was rounded from the float product, within 2^31 hundredths
+  if (fabs((float)value * multiplier - exact) < 0.001 && exact < 2e7)
+    CHECK_STRING(json.c_str(), _Number(_OldJsonValue(multiplier, value)).c_str());
+  if (fabs((double)value * multiplier - exact) < 0.001 && exact < 2e9) {
+    _OldFormatValue(multiplier, value, text, sizeof(text));
+    CHECK_STRING(plain.c_str(), text);
+  }
+}
+
+TEST(FormatFixed_Every16BitRegisterValue) {
+  const sGrowattModbusReg_t *scales[GROWATT_MAX_REGISTERS * 2];
+  int count = _Scales(scales, false);
+
+  for (int k = 0; k < count; k++) {
+    for (uint32_t value = 0; value <= 0xFFFF; value++) {
+      Test::Context("scale %u*10^%d, value %lu", scales[k]->ScaleFactor(), scales[k]->ScaleExponent(),
+                    (unsigned long)value);
+      _CheckRegisterValue(*scales[k], value);
+    }
+  }
+}
+
+TEST(FormatFixed_32BitRegisterValues) {
+  const sGrowattModbusReg_t *scales[GROWATT_MAX_REGISTERS * 2];
+  int count = _Scales(scales, true);
+  const uint32_t edges[] = {0x10000, 0xFFFFFF, 0x1000000, 0x1000001, 69469221, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF};
+  uint64_t state = 20;
+
+  for (int k = 0; k < count; k++) {
+    for (uint32_t value : edges) {
+      Test::Context("scale %u*10^%d, value %lu", scales[k]->ScaleFactor(), scales[k]->ScaleExponent(),
+                    (unsigned long)value);
+      _CheckRegisterValue(*scales[k], value);
+    }
+    for (int i = 0; i < 500000; i++) {
+      // all magnitudes, not only the large ones a uniform sample gives
+      uint32_t value = _Random(state) >> (_Random(state) % 32);
+      Test::Context("scale %u*10^%d, value %lu", scales[k]->ScaleFactor(), scales[k]->ScaleExponent(),
+                    (unsigned long)value);
+      _CheckRegisterValue(*scales[k], value);
+    }
+  }
+}
+
+TEST(FormatFixed_ShiftedExponent) {
+  // e.g. kWh as Wh (_FixedInput(reg, 3)) and the sums of mixed scales
+  uint64_t state = 7;
+
+  for (int8_t exponent = -9; exponent <= 6; exponent++) {
+    for (int i = 0; i < 20000; i++) {
+      int64_t value = ((int64_t)_Random(state) << 32 | _Random(state)) >> (_Random(state) % 64);
+      if (exponent > 0)
+        value /= 1000000;
+      if (i & 1)
+        value = -value;
+      sFixedPoint_t fixed = {value, exponent};
+      Test::Context("%lld*10^%d", (long long)value, exponent);
+      CHECK_STRING(_Fixed(fixed, true).c_str(), _Exact(value, exponent, true).c_str());
+      CHECK_STRING(_Fixed(fixed, false).c_str(), _Exact(value, exponent, false).c_str());
+    }
+  }
+}
+
+static void _CheckNumber(double value) {
+  char text[32];
+  std::string expected = _Number(value);
+
+  // a negative number rounding to zero was written as -0
+  if (expected == "-0")
+    expected = "0";
+  Test::Context("%.17g", value);
+  CHECK_STRING(std::string(text, JsonWriter::FormatNumber(value, text, sizeof(text))).c_str(), expected.c_str());
+}
+
+TEST(FormatNumber_MatchesPrintf) {
+  const double special[] = {0.0, -0.0, NAN, INFINITY, -INFINITY, 0.5, -0.5, 1e-7, 5e-7, 4.9999999e-7,
+                            2147483646.0, 2147483647.0, 2147483648.0, -2147483647.0, 999999999999.9999,
+                            1e12, 1e15, 1e20, -1e20, 1.7976931348623157e308, 4.9e-324};
+  uint64_t state = 42;
+
+  for (double value : special) {
+    _CheckNumber(value);
+  }
+  for (int i = 0; i < 2000000; i++) {
+    uint64_t mantissa = ((uint64_t)_Random(state) << 32 | _Random(state)) >> (_Random(state) % 64);
+    double value;
+
+    switch (i % 4) {
+      case 0: // decimals as computed from the registers
+        value = (double)(mantissa >> 20) / pow(10, _Random(state) % 7);
+        break;
+      case 1: // any magnitude
+        value = (1.0 + _Random(state) / 4294967296.0) * pow(10, (int)(_Random(state) % 24) - 10);
+        break;
+      case 2: // binary fractions, e.g. the means of the history
+        value = (double)(mantissa >> 24) / (1ULL << (_Random(state) % 24));
+        break;
+      default: // integers up to 2^53
+        value = (double)(mantissa >> 11);
+        break;
+    }
+    _CheckNumber((_Random(state) & 1) ? -value : value);
+  }
+}
+
+TEST(FormatFixed_RoundedToTwoDecimals) {
+  // derived values of /uistatus (_round2) and of the history (round), now FromDouble(x, -2)
+  uint64_t state = 3;
+
+  for (int i = 0; i < 2000000; i++) {
+    double value = _Random(state) / pow(10, _Random(state) % 9);
+    float sample = (float)value;
+    Test::Context("%.17g", value);
+    if (value < 2e7)
+      CHECK_STRING(_Fixed(sFixedPoint_t::FromDouble(value, -2), true).c_str(), _Number(_OldRound2(value)).c_str());
+    CHECK_STRING(_Fixed(sFixedPoint_t::FromDouble(sample, -2), true).c_str(),
+                 _Number(round(sample * 100.0) / 100.0).c_str());
+    CHECK_STRING(_Fixed(sFixedPoint_t::FromDouble(-sample, -2), true).c_str(),
+                 _Number(round(-sample * 100.0) / 100.0).c_str());
+  }
+}
+
+static void _CheckDerived(const char *name, sFixedPoint_t fixed, double value) {
+  /**
+   * @brief A derived value against the double it was computed as before, rounded to two
+   *        decimals. Where the double lies within its rounding error of half a digit either
+   *        neighbour is right.
+   */
+  sFixedPoint_t expected = sFixedPoint_t::FromDouble(value, -2);
+  double digits = fabs(value) * 100;
+
+  if (fixed.Value == expected.Value && fixed.Exponent == expected.Exponent)
+    return;
+  Test::Context("%s %.17g", name, value);
+  CHECK(fixed.Exponent == -2 && llabs(fixed.Value - expected.Value) == 1 &&
+        fabs(digits - floor(digits) - 0.5) < 1e-9 * (digits + 1));
+}
+
+TEST(FixedRatio_Aggregates) {
+  // three phases of 0.1 V, 0.1 A and 0.1 W and the day energy of 0.1 kWh, as CreateUIJson()
+  uint64_t state = 5;
+
+  for (int i = 0; i < 1000000; i++) {
+    sFixedPoint_t phase[3], power[3];
+    sFixedPoint_t sum = {0, -1}, powerSum = {0, -1};
+    sFixedPoint_t day = {(int64_t)(_Random(state) % 2000), -1};
+
+    for (int p = 0; p < 3; p++) {
+      phase[p] = {(int64_t)(_Random(state) >> (16 + _Random(state) % 16)), -1};
+      power[p] = {(int64_t)(_Random(state) >> (_Random(state) % 32)), -1};
+      sum = GrowattTest::FixedSum(sum, phase[p]);
+      powerSum = GrowattTest::FixedSum(powerSum, power[p]);
+    }
+    double average = (phase[0].ToDouble() + phase[1].ToDouble() + phase[2].ToDouble()) / 3.0;
+    _CheckDerived("average", GrowattTest::FixedRatio(sum, 1, 3, -2), average);
+    _CheckDerived("line", GrowattTest::FixedRatio(sum, 17320508, 30000000, -2), average * 1.7320508);
+    for (int p = 0; p < 3; p++) {
+      double share = (powerSum.Value != 0) ? day.ToDouble() * power[p].ToDouble() / powerSum.ToDouble() : 0;
+      _CheckDerived("share", GrowattTest::FixedShare(day, power[p], powerSum, -2), share);
+    }
+  }
+}
+
+TEST(FixedPoint_Rounded) {
+  const struct {
+    sFixedPoint_t Value;
+    int8_t Exponent;
+    sFixedPoint_t Expected;
+  } cases[] = {
+    {{2306, -1}, 0, {231, 0}}, {{2305, -1}, 0, {231, 0}}, {{2304, -1}, 0, {230, 0}},
+    {{-2305, -1}, 0, {-231, 0}}, {{-2304, -1}, 0, {-230, 0}}, {{12, -1}, -3, {1200, -3}},
+    {{7, 2}, 0, {700, 0}}, {{1234567, -3}, 1, {123, 1}}, {{0, -1}, 0, {0, 0}},
+  };
+
+  for (const auto &c : cases) {
+    sFixedPoint_t rounded = c.Value.Rounded(c.Exponent);
+    Test::Context("{%lld, %d} to %d", (long long)c.Value.Value, c.Value.Exponent, c.Exponent);
+    CHECK(rounded.Value == c.Expected.Value && rounded.Exponent == c.Expected.Exponent);
+  }
+}
@@ -0,0 +1,185 @@
+// The read windows planned from the register tables of the protocol (Growatt::_PlanFragments())
+// at every fragment size: every register is read completely, no window is longer than the
+// fragment size, and the plan costs no more than merging neighbours greedily
+
+#include <Arduino.h>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "Config.h"
+
+#ifndef MODBUS_REQUEST_COST
+#define MODBUS_REQUEST_COST 50
+#endif
+
+static uint8_t _Width(const sGrowattModbusReg_t &reg) {
+  return (reg.Size() == SIZE_16BIT) ? 1 : 2;
+}
+
+static uint32_t _Cost(const sGrowattReadFragment_t *fragments, uint8_t count) {
+  uint32_t cost = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    cost += MODBUS_REQUEST_COST + fragments[i].FragmentSize;
+  }
+  return cost;
+}
+
+static uint32_t _GreedyCost(const sGrowattModbusReg_t *registers, const uint8_t *indices, uint8_t count,
+                            uint8_t size) {
+  /**
+   * @brief Cost of the plan merging the registers in address order into the current window
+   *        while it stays within the fragment size and the gap costs less than a request
+   */
+  uint8_t order[GROWATT_MAX_REGISTERS];
+  uint32_t cost = 0;
+  uint32_t start = 0, end = 0;
+
+  memcpy(order, indices, count);
+  for (uint8_t i = 1; i < count; i++) {
+    for (uint8_t j = i; j > 0 && registers[order[j - 1]].Address() > registers[order[j]].Address(); j--) {
+      uint8_t swap = order[j];
+      order[j] = order[j - 1];
+      order[j - 1] = swap;
+    }
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    const sGrowattModbusReg_t &reg = registers[order[i]];
+    uint32_t regEnd = reg.Address() + _Width(reg);
+    if (i > 0 && (regEnd > end ? regEnd : end) - start <= size && reg.Address() <= end + MODBUS_REQUEST_COST) {
+      if (regEnd > end)
+        end = regEnd;
+      continue;
+    }
+    if (i > 0)
+      cost += MODBUS_REQUEST_COST + (end - start);
+    start = reg.Address();
+    end = regEnd;
+  }
+  if (count > 0)
+    cost += MODBUS_REQUEST_COST + (end - start);
+  return cost;
+}
+
+static void _CheckPlan(const sGrowattModbusReg_t *registers, const uint8_t *indices, uint8_t count, uint8_t size) {
+  sGrowattReadFragment_t fragments[GROWATT_MAX_FRAGMENTS + 1];
+  uint8_t n;
+
+  // a guard entry behind the capacity, the planner must never write it
+  fragments[GROWATT_MAX_FRAGMENTS].StartAddress = 0xBEEF;
+  n = GrowattTest::PlanFragments(registers, indices, count, size, fragments);
+
+  CHECK(n <= GROWATT_MAX_FRAGMENTS);
+  CHECK(n <= count);
+  CHECK_EQUAL(fragments[GROWATT_MAX_FRAGMENTS].StartAddress, 0xBEEF);
+  if (n > GROWATT_MAX_FRAGMENTS)
+    return;
+
+  for (uint8_t i = 0; i < n; i++) {
+    CHECK(fragments[i].FragmentSize >= 1);
+    CHECK(fragments[i].FragmentSize <= size);
+    if (i > 0)
+      CHECK(fragments[i].StartAddress >= fragments[i - 1].StartAddress + fragments[i - 1].FragmentSize);
+  }
+
+  // every register completely in a window, every window starts with a register
+  for (uint8_t k = 0; k < count; k++) {
+    const sGrowattModbusReg_t &reg = registers[indices[k]];
+    bool covered = false;
+    for (uint8_t i = 0; i < n && !covered; i++) {
+      covered = reg.Address() >= fragments[i].StartAddress &&
+                reg.Address() + _Width(reg) <= fragments[i].StartAddress + fragments[i].FragmentSize;
+    }
+    if (!CHECK(covered))
+      Test::Context("fragment size %u, register %u (address %u) not read", size, indices[k], reg.Address());
+  }
+  for (uint8_t i = 0; i < n; i++) {
+    bool used = false;
+    for (uint8_t k = 0; k < count && !used; k++) {
+      used = registers[indices[k]].Address() == fragments[i].StartAddress;
+    }
+    CHECK(used);
+  }
+
+  CHECK(_Cost(fragments, n) <= _GreedyCost(registers, indices, count, size));
+}
+
+static void _CheckTable(const sGrowattModbusReg_t *registers, uint16_t registerCount, const char *table) {
+  uint8_t all[GROWATT_MAX_REGISTERS];
+  uint8_t some[GROWATT_MAX_REGISTERS];
+  uint32_t random = 1;
+
+  for (uint16_t i = 0; i < registerCount; i++) {
+    all[i] = i;
+  }
+  for (uint8_t size = 2; size <= 125; size++) {
+    Test::Context("%s registers, fragment size %u", table, size);
+    _CheckPlan(registers, all, registerCount, size);
+
+    // a read cycle plans the registers that are due only
+    for (int round = 0; round < 8; round++) {
+      uint8_t count = 0;
+      for (uint16_t i = 0; i < registerCount; i++) {
+        random = random * 1103515245 + 12345;
+        if ((random >> 16) & 1)
+          some[count++] = i;
+      }
+      Test::Context("%s registers, fragment size %u, %u of them", table, size, count);
+      _CheckPlan(registers, some, count, size);
+    }
+  }
+}
+
+TEST(FragmentPlanner_InputRegisters) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+
+  inverter.InitProtocol();
+  _CheckTable(protocol.InputRegisters, protocol.InputRegisterCount, "input");
+}
+
+TEST(FragmentPlanner_HoldingRegisters) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+
+  inverter.InitProtocol();
+  _CheckTable(protocol.HoldingRegisters, protocol.HoldingRegisterCount, "holding");
+}
+
+TEST(FragmentPlanner_ProtocolPlanCoversTables) {
+  // the plan of the protocol is made at InitProtocol() and with every new fragment size
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+
+  inverter.InitProtocol();
+  for (uint8_t size = 2; size <= MODBUS_MAX_FRAGMENT_SIZE; size++) {
+    uint16_t inputRead = 0, holdingRead = 0;
+
+    inverter.SetMaxFragmentSize(size);
+    for (uint16_t k = 0; k < protocol.InputRegisterCount; k++) {
+      const sGrowattModbusReg_t &reg = protocol.InputRegisters[k];
+      for (uint8_t i = 0; i < protocol.InputFragmentCount; i++) {
+        const sGrowattReadFragment_t &fragment = protocol.InputReadFragments[i];
+        if (reg.Address() >= fragment.StartAddress &&
+            reg.Address() + _Width(reg) <= fragment.StartAddress + fragment.FragmentSize) {
+          inputRead++;
+          break;
+        }
+      }
+    }
+    for (uint16_t k = 0; k < protocol.HoldingRegisterCount; k++) {
+      const sGrowattModbusReg_t &reg = protocol.HoldingRegisters[k];
+      for (uint8_t i = 0; i < protocol.HoldingFragmentCount; i++) {
+        const sGrowattReadFragment_t &fragment = protocol.HoldingReadFragments[i];
+        if (reg.Address() >= fragment.StartAddress &&
+            reg.Address() + _Width(reg) <= fragment.StartAddress + fragment.FragmentSize) {
+          holdingRead++;
+          break;
+        }
+      }
+    }
+    Test::Context("fragment size %u", size);
+    CHECK_EQUAL(inputRead, protocol.InputRegisterCount);
+    CHECK_EQUAL(holdingRead, protocol.HoldingRegisterCount);
+  }
+}
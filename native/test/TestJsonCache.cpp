@@ -0,0 +1,85 @@
+// The rendered web server documents (Growatt::GetCachedJson()): rendered once per read cycle and
+// while a cycle decodes into the values the last rendered document is served, never a mix of
+// two cycles.
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "InverterSimulator.h"
+
+#define MAC "00:11:22:33:44:55"
+
+static void _FillRegisters(uint16_t round) {
+  for (uint32_t address = 0; address <= 0xFFFF; address++) {
+    Inverter485.SetInput(address, (uint16_t)(address * 7919U + round * 104729U));
+    Inverter485.SetHolding(address, (uint16_t)(address * 6271U + round * 15485863U));
+  }
+}
+
+static bool _Cached(Growatt &inverter, std::string &text) {
+  const char *json;
+  size_t length;
+
+  if (!inverter.GetCachedJson(JSON_STATUS, MAC, &json, &length))
+    return false;
+  text.assign(json, length);
+  return true;
+}
+
+static std::string _Live(Growatt &inverter) {
+  char buffer[4096];
+  BufferPrint out(buffer, sizeof(buffer));
+
+  inverter.CreateJsonDocument(JSON_STATUS, out, MAC);
+  return std::string(buffer, out.Length());
+}
+
+TEST(JsonCache_RunningCycle) {
+  Growatt inverter;
+  std::string first, cached, again;
+  const char *json, *same;
+  size_t length;
+
+  NativeClock::Advance(1000000);
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  if (!CHECK(inverter.GetWiFiStickType() != Undef_stick))
+    return;
+
+  // nothing rendered yet and a cycle running: the caller has to render
+  _FillRegisters(1);
+  CHECK(inverter.StartReadData(true));
+  if (!CHECK_EQUAL(inverter.Poll(), READ_BUSY))
+    return;
+  CHECK(!_Cached(inverter, cached));
+  while (inverter.Poll() == READ_BUSY) {
+  }
+
+  CHECK(_Cached(inverter, first));
+  CHECK_STRING(first.c_str(), _Live(inverter).c_str());
+  // rendered once per cycle
+  CHECK(inverter.GetCachedJson(JSON_STATUS, MAC, &json, &length));
+  CHECK(inverter.GetCachedJson(JSON_STATUS, MAC, &same, &length));
+  CHECK(json == same);
+
+  // a complete cycle nobody asked for, then one running: the last rendered document is served
+  _FillRegisters(2);
+  CHECK(inverter.ReadData(true));
+  _FillRegisters(3);
+  CHECK(inverter.StartReadData(true));
+  CHECK_EQUAL(inverter.Poll(), READ_BUSY);
+  CHECK(_Cached(inverter, cached));
+  CHECK_STRING(cached.c_str(), first.c_str());
+
+  // replaced once the cycle is complete
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  CHECK(_Cached(inverter, again));
+  CHECK(again != first);
+  CHECK_STRING(again.c_str(), _Live(inverter).c_str());
+}
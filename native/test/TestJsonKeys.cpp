@@ -0,0 +1,112 @@
+// The documents keyed by register name (Growatt::CreateJson(), CreateDeltaJson(), CreateUIJson())
+// have every key once. Protocol 125 has registers in both tables under the same name, many JSON
+// readers take the last of duplicate keys, others the first or fail. The Home Assistant discovery
+// configs (CreateDiscoveryJson()) fit the MQTT packet with the longest topic.
+
+#include <Arduino.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "InverterSimulator.h"
+#include "Config.h"
+
+#define MAC "00:11:22:33:44:55"
+
+class KeyPrint : public Print {
+  public:
+    size_t write(uint8_t c) override {
+      Text += (char)c;
+      return 1;
+    }
+
+    std::vector<std::string> Keys() const {
+      /**
+       * @brief The keys of the outermost object, the keys need no unescaping
+       */
+      std::vector<std::string> keys;
+      int depth = 0;
+
+      for (size_t i = 0; i < Text.size(); i++) {
+        char c = Text[i];
+        if (c == '{' || c == '[') {
+          depth++;
+        } else if (c == '}' || c == ']') {
+          depth--;
+        } else if (c == '"') {
+          size_t end = i + 1;
+          while (end < Text.size() && Text[end] != '"') {
+            end += (Text[end] == '\\') ? 2 : 1;
+          }
+          if (depth == 1 && end + 1 < Text.size() && Text[end + 1] == ':')
+            keys.push_back(Text.substr(i + 1, end - i - 1));
+          i = end;
+        }
+      }
+      return keys;
+    }
+
+    std::string Text;
+};
+
+static void _CheckUnique(const char *document, const KeyPrint &out, size_t minimum) {
+  std::vector<std::string> keys = out.Keys();
+  std::set<std::string> seen;
+
+  Test::Context("%s", document);
+  CHECK(keys.size() >= minimum);
+  for (const std::string &key : keys) {
+    Test::Context("%s: %s", document, key.c_str());
+    CHECK(seen.insert(key).second);
+  }
+}
+
+TEST(JsonKeys_Unique) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+  KeyPrint json, delta, ui;
+
+  NativeClock::Advance(1000000);
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  if (!CHECK(inverter.GetWiFiStickType() != Undef_stick) || !CHECK(inverter.ReadData(true)))
+    return;
+
+  inverter.CreateJson(json, MAC);
+  _CheckUnique("CreateJson", json, protocol.InputRegisterCount + 2);
+  CHECK(inverter.PrepareDeltaJson(true));
+  inverter.CreateDeltaJson(delta, MAC);
+  _CheckUnique("CreateDeltaJson", delta, protocol.InputRegisterCount + 4);
+  inverter.CreateUIJson(ui, false);
+  _CheckUnique("CreateUIJson", ui, 1);
+}
+
+TEST(JsonKeys_DiscoveryConfig) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+  // the MQTT topic of the config portal has up to 64 characters
+  std::string topic(64, 't');
+  const char *deviceId = "growatt_AABBCCDDEEFF";
+
+  inverter.InitProtocol();
+  for (int t = 0; t < 2; t++) {
+    int count = (t == 0) ? protocol.InputRegisterCount : protocol.HoldingRegisterCount;
+    for (int i = 0; i < count; i++) {
+      const sGrowattModbusReg_t &reg = (t == 0) ? protocol.InputRegisters[i] : protocol.HoldingRegisters[i];
+      std::string stateTopic = topic + "/" + reg.name;
+      std::string configTopic = std::string(MQTT_DISCOVERY_PREFIX "/sensor/") + deviceId + "/" + reg.name + "/config";
+      KeyPrint config;
+
+      Growatt::CreateDiscoveryJson(config, reg, stateTopic.c_str(), deviceId);
+      _CheckUnique(reg.name, config, 4);
+      Test::Context("%s", reg.name);
+      CHECK(config.Text.find(std::string("\"uniq_id\":\"") + deviceId + "_" + reg.name + "\"") != std::string::npos);
+      CHECK(config.Text.size() + configTopic.size() + 7 <= MQTT_MAX_PACKET_SIZE);
+    }
+  }
+}
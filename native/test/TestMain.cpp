@@ -0,0 +1,110 @@
+// Tests of the inverter modules against the simulated inverter, built by env:native_test (one
+// env per protocol, as the register tables are chosen at compile time) and run on the
+// development machine:
+//   pio run -e native_test -t exec
+// or, for the tests with a name containing <filter>, after the build:
+//   .pio/build/native_test/program <filter>
+// Exits with 1 if a test failed.
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+#include "Test.h"
+
+// reports per test, the exhaustive tests could flood the output otherwise
+#define TEST_MAX_REPORTS 20
+
+static Test *_Tests = NULL;
+static uint32_t _Failures;
+static char _Context[128];
+
+Test::Test(const char *name, TestFunction_t run) {
+  _Name = name;
+  _Run = run;
+  _Next = _Tests;
+  _Tests = this;
+}
+
+int Test::RunAll(const char *filter) {
+  /**
+   * @brief Run the tests in the order of their names
+   * @returns the number of tests failed
+   */
+  int run = 0;
+  int failed = 0;
+  const char *last = "";
+
+  for (;;) {
+    Test *next = NULL;
+    for (Test *test = _Tests; test != NULL; test = test->_Next) {
+      if (strcmp(test->_Name, last) > 0 && (next == NULL || strcmp(test->_Name, next->_Name) < 0))
+        next = test;
+    }
+    if (next == NULL)
+      break;
+    last = next->_Name;
+    if (filter != NULL && strstr(next->_Name, filter) == NULL)
+      continue;
+
+    _Failures = 0;
+    _Context[0] = '\0';
+    next->_Run();
+    run++;
+    if (_Failures > 0) {
+      failed++;
+      printf("FAILED %s (%u checks)\n", next->_Name, _Failures);
+    } else {
+      printf("ok     %s\n", next->_Name);
+    }
+    fflush(stdout);
+  }
+  printf("%d tests, %d failed (protocol %d)\n", run, failed, GROWATT_MODBUS_VERSION);
+  return failed;
+}
+
+void Test::Context(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(_Context, sizeof(_Context), format, args);
+  va_end(args);
+}
+
+bool Test::Check(bool ok, const char *expression, const char *file, int line) {
+  if (!ok)
+    _Fail(file, line, "%s", expression);
+  return ok;
+}
+
+bool Test::CheckEqual(long long actual, long long expected, const char *expression, const char *file, int line) {
+  if (actual != expected)
+    _Fail(file, line, "%s: %lld, expected %lld", expression, actual, expected);
+  return actual == expected;
+}
+
+bool Test::CheckString(const char *actual, const char *expected, const char *expression, const char *file,
+                       int line) {
+  bool ok = (strcmp(actual, expected) == 0);
+
+  if (!ok)
+    _Fail(file, line, "%s: \"%s\", expected \"%s\"", expression, actual, expected);
+  return ok;
+}
+
+void Test::_Fail(const char *file, int line, const char *format, ...) {
+  va_list args;
+
+  if (++_Failures > TEST_MAX_REPORTS)
+    return;
+  printf("  %s:%d: ", file, line);
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  if (_Context[0] != '\0')
+    printf(" [%s]", _Context);
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  return (Test::RunAll((argc > 1) ? argv[1] : NULL) > 0) ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+// The Modbus RTU master (ModbusRtu) against the simulated inverter: successful reads and writes,
+// and the faults a real bus produces (no answer, broken checksum, exception, short frame). Frames
+// the simulator does not produce come from a FrameStream.
+
+#include <Arduino.h>
+
+#include "Test.h"
+#include "ModbusRtu.h"
+#include "InverterSimulator.h"
+#include "Config.h"
+
+#ifndef MODBUS_RESPONSE_TIMEOUT
+#define MODBUS_RESPONSE_TIMEOUT 2000
+#endif
+
+// Answers every request with the same frame, the checksum is appended
+class FrameStream : public Stream {
+  public:
+    FrameStream(const uint8_t *frame, size_t length) : _Length(0), _Position(0) {
+      uint16_t crc = InverterSimulator::Crc16(frame, length);
+      memcpy(_Frame, frame, length);
+      _Frame[length] = crc & 0xFF;
+      _Frame[length + 1] = crc >> 8;
+      _FrameLength = length + 2;
+    }
+    size_t write(uint8_t) override {
+      // the answer is ready once the 8 bytes of a request are sent
+      if (++_Length % 8 == 0)
+        _Position = 0;
+      return 1;
+    }
+    using Print::write;
+    int available() override { return (_Length >= 8) ? _FrameLength - _Position : 0; }
+    int read() override { return (available() > 0) ? _Frame[_Position++] : -1; }
+    int peek() override { return (available() > 0) ? _Frame[_Position] : -1; }
+
+  private:
+    uint8_t _Frame[16];
+    size_t _FrameLength;
+    size_t _Length;
+    size_t _Position;
+};
+
+static void _Begin(ModbusRtu &modbus) {
+  modbus.begin(1, Serial);
+  for (uint16_t i = 0; i < 10; i++) {
+    Inverter485.SetInput(100 + i, 0x1100 + i);
+    Inverter485.SetHolding(100 + i, 0x2200 + i);
+  }
+}
+
+TEST(ModbusRtu_Read) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBSuccess);
+  for (uint8_t i = 0; i < 5; i++) {
+    CHECK_EQUAL(modbus.getResponseBuffer(i), 0x1100 + i);
+  }
+  CHECK_EQUAL(modbus.getResponseBuffer(5), 0xFFFF);
+
+  CHECK_EQUAL(modbus.readHoldingRegisters(102, 3), ModbusRtu::ku8MBSuccess);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0x2202);
+  CHECK_EQUAL(modbus.getResponseBuffer(2), 0x2204);
+  CHECK_EQUAL(modbus.getResponseBuffer(3), 0xFFFF);
+
+  CHECK(!modbus.startReadInputRegisters(100, 0));
+  CHECK(!modbus.startReadInputRegisters(100, ModbusRtu::ku8MaxBufferSize + 1));
+}
+
+TEST(ModbusRtu_Write) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  CHECK_EQUAL(modbus.writeSingleRegister(105, 0xBEEF), ModbusRtu::ku8MBSuccess);
+  CHECK_EQUAL(modbus.readHoldingRegisters(105, 1), ModbusRtu::ku8MBSuccess);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0xBEEF);
+}
+
+TEST(ModbusRtu_NonBlocking) {
+  ModbusRtu modbus;
+  int polls = 0;
+  uint8_t result;
+
+  _Begin(modbus);
+  CHECK(modbus.startReadInputRegisters(100, 2));
+  CHECK(modbus.busy());
+  // one request at a time
+  CHECK(!modbus.startReadHoldingRegisters(100, 2));
+  CHECK_EQUAL(modbus.readInputRegisters(100, 2), ModbusRtu::ku8MBBusy);
+
+  while ((result = modbus.poll()) == ModbusRtu::ku8MBBusy && polls < 1000) {
+    polls++;
+  }
+  CHECK_EQUAL(result, ModbusRtu::ku8MBSuccess);
+  CHECK(!modbus.busy());
+  CHECK_EQUAL(modbus.getResponseBuffer(1), 0x1101);
+  // the result stays until the next request
+  CHECK_EQUAL(modbus.poll(), ModbusRtu::ku8MBSuccess);
+}
+
+TEST(ModbusRtu_Timeout) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  Inverter485.Fault(ModbusRtu::ku8MBResponseTimedOut);
+  CHECK(modbus.startReadInputRegisters(100, 5));
+  CHECK_EQUAL(modbus.poll(), ModbusRtu::ku8MBBusy);
+  NativeClock::Advance((MODBUS_RESPONSE_TIMEOUT - 100) * 1000ULL);
+  CHECK_EQUAL(modbus.poll(), ModbusRtu::ku8MBBusy);
+  NativeClock::Advance(200 * 1000ULL);
+  CHECK_EQUAL(modbus.poll(), ModbusRtu::ku8MBResponseTimedOut);
+  CHECK(!modbus.busy());
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0xFFFF);
+
+  // the bus is usable again
+  CHECK_EQUAL(modbus.readInputRegisters(100, 1), ModbusRtu::ku8MBSuccess);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0x1100);
+}
+
+TEST(ModbusRtu_InvalidCrc) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  Inverter485.Fault(ModbusRtu::ku8MBInvalidCRC);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBInvalidCRC);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0xFFFF);
+
+  Inverter485.Fault(ModbusRtu::ku8MBInvalidCRC);
+  CHECK_EQUAL(modbus.writeSingleRegister(105, 1), ModbusRtu::ku8MBInvalidCRC);
+}
+
+TEST(ModbusRtu_Exception) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  // illegal data address, the exception code is the result
+  Inverter485.Fault(0x02);
+  CHECK_EQUAL(modbus.readHoldingRegisters(100, 5), 0x02);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0xFFFF);
+
+  // slave device failure
+  Inverter485.Fault(0x04);
+  CHECK_EQUAL(modbus.writeSingleRegister(105, 1), 0x04);
+
+  // the answer of another slave or to another function
+  Inverter485.Fault(ModbusRtu::ku8MBInvalidSlaveID);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBInvalidSlaveID);
+  Inverter485.Fault(ModbusRtu::ku8MBInvalidFunction);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBInvalidFunction);
+}
+
+TEST(ModbusRtu_ShortFrame) {
+  ModbusRtu modbus;
+
+  _Begin(modbus);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBSuccess);
+
+  // a valid frame with 3 of the 5 registers must not leave the last read in the buffer
+  Inverter485.Fault(ModbusRtu::ku8MBSuccess, 3);
+  CHECK_EQUAL(modbus.readHoldingRegisters(100, 5), ModbusRtu::ku8MBInvalidFunction);
+  for (uint8_t i = 0; i < 5; i++) {
+    CHECK_EQUAL(modbus.getResponseBuffer(i), 0xFFFF);
+  }
+
+  Inverter485.Fault(ModbusRtu::ku8MBSuccess, 0);
+  CHECK_EQUAL(modbus.readHoldingRegisters(100, 1), ModbusRtu::ku8MBInvalidFunction);
+
+  CHECK_EQUAL(modbus.readHoldingRegisters(100, 5), ModbusRtu::ku8MBSuccess);
+  CHECK_EQUAL(modbus.getResponseBuffer(4), 0x2204);
+}
+
+TEST(ModbusRtu_WriteEcho) {
+  ModbusRtu modbus;
+  const uint8_t echo[] = {1, 0x06, 0x00, 105, 0xBE, 0xEF};
+  FrameStream stream(echo, sizeof(echo));
+
+  modbus.begin(1, stream);
+  CHECK_EQUAL(modbus.writeSingleRegister(105, 0xBEEF), ModbusRtu::ku8MBSuccess);
+  // an echo of another value or register does not confirm the write
+  CHECK_EQUAL(modbus.writeSingleRegister(105, 0xBEEE), ModbusRtu::ku8MBInvalidFunction);
+  CHECK_EQUAL(modbus.writeSingleRegister(106, 0xBEEF), ModbusRtu::ku8MBInvalidFunction);
+}
+
+TEST(ModbusRtu_ExceptionCodeZero) {
+  ModbusRtu modbus;
+  const uint8_t exception[] = {1, 0x84, 0x00};
+  FrameStream stream(exception, sizeof(exception));
+
+  modbus.begin(1, stream);
+  CHECK_EQUAL(modbus.readInputRegisters(100, 5), ModbusRtu::ku8MBInvalidFunction);
+  CHECK_EQUAL(modbus.getResponseBuffer(0), 0xFFFF);
+}
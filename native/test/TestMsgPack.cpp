@@ -0,0 +1,383 @@
+// The MessagePack documents (Growatt::CreateMsgPack(), CreateDeltaMsgPack()) decoded with the
+// schema (CreateSchemaJson()) give the values of the JSON documents, register by register. The
+// JSON documents leave out the holding registers named like an input register.
+// Both formats are read by the small readers below into the same tree, ArduinoJson reads
+// string keys only and the delta document has integer ones.
+
+#include <Arduino.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Test.h"
+#include "GrowattTest.h"
+#include "InverterSimulator.h"
+
+#define MAC "00:11:22:33:44:55"
+
+class StringPrint : public Print {
+  public:
+    size_t write(uint8_t c) override {
+      Text += (char)c;
+      return 1;
+    }
+
+    std::string Text;
+};
+
+struct Node {
+  enum { Invalid, Nil, Bool, Number, String, Array, Map } Type = Invalid;
+  double Value = 0;
+  std::string Text;
+  // map members keep their order, integer keys are converted to text
+  std::vector<std::pair<std::string, Node>> Members;
+  std::vector<Node> Items;
+
+  const Node &operator[](const char *key) const {
+    static const Node missing;
+    for (const auto &member : Members) {
+      if (member.first == key)
+        return member.second;
+    }
+    return missing;
+  }
+  const Node &operator[](size_t index) const {
+    static const Node missing;
+    return (index < Items.size()) ? Items[index] : missing;
+  }
+};
+
+class JsonReader {
+  public:
+    JsonReader(const std::string &text) : _Text(text), _Position(0), _Failed(false) {}
+
+    bool Read(Node &node) {
+      _Value(node);
+      _Space();
+      return !_Failed && _Position == _Text.size();
+    }
+
+  private:
+    const std::string &_Text;
+    size_t _Position;
+    bool _Failed;
+
+    void _Space() {
+      while (_Position < _Text.size() && isspace((unsigned char)_Text[_Position])) {
+        _Position++;
+      }
+    }
+
+    bool _Next(char c) {
+      _Space();
+      if (_Position < _Text.size() && _Text[_Position] == c) {
+        _Position++;
+        return true;
+      }
+      return false;
+    }
+
+    void _Expect(char c) {
+      if (!_Next(c))
+        _Failed = true;
+    }
+
+    std::string _String() {
+      std::string s;
+      _Expect('"');
+      while (!_Failed && _Position < _Text.size() && _Text[_Position] != '"') {
+        if (_Text[_Position] == '\\')
+          _Position++;
+        s += _Text[_Position++];
+      }
+      _Expect('"');
+      return s;
+    }
+
+    void _Value(Node &node) {
+      _Space();
+      if (_Failed || _Position >= _Text.size()) {
+        _Failed = true;
+      } else if (_Next('{')) {
+        node.Type = Node::Map;
+        while (!_Failed && !_Next('}')) {
+          if (!node.Members.empty())
+            _Expect(',');
+          node.Members.emplace_back(_String(), Node());
+          _Expect(':');
+          _Value(node.Members.back().second);
+        }
+      } else if (_Next('[')) {
+        node.Type = Node::Array;
+        while (!_Failed && !_Next(']')) {
+          if (!node.Items.empty())
+            _Expect(',');
+          node.Items.emplace_back();
+          _Value(node.Items.back());
+        }
+      } else if (_Text[_Position] == '"') {
+        node.Type = Node::String;
+        node.Text = _String();
+      } else if (_Text.compare(_Position, 4, "true") == 0 || _Text.compare(_Position, 5, "false") == 0) {
+        node.Type = Node::Bool;
+        node.Value = _Text[_Position] == 't';
+        _Position += node.Value ? 4 : 5;
+      } else if (_Text.compare(_Position, 4, "null") == 0) {
+        node.Type = Node::Nil;
+        _Position += 4;
+      } else {
+        char *end;
+        node.Type = Node::Number;
+        node.Value = strtod(_Text.c_str() + _Position, &end);
+        _Failed = end == _Text.c_str() + _Position;
+        _Position = end - _Text.c_str();
+      }
+    }
+};
+
+class MsgPackReader {
+  public:
+    MsgPackReader(const std::string &data) : _Data(data), _Position(0), _Failed(false) {}
+
+    bool Read(Node &node) {
+      _Value(node);
+      return !_Failed && _Position == _Data.size();
+    }
+
+  private:
+    const std::string &_Data;
+    size_t _Position;
+    bool _Failed;
+
+    uint8_t _Byte() {
+      if (_Position >= _Data.size()) {
+        _Failed = true;
+        return 0xC1;
+      }
+      return _Data[_Position++];
+    }
+
+    uint32_t _Big(uint8_t bytes) {
+      uint32_t value = 0;
+      while (bytes--) {
+        value = (value << 8) | _Byte();
+      }
+      return value;
+    }
+
+    void _Value(Node &node) {
+      uint8_t code = _Byte();
+      uint32_t count = 0;
+
+      if (code < 0x80 || code == 0xCC || code == 0xCD || code == 0xCE) {
+        node.Type = Node::Number;
+        node.Value = (code < 0x80) ? code : _Big(code == 0xCC ? 1 : (code == 0xCD ? 2 : 4));
+      } else if (code >= 0xE0 || code == 0xD0 || code == 0xD1 || code == 0xD2) {
+        node.Type = Node::Number;
+        if (code >= 0xE0)
+          node.Value = (int8_t)code;
+        else if (code == 0xD0)
+          node.Value = (int8_t)_Big(1);
+        else if (code == 0xD1)
+          node.Value = (int16_t)_Big(2);
+        else
+          node.Value = (int32_t)_Big(4);
+      } else if (code == 0xC0) {
+        node.Type = Node::Nil;
+      } else if (code == 0xC2 || code == 0xC3) {
+        node.Type = Node::Bool;
+        node.Value = code == 0xC3;
+      } else if ((code & 0xE0) == 0xA0 || code == 0xD9 || code == 0xDA) {
+        count = ((code & 0xE0) == 0xA0) ? code & 0x1F : _Big(code == 0xD9 ? 1 : 2);
+        node.Type = Node::String;
+        if (_Position + count > _Data.size()) {
+          _Failed = true;
+          return;
+        }
+        node.Text = _Data.substr(_Position, count);
+        _Position += count;
+      } else if ((code & 0xF0) == 0x90 || code == 0xDC) {
+        count = ((code & 0xF0) == 0x90) ? code & 0x0F : _Big(2);
+        node.Type = Node::Array;
+        for (uint32_t i = 0; i < count && !_Failed; i++) {
+          node.Items.emplace_back();
+          _Value(node.Items.back());
+        }
+      } else if ((code & 0xF0) == 0x80 || code == 0xDE) {
+        count = ((code & 0xF0) == 0x80) ? code & 0x0F : _Big(2);
+        node.Type = Node::Map;
+        for (uint32_t i = 0; i < count && !_Failed; i++) {
+          Node key;
+          _Value(key);
+          if (key.Type == Node::Number)
+            key.Text = std::to_string((long)key.Value);
+          else if (key.Type != Node::String)
+            _Failed = true;
+          node.Members.emplace_back(key.Text, Node());
+          _Value(node.Members.back().second);
+        }
+      } else {
+        _Failed = true;
+      }
+    }
+};
+
+static void _FillRegisters(uint16_t round) {
+  // values of all magnitudes, 32 bit registers get large ones
+  for (uint32_t address = 0; address <= 0xFFFF; address++) {
+    Inverter485.SetInput(address, (uint16_t)((address * 7919U + round * 104729U) >> (address % 13)));
+    Inverter485.SetHolding(address, (uint16_t)((address * 6271U + round * 15485863U) >> (address % 11)));
+  }
+}
+
+static bool _Read(Growatt &inverter, uint16_t round) {
+  _FillRegisters(round);
+  return CHECK(inverter.ReadData(true));
+}
+
+static bool _Detect(Growatt &inverter) {
+  NativeClock::Advance(1000000);
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  return CHECK(inverter.GetWiFiStickType() != Undef_stick);
+}
+
+static bool _Parse(Growatt &inverter, Node &schema) {
+  StringPrint text;
+
+  inverter.CreateSchemaJson(text);
+  if (!CHECK(JsonReader(text.Text).Read(schema)))
+    return false;
+  CHECK_EQUAL(schema["Schema"].Value, inverter.GetSchemaId());
+  CHECK_EQUAL(schema["Input"].Items.size(), GrowattTest::Protocol(inverter).InputRegisterCount);
+  CHECK_EQUAL(schema["Holding"].Items.size(), GrowattTest::Protocol(inverter).HoldingRegisterCount);
+  return true;
+}
+
+static void _CheckValue(const std::pair<std::string, Node> &json, const Node &schema, const Node &raw) {
+  /**
+   * @brief Compare a member of the JSON document with the raw value scaled by the schema entry
+   *        [name, unit, multiplier] of its register
+   */
+  double expected = raw.Value * schema[2].Value;
+
+  CHECK_STRING(json.first.c_str(), schema[(size_t)0].Text.c_str());
+  CHECK_EQUAL(raw.Type, Node::Number);
+  CHECK_EQUAL(json.second.Type, Node::Number);
+  if (!CHECK(fabs(json.second.Value - expected) <= 1e-9 * fmax(1.0, fabs(expected))))
+    Test::Context("raw %.0f, JSON %.10g, scaled %.10g", raw.Value, json.second.Value, expected);
+}
+
+static void _CheckTrailer(const Node &msg, const Node &json, const char *const *keys, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const Node &m = msg[keys[i]];
+    const Node &j = json[keys[i]];
+    Test::Context("member %s", keys[i]);
+    CHECK(m.Type != Node::Invalid);
+    CHECK_EQUAL(m.Type, j.Type);
+    CHECK_EQUAL(m.Value, j.Value);
+    CHECK_STRING(m.Text.c_str(), j.Text.c_str());
+  }
+}
+
+TEST(MsgPack_FullDocumentMatchesJson) {
+  Growatt inverter;
+  const sProtocolDefinition_t &protocol = GrowattTest::Protocol(inverter);
+  const char *const trailer[] = {"Mac", "Cnt"};
+  StringPrint jsonText, msgText;
+  Node schema, json, msg;
+  size_t member;
+  int duplicates = 0;
+
+  if (!_Detect(inverter) || !_Read(inverter, 1) || !_Parse(inverter, schema))
+    return;
+  inverter.CreateJson(jsonText, MAC);
+  inverter.CreateMsgPack(msgText, MAC);
+  if (!CHECK(JsonReader(jsonText.Text).Read(json)) || !CHECK(MsgPackReader(msgText.Text).Read(msg)))
+    return;
+
+  CHECK_EQUAL(msg.Members.size(), 5);
+  CHECK_EQUAL(msg["Schema"].Value, inverter.GetSchemaId());
+  CHECK_EQUAL(msg["Input"].Items.size(), protocol.InputRegisterCount);
+  CHECK_EQUAL(msg["Holding"].Items.size(), protocol.HoldingRegisterCount);
+  for (int i = 0; i < protocol.HoldingRegisterCount; i++) {
+    duplicates += inverter.IsDuplicateHolding(i);
+  }
+  if (!CHECK_EQUAL(json.Members.size(), protocol.InputRegisterCount + protocol.HoldingRegisterCount - duplicates + 2))
+    return;
+  _CheckTrailer(msg, json, trailer, 2);
+
+  // the JSON members are the input registers, then the holding registers, in table order
+  for (int i = 0; i < protocol.InputRegisterCount; i++) {
+    Test::Context("input register %d", i);
+    CHECK_EQUAL(msg["Input"][i].Value, inverter.GetInputValue(i));
+    _CheckValue(json.Members[i], schema["Input"][i], msg["Input"][i]);
+  }
+  member = protocol.InputRegisterCount;
+  for (int i = 0; i < protocol.HoldingRegisterCount; i++) {
+    Test::Context("holding register %d", i);
+    CHECK_EQUAL(msg["Holding"][i].Value, inverter.GetHoldingValue(i));
+    if (!inverter.IsDuplicateHolding(i))
+      _CheckValue(json.Members[member++], schema["Holding"][i], msg["Holding"][i]);
+  }
+}
+
+static void _CheckDelta(Growatt &inverter, const Node &schema) {
+  /**
+   * @brief Compare the delta documents selected by the last PrepareDeltaJson()
+   */
+  const char *const trailer[] = {"Mac", "Cnt", "Seq", "Full"};
+  StringPrint jsonText, msgText;
+  Node json, msg;
+  size_t member = 0;
+  size_t duplicates = 0;
+
+  inverter.CreateDeltaJson(jsonText, MAC);
+  inverter.CreateDeltaMsgPack(msgText, MAC);
+  if (!CHECK(JsonReader(jsonText.Text).Read(json)) || !CHECK(MsgPackReader(msgText.Text).Read(msg)))
+    return;
+
+  CHECK_EQUAL(msg.Members.size(), 7);
+  CHECK_EQUAL(msg["Schema"].Value, inverter.GetSchemaId());
+  for (const auto &reg : msg["Holding"].Members) {
+    duplicates += inverter.IsDuplicateHolding(strtoul(reg.first.c_str(), NULL, 10));
+  }
+  if (!CHECK_EQUAL(json.Members.size(), msg["Input"].Members.size() + msg["Holding"].Members.size() - duplicates + 4))
+    return;
+  _CheckTrailer(msg, json, trailer, 4);
+
+  // the registers are in table order in both, the MessagePack keys are the register IDs
+  for (const char *table : {"Input", "Holding"}) {
+    for (const auto &reg : msg[table].Members) {
+      size_t id = strtoul(reg.first.c_str(), NULL, 10);
+      Test::Context("%s register %s", table, reg.first.c_str());
+      if (table[0] == 'H' && inverter.IsDuplicateHolding(id))
+        continue;
+      if (CHECK(id < schema[table].Items.size()))
+        _CheckValue(json.Members[member], schema[table][id], reg.second);
+      member++;
+    }
+  }
+}
+
+TEST(MsgPack_DeltaDocumentMatchesJson) {
+  Growatt inverter;
+  Node schema;
+
+  if (!_Detect(inverter) || !_Read(inverter, 2) || !_Parse(inverter, schema))
+    return;
+
+  Test::Context("full snapshot");
+  CHECK(inverter.PrepareDeltaJson(true));
+  _CheckDelta(inverter, schema);
+
+  // all registers change, those beyond their deadband make the delta
+  if (!_Read(inverter, 3))
+    return;
+  Test::Context("changes");
+  CHECK(inverter.PrepareDeltaJson(false));
+  _CheckDelta(inverter, schema);
+}
@@ -0,0 +1,163 @@
+// The energy per phase (PhaseEnergy) follows the steps of the total energy counter. A counter
+// dropping to 0 or a low value for some read cycles, as inverters report around start-up, adds
+// nothing, a counter which was reset goes on from its new value. Saving without a change keeps
+// the saved state. The integration keeps what a cycle adds below a Ws, a state saved in double
+// Wh is taken over.
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <stddef.h>
+
+#include "Test.h"
+#include "PhaseEnergy.h"
+#include "Config.h"
+
+#define LIFETIME 12345600   // [Wh]
+#define CYCLE 36000UL       // [ms] 15 Wh per cycle at full power
+
+static bool _Near(int64_t total, int64_t counted) {
+  /**
+   * @brief The integration runs ahead of the counter by at most the energy of the cycles since
+   *        its last step
+   */
+  Test::Context("%lld Wh, counted %lld Wh", (long long)total, (long long)counted);
+  return CHECK(total >= counted && total < counted + 50);
+}
+
+class PhaseEnergyRun {
+  public:
+    PhaseEnergyRun() : Time(1000) {
+    }
+
+    void Add(int64_t counter, int cycles = 1, bool feedIn = true) {
+      // [0.1 W]
+      const int32_t power[PHASE_COUNT] = {feedIn ? 10000 : 0, feedIn ? 5000 : 0, 0};
+
+      for (int i = 0; i < cycles; i++) {
+        Energy.Add(Time, power, counter);
+        Time += CYCLE;
+      }
+    }
+
+    int64_t Sum() {
+      return Energy.Total(0) + Energy.Total(1) + Energy.Total(2);
+    }
+
+    PhaseEnergy Energy;
+    uint32_t Time;
+};
+
+TEST(PhaseEnergy_CounterDrop) {
+  PhaseEnergyRun run;
+
+  run.Add(LIFETIME, 3);
+  run.Add(LIFETIME + 100);
+  _Near(run.Sum(), 100);
+
+  // shorter and longer than PHASE_ENERGY_RESET_CYCLES, a low value which does not count up
+  run.Add(0, PHASE_ENERGY_RESET_CYCLES / 2, false);
+  run.Add(LIFETIME + 200);
+  _Near(run.Sum(), 200);
+  run.Add(0, PHASE_ENERGY_RESET_CYCLES * 3, false);
+  run.Add(LIFETIME + 300);
+  _Near(run.Sum(), 300);
+  run.Add(700, PHASE_ENERGY_RESET_CYCLES * 3, false);
+  run.Add(LIFETIME + 400);
+  _Near(run.Sum(), 400);
+  CHECK(run.Energy.Total(0) > run.Energy.Total(1) && run.Energy.Total(2) == 0);
+
+  LittleFS.remove("/energy.bin");
+}
+
+TEST(PhaseEnergy_CounterReset) {
+  PhaseEnergyRun run;
+
+  run.Add(LIFETIME, 3);
+  run.Add(LIFETIME + 100);
+  // a reset counter counts up from its new value after PHASE_ENERGY_RESET_CYCLES read cycles
+  run.Add(50, PHASE_ENERGY_RESET_CYCLES, false);
+  run.Add(150);
+  _Near(run.Sum(), 200);
+  run.Add(250);
+  _Near(run.Sum(), 300);
+
+  LittleFS.remove("/energy.bin");
+}
+
+TEST(PhaseEnergy_StartAtZero) {
+  PhaseEnergyRun run;
+
+  // no saved state and the inverter starting up with a counter of 0
+  run.Add(0, 3, false);
+  run.Add(LIFETIME);
+  run.Add(LIFETIME + 100);
+  _Near(run.Sum(), 100);
+
+  LittleFS.remove("/energy.bin");
+}
+
+TEST(PhaseEnergy_SaveUnchanged) {
+  PhaseEnergyRun run, restored;
+
+  run.Add(LIFETIME, 3);
+  run.Add(LIFETIME + 100);
+  run.Energy.Save();
+  // a restart before the state was restored, e.g. the config portal failing in setup()
+  PhaseEnergy early;
+  early.Save();
+  restored.Energy.Begin();
+  _Near(restored.Sum(), 100);
+
+  LittleFS.remove("/energy.bin");
+}
+
+TEST(PhaseEnergy_LowPower) {
+  PhaseEnergy energy;
+  // [0.1 W], a cycle of 3.6 s adds 0.36 Ws, nothing and 36 Ws
+  const int32_t power[PHASE_COUNT] = {1, 0, 100};
+  const int32_t idle[PHASE_COUNT] = {0, 0, 0};
+  uint32_t time = 1000;
+
+  for (int i = 0; i <= 10000; i++) {
+    energy.Add(time, power, LIFETIME);
+    time += 3600;
+  }
+  // 10 h
+  CHECK_EQUAL(energy.Total(0), 1);
+  CHECK_EQUAL(energy.Total(1), 0);
+  CHECK_EQUAL(energy.Total(2), 100);
+  energy.Add(time, idle, LIFETIME);
+
+  LittleFS.remove("/energy.bin");
+}
+
+TEST(PhaseEnergy_MigrateV1) {
+  struct {
+    uint32_t Magic;
+    double Energy[PHASE_COUNT];
+    double Pending[PHASE_COUNT];
+    double Counter;
+    double Reported[PHASE_COUNT];
+    uint32_t Checksum;
+  } old = {PHASE_ENERGY_MAGIC_V1, {1000.25, 500, 0}, {10, 5, 0}, LIFETIME, {1010.25, 505.5, 0}, 2166136261UL};
+  const uint8_t *bytes = (const uint8_t *)&old;
+  PhaseEnergyRun run;
+
+  // FNV-1a of PhaseEnergy.cpp
+  for (size_t i = 0; i < offsetof(decltype(old), Checksum); i++) {
+    old.Checksum = (old.Checksum ^ bytes[i]) * 16777619UL;
+  }
+  File file = LittleFS.open("/energy.bin", "w");
+  file.write(bytes, sizeof(old));
+  file.close();
+
+  run.Energy.Begin();
+  CHECK_EQUAL(run.Energy.Total(0), 1010);
+  CHECK_EQUAL(run.Energy.Total(1), 506);
+  // the counter is taken over: its next step is split, no new reference
+  run.Add(LIFETIME, 3);
+  run.Add(LIFETIME + 100);
+  _Near(run.Sum(), 1500 + 100);
+
+  LittleFS.remove("/energy.bin");
+}
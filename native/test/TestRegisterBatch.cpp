@@ -0,0 +1,90 @@
+// The register batch of <ip>/registers (RegisterBatch): the reads after one timed out and the
+// ones beyond REGISTER_BATCH_MAX_REQUESTS are left out, each read costs the web server up to
+// the response timeout if the inverter doesn't answer.
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "Test.h"
+#include "RegisterBatch.h"
+#include "InverterSimulator.h"
+#include "Config.h"
+
+static bool _Detect(Growatt &inverter) {
+  NativeClock::Advance(1000000);
+  inverter.InitProtocol();
+  inverter.begin(Serial);
+  while (inverter.Poll() == READ_BUSY) {
+  }
+  return CHECK(inverter.GetWiFiStickType() != Undef_stick);
+}
+
+static std::string _List(uint16_t reads) {
+  /**
+   * @brief Registers far enough apart to be read with a request each
+   */
+  std::string list;
+
+  for (uint16_t i = 0; i < reads; i++) {
+    list += (i > 0) ? "," : "";
+    list += std::to_string(1000 + i * (MODBUS_REQUEST_COST + 10));
+  }
+  return list;
+}
+
+static std::string _Write(RegisterBatch &batch) {
+  char buffer[8192];
+  BufferPrint out(buffer, sizeof(buffer));
+
+  batch.Write(out);
+  return std::string(buffer, out.Length());
+}
+
+static size_t _Count(const std::string &text, const std::string &part) {
+  size_t count = 0;
+
+  for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) {
+    count++;
+  }
+  return count;
+}
+
+TEST(RegisterBatch_Timeout) {
+  Growatt inverter;
+  RegisterBatch batch;
+
+  if (!_Detect(inverter))
+    return;
+  CHECK(batch.Add(false, _List(4).c_str()));
+
+  uint32_t requests = Inverter485.Requests();
+  Inverter485.Fault(ModbusRtu::ku8MBResponseTimedOut);
+  CHECK(batch.Read(inverter, 0));
+  CHECK_EQUAL(Inverter485.Requests() - requests, 1);
+
+  std::string json = _Write(batch);
+  Test::Context("%s", json.c_str());
+  CHECK(json.find("\"requests\":1,") != std::string::npos);
+  CHECK_EQUAL(_Count(json, "\"result\":226}"), 1);
+  CHECK_EQUAL(_Count(json, "\"result\":null}"), 3);
+  CHECK_EQUAL(_Count(json, "\"values\":[null]"), 4);
+}
+
+TEST(RegisterBatch_MaxRequests) {
+  Growatt inverter;
+  RegisterBatch batch;
+
+  if (!_Detect(inverter))
+    return;
+  CHECK(batch.Add(true, _List(REGISTER_BATCH_MAX_REQUESTS + 3).c_str()));
+
+  uint32_t requests = Inverter485.Requests();
+  CHECK(batch.Read(inverter, 0));
+  CHECK_EQUAL(Inverter485.Requests() - requests, REGISTER_BATCH_MAX_REQUESTS);
+
+  std::string json = _Write(batch);
+  Test::Context("%s", json.c_str());
+  CHECK_EQUAL(_Count(json, "\"values\":[null]"), 3);
+  CHECK_EQUAL(_Count(json, "\"result\":null}"), 3);
+}
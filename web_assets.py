@@ -0,0 +1,83 @@
+"""Compress the web UI in SRC/ShineWiFi-ModBus/web into index.h
+
+The files are stored gzip compressed as PROGMEM arrays and served with
+Content-Encoding: gzip. Each file gets an ETag derived from its content,
+index.html references chart.js with that ETag as version, so the library
+can be cached for good. Runs before every PlatformIO build, or by hand with
+python3 web_assets.py (e.g. for the Arduino IDE). index.h is only rewritten
+if its content changes.
+"""
+import gzip
+import hashlib
+import os
+
+try:
+    from SCons.Script import Import  # type: ignore
+    Import("env")
+    project_dir = env["PROJECT_DIR"]
+except Exception:
+    env = None
+    project_dir = os.path.dirname(os.path.abspath(__file__))
+
+src_dir = os.path.join(project_dir, 'SRC', 'ShineWiFi-ModBus')
+web_dir = os.path.join(src_dir, 'web')
+target = os.path.join(src_dir, 'index.h')
+
+# (file, symbol, content type), chart.js first, its version goes into index.html
+ASSETS = [
+    ('chart.js', 'CHART_JS', 'application/javascript'),
+    ('index.html', 'INDEX_HTML', 'text/html'),
+]
+
+
+def read_asset(name: str) -> bytes:
+    with open(os.path.join(web_dir, name), 'rb') as f:
+        return f.read()
+
+
+def c_array(symbol: str, data: bytes) -> str:
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('  ' + ', '.join('0x%02x' % b for b in data[i:i + 16]) + ',')
+    return 'const uint8_t %s_GZ[] PROGMEM = {\n%s\n};\n' % (symbol, '\n'.join(lines))
+
+
+def build_header() -> str:
+    out = [
+        '// Generated by web_assets.py from the files in web/, do not edit.\n',
+        '// The web UI, gzip compressed, with ETags of the uncompressed files\n',
+        '#ifndef _INDEX_H_\n',
+        '#define _INDEX_H_\n',
+        '\n',
+    ]
+    versions = {}
+    for name, symbol, content_type in ASSETS:
+        data = read_asset(name)
+        for key, version in versions.items():
+            data = data.replace(('%' + key + '_VERSION%').encode(), version.encode())
+        version = hashlib.sha256(data).hexdigest()[:16]
+        versions[symbol] = version
+        # mtime 0: the output only depends on the content
+        compressed = gzip.compress(data, 9, mtime=0)
+
+        out.append('// %s: %d bytes, %d bytes compressed\n' % (name, len(data), len(compressed)))
+        out.append('#define %s_TYPE "%s"\n' % (symbol, content_type))
+        out.append('#define %s_ETAG "\\"%s\\""\n' % (symbol, version))
+        out.append(c_array(symbol, compressed))
+        out.append('\n')
+    out.append('#endif // _INDEX_H_\n')
+    return ''.join(out)
+
+
+def main() -> None:
+    header = build_header()
+    if os.path.isfile(target):
+        with open(target, 'r') as f:
+            if f.read() == header:
+                return
+    with open(target, 'w') as f:
+        f.write(header)
+    print('web_assets.py: rebuilt index.h')
+
+
+main()